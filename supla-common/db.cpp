@@ -25,7 +25,11 @@
 #include "log.h"
 #include "tools.h"
 
-dbcommon::dbcommon() { _mysql = NULL; }
+dbcommon::dbcommon() {
+  _mysql = NULL;
+  in_transaction = false;
+  last_stmt_errno = 0;
+}
 
 dbcommon::~dbcommon() { disconnect(); }
 
@@ -110,6 +114,8 @@ void dbcommon::disconnect(void) {
     mysql_close((MYSQL *)_mysql);
     _mysql = NULL;
   }
+
+  in_transaction = false;
 }
 
 int dbcommon::query(const char *stmt_str, bool log_err) {
@@ -122,11 +128,20 @@ int dbcommon::query(const char *stmt_str, bool log_err) {
   return result;
 }
 
-void dbcommon::start_transaction(void) { query("START TRANSACTION"); }
+void dbcommon::start_transaction(void) {
+  in_transaction = true;
+  query("START TRANSACTION");
+}
 
-void dbcommon::commit(void) { query("COMMIT"); }
+void dbcommon::commit(void) {
+  in_transaction = false;
+  query("COMMIT");
+}
 
-void dbcommon::rollback(void) { query("ROLLBACK", false); }
+void dbcommon::rollback(void) {
+  in_transaction = false;
+  query("ROLLBACK", false);
+}
 
 void dbcommon::stmt_close(void *_stmt) {
   if (_stmt != NULL) mysql_stmt_close((MYSQL_STMT *)_stmt);
@@ -141,6 +156,7 @@ bool dbcommon::stmt_execute(void **_stmt, const char *stmt_str, void *bind,
     supla_log(LOG_ERR, "MySQL - mysql_stmt_init(), out of memory");
 
   } else if (mysql_stmt_prepare(stmt, stmt_str, strnlen(stmt_str, 10240))) {
+    last_stmt_errno = mysql_stmt_errno(stmt);
     supla_log(LOG_ERR, "MySQL - stmt prepare error - %s",
               mysql_stmt_error(stmt));
 
@@ -164,6 +180,7 @@ bool dbcommon::stmt_execute(void **_stmt, const char *stmt_str, void *bind,
 
     if (err == false) {
       if (mysql_stmt_execute(stmt) != 0) {
+        last_stmt_errno = mysql_stmt_errno(stmt);
         if (exec_errors)
           supla_log(LOG_ERR, "MySQL - execute error: %s",
                     mysql_stmt_error(stmt));
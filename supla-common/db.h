@@ -24,6 +24,10 @@
 class dbcommon {
  protected:
   void *_mysql;
+  bool in_transaction;
+  // The error code of the last failed statement, 0 if none failed since
+  // connect().
+  unsigned int last_stmt_errno;
   int query(const char *stmt_str, bool log_err = false);
   bool stmt_execute(void **_stmt, const char *stmt_str, void *bind,
                     int bind_size, bool exec_errors = false);
@@ -44,9 +48,9 @@ class dbcommon {
 
  public:
   dbcommon();
-  bool connect(int connection_timeout_sec);
+  virtual bool connect(int connection_timeout_sec);
   bool connect(void);
-  void disconnect(void);
+  virtual void disconnect(void);
   virtual ~dbcommon();
 
   static bool mainthread_init(void);
@@ -34,7 +34,7 @@
 #include <sys/eventfd.h>
 #endif
 
-TEventHandler *eh_init(void) {
+static TEventHandler *_eh_init(unsigned char use_epoll) {
 #ifdef __linux__
   struct epoll_event evnt = {0};
 #endif
@@ -52,11 +52,15 @@ TEventHandler *eh_init(void) {
 
 #ifdef __linux__
 
+    if (use_epoll) {
 #ifdef __ANDROID__
-    eh->epoll_fd = epoll_create(1);
+      eh->epoll_fd = epoll_create(1);
 #else
-    eh->epoll_fd = epoll_create1(0);
+      eh->epoll_fd = epoll_create1(0);
 #endif
+    } else {
+      eh->epoll_fd = -1;
+    }
 
     eh->fd1 = eventfd(0, EFD_NONBLOCK);
     eh->nfds = eh->fd1 + 1;
@@ -86,6 +90,13 @@ TEventHandler *eh_init(void) {
 #endif
 }
 
+TEventHandler *eh_init(void) { return _eh_init(1); }
+
+// The event handler created in this way does not have its own epoll instance.
+// It is intended for objects whose descriptors are monitored by an external
+// event loop, which only needs the event descriptor (fd1).
+TEventHandler *eh_init_without_epoll(void) { return _eh_init(0); }
+
 void eh_add_fd(TEventHandler *eh, int fd) {
 #ifdef __linux__
   struct epoll_event evnt = {0};
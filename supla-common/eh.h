@@ -56,6 +56,7 @@ typedef struct {
 } TEventHandler;
 
 TEventHandler *eh_init(void);
+TEventHandler *eh_init_without_epoll(void);
 void eh_add_fd(TEventHandler *eh, int fd);
 void eh_raise_event(TEventHandler *eh);
 int eh_wait(TEventHandler *eh, int usec);
@@ -19,13 +19,38 @@
 #include "safearray.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include "log.h"
 
+#define SAFE_ARRAY_INDEX_MIN_BUCKET_COUNT 16
+
+typedef struct {
+  unsigned long long key;
+  void *ptr;
+} TSafeArrayIndexItem;
+
+typedef struct {
+  int count;
+  TSafeArrayIndexItem *items;
+} TSafeArrayBucket;
+
+// Hash index. The items are assigned to buckets by the key returned by
+// key_func, which must not change while the item is in the array.
+typedef struct {
+  _func_sa_key key_func;
+  int count;
+  int bucket_count;
+  TSafeArrayBucket *buckets;
+} TSafeArrayIndex;
+
 typedef struct {
   void *lck;
 
   int count;
   void **arr;
+
+  int index_count;
+  TSafeArrayIndex index[SAFE_ARRAY_MAX_INDEX_COUNT];
 } TSafeArray;
 
 void *safe_array_init(void) {
@@ -33,18 +58,236 @@ void *safe_array_init(void) {
   sa->lck = lck_init();
   sa->count = 0;
   sa->arr = NULL;
+  sa->index_count = 0;
 
   return sa;
 }
 
+static void safe_array_index_free(TSafeArrayIndex *index) {
+  int a;
+  for (a = 0; a < index->bucket_count; a++) {
+    free(index->buckets[a].items);
+  }
+  free(index->buckets);
+  index->buckets = NULL;
+  index->bucket_count = 0;
+  index->count = 0;
+}
+
 void safe_array_free(void *_arr) {
+  int a;
   assert(_arr != 0);
 
+  for (a = 0; a < ((TSafeArray *)_arr)->index_count; a++) {
+    safe_array_index_free(&((TSafeArray *)_arr)->index[a]);
+  }
+
   lck_free(((TSafeArray *)_arr)->lck);
   free(((TSafeArray *)_arr)->arr);
   free(_arr);
 }
 
+unsigned long long safe_array_key_hash(const void *data, int size) {
+  // FNV-1a
+  unsigned long long result = 14695981039346656037ULL;
+  int a;
+
+  for (a = 0; a < size; a++) {
+    result ^= ((const unsigned char *)data)[a];
+    result *= 1099511628211ULL;
+  }
+
+  return result;
+}
+
+static TSafeArrayBucket *safe_array_index_bucket(TSafeArrayIndex *index,
+                                                 unsigned long long key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return &index->buckets[key & (index->bucket_count - 1)];
+}
+
+static char safe_array_bucket_add(TSafeArrayBucket *bucket,
+                                  unsigned long long key, void *ptr) {
+  TSafeArrayIndexItem *items = realloc(
+      bucket->items, sizeof(TSafeArrayIndexItem) * (bucket->count + 1));
+
+  if (items == NULL) {
+    return 0;
+  }
+
+  bucket->items = items;
+  bucket->items[bucket->count].key = key;
+  bucket->items[bucket->count].ptr = ptr;
+  bucket->count++;
+
+  return 1;
+}
+
+static char safe_array_bucket_remove(TSafeArrayBucket *bucket, void *ptr) {
+  int a;
+
+  for (a = 0; a < bucket->count; a++) {
+    if (bucket->items[a].ptr == ptr) {
+      bucket->count--;
+      if (a < bucket->count) {
+        bucket->items[a] = bucket->items[bucket->count];
+      }
+
+      if (bucket->count == 0) {
+        free(bucket->items);
+        bucket->items = NULL;
+      }
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void safe_array_index_rehash(TSafeArrayIndex *index, int bucket_count) {
+  TSafeArrayIndex new_index = *index;
+  int a, b;
+
+  new_index.bucket_count = bucket_count;
+  new_index.buckets = calloc(bucket_count, sizeof(TSafeArrayBucket));
+
+  if (new_index.buckets == NULL) {
+    return;
+  }
+
+  for (a = 0; a < index->bucket_count; a++) {
+    TSafeArrayBucket *bucket = &index->buckets[a];
+    for (b = 0; b < bucket->count; b++) {
+      if (!safe_array_bucket_add(
+              safe_array_index_bucket(&new_index, bucket->items[b].key),
+              bucket->items[b].key, bucket->items[b].ptr)) {
+        safe_array_index_free(&new_index);
+        return;
+      }
+    }
+  }
+
+  new_index.count = index->count;
+  safe_array_index_free(index);
+  *index = new_index;
+}
+
+static char safe_array_index_add(TSafeArrayIndex *index, void *ptr) {
+  if (index->count >= index->bucket_count * 2) {
+    safe_array_index_rehash(
+        index, index->bucket_count ? index->bucket_count * 2
+                                   : SAFE_ARRAY_INDEX_MIN_BUCKET_COUNT);
+  }
+
+  if (index->bucket_count == 0) {
+    return 0;
+  }
+
+  unsigned long long key = index->key_func(ptr);
+  if (!safe_array_bucket_add(safe_array_index_bucket(index, key), key, ptr)) {
+    return 0;
+  }
+
+  index->count++;
+  return 1;
+}
+
+static void safe_array_index_remove(TSafeArrayIndex *index, void *ptr) {
+  int a;
+
+  if (index->bucket_count == 0) {
+    return;
+  }
+
+  if (safe_array_bucket_remove(
+          safe_array_index_bucket(index, index->key_func(ptr)), ptr)) {
+    index->count--;
+    return;
+  }
+
+  // The key has changed since the item was added.
+  for (a = 0; a < index->bucket_count; a++) {
+    if (safe_array_bucket_remove(&index->buckets[a], ptr)) {
+      index->count--;
+      return;
+    }
+  }
+}
+
+static void safe_array_indexes_remove(TSafeArray *arr, void *ptr,
+                                      int index_count) {
+  int a;
+  for (a = 0; a < index_count; a++) {
+    safe_array_index_remove(&arr->index[a], ptr);
+  }
+}
+
+int safe_array_add_index(void *_arr, _func_sa_key key_func) {
+  int result = -1;
+  int a;
+  TSafeArray *arr = (TSafeArray *)_arr;
+
+  assert(_arr != 0);
+  assert(key_func != 0);
+
+  safe_array_lock(_arr);
+
+  if (arr->index_count < SAFE_ARRAY_MAX_INDEX_COUNT) {
+    TSafeArrayIndex *index = &arr->index[arr->index_count];
+    memset(index, 0, sizeof(TSafeArrayIndex));
+    index->key_func = key_func;
+    result = arr->index_count;
+
+    for (a = 0; a < arr->count; a++) {
+      if (!safe_array_index_add(index, arr->arr[a])) {
+        safe_array_index_free(index);
+        result = -1;
+        break;
+      }
+    }
+
+    if (result != -1) {
+      arr->index_count++;
+    }
+  }
+
+  safe_array_unlock(_arr);
+
+  return result;
+}
+
+void *safe_array_findkey(void *_arr, int index_num, unsigned long long key,
+                         _func_sa_cnd_param find_cnd, void *user_param) {
+  void *result = NULL;
+  int a;
+  TSafeArray *arr = (TSafeArray *)_arr;
+
+  assert(_arr != 0);
+
+  safe_array_lock(_arr);
+
+  if (index_num >= 0 && index_num < arr->index_count &&
+      arr->index[index_num].bucket_count > 0) {
+    TSafeArrayBucket *bucket =
+        safe_array_index_bucket(&arr->index[index_num], key);
+
+    for (a = 0; a < bucket->count; a++) {
+      if (bucket->items[a].key == key &&
+          (find_cnd == NULL ||
+           find_cnd(bucket->items[a].ptr, user_param) == 1)) {
+        result = bucket->items[a].ptr;
+        break;
+      }
+    }
+  }
+
+  safe_array_unlock(_arr);
+
+  return result;
+}
+
 #ifdef __LCK_DEBUG
 void _safe_array_lock(void *_arr, const char *file, int line) {
   assert(_arr != 0);
@@ -94,6 +337,7 @@ void safe_array_move_to_begin(void *_arr, int idx) {
 
 int safe_array_add(void *_arr, void *ptr) {
   int result = 0;
+  int a;
   TSafeArray *arr = (TSafeArray *)_arr;
 
   assert(_arr != 0);
@@ -102,9 +346,18 @@ int safe_array_add(void *_arr, void *ptr) {
 
   safe_array_lock(_arr);
 
+  for (a = 0; a < arr->index_count; a++) {
+    if (!safe_array_index_add(&arr->index[a], ptr)) {
+      safe_array_indexes_remove(arr, ptr, a);
+      safe_array_unlock(_arr);
+      return -1;
+    }
+  }
+
   void **new_arr = realloc(arr->arr, sizeof(void *) * (arr->count + 1));
 
   if (new_arr == NULL) {
+    safe_array_indexes_remove(arr, ptr, arr->index_count);
     result = -1;
 
   } else {
@@ -129,6 +382,8 @@ void safe_array_delete(void *_arr, int idx) {
   safe_array_lock(_arr);
 
   if (idx < arr->count) {
+    safe_array_indexes_remove(arr, arr->arr[idx], arr->index_count);
+
     if (idx < arr->count - 1) arr->arr[idx] = arr->arr[arr->count - 1];
 
     void **new_arr = realloc(arr->arr, sizeof(void *) * (arr->count - 1));
@@ -200,6 +455,8 @@ void *safe_array_pop(void *_arr) {
 
   if (result != NULL) {
     for (a = 1; a < arr->count; a++) arr->arr[a - 1] = arr->arr[a];
+    // Let safe_array_delete remove the popped item from the indexes.
+    arr->arr[arr->count - 1] = result;
   }
 
   safe_array_delete(_arr, arr->count - 1);
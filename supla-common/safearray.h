@@ -25,8 +25,11 @@
 extern "C" {
 #endif
 
+#define SAFE_ARRAY_MAX_INDEX_COUNT 2
+
 typedef char (*_func_sa_cnd)(void *ptr);
 typedef char (*_func_sa_cnd_param)(void *ptr, void *user_param);
+typedef unsigned long long (*_func_sa_key)(void *ptr);
 
 void *safe_array_init(void);
 #ifdef __LCK_DEBUG
@@ -49,6 +52,16 @@ void *safe_array_findcnd(void *arr, _func_sa_cnd_param find_cnd,
                          void *user_param);
 void safe_array_move_to_begin(void *_arr, int idx);
 
+// Hash indexes allow to find items by key without scanning the whole array.
+// safe_array_add_index returns the index number or -1 on failure.
+// safe_array_findkey returns the first item with the given key for which
+// find_cnd returns 1. find_cnd can be NULL when the key is unique, otherwise
+// it resolves hash collisions (see safe_array_key_hash).
+int safe_array_add_index(void *arr, _func_sa_key key_func);
+void *safe_array_findkey(void *arr, int index_num, unsigned long long key,
+                         _func_sa_cnd_param find_cnd, void *user_param);
+unsigned long long safe_array_key_hash(const void *data, int size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,11 +52,16 @@
 #define SRPC_QUEUE_MIN_ALLOC_COUNT 2
 #endif /* SRPC_QUEUE_MIN_ALLOC_COUNT */
 
+#ifndef SRPC_QUEUE_RETAIN_SIZE
+#define SRPC_QUEUE_RETAIN_SIZE 0
+#endif /* SRPC_QUEUE_RETAIN_SIZE */
+
 #elif defined(__AVR__)
 
 #define SRPC_BUFFER_SIZE 32
 #define SRPC_QUEUE_SIZE 1
 #define SRPC_QUEUE_MIN_ALLOC_COUNT 1
+#define SRPC_QUEUE_RETAIN_SIZE 0
 #define __EH_DISABLED
 
 #else
@@ -75,11 +80,23 @@
 #define SRPC_QUEUE_MIN_ALLOC_COUNT 0
 #endif /*SRPC_QUEUE_MIN_ALLOC_COUNT*/
 
+// Queue slots not larger than SRPC_QUEUE_RETAIN_SIZE are not released after
+// use, regardless of SRPC_QUEUE_MIN_ALLOC_COUNT.
+#ifndef SRPC_QUEUE_RETAIN_SIZE
+#define SRPC_QUEUE_RETAIN_SIZE 1024
+#endif /*SRPC_QUEUE_RETAIN_SIZE*/
+
+#define SRPC_SDP_HEADER_SIZE (sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE)
+
+// Ring buffer. Slots are allocated according to the actual size of the packet
+// and reused as long as they are large enough.
 typedef struct {
   unsigned char item_count;
   unsigned char alloc_count;
+  unsigned char head;
 
   TSuplaDataPacket *item[SRPC_QUEUE_SIZE];
+  unsigned _supla_int_t item_size[SRPC_QUEUE_SIZE];
 } Tsrpc_Queue;
 
 typedef struct {
@@ -133,11 +150,14 @@ void SRPC_ICACHE_FLASH srpc_queue_free(Tsrpc_Queue *queue) {
   for (a = 0; a < SRPC_QUEUE_SIZE; a++) {
     if (queue->item[a] != NULL) {
       free(queue->item[a]);
+      queue->item[a] = NULL;
     }
+    queue->item_size[a] = 0;
   }
 
   queue->item_count = 0;
   queue->alloc_count = 0;
+  queue->head = 0;
 }
 
 void SRPC_ICACHE_FLASH srpc_free(void *_srpc) {
@@ -159,64 +179,124 @@ void SRPC_ICACHE_FLASH srpc_free(void *_srpc) {
   }
 }
 
+unsigned char SRPC_ICACHE_FLASH srpc_queue_idx(Tsrpc_Queue *queue,
+                                              unsigned char n) {
+  return (queue->head + n) % SRPC_QUEUE_SIZE;
+}
+
 char SRPC_ICACHE_FLASH srpc_queue_push(Tsrpc_Queue *queue,
                                        TSuplaDataPacket *sdp) {
   if (queue->item_count >= SRPC_QUEUE_SIZE) {
     return SUPLA_RESULT_FALSE;
   }
 
-  if (queue->item[queue->item_count] == NULL) {
-    queue->item[queue->item_count] =
-        (TSuplaDataPacket *)malloc(sizeof(TSuplaDataPacket));
+  unsigned _supla_int_t size = SRPC_SDP_HEADER_SIZE;
+  if (sdp->data_size > SUPLA_MAX_DATA_SIZE) {
+    size += SUPLA_MAX_DATA_SIZE;
+  } else {
+    size += sdp->data_size;
   }
 
-  if (queue->item[queue->item_count] == NULL) {
-    return SUPLA_RESULT_FALSE;
-  } else {
+  unsigned char idx = srpc_queue_idx(queue, queue->item_count);
+
+  if (queue->item[idx] != NULL && queue->item_size[idx] < size) {
+    free(queue->item[idx]);
+    queue->item[idx] = NULL;
+    queue->item_size[idx] = 0;
+    queue->alloc_count--;
+  }
+
+  if (queue->item[idx] == NULL) {
+    queue->item[idx] = (TSuplaDataPacket *)malloc(size);
+    if (queue->item[idx] == NULL) {
+      return SUPLA_RESULT_FALSE;
+    }
+
+    queue->item_size[idx] = size;
     queue->alloc_count++;
   }
 
-  memcpy(queue->item[queue->item_count], sdp, sizeof(TSuplaDataPacket));
+  memcpy(queue->item[idx], sdp, size);
   queue->item_count++;
 
   return SUPLA_RESULT_TRUE;
 }
 
-char SRPC_ICACHE_FLASH srpc_queue_pop(Tsrpc_Queue *queue, TSuplaDataPacket *sdp,
-                                      unsigned _supla_int_t rr_id) {
-  _supla_int_t a, b;
+// Returns the packet in place. The packet stays in the queue until
+// srpc_queue_remove is called. Only the first SRPC_SDP_HEADER_SIZE +
+// data_size bytes of the returned packet are valid.
+TSuplaDataPacket *SRPC_ICACHE_FLASH srpc_queue_get(Tsrpc_Queue *queue,
+                                                  unsigned _supla_int_t rr_id,
+                                                  unsigned char *n) {
+  unsigned char a;
 
-  for (a = 0; a < queue->item_count; a++)
-    if (rr_id == 0 || queue->item[a]->rr_id == rr_id) {
-      memcpy(sdp, queue->item[a], sizeof(TSuplaDataPacket));
+  for (a = 0; a < queue->item_count; a++) {
+    TSuplaDataPacket *item = queue->item[srpc_queue_idx(queue, a)];
+    if (rr_id == 0 || item->rr_id == rr_id) {
+      *n = a;
+      return item;
+    }
+  }
 
-      if (queue->alloc_count > SRPC_QUEUE_MIN_ALLOC_COUNT) {
-        queue->alloc_count--;
-        free(queue->item[a]);
-        queue->item[a] = NULL;
-      }
+  return NULL;
+}
 
-      TSuplaDataPacket *item = queue->item[a];
+void SRPC_ICACHE_FLASH srpc_queue_remove(Tsrpc_Queue *queue, unsigned char n) {
+  unsigned char a;
 
-      for (b = a; b < queue->item_count - 1; b++) {
-        queue->item[b] = queue->item[b + 1];
-      }
+  if (n >= queue->item_count) {
+    return;
+  }
 
-      queue->item_count--;
-      queue->item[queue->item_count] = item;
+  unsigned char idx = srpc_queue_idx(queue, n);
+  TSuplaDataPacket *item = queue->item[idx];
+  unsigned _supla_int_t item_size = queue->item_size[idx];
+
+  if (queue->alloc_count > SRPC_QUEUE_MIN_ALLOC_COUNT &&
+      item_size > SRPC_QUEUE_RETAIN_SIZE) {
+    queue->alloc_count--;
+    free(item);
+    item = NULL;
+    item_size = 0;
+  }
 
-      return SUPLA_RESULT_TRUE;
+  if (n == 0) {
+    // The most common case. No need to move anything.
+    queue->item[idx] = item;
+    queue->item_size[idx] = item_size;
+    queue->head = srpc_queue_idx(queue, 1);
+  } else {
+    for (a = n; a < queue->item_count - 1; a++) {
+      unsigned char i1 = srpc_queue_idx(queue, a);
+      unsigned char i2 = srpc_queue_idx(queue, a + 1);
+      queue->item[i1] = queue->item[i2];
+      queue->item_size[i1] = queue->item_size[i2];
     }
 
-  return SUPLA_RESULT_FALSE;
+    idx = srpc_queue_idx(queue, queue->item_count - 1);
+    queue->item[idx] = item;
+    queue->item_size[idx] = item_size;
+  }
+
+  queue->item_count--;
+
+  if (queue->item_count == 0) {
+    queue->head = 0;
+  }
 }
 
-char SRPC_ICACHE_FLASH srpc_in_queue_pop(Tsrpc *srpc, TSuplaDataPacket *sdp,
-                                         unsigned _supla_int_t rr_id) {
+TSuplaDataPacket *SRPC_ICACHE_FLASH srpc_in_queue_get(
+    Tsrpc *srpc, unsigned _supla_int_t rr_id, unsigned char *n) {
 #ifdef SRPC_WITHOUT_IN_QUEUE
-  return 1;
+  return &srpc->sdp;
 #else
-  return srpc_queue_pop(&srpc->in_queue, sdp, rr_id);
+  return srpc_queue_get(&srpc->in_queue, rr_id, n);
+#endif /*SRPC_WITHOUT_IN_QUEUE*/
+}
+
+void SRPC_ICACHE_FLASH srpc_in_queue_remove(Tsrpc *srpc, unsigned char n) {
+#ifndef SRPC_WITHOUT_IN_QUEUE
+  srpc_queue_remove(&srpc->in_queue, n);
 #endif /*SRPC_WITHOUT_IN_QUEUE*/
 }
 
@@ -253,9 +333,13 @@ char SRPC_ICACHE_FLASH srpc_out_queue_push(Tsrpc *srpc, TSuplaDataPacket *sdp) {
 }
 
 #ifndef SRPC_WITHOUT_OUT_QUEUE
-char SRPC_ICACHE_FLASH srpc_out_queue_pop(Tsrpc *srpc, TSuplaDataPacket *sdp,
-                                          unsigned _supla_int_t rr_id) {
-  return srpc_queue_pop(&srpc->out_queue, sdp, rr_id);
+TSuplaDataPacket *SRPC_ICACHE_FLASH srpc_out_queue_get(Tsrpc *srpc,
+                                                      unsigned char *n) {
+  return srpc_queue_get(&srpc->out_queue, 0, n);
+}
+
+void SRPC_ICACHE_FLASH srpc_out_queue_remove(Tsrpc *srpc, unsigned char n) {
+  srpc_queue_remove(&srpc->out_queue, n);
 }
 #endif /*SRPC_WITHOUT_OUT_QUEUE*/
 
@@ -356,12 +440,19 @@ char SRPC_ICACHE_FLASH srpc_iterate(void *_srpc) {
 
   // --------- OUT ---------------
 #ifndef SRPC_WITHOUT_OUT_QUEUE
-  if (srpc_out_queue_pop(srpc, &srpc->sdp, 0) == SUPLA_RESULT_TRUE &&
-      SUPLA_RESULT_TRUE !=
-          (result = sproto_out_buffer_append(srpc->proto, &srpc->sdp)) &&
-      result != SUPLA_RESULT_FALSE) {
-    supla_log(LOG_DEBUG, "sproto_out_buffer_append error: %i", result);
-    return lck_unlock_r(srpc->lck, SUPLA_RESULT_FALSE);
+  {
+    unsigned char n = 0;
+    TSuplaDataPacket *sdp = srpc_out_queue_get(srpc, &n);
+
+    if (sdp != NULL) {
+      result = sproto_out_buffer_append(srpc->proto, sdp);
+      srpc_out_queue_remove(srpc, n);
+
+      if (result != SUPLA_RESULT_TRUE && result != SUPLA_RESULT_FALSE) {
+        supla_log(LOG_DEBUG, "sproto_out_buffer_append error: %i", result);
+        return lck_unlock_r(srpc->lck, SUPLA_RESULT_FALSE);
+      }
+    }
   }
 
   data_size = sproto_pop_out_data(srpc->proto, data_buffer, SRPC_BUFFER_SIZE);
@@ -402,8 +493,9 @@ typedef unsigned _supla_int_t (*_func_srpc_pack_get_caption_size)(
     void *pack, _supla_int_t idx);
 
 void SRPC_ICACHE_FLASH srpc_getpack(
-    Tsrpc *srpc, TsrpcReceivedData *rd, unsigned _supla_int_t pack_sizeof,
-    unsigned _supla_int_t item_sizeof, unsigned _supla_int_t pack_max_count,
+    TSuplaDataPacket *sdp, TsrpcReceivedData *rd,
+    unsigned _supla_int_t pack_sizeof, unsigned _supla_int_t item_sizeof,
+    unsigned _supla_int_t pack_max_count,
     unsigned _supla_int_t caption_max_size,
     _func_srpc_pack_get_pack_count pack_get_count,
     _func_srpc_pack_set_pack_count pack_set_count,
@@ -414,11 +506,11 @@ void SRPC_ICACHE_FLASH srpc_getpack(
   _supla_int_t a, count, size, offset, pack_size;
   void *pack = NULL;
 
-  if (srpc->sdp.data_size < header_size || srpc->sdp.data_size > pack_sizeof) {
+  if (sdp->data_size < header_size || sdp->data_size > pack_sizeof) {
     return;
   }
 
-  count = pack_get_count(srpc->sdp.data);
+  count = pack_get_count(sdp->data);
 
   if (count < 0 || count > pack_max_count) {
     return;
@@ -430,18 +522,18 @@ void SRPC_ICACHE_FLASH srpc_getpack(
   if (pack == NULL) return;
 
   memset(pack, 0, pack_size);
-  memcpy(pack, srpc->sdp.data, header_size);
+  memcpy(pack, sdp->data, header_size);
 
   offset = header_size;
   pack_set_count(pack, 0, 0);
 
   for (a = 0; a < count; a++)
-    if (srpc->sdp.data_size - offset >= c_header_size) {
-      size = get_item_caption_size(&srpc->sdp.data[offset]);
+    if (sdp->data_size - offset >= c_header_size) {
+      size = get_item_caption_size(&sdp->data[offset]);
 
       if (size >= 0 && size <= caption_max_size &&
-          srpc->sdp.data_size - offset >= c_header_size + size) {
-        memcpy(get_item_ptr(pack, a), &srpc->sdp.data[offset],
+          sdp->data_size - offset >= c_header_size + size) {
+        memcpy(get_item_ptr(pack, a), &sdp->data[offset],
                c_header_size + size);
         offset += c_header_size + size;
         pack_set_count(pack, 1, 1);
@@ -452,7 +544,7 @@ void SRPC_ICACHE_FLASH srpc_getpack(
     }
 
   if (count == pack_get_count(pack)) {
-    srpc->sdp.data_size = 0;
+    sdp->data_size = 0;
     // dcs_ping is 1st variable in union
     rd->data.dcs_ping = pack;
 
@@ -484,8 +576,9 @@ srpc_channelpack_get_item_caption_size(void *item) {
   return ((TSC_SuplaChannel *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getchannelpack(Tsrpc *srpc, TsrpcReceivedData *rd) {
-  srpc_getpack(srpc, rd, sizeof(TSC_SuplaChannelPack), sizeof(TSC_SuplaChannel),
+void SRPC_ICACHE_FLASH srpc_getchannelpack(TSuplaDataPacket *sdp,
+                                           TsrpcReceivedData *rd) {
+  srpc_getpack(sdp, rd, sizeof(TSC_SuplaChannelPack), sizeof(TSC_SuplaChannel),
                SUPLA_CHANNELPACK_MAXCOUNT, SUPLA_CHANNEL_CAPTION_MAXSIZE,
                &srpc_channelpack_get_pack_count,
                &srpc_channelpack_set_pack_count, &srpc_channelpack_get_item_ptr,
@@ -515,10 +608,10 @@ srpc_channelpack_get_item_caption_size_b(void *item) {
   return ((TSC_SuplaChannel_B *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getchannelpack_b(Tsrpc *srpc,
+void SRPC_ICACHE_FLASH srpc_getchannelpack_b(TSuplaDataPacket *sdp,
                                              TsrpcReceivedData *rd) {
   srpc_getpack(
-      srpc, rd, sizeof(TSC_SuplaChannelPack_B), sizeof(TSC_SuplaChannel_B),
+      sdp, rd, sizeof(TSC_SuplaChannelPack_B), sizeof(TSC_SuplaChannel_B),
       SUPLA_CHANNELPACK_MAXCOUNT, SUPLA_CHANNEL_CAPTION_MAXSIZE,
       &srpc_channelpack_get_pack_count_b, &srpc_channelpack_set_pack_count_b,
       &srpc_channelpack_get_item_ptr_b,
@@ -548,10 +641,10 @@ srpc_channelpack_get_item_caption_size_c(void *item) {
   return ((TSC_SuplaChannel_C *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getchannelpack_c(Tsrpc *srpc,
+void SRPC_ICACHE_FLASH srpc_getchannelpack_c(TSuplaDataPacket *sdp,
                                              TsrpcReceivedData *rd) {
   srpc_getpack(
-      srpc, rd, sizeof(TSC_SuplaChannelPack_C), sizeof(TSC_SuplaChannel_C),
+      sdp, rd, sizeof(TSC_SuplaChannelPack_C), sizeof(TSC_SuplaChannel_C),
       SUPLA_CHANNELPACK_MAXCOUNT, SUPLA_CHANNEL_CAPTION_MAXSIZE,
       &srpc_channelpack_get_pack_count_c, &srpc_channelpack_set_pack_count_c,
       &srpc_channelpack_get_item_ptr_c,
@@ -582,9 +675,9 @@ srpc_channelgroup_pack_get_item_caption_size(void *item) {
   return ((TSC_SuplaChannelGroup *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getchannelgroup_pack(Tsrpc *srpc,
+void SRPC_ICACHE_FLASH srpc_getchannelgroup_pack(TSuplaDataPacket *sdp,
                                                  TsrpcReceivedData *rd) {
-  srpc_getpack(srpc, rd, sizeof(TSC_SuplaChannelGroupPack),
+  srpc_getpack(sdp, rd, sizeof(TSC_SuplaChannelGroupPack),
                sizeof(TSC_SuplaChannelGroup), SUPLA_CHANNELGROUP_PACK_MAXCOUNT,
                SUPLA_CHANNELGROUP_CAPTION_MAXSIZE,
                &srpc_channelgroup_pack_get_pack_count,
@@ -617,9 +710,9 @@ srpc_channelgroup_pack_b_get_item_caption_size(void *item) {
   return ((TSC_SuplaChannelGroup_B *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getchannelgroup_pack_b(Tsrpc *srpc,
+void SRPC_ICACHE_FLASH srpc_getchannelgroup_pack_b(TSuplaDataPacket *sdp,
                                                    TsrpcReceivedData *rd) {
-  srpc_getpack(srpc, rd, sizeof(TSC_SuplaChannelGroupPack_B),
+  srpc_getpack(sdp, rd, sizeof(TSC_SuplaChannelGroupPack_B),
                sizeof(TSC_SuplaChannelGroup_B),
                SUPLA_CHANNELGROUP_PACK_MAXCOUNT,
                SUPLA_CHANNELGROUP_CAPTION_MAXSIZE,
@@ -652,10 +745,10 @@ srpc_locationpack_get_item_caption_size(void *item) {
   return ((TSC_SuplaLocation *)item)->CaptionSize;
 }
 
-void SRPC_ICACHE_FLASH srpc_getlocationpack(Tsrpc *srpc,
+void SRPC_ICACHE_FLASH srpc_getlocationpack(TSuplaDataPacket *sdp,
                                             TsrpcReceivedData *rd) {
   srpc_getpack(
-      srpc, rd, sizeof(TSC_SuplaLocationPack), sizeof(TSC_SuplaLocation),
+      sdp, rd, sizeof(TSC_SuplaLocationPack), sizeof(TSC_SuplaLocation),
       SUPLA_LOCATIONPACK_MAXCOUNT, SUPLA_LOCATION_CAPTION_MAXSIZE,
       &srpc_locationpack_get_pack_count, &srpc_locationpack_set_pack_count,
       &srpc_locationpack_get_item_ptr,
@@ -666,18 +759,22 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
                                     unsigned _supla_int_t rr_id) {
   Tsrpc *srpc = (Tsrpc *)_srpc;
   char call_with_no_data = 0;
+  char result = SUPLA_RESULT_FALSE;
+  unsigned char n = 0;
+  TSuplaDataPacket *sdp = NULL;
   rd->call_type = 0;
 
   lck_lock(srpc->lck);
 
-  if (SUPLA_RESULT_TRUE == srpc_in_queue_pop(srpc, &srpc->sdp, rr_id)) {
-    rd->call_type = srpc->sdp.call_type;
-    rd->rr_id = srpc->sdp.rr_id;
+  // The packet is read directly from the queue, without copying.
+  if (NULL != (sdp = srpc_in_queue_get(srpc, rr_id, &n))) {
+    rd->call_type = sdp->call_type;
+    rd->rr_id = sdp->rr_id;
 
     // first one
     rd->data.dcs_ping = NULL;
 
-    switch (srpc->sdp.call_type) {
+    switch (sdp->call_type) {
       case SUPLA_DCS_CALL_GETVERSION:
       case SUPLA_CS_CALL_GET_NEXT:
       case SUPLA_DCS_CALL_GET_REGISTRATION_ENABLED:
@@ -686,7 +783,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SDC_CALL_GETVERSION_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSDC_SuplaGetVersionResult))
+        if (sdp->data_size == sizeof(TSDC_SuplaGetVersionResult))
           rd->data.sdc_getversion_result = (TSDC_SuplaGetVersionResult *)malloc(
               sizeof(TSDC_SuplaGetVersionResult));
 
@@ -694,7 +791,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SDC_CALL_VERSIONERROR:
 
-        if (srpc->sdp.data_size == sizeof(TSDC_SuplaVersionError))
+        if (sdp->data_size == sizeof(TSDC_SuplaVersionError))
           rd->data.sdc_version_error =
               (TSDC_SuplaVersionError *)malloc(sizeof(TSDC_SuplaVersionError));
 
@@ -702,15 +799,15 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DCS_CALL_PING_SERVER:
 
-        if (srpc->sdp.data_size == sizeof(TDCS_SuplaPingServer) ||
-            srpc->sdp.data_size == sizeof(TDCS_SuplaPingServer_COMPAT)) {
+        if (sdp->data_size == sizeof(TDCS_SuplaPingServer) ||
+            sdp->data_size == sizeof(TDCS_SuplaPingServer_COMPAT)) {
           rd->data.dcs_ping =
               (TDCS_SuplaPingServer *)malloc(sizeof(TDCS_SuplaPingServer));
 
 #ifndef __AVR__
-          if (srpc->sdp.data_size == sizeof(TDCS_SuplaPingServer_COMPAT)) {
+          if (sdp->data_size == sizeof(TDCS_SuplaPingServer_COMPAT)) {
             TDCS_SuplaPingServer_COMPAT *compat =
-                (TDCS_SuplaPingServer_COMPAT *)srpc->sdp.data;
+                (TDCS_SuplaPingServer_COMPAT *)sdp->data;
 
             rd->data.dcs_ping->now.tv_sec = compat->now.tv_sec;
             rd->data.dcs_ping->now.tv_usec = compat->now.tv_usec;
@@ -722,7 +819,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SDC_CALL_PING_SERVER_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSDC_SuplaPingServerResult))
+        if (sdp->data_size == sizeof(TSDC_SuplaPingServerResult))
           rd->data.sdc_ping_result = (TSDC_SuplaPingServerResult *)malloc(
               sizeof(TSDC_SuplaPingServerResult));
 
@@ -730,7 +827,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DCS_CALL_SET_ACTIVITY_TIMEOUT:
 
-        if (srpc->sdp.data_size == sizeof(TDCS_SuplaSetActivityTimeout))
+        if (sdp->data_size == sizeof(TDCS_SuplaSetActivityTimeout))
           rd->data.dcs_set_activity_timeout =
               (TDCS_SuplaSetActivityTimeout *)malloc(
                   sizeof(TDCS_SuplaSetActivityTimeout));
@@ -739,7 +836,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SDC_CALL_SET_ACTIVITY_TIMEOUT_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSDC_SuplaSetActivityTimeoutResult))
+        if (sdp->data_size == sizeof(TSDC_SuplaSetActivityTimeoutResult))
           rd->data.sdc_set_activity_timeout_result =
               (TSDC_SuplaSetActivityTimeoutResult *)malloc(
                   sizeof(TSDC_SuplaSetActivityTimeoutResult));
@@ -748,7 +845,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SDC_CALL_GET_REGISTRATION_ENABLED_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSDC_RegistrationEnabled))
+        if (sdp->data_size == sizeof(TSDC_RegistrationEnabled))
           rd->data.sdc_reg_enabled = (TSDC_RegistrationEnabled *)malloc(
               sizeof(TSDC_RegistrationEnabled));
 
@@ -757,8 +854,8 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         call_with_no_data = 1;
         break;
       case SUPLA_DCS_CALL_GET_USER_LOCALTIME_RESULT:
-        if (srpc->sdp.data_size <= sizeof(TSDC_UserLocalTimeResult) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSDC_UserLocalTimeResult) &&
+            sdp->data_size >=
                 (sizeof(TSDC_UserLocalTimeResult) - SUPLA_TIMEZONE_MAXSIZE)) {
           rd->data.sdc_user_localtime_result =
               (TSDC_UserLocalTimeResult *)malloc(
@@ -768,13 +865,13 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_CSD_CALL_GET_CHANNEL_STATE:
-        if (srpc->sdp.data_size == sizeof(TCSD_ChannelStateRequest))
+        if (sdp->data_size == sizeof(TCSD_ChannelStateRequest))
           rd->data.csd_channel_state_request =
               (TCSD_ChannelStateRequest *)malloc(
                   sizeof(TCSD_ChannelStateRequest));
         break;
       case SUPLA_DSC_CALL_CHANNEL_STATE_RESULT:
-        if (srpc->sdp.data_size == sizeof(TDSC_ChannelState))
+        if (sdp->data_size == sizeof(TDSC_ChannelState))
           rd->data.dsc_channel_state =
               (TDSC_ChannelState *)malloc(sizeof(TDSC_ChannelState));
         break;
@@ -782,10 +879,10 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 #ifndef SRPC_EXCLUDE_DEVICE
       case SUPLA_DS_CALL_REGISTER_DEVICE:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TDS_SuplaRegisterDevice) -
                  (sizeof(TDS_SuplaDeviceChannel) * SUPLA_CHANNELMAXCOUNT)) &&
-            srpc->sdp.data_size <= sizeof(TDS_SuplaRegisterDevice)) {
+            sdp->data_size <= sizeof(TDS_SuplaRegisterDevice)) {
           rd->data.ds_register_device = (TDS_SuplaRegisterDevice *)malloc(
               sizeof(TDS_SuplaRegisterDevice));
         }
@@ -794,10 +891,10 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_REGISTER_DEVICE_B:  // ver. >= 2
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TDS_SuplaRegisterDevice_B) -
                  (sizeof(TDS_SuplaDeviceChannel_B) * SUPLA_CHANNELMAXCOUNT)) &&
-            srpc->sdp.data_size <= sizeof(TDS_SuplaRegisterDevice_B)) {
+            sdp->data_size <= sizeof(TDS_SuplaRegisterDevice_B)) {
           rd->data.ds_register_device_b = (TDS_SuplaRegisterDevice_B *)malloc(
               sizeof(TDS_SuplaRegisterDevice_B));
         }
@@ -806,10 +903,10 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_REGISTER_DEVICE_C:  // ver. >= 6
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TDS_SuplaRegisterDevice_C) -
                  (sizeof(TDS_SuplaDeviceChannel_B) * SUPLA_CHANNELMAXCOUNT)) &&
-            srpc->sdp.data_size <= sizeof(TDS_SuplaRegisterDevice_C)) {
+            sdp->data_size <= sizeof(TDS_SuplaRegisterDevice_C)) {
           rd->data.ds_register_device_c = (TDS_SuplaRegisterDevice_C *)malloc(
               sizeof(TDS_SuplaRegisterDevice_C));
         }
@@ -818,10 +915,10 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_REGISTER_DEVICE_D:  // ver. >= 7
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TDS_SuplaRegisterDevice_D) -
                  (sizeof(TDS_SuplaDeviceChannel_B) * SUPLA_CHANNELMAXCOUNT)) &&
-            srpc->sdp.data_size <= sizeof(TDS_SuplaRegisterDevice_D)) {
+            sdp->data_size <= sizeof(TDS_SuplaRegisterDevice_D)) {
           rd->data.ds_register_device_d = (TDS_SuplaRegisterDevice_D *)malloc(
               sizeof(TDS_SuplaRegisterDevice_D));
         }
@@ -830,10 +927,10 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_REGISTER_DEVICE_E:  // ver. >= 10
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TDS_SuplaRegisterDevice_E) -
                  (sizeof(TDS_SuplaDeviceChannel_C) * SUPLA_CHANNELMAXCOUNT)) &&
-            srpc->sdp.data_size <= sizeof(TDS_SuplaRegisterDevice_E)) {
+            sdp->data_size <= sizeof(TDS_SuplaRegisterDevice_E)) {
           rd->data.ds_register_device_e = (TDS_SuplaRegisterDevice_E *)malloc(
               sizeof(TDS_SuplaRegisterDevice_E));
         }
@@ -842,7 +939,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SD_CALL_REGISTER_DEVICE_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSD_SuplaRegisterDeviceResult))
+        if (sdp->data_size == sizeof(TSD_SuplaRegisterDeviceResult))
           rd->data.sd_register_device_result =
               (TSD_SuplaRegisterDeviceResult *)malloc(
                   sizeof(TSD_SuplaRegisterDeviceResult));
@@ -850,7 +947,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_DEVICE_CHANNEL_VALUE_CHANGED:
 
-        if (srpc->sdp.data_size == sizeof(TDS_SuplaDeviceChannelValue))
+        if (sdp->data_size == sizeof(TDS_SuplaDeviceChannelValue))
           rd->data.ds_device_channel_value =
               (TDS_SuplaDeviceChannelValue *)malloc(
                   sizeof(TDS_SuplaDeviceChannelValue));
@@ -859,7 +956,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_DEVICE_CHANNEL_VALUE_CHANGED_B:
 
-        if (srpc->sdp.data_size == sizeof(TDS_SuplaDeviceChannelValue_B))
+        if (sdp->data_size == sizeof(TDS_SuplaDeviceChannelValue_B))
           rd->data.ds_device_channel_value_b =
               (TDS_SuplaDeviceChannelValue_B *)malloc(
                   sizeof(TDS_SuplaDeviceChannelValue_B));
@@ -868,7 +965,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_DEVICE_CHANNEL_VALUE_CHANGED_C:
 
-        if (srpc->sdp.data_size == sizeof(TDS_SuplaDeviceChannelValue_C))
+        if (sdp->data_size == sizeof(TDS_SuplaDeviceChannelValue_C))
           rd->data.ds_device_channel_value_c =
               (TDS_SuplaDeviceChannelValue_C *)malloc(
                   sizeof(TDS_SuplaDeviceChannelValue_C));
@@ -877,9 +974,9 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_DEVICE_CHANNEL_EXTENDEDVALUE_CHANGED:
 
-        if (srpc->sdp.data_size <=
+        if (sdp->data_size <=
                 sizeof(TDS_SuplaDeviceChannelExtendedValue) &&
-            srpc->sdp.data_size >=
+            sdp->data_size >=
                 (sizeof(TDS_SuplaDeviceChannelExtendedValue) -
                  SUPLA_CHANNELEXTENDEDVALUE_SIZE))
           rd->data.ds_device_channel_extendedvalue =
@@ -890,7 +987,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SD_CALL_CHANNEL_SET_VALUE:
 
-        if (srpc->sdp.data_size == sizeof(TSD_SuplaChannelNewValue))
+        if (sdp->data_size == sizeof(TSD_SuplaChannelNewValue))
           rd->data.sd_channel_new_value = (TSD_SuplaChannelNewValue *)malloc(
               sizeof(TSD_SuplaChannelNewValue));
 
@@ -898,7 +995,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SD_CALL_CHANNELGROUP_SET_VALUE:
 
-        if (srpc->sdp.data_size == sizeof(TSD_SuplaChannelGroupNewValue))
+        if (sdp->data_size == sizeof(TSD_SuplaChannelGroupNewValue))
           rd->data.sd_channelgroup_new_value =
               (TSD_SuplaChannelGroupNewValue *)malloc(
                   sizeof(TSD_SuplaChannelGroupNewValue));
@@ -907,7 +1004,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_CHANNEL_SET_VALUE_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TDS_SuplaChannelNewValueResult))
+        if (sdp->data_size == sizeof(TDS_SuplaChannelNewValueResult))
           rd->data.ds_channel_new_value_result =
               (TDS_SuplaChannelNewValueResult *)malloc(
                   sizeof(TDS_SuplaChannelNewValueResult));
@@ -916,7 +1013,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_DS_CALL_GET_FIRMWARE_UPDATE_URL:
 
-        if (srpc->sdp.data_size == sizeof(TDS_FirmwareUpdateParams))
+        if (sdp->data_size == sizeof(TDS_FirmwareUpdateParams))
           rd->data.ds_firmware_update_params =
               (TDS_FirmwareUpdateParams *)malloc(
                   sizeof(TDS_FirmwareUpdateParams));
@@ -925,29 +1022,29 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SD_CALL_GET_FIRMWARE_UPDATE_URL_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSD_FirmwareUpdate_UrlResult) ||
-            srpc->sdp.data_size == sizeof(char)) {
+        if (sdp->data_size == sizeof(TSD_FirmwareUpdate_UrlResult) ||
+            sdp->data_size == sizeof(char)) {
           rd->data.sc_firmware_update_url_result =
               (TSD_FirmwareUpdate_UrlResult *)malloc(
                   sizeof(TSD_FirmwareUpdate_UrlResult));
 
-          if (srpc->sdp.data_size == sizeof(char) &&
+          if (sdp->data_size == sizeof(char) &&
               rd->data.sc_firmware_update_url_result != NULL)
             memset(rd->data.sc_firmware_update_url_result, 0,
                    sizeof(TSD_FirmwareUpdate_UrlResult));
         }
         break;
       case SUPLA_SD_CALL_DEVICE_CALCFG_REQUEST:
-        if (srpc->sdp.data_size <= sizeof(TSD_DeviceCalCfgRequest) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSD_DeviceCalCfgRequest) &&
+            sdp->data_size >=
                 (sizeof(TSD_DeviceCalCfgRequest) - SUPLA_CALCFG_DATA_MAXSIZE)) {
           rd->data.sd_device_calcfg_request = (TSD_DeviceCalCfgRequest *)malloc(
               sizeof(TSD_DeviceCalCfgRequest));
         }
         break;
       case SUPLA_DS_CALL_DEVICE_CALCFG_RESULT:
-        if (srpc->sdp.data_size <= sizeof(TDS_DeviceCalCfgResult) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TDS_DeviceCalCfgResult) &&
+            sdp->data_size >=
                 (sizeof(TDS_DeviceCalCfgResult) - SUPLA_CALCFG_DATA_MAXSIZE)) {
           rd->data.ds_device_calcfg_result =
               (TDS_DeviceCalCfgResult *)malloc(sizeof(TDS_DeviceCalCfgResult));
@@ -957,8 +1054,8 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         call_with_no_data = 1;
         break;
       case SUPLA_SD_CALL_GET_CHANNEL_FUNCTIONS_RESULT:
-        if (srpc->sdp.data_size <= sizeof(TSD_ChannelFunctions) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSD_ChannelFunctions) &&
+            sdp->data_size >=
                 (sizeof(TSD_ChannelFunctions) -
                  sizeof(_supla_int_t) * SUPLA_CHANNELMAXCOUNT)) {
           rd->data.sd_channel_functions =
@@ -966,14 +1063,14 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         }
         break;
       case SUPLA_DS_CALL_GET_CHANNEL_INT_PARAMS:
-        if (srpc->sdp.data_size == sizeof(TDS_GetChannelIntParamsRequest)) {
+        if (sdp->data_size == sizeof(TDS_GetChannelIntParamsRequest)) {
           rd->data.ds_get_channel_int_params_request =
               (TDS_GetChannelIntParamsRequest *)malloc(
                   sizeof(TDS_GetChannelIntParamsRequest));
         }
         break;
       case SUPLA_SD_CALL_GET_CHANNEL_INT_PARAMS_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSD_ChannelIntParams)) {
+        if (sdp->data_size == sizeof(TSD_ChannelIntParams)) {
           rd->data.sd_channel_int_params =
               (TSD_ChannelIntParams *)malloc(sizeof(TSD_ChannelIntParams));
         }
@@ -983,7 +1080,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 #ifndef SRPC_EXCLUDE_CLIENT
       case SUPLA_CS_CALL_REGISTER_CLIENT:
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaRegisterClient))
+        if (sdp->data_size == sizeof(TCS_SuplaRegisterClient))
           rd->data.cs_register_client = (TCS_SuplaRegisterClient *)malloc(
               sizeof(TCS_SuplaRegisterClient));
 
@@ -991,7 +1088,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_REGISTER_CLIENT_B:  // ver. >= 6
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaRegisterClient_B))
+        if (sdp->data_size == sizeof(TCS_SuplaRegisterClient_B))
           rd->data.cs_register_client_b = (TCS_SuplaRegisterClient_B *)malloc(
               sizeof(TCS_SuplaRegisterClient_B));
 
@@ -999,7 +1096,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_REGISTER_CLIENT_C:  // ver. >= 7
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaRegisterClient_C))
+        if (sdp->data_size == sizeof(TCS_SuplaRegisterClient_C))
           rd->data.cs_register_client_c = (TCS_SuplaRegisterClient_C *)malloc(
               sizeof(TCS_SuplaRegisterClient_C));
 
@@ -1007,7 +1104,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_REGISTER_CLIENT_D:  // ver. >= 12
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaRegisterClient_D))
+        if (sdp->data_size == sizeof(TCS_SuplaRegisterClient_D))
           rd->data.cs_register_client_d = (TCS_SuplaRegisterClient_D *)malloc(
               sizeof(TCS_SuplaRegisterClient_D));
 
@@ -1015,7 +1112,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_REGISTER_CLIENT_RESULT:
 
-        if (srpc->sdp.data_size == sizeof(TSC_SuplaRegisterClientResult))
+        if (sdp->data_size == sizeof(TSC_SuplaRegisterClientResult))
           rd->data.sc_register_client_result =
               (TSC_SuplaRegisterClientResult *)malloc(
                   sizeof(TSC_SuplaRegisterClientResult));
@@ -1024,7 +1121,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_REGISTER_CLIENT_RESULT_B:
 
-        if (srpc->sdp.data_size == sizeof(TSC_SuplaRegisterClientResult_B))
+        if (sdp->data_size == sizeof(TSC_SuplaRegisterClientResult_B))
           rd->data.sc_register_client_result_b =
               (TSC_SuplaRegisterClientResult_B *)malloc(
                   sizeof(TSC_SuplaRegisterClientResult_B));
@@ -1033,9 +1130,9 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_LOCATION_UPDATE:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SuplaLocation) - SUPLA_LOCATION_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SuplaLocation)) {
+            sdp->data_size <= sizeof(TSC_SuplaLocation)) {
           rd->data.sc_location =
               (TSC_SuplaLocation *)malloc(sizeof(TSC_SuplaLocation));
         }
@@ -1043,14 +1140,14 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_LOCATIONPACK_UPDATE:
-        srpc_getlocationpack(srpc, rd);
+        srpc_getlocationpack(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNEL_UPDATE:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SuplaChannel) - SUPLA_CHANNEL_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SuplaChannel)) {
+            sdp->data_size <= sizeof(TSC_SuplaChannel)) {
           rd->data.sc_channel =
               (TSC_SuplaChannel *)malloc(sizeof(TSC_SuplaChannel));
         }
@@ -1059,9 +1156,9 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_CHANNEL_UPDATE_B:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SuplaChannel_B) - SUPLA_CHANNEL_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SuplaChannel_B)) {
+            sdp->data_size <= sizeof(TSC_SuplaChannel_B)) {
           rd->data.sc_channel_b =
               (TSC_SuplaChannel_B *)malloc(sizeof(TSC_SuplaChannel_B));
         }
@@ -1070,9 +1167,9 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_CHANNEL_UPDATE_C:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SuplaChannel_C) - SUPLA_CHANNEL_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SuplaChannel_C)) {
+            sdp->data_size <= sizeof(TSC_SuplaChannel_C)) {
           rd->data.sc_channel_c =
               (TSC_SuplaChannel_C *)malloc(sizeof(TSC_SuplaChannel_C));
         }
@@ -1080,36 +1177,36 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_CHANNELPACK_UPDATE:
-        srpc_getchannelpack(srpc, rd);
+        srpc_getchannelpack(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNELPACK_UPDATE_B:
-        srpc_getchannelpack_b(srpc, rd);
+        srpc_getchannelpack_b(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNELPACK_UPDATE_C:
-        srpc_getchannelpack_c(srpc, rd);
+        srpc_getchannelpack_c(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNEL_VALUE_UPDATE:
 
-        if (srpc->sdp.data_size == sizeof(TSC_SuplaChannelValue))
+        if (sdp->data_size == sizeof(TSC_SuplaChannelValue))
           rd->data.sc_channel_value =
               (TSC_SuplaChannelValue *)malloc(sizeof(TSC_SuplaChannelValue));
 
         break;
 
       case SUPLA_SC_CALL_CHANNELGROUP_PACK_UPDATE:
-        srpc_getchannelgroup_pack(srpc, rd);
+        srpc_getchannelgroup_pack(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNELGROUP_PACK_UPDATE_B:
-        srpc_getchannelgroup_pack_b(srpc, rd);
+        srpc_getchannelgroup_pack_b(sdp, rd);
         break;
 
       case SUPLA_SC_CALL_CHANNELGROUP_RELATION_PACK_UPDATE:
-        if (srpc->sdp.data_size <= sizeof(TSC_SuplaChannelGroupRelationPack) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSC_SuplaChannelGroupRelationPack) &&
+            sdp->data_size >=
                 (sizeof(TSC_SuplaChannelGroupRelationPack) -
                  (sizeof(TSC_SuplaChannelGroupRelation) *
                   SUPLA_CHANNELGROUP_RELATION_PACK_MAXCOUNT))) {
@@ -1120,8 +1217,8 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_CHANNELVALUE_PACK_UPDATE:
-        if (srpc->sdp.data_size <= sizeof(TSC_SuplaChannelValuePack) &&
-            srpc->sdp.data_size >= (sizeof(TSC_SuplaChannelValuePack) -
+        if (sdp->data_size <= sizeof(TSC_SuplaChannelValuePack) &&
+            sdp->data_size >= (sizeof(TSC_SuplaChannelValuePack) -
                                     (sizeof(TSC_SuplaChannelValue) *
                                      SUPLA_CHANNELVALUE_PACK_MAXCOUNT))) {
           rd->data.sc_channelvalue_pack = (TSC_SuplaChannelValuePack *)malloc(
@@ -1130,8 +1227,8 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_CHANNELEXTENDEDVALUE_PACK_UPDATE:
-        if (srpc->sdp.data_size <= sizeof(TSC_SuplaChannelExtendedValuePack) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSC_SuplaChannelExtendedValuePack) &&
+            sdp->data_size >=
                 (sizeof(TSC_SuplaChannelExtendedValuePack) -
                  SUPLA_CHANNELEXTENDEDVALUE_PACK_MAXDATASIZE)) {
           rd->data.sc_channelextendedvalue_pack =
@@ -1142,7 +1239,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_CHANNEL_SET_VALUE:
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaChannelNewValue))
+        if (sdp->data_size == sizeof(TCS_SuplaChannelNewValue))
           rd->data.cs_channel_new_value = (TCS_SuplaChannelNewValue *)malloc(
               sizeof(TCS_SuplaChannelNewValue));
 
@@ -1150,7 +1247,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_SET_VALUE:
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaNewValue))
+        if (sdp->data_size == sizeof(TCS_SuplaNewValue))
           rd->data.cs_new_value =
               (TCS_SuplaNewValue *)malloc(sizeof(TCS_SuplaNewValue));
 
@@ -1158,7 +1255,7 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_CHANNEL_SET_VALUE_B:
 
-        if (srpc->sdp.data_size == sizeof(TCS_SuplaChannelNewValue_B))
+        if (sdp->data_size == sizeof(TCS_SuplaChannelNewValue_B))
           rd->data.cs_channel_new_value_b =
               (TCS_SuplaChannelNewValue_B *)malloc(
                   sizeof(TCS_SuplaChannelNewValue_B));
@@ -1167,9 +1264,9 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_SC_CALL_EVENT:
 
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SuplaEvent) - SUPLA_SENDER_NAME_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SuplaEvent)) {
+            sdp->data_size <= sizeof(TSC_SuplaEvent)) {
           rd->data.sc_event = (TSC_SuplaEvent *)malloc(sizeof(TSC_SuplaEvent));
         }
 
@@ -1180,16 +1277,16 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_OAUTH_TOKEN_REQUEST_RESULT:
-        if (srpc->sdp.data_size >= (sizeof(TSC_OAuthTokenRequestResult) -
+        if (sdp->data_size >= (sizeof(TSC_OAuthTokenRequestResult) -
                                     SUPLA_OAUTH_TOKEN_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_OAuthTokenRequestResult)) {
+            sdp->data_size <= sizeof(TSC_OAuthTokenRequestResult)) {
           rd->data.sc_oauth_tokenrequest_result =
               (TSC_OAuthTokenRequestResult *)malloc(
                   sizeof(TSC_OAuthTokenRequestResult));
         }
         break;
       case SUPLA_CS_CALL_SUPERUSER_AUTHORIZATION_REQUEST:
-        if (srpc->sdp.data_size == sizeof(TCS_SuperUserAuthorizationRequest))
+        if (sdp->data_size == sizeof(TCS_SuperUserAuthorizationRequest))
           rd->data.cs_superuser_authorization_request =
               (TCS_SuperUserAuthorizationRequest *)malloc(
                   sizeof(TCS_SuperUserAuthorizationRequest));
@@ -1198,22 +1295,22 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         call_with_no_data = 1;
         break;
       case SUPLA_SC_CALL_SUPERUSER_AUTHORIZATION_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSC_SuperUserAuthorizationResult))
+        if (sdp->data_size == sizeof(TSC_SuperUserAuthorizationResult))
           rd->data.sc_superuser_authorization_result =
               (TSC_SuperUserAuthorizationResult *)malloc(
                   sizeof(TSC_SuperUserAuthorizationResult));
         break;
       case SUPLA_CS_CALL_DEVICE_CALCFG_REQUEST:
-        if (srpc->sdp.data_size <= sizeof(TCS_DeviceCalCfgRequest) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TCS_DeviceCalCfgRequest) &&
+            sdp->data_size >=
                 (sizeof(TCS_DeviceCalCfgRequest) - SUPLA_CALCFG_DATA_MAXSIZE)) {
           rd->data.cs_device_calcfg_request = (TCS_DeviceCalCfgRequest *)malloc(
               sizeof(TCS_DeviceCalCfgRequest));
         }
         break;
       case SUPLA_CS_CALL_DEVICE_CALCFG_REQUEST_B:
-        if (srpc->sdp.data_size <= sizeof(TCS_DeviceCalCfgRequest_B) &&
-            srpc->sdp.data_size >= (sizeof(TCS_DeviceCalCfgRequest_B) -
+        if (sdp->data_size <= sizeof(TCS_DeviceCalCfgRequest_B) &&
+            sdp->data_size >= (sizeof(TCS_DeviceCalCfgRequest_B) -
                                     SUPLA_CALCFG_DATA_MAXSIZE)) {
           rd->data.cs_device_calcfg_request_b =
               (TCS_DeviceCalCfgRequest_B *)malloc(
@@ -1221,8 +1318,8 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         }
         break;
       case SUPLA_SC_CALL_DEVICE_CALCFG_RESULT:
-        if (srpc->sdp.data_size <= sizeof(TSC_DeviceCalCfgResult) &&
-            srpc->sdp.data_size >=
+        if (sdp->data_size <= sizeof(TSC_DeviceCalCfgResult) &&
+            sdp->data_size >=
                 (sizeof(TSC_DeviceCalCfgResult) - SUPLA_CALCFG_DATA_MAXSIZE)) {
           rd->data.sc_device_calcfg_result =
               (TSC_DeviceCalCfgResult *)malloc(sizeof(TSC_DeviceCalCfgResult));
@@ -1230,27 +1327,27 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_CS_CALL_GET_CHANNEL_BASIC_CFG:
-        if (srpc->sdp.data_size == sizeof(TCS_ChannelBasicCfgRequest))
+        if (sdp->data_size == sizeof(TCS_ChannelBasicCfgRequest))
           rd->data.cs_channel_basic_cfg_request =
               (TCS_ChannelBasicCfgRequest *)malloc(
                   sizeof(TCS_ChannelBasicCfgRequest));
         break;
       case SUPLA_SC_CALL_CHANNEL_BASIC_CFG_RESULT:
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_ChannelBasicCfg) - SUPLA_CHANNEL_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_ChannelBasicCfg))
+            sdp->data_size <= sizeof(TSC_ChannelBasicCfg))
           rd->data.sc_channel_basic_cfg =
               (TSC_ChannelBasicCfg *)malloc(sizeof(TSC_ChannelBasicCfg));
         break;
 
       case SUPLA_CS_CALL_SET_CHANNEL_FUNCTION:
-        if (srpc->sdp.data_size == sizeof(TCS_SetChannelFunction))
+        if (sdp->data_size == sizeof(TCS_SetChannelFunction))
           rd->data.cs_set_channel_function =
               (TCS_SetChannelFunction *)malloc(sizeof(TCS_SetChannelFunction));
         break;
 
       case SUPLA_SC_CALL_SET_CHANNEL_FUNCTION_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSC_SetChannelFunctionResult))
+        if (sdp->data_size == sizeof(TSC_SetChannelFunctionResult))
           rd->data.sc_set_channel_function_result =
               (TSC_SetChannelFunctionResult *)malloc(
                   sizeof(TSC_SetChannelFunctionResult));
@@ -1258,18 +1355,18 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
 
       case SUPLA_CS_CALL_SET_CHANNEL_CAPTION:
       case SUPLA_CS_CALL_SET_LOCATION_CAPTION:
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TCS_SetCaption) - SUPLA_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TCS_SetCaption))
+            sdp->data_size <= sizeof(TCS_SetCaption))
           rd->data.cs_set_caption =
               (TCS_SetCaption *)malloc(sizeof(TCS_SetCaption));
         break;
 
       case SUPLA_SC_CALL_SET_CHANNEL_CAPTION_RESULT:
       case SUPLA_SC_CALL_SET_LOCATION_CAPTION_RESULT:
-        if (srpc->sdp.data_size >=
+        if (sdp->data_size >=
                 (sizeof(TSC_SetCaptionResult) - SUPLA_CAPTION_MAXSIZE) &&
-            srpc->sdp.data_size <= sizeof(TSC_SetCaptionResult))
+            sdp->data_size <= sizeof(TSC_SetCaptionResult))
           rd->data.sc_set_caption_result =
               (TSC_SetCaptionResult *)malloc(sizeof(TSC_SetCaptionResult));
         break;
@@ -1279,34 +1376,34 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
         break;
 
       case SUPLA_SC_CALL_CLIENTS_RECONNECT_REQUEST_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSC_ClientsReconnectRequestResult))
+        if (sdp->data_size == sizeof(TSC_ClientsReconnectRequestResult))
           rd->data.sc_clients_reconnect_result =
               (TSC_ClientsReconnectRequestResult *)malloc(
                   sizeof(TSC_ClientsReconnectRequestResult));
         break;
 
       case SUPLA_CS_CALL_SET_REGISTRATION_ENABLED:
-        if (srpc->sdp.data_size == sizeof(TCS_SetRegistrationEnabled))
+        if (sdp->data_size == sizeof(TCS_SetRegistrationEnabled))
           rd->data.cs_set_registration_enabled =
               (TCS_SetRegistrationEnabled *)malloc(
                   sizeof(TCS_SetRegistrationEnabled));
         break;
 
       case SUPLA_SC_CALL_SET_REGISTRATION_ENABLED_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSC_SetRegistrationEnabledResult))
+        if (sdp->data_size == sizeof(TSC_SetRegistrationEnabledResult))
           rd->data.sc_set_registration_enabled_result =
               (TSC_SetRegistrationEnabledResult *)malloc(
                   sizeof(TSC_SetRegistrationEnabledResult));
         break;
 
       case SUPLA_CS_CALL_DEVICE_RECONNECT_REQUEST:
-        if (srpc->sdp.data_size == sizeof(TCS_DeviceReconnectRequest))
+        if (sdp->data_size == sizeof(TCS_DeviceReconnectRequest))
           rd->data.cs_device_reconnect_request =
               (TCS_DeviceReconnectRequest *)malloc(
                   sizeof(TCS_DeviceReconnectRequest));
         break;
       case SUPLA_SC_CALL_DEVICE_RECONNECT_REQUEST_RESULT:
-        if (srpc->sdp.data_size == sizeof(TSC_DeviceReconnectRequestResult))
+        if (sdp->data_size == sizeof(TSC_DeviceReconnectRequestResult))
           rd->data.sc_device_reconnect_request_result =
               (TSC_DeviceReconnectRequestResult *)malloc(
                   sizeof(TSC_DeviceReconnectRequestResult));
@@ -1316,21 +1413,21 @@ char SRPC_ICACHE_FLASH srpc_getdata(void *_srpc, TsrpcReceivedData *rd,
     }
 
     if (call_with_no_data == 1) {
-      return lck_unlock_r(srpc->lck, SUPLA_RESULT_TRUE);
-    }
-
-    if (rd->data.dcs_ping != NULL) {
-      if (srpc->sdp.data_size > 0) {
-        memcpy(rd->data.dcs_ping, srpc->sdp.data, srpc->sdp.data_size);
+      result = SUPLA_RESULT_TRUE;
+    } else if (rd->data.dcs_ping != NULL) {
+      if (sdp->data_size > 0) {
+        memcpy(rd->data.dcs_ping, sdp->data, sdp->data_size);
       }
 
-      return lck_unlock_r(srpc->lck, SUPLA_RESULT_TRUE);
+      result = SUPLA_RESULT_TRUE;
+    } else {
+      result = SUPLA_RESULT_DATA_ERROR;
     }
 
-    return lck_unlock_r(srpc->lck, SUPLA_RESULT_DATA_ERROR);
+    srpc_in_queue_remove(srpc, n);
   }
 
-  return lck_unlock_r(srpc->lck, SUPLA_RESULT_FALSE);
+  return lck_unlock_r(srpc->lck, result);
 }
 
 void SRPC_ICACHE_FLASH srpc_rd_free(TsrpcReceivedData *rd) {
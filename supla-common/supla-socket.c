@@ -426,6 +426,50 @@ char ssocket_accept_ssl(void *_ssd, void *_supla_socket) {
     }
   }
 
+#endif /*ifdef NOSSL*/
+  return supla_socket->sfd == -1 ? 0 : 1;
+}
+
+// Non-blocking variant of ssocket_accept_ssl. It should be called each time
+// the socket becomes readable until it returns a value other than -1.
+// Returns 1 if the handshake has been completed, 0 on error and -1 if the
+// handshake is still in progress.
+char ssocket_accept_ssl_nonblock(void *_ssd, void *_supla_socket) {
+  TSuplaSocket *supla_socket = (TSuplaSocket *)_supla_socket;
+#ifndef NOSSL
+  int n;
+  TSuplaSocketData *ssd = (TSuplaSocketData *)_ssd;
+
+  if (_supla_socket && supla_socket->sfd != -1 && ssd->secure == 1) {
+    if (supla_socket->ssl == NULL) {
+      if (-1 == fcntl(supla_socket->sfd, F_SETFL, O_NONBLOCK)) {
+        supla_log(LOG_ERR, "O_NONBLOCK");
+        ssocket_supla_socket_close(supla_socket);
+        return 0;
+      }
+
+      supla_socket->ssl = SSL_new(ssd->ctx);
+      SSL_set_fd(supla_socket->ssl, supla_socket->sfd);
+    }
+
+    n = SSL_accept(supla_socket->ssl);
+
+    if (n < 1) {
+      n = SSL_get_error(supla_socket->ssl, n);
+      if (n == SSL_ERROR_WANT_READ) {
+        return -1;
+      } else if (n == SSL_ERROR_WANT_WRITE) {
+        return -2;
+      }
+
+      ssocket_ssl_error_log();
+      ssocket_supla_socket_close(supla_socket);
+    } else {
+      supla_log(LOG_INFO, "Cipher: %s, ClientSD: %i",
+                SSL_get_cipher(supla_socket->ssl), supla_socket->sfd);
+    }
+  }
+
 #endif /*ifdef NOSSL*/
   return supla_socket->sfd == -1 ? 0 : 1;
 }
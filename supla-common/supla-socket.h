@@ -32,6 +32,10 @@ supla_socket_data *ssocket_server_init(const char cert[], const char key[],
                                        int port, unsigned char secure);
 char ssocket_accept(void *_ssd, unsigned int *ipv4, void **_supla_socket);
 char ssocket_accept_ssl(void *_ssd, void *_supla_socket);
+// Returns 1 when the connection is established, -1 when the handshake waits
+// for the socket to become readable, -2 when it waits for it to become
+// writable and 0 on failure.
+char ssocket_accept_ssl_nonblock(void *_ssd, void *_supla_socket);
 supla_socket_data *ssocket_client_init(const char host[], int port,
                                        unsigned char secure);
 unsigned char ssocket_client_connect(void *ssd, const char *state_file,
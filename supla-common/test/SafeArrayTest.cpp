@@ -28,6 +28,14 @@ char safe_array_test_del_cnd1(void *ptr) { return 0; }
 
 char safe_array_test_del_cnd2(void *ptr) { return 1; }
 
+unsigned long long safe_array_test_key(void *ptr) {
+  return (unsigned long long)ptr / 10;
+}
+
+unsigned long long safe_array_test_mod_key(void *ptr) {
+  return (unsigned long long)ptr % 3;
+}
+
 namespace {
 
 class SafeArrayTest : public ::testing::Test {
@@ -120,4 +128,59 @@ TEST_F(SafeArrayTest, move_to_begin) {
 
   safe_array_free(arr);
 }
+
+TEST_F(SafeArrayTest, index) {
+  void *arr = safe_array_init();
+  ASSERT_FALSE(arr == NULL);
+
+  ASSERT_EQ(0, safe_array_add(arr, (void *)10));
+  ASSERT_EQ(0, safe_array_add_index(arr, safe_array_test_key));
+
+  for (long long a = 2; a <= 1000; a++) {
+    ASSERT_EQ(a - 1, safe_array_add(arr, (void *)(a * 10)));
+  }
+
+  ASSERT_EQ(1, safe_array_add_index(arr, safe_array_test_mod_key));
+  ASSERT_EQ(-1, safe_array_add_index(arr, safe_array_test_key));
+
+  ASSERT_EQ(10, (long long)safe_array_findkey(arr, 0, 1, NULL, NULL));
+  ASSERT_EQ(5550, (long long)safe_array_findkey(arr, 0, 555, NULL, NULL));
+  ASSERT_EQ(10000, (long long)safe_array_findkey(arr, 0, 1000, NULL, NULL));
+  ASSERT_TRUE(safe_array_findkey(arr, 0, 1001, NULL, NULL) == NULL);
+  ASSERT_TRUE(safe_array_findkey(arr, 2, 1, NULL, NULL) == NULL);
+
+  ASSERT_EQ(5550, (long long)safe_array_findkey(arr, 1, 0,
+                                                &safe_array_test_find_cnd,
+                                                (void *)5550));
+  ASSERT_TRUE(safe_array_findkey(arr, 1, 1, &safe_array_test_find_cnd,
+                                 (void *)5550) == NULL);
+
+  safe_array_remove(arr, (void *)5550);
+  ASSERT_TRUE(safe_array_findkey(arr, 0, 555, NULL, NULL) == NULL);
+  ASSERT_TRUE(safe_array_findkey(arr, 1, 0, &safe_array_test_find_cnd,
+                                 (void *)5550) == NULL);
+
+  ASSERT_EQ(10, (long long)safe_array_pop(arr));
+  ASSERT_TRUE(safe_array_findkey(arr, 0, 1, NULL, NULL) == NULL);
+  ASSERT_EQ(20, (long long)safe_array_findkey(arr, 0, 2, NULL, NULL));
+
+  safe_array_clean(arr, &safe_array_test_del_cnd2);
+  ASSERT_EQ(0, safe_array_count(arr));
+  ASSERT_TRUE(safe_array_findkey(arr, 0, 2, NULL, NULL) == NULL);
+
+  ASSERT_EQ(0, safe_array_add(arr, (void *)30));
+  ASSERT_EQ(30, (long long)safe_array_findkey(arr, 0, 3, NULL, NULL));
+
+  safe_array_free(arr);
+}
+
+TEST_F(SafeArrayTest, key_hash) {
+  char data1[] = {1, 2, 3, 4};
+  char data2[] = {1, 2, 3, 5};
+
+  ASSERT_EQ(safe_array_key_hash(data1, sizeof(data1)),
+            safe_array_key_hash(data1, sizeof(data1)));
+  ASSERT_NE(safe_array_key_hash(data1, sizeof(data1)),
+            safe_array_key_hash(data2, sizeof(data2)));
+}
 }  // namespace
@@ -763,6 +763,61 @@ TEST_F(SrpcTest, call_ping_server_result) {
   srpc = NULL;
 }
 
+//---------------------------------------------------------
+// QUEUE
+//---------------------------------------------------------
+
+TEST_F(SrpcTest, queue_order_after_wrap_around) {
+  std::vector<std::vector<char> > packets;
+
+  data_read_result = -1;
+  srpc = srpcInit();
+  ASSERT_FALSE(srpc == NULL);
+
+  for (int a = 0; a < 3; a++) {
+    ASSERT_GT(srpc_dcs_async_ping_server(srpc), 0);
+  }
+
+  for (int a = 0; a < 30; a++) {
+    ASSERT_GT(srpc_dcs_async_ping_server(srpc), 0);
+    ASSERT_EQ(SUPLA_RESULT_TRUE, srpc_iterate(srpc));
+    ASSERT_FALSE(data_write == NULL);
+    ASSERT_EQ(39, data_write_size);
+    ASSERT_EQ((unsigned int)(a + 1), ((TSuplaDataPacket *)data_write)->rr_id);
+    packets.push_back(
+        std::vector<char>(data_write, data_write + data_write_size));
+    free(data_write);
+    data_write = NULL;
+    data_write_size = 0;
+  }
+
+  for (size_t a = 0; a < packets.size(); a += 3) {
+    for (size_t b = a; b < a + 3; b++) {
+      free(data_read);
+      data_read = (char *)malloc(packets[b].size());
+      ASSERT_FALSE(data_read == NULL);
+      memcpy(data_read, packets[b].data(), packets[b].size());
+      data_read_result = packets[b].size();
+      ASSERT_EQ(SUPLA_RESULT_TRUE, srpc_iterate(srpc));
+      ASSERT_EQ((unsigned int)(b + 1), (unsigned int)cr_rr_id);
+    }
+
+    data_read_result = -1;
+
+    for (size_t b = a; b < a + 3; b++) {
+      ASSERT_EQ(SUPLA_RESULT_TRUE, srpc_getdata(srpc, &cr_rd, 0));
+      ASSERT_EQ((unsigned int)(b + 1), cr_rd.rr_id);
+      ASSERT_EQ((unsigned int)SUPLA_DCS_CALL_PING_SERVER, cr_rd.call_type);
+      free(cr_rd.data.dcs_ping);
+    }
+
+    ASSERT_EQ(SUPLA_RESULT_FALSE, srpc_getdata(srpc, &cr_rd, 0));
+  }
+
+  srpc_free(srpc);
+  srpc = NULL;
+}
+
 //---------------------------------------------------------
 // ACTIVITY TIMEOUT
 //---------------------------------------------------------
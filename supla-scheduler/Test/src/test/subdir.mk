@@ -6,18 +6,24 @@
 CPP_SRCS += \
 ../src/test/ActionTest.cpp \
 ../src/test/AllTests.cpp \
+../src/test/QueueMock.cpp \
+../src/test/QueueTest.cpp \
 ../src/test/WorkerMock.cpp \
 ../src/test/WorkerTest.cpp 
 
 OBJS += \
 ./src/test/ActionTest.o \
 ./src/test/AllTests.o \
+./src/test/QueueMock.o \
+./src/test/QueueTest.o \
 ./src/test/WorkerMock.o \
 ./src/test/WorkerTest.o 
 
 CPP_DEPS += \
 ./src/test/ActionTest.d \
 ./src/test/AllTests.d \
+./src/test/QueueMock.d \
+./src/test/QueueTest.d \
 ./src/test/WorkerMock.d \
 ./src/test/WorkerTest.d 
 
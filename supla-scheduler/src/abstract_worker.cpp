@@ -40,13 +40,29 @@ queue *s_abstract_worker::get_queue(void) { return q; }
 
 const s_exec_t *s_abstract_worker::get_exec(void) { return &s_exec; }
 
+bool s_abstract_worker::set_retry(int sec) {
+  if (!db->set_retry(get_id(), sec)) return false;
+
+  if (q) q->retry(&s_exec, sec);
+  return true;
+}
+
 void s_abstract_worker::execute(void *sthread) {
   if (!db->connect()) return;
 
   s_exec = q->get_job();
 
   while (s_exec.id && !sthread_isterminated(sthread)) {
-    if (db->set_fetched(s_exec.id)) q->mark_fetched();
+    if (db->set_fetched(s_exec.id)) {
+      q->mark_fetched();
+    } else if (q->is_preload_enabled()) {
+      // The preloaded copy is out of date. The execution has been removed,
+      // finished, rescheduled or taken by another worker in the meantime.
+      if (s_exec.action_param != NULL) free(s_exec.action_param);
+
+      s_exec = q->get_job();
+      continue;
+    }
 
     s_worker_action *action =
         AbstractActionFactory::createByActionType(s_exec.action, this);
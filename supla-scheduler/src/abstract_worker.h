@@ -40,6 +40,7 @@ class s_abstract_worker {
   virtual ~s_abstract_worker();
   void execute(void *sthread);
   database *get_db(void);
+  bool set_retry(int sec);
 
   virtual int get_channel_func(void) = 0;
   virtual int get_id(void) = 0;
@@ -79,7 +79,7 @@ void s_worker_action::execute(void) {
       }
 
     } else {
-      worker->get_db()->set_retry(worker->get_id(), waiting_time_to_check());
+      worker->set_retry(waiting_time_to_check());
     }
 
     return;
@@ -93,8 +93,7 @@ void s_worker_action::execute(void) {
                                  ACTION_EXECUTION_RESULT_SUCCESS);
   } else if (retry_when_fail() &&
              worker->get_retry_count() + 1 < (try_limit() * 2)) {
-    worker->get_db()->set_retry(
-        worker->get_id(), waiting_time_to_retry() - waiting_time_to_check());
+    worker->set_retry(waiting_time_to_retry() - waiting_time_to_check());
 
   } else if (fail_result_code > 0) {
     worker->get_db()->set_result(worker->get_id(), fail_result_code);
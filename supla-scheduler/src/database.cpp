@@ -52,45 +52,39 @@ int database::cfg_get_port(void) {
              : scfg_int(CFG_SCHEDULER_MYSQL_PORT);
 }
 
-void database::get_s_executions(void *s_exec_arr, int limit) {
+#define S_EXECUTIONS_SELECT                                                   \
+  "SELECT e.`id`, e.`schedule_id`, s.`user_id`, "                             \
+  "IFNULL(c.`iodevice_id`, 0) `iodevice_id`, IFNULL(s.`channel_id`, 0) "      \
+  "`channel_id`, IFNULL(s.`channel_group_id`, 0) `channel_group_id`, "        \
+  "IFNULL(c.`func`, IFNULL(g.`func`, 0)) `func`, IFNULL(c.`param1`, 0) "      \
+  "`param1`, IFNULL(c.`param2`, 0) `param2`, IFNULL(c.`param3`, 0) "          \
+  "`param3`, e.`action`, e.`action_param`, "                                  \
+  "UNIX_TIMESTAMP(e.`planned_timestamp`), "                                   \
+  "UNIX_TIMESTAMP(e.`retry_timestamp`), e.`retry_count`, s.`retry`, "         \
+  "UNIX_TIMESTAMP(UTC_TIMESTAMP()) "                                          \
+  "FROM `supla_scheduled_executions` AS e, `supla_schedule` AS s LEFT "       \
+  "JOIN `supla_dev_channel` AS c ON s.`channel_id` = c.`id` LEFT JOIN "       \
+  "`supla_dev_channel_group` AS g ON s.`channel_group_id` = g.`id` "          \
+  "WHERE e.`schedule_id` = s.`id` AND e.`result_timestamp` IS NULL AND "      \
+  "e.`fetched_timestamp` IS NULL AND "
+
+int database::fetch_s_executions(const char *sql, void *pbind, int pbind_size,
+                                 void *s_exec_arr, int *db_timestamp) {
   MYSQL_STMT *stmt;
+  int count = 0;
 
-  MYSQL_BIND pbind[1];
-  memset(pbind, 0, sizeof(pbind));
+  if (s_exec_arr == NULL) return 0;
 
-  if (s_exec_arr == NULL) return;
-
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&limit;
-
-  if (stmt_execute(
-          (void **)&stmt,
-          "SELECT e.`id`, e.`schedule_id`, s.`user_id`, "
-          "IFNULL(c.`iodevice_id`, 0) `iodevice_id`, IFNULL(s.`channel_id`, 0) "
-          "`channel_id`, IFNULL(s.`channel_group_id`, 0) `channel_group_id`, "
-          "IFNULL(c.`func`, IFNULL(g.`func`, 0)) `func`, IFNULL(c.`param1`, 0) "
-          "`param1`, IFNULL(c.`param2`, 0) `param2`, IFNULL(c.`param3`, 0) "
-          "`param3`, e.`action`, e.`action_param`, "
-          "UNIX_TIMESTAMP(e.`planned_timestamp`), "
-          "UNIX_TIMESTAMP(e.`retry_timestamp`), e.`retry_count`, s.`retry` "
-          "FROM `supla_scheduled_executions` AS e, `supla_schedule` AS s LEFT "
-          "JOIN `supla_dev_channel` AS c ON s.`channel_id` = c.`id` LEFT JOIN "
-          "`supla_dev_channel_group` AS g ON s.`channel_group_id` = g.`id` "
-          "WHERE e.`schedule_id` = s.`id` AND e.`result_timestamp` IS NULL AND "
-          "e.`fetched_timestamp` IS NULL AND ( (e.`retry_timestamp` IS NULL "
-          "AND e.`planned_timestamp` <= UTC_TIMESTAMP()) OR "
-          "(e.`retry_timestamp` IS NOT NULL AND e.`retry_timestamp` <= "
-          "UTC_TIMESTAMP())) LIMIT ?",
-          pbind, 1, true)) {
+  if (stmt_execute((void **)&stmt, sql, pbind, pbind_size, true)) {
     my_bool is_null[4];
 
-    MYSQL_BIND rbind[16];
+    MYSQL_BIND rbind[17];
     memset(rbind, 0, sizeof(rbind));
 
     int id, schedule_id, user_id, device_id, channel_id, channel_group_id,
         channel_func, channel_param1, channel_param2, channel_param3;
     int action, planned_timestamp, retry_timestamp, retry_count,
-        retry_when_fail;
+        retry_when_fail, now;
 
     unsigned long length;
     char action_param[256];
@@ -149,6 +143,9 @@ void database::get_s_executions(void *s_exec_arr, int limit) {
     rbind[15].buffer = &retry_when_fail;
     rbind[15].is_null = &is_null[3];
 
+    rbind[16].buffer_type = MYSQL_TYPE_LONG;
+    rbind[16].buffer = &now;
+
     if (mysql_stmt_bind_result(stmt, rbind)) {
       supla_log(LOG_ERR, "MySQL - stmt bind error - %s",
                 mysql_stmt_error(stmt));
@@ -184,12 +181,18 @@ void database::get_s_executions(void *s_exec_arr, int limit) {
             s_exec->retry_count = is_null[2] ? 0 : retry_count;
             s_exec->retry_when_fail = !is_null[3] && retry_when_fail > 0;
 
+            if (db_timestamp) {
+              *db_timestamp = now;
+            }
+
             if (safe_array_add(s_exec_arr, s_exec) == -1) {
               if (s_exec->action_param != NULL) {
                 free(s_exec->action_param);
               }
 
               free(s_exec);
+            } else {
+              count++;
             }
           }
         }
@@ -198,6 +201,125 @@ void database::get_s_executions(void *s_exec_arr, int limit) {
 
     mysql_stmt_close(stmt);
   }
+
+  return count;
+}
+
+void database::get_s_executions(void *s_exec_arr, int limit) {
+  MYSQL_BIND pbind[1];
+  memset(pbind, 0, sizeof(pbind));
+
+  pbind[0].buffer_type = MYSQL_TYPE_LONG;
+  pbind[0].buffer = (char *)&limit;
+
+  fetch_s_executions(S_EXECUTIONS_SELECT
+                     "( (e.`retry_timestamp` IS NULL "
+                     "AND e.`planned_timestamp` <= UTC_TIMESTAMP()) OR "
+                     "(e.`retry_timestamp` IS NOT NULL AND e.`retry_timestamp` "
+                     "<= UTC_TIMESTAMP())) LIMIT ?",
+                     pbind, 1, s_exec_arr, NULL);
+}
+
+int database::get_planned_s_executions(void *s_exec_arr, int after_id,
+                                       int to_id, int horizon, int limit,
+                                       int *db_timestamp) {
+  MYSQL_BIND pbind[4];
+  memset(pbind, 0, sizeof(pbind));
+
+  pbind[0].buffer_type = MYSQL_TYPE_LONG;
+  pbind[0].buffer = (char *)&after_id;
+
+  pbind[1].buffer_type = MYSQL_TYPE_LONG;
+  pbind[1].buffer = (char *)&to_id;
+
+  pbind[2].buffer_type = MYSQL_TYPE_LONG;
+  pbind[2].buffer = (char *)&horizon;
+
+  pbind[3].buffer_type = MYSQL_TYPE_LONG;
+  pbind[3].buffer = (char *)&limit;
+
+  return fetch_s_executions(
+      S_EXECUTIONS_SELECT
+      "e.`id` > ? AND e.`id` <= ? AND IFNULL(e.`retry_timestamp`, "
+      "e.`planned_timestamp`) <= UTC_TIMESTAMP() + INTERVAL ? SECOND "
+      "ORDER BY e.`id` LIMIT ?",
+      pbind, 4, s_exec_arr, db_timestamp);
+}
+
+int database::get_due_s_executions(void *s_exec_arr, bool retry,
+                                   int after_timestamp, int after_id,
+                                   int since, int horizon, int limit,
+                                   int *db_timestamp) {
+  MYSQL_BIND pbind[6];
+  memset(pbind, 0, sizeof(pbind));
+
+  pbind[0].buffer_type = MYSQL_TYPE_LONG;
+  pbind[0].buffer = (char *)&after_timestamp;
+
+  pbind[1].buffer_type = MYSQL_TYPE_LONG;
+  pbind[1].buffer = (char *)&since;
+
+  pbind[2].buffer_type = MYSQL_TYPE_LONG;
+  pbind[2].buffer = (char *)&after_timestamp;
+
+  pbind[3].buffer_type = MYSQL_TYPE_LONG;
+  pbind[3].buffer = (char *)&after_id;
+
+  pbind[4].buffer_type = MYSQL_TYPE_LONG;
+  pbind[4].buffer = (char *)&horizon;
+
+  pbind[5].buffer_type = MYSQL_TYPE_LONG;
+  pbind[5].buffer = (char *)&limit;
+
+  if (retry) {
+    return fetch_s_executions(
+        S_EXECUTIONS_SELECT
+        "e.`retry_timestamp` >= GREATEST(FROM_UNIXTIME(?), UTC_TIMESTAMP() - "
+        "INTERVAL ? SECOND) AND (e.`retry_timestamp` > FROM_UNIXTIME(?) OR "
+        "e.`id` > ?) AND e.`retry_timestamp` <= UTC_TIMESTAMP() + INTERVAL ? "
+        "SECOND ORDER BY e.`retry_timestamp`, e.`id` LIMIT ?",
+        pbind, 6, s_exec_arr, db_timestamp);
+  }
+
+  return fetch_s_executions(
+      S_EXECUTIONS_SELECT
+      "e.`retry_timestamp` IS NULL AND e.`planned_timestamp` >= "
+      "GREATEST(FROM_UNIXTIME(?), UTC_TIMESTAMP() - INTERVAL ? SECOND) AND "
+      "(e.`planned_timestamp` > FROM_UNIXTIME(?) OR e.`id` > ?) AND "
+      "e.`planned_timestamp` <= UTC_TIMESTAMP() + INTERVAL ? SECOND ORDER BY "
+      "e.`planned_timestamp`, e.`id` LIMIT ?",
+      pbind, 6, s_exec_arr, db_timestamp);
+}
+
+int database::get_last_s_execution_id(void) {
+  MYSQL_STMT *stmt;
+  int id = 0;
+
+  if (stmt_execute((void **)&stmt,
+                   "SELECT IFNULL(MAX(`id`), 0) FROM "
+                   "`supla_scheduled_executions`",
+                   NULL, 0, true)) {
+    MYSQL_BIND rbind[1];
+    memset(rbind, 0, sizeof(rbind));
+
+    rbind[0].buffer_type = MYSQL_TYPE_LONG;
+    rbind[0].buffer = (char *)&id;
+
+    if (mysql_stmt_bind_result(stmt, rbind)) {
+      supla_log(LOG_ERR, "MySQL - stmt bind error - %s",
+                mysql_stmt_error(stmt));
+    } else {
+      mysql_stmt_store_result(stmt);
+
+      if (mysql_stmt_num_rows(stmt) == 0 || mysql_stmt_fetch(stmt)) {
+        id = 0;
+      }
+    }
+
+    mysql_stmt_close(stmt);
+  }
+
+  return id;
 }
 
 bool database::get_channel(supla_channel *channel) {
@@ -313,7 +435,9 @@ bool database::set_fetched(int id) {
   if (stmt_execute((void **)&stmt,
                    "UPDATE `supla_scheduled_executions` SET `consumed` = 1, "
                    "`fetched_timestamp`= UTC_TIMESTAMP() WHERE `id` = ? AND "
-                   "`fetched_timestamp` IS NULL",
+                   "`fetched_timestamp` IS NULL AND `result_timestamp` IS "
+                   "NULL AND IFNULL(`retry_timestamp`, `planned_timestamp`) "
+                   "<= UTC_TIMESTAMP() + INTERVAL 1 SECOND",
                    pbind, 1, true)) {
     result = mysql_stmt_affected_rows(stmt) == 1;
     mysql_stmt_close(stmt);
@@ -30,8 +30,25 @@ class database : public dbcommon {
   virtual char *cfg_get_database(void);
   virtual int cfg_get_port(void);
 
+  int fetch_s_executions(const char *sql, void *pbind, int pbind_size,
+                         void *s_exec_arr, int *db_timestamp);
+
  public:
   void get_s_executions(void *s_exec_arr, int limit);
+  // Loads up to limit executions with after_id < id <= to_id, ordered by id,
+  // that are due within horizon seconds. *db_timestamp receives the database
+  // clock so that the due times can be related to the local one.
+  int get_planned_s_executions(void *s_exec_arr, int after_id, int to_id,
+                               int horizon, int limit, int *db_timestamp);
+  // Loads up to limit executions due between since seconds ago and horizon
+  // seconds ahead, ordered by the due time and id and following the
+  // (after_timestamp, after_id) position. The executions planned for the
+  // first time and the retried ones are separate ranges so that each one is
+  // read through the index of its own column.
+  int get_due_s_executions(void *s_exec_arr, bool retry, int after_timestamp,
+                           int after_id, int since, int horizon, int limit,
+                           int *db_timestamp);
+  int get_last_s_execution_id(void);
   bool get_channel(supla_channel *channel);
 
   void set_expired_result(int expired_time);
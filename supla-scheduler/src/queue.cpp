@@ -73,10 +73,22 @@ queue::queue(void *user, void *q_sthread) {
   timer_one_min.tv_sec = 0;
   timer_one_min.tv_usec = 0;
 
+  preload_timer.tv_sec = 0;
+  preload_timer.tv_usec = 0;
+
+  preload_full_timer.tv_sec = 0;
+  preload_full_timer.tv_usec = 0;
+
+  preload_last_id = 0;
+
   loop_eh = eh_init();
 
   max_workers = scfg_int(CFG_MAX_WORKERS);
   max_job_per_second = scfg_int(CFG_MAX_JOB_PER_SECOND);
+  preload_horizon = scfg_int(CFG_PRELOAD_HORIZON);
+  preload_interval = scfg_int(CFG_PRELOAD_INTERVAL);
+
+  if (preload_horizon < 0) preload_horizon = 0;
 
   job_counter = 0;
   total_fetch_count = 0;
@@ -95,6 +107,12 @@ queue::~queue() {
   safe_array_clean(s_exec_arr, queue_loop_s_exec_arr_free);
   safe_array_free(s_exec_arr);
 
+  for (std::map<std::pair<int, int>, s_exec_t *>::iterator it =
+           planned.begin();
+       it != planned.end(); ++it) {
+    queue_loop_s_exec_arr_free(it->second);
+  }
+
   delete db;
 
   lck_free(lck);
@@ -212,6 +230,18 @@ void queue::mark_fetched() {
   lck_unlock(lck);
 }
 
+void queue::check_overdue(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  if (now.tv_sec - timer_one_min.tv_sec >= 60) {
+    timer_one_min = now;
+
+    set_zombie_result();
+    set_overdue_result();
+  }
+}
+
 void queue::load(void) {
   if (safe_array_count(s_exec_arr) > 0 || wait_for_fetch() || limit_exceeded())
     return;
@@ -222,20 +252,191 @@ void queue::load(void) {
 
   if (!db->connect()) return;
 
+  check_overdue();
+
+  db->get_s_executions(s_exec_arr, limit);
+  db->disconnect();
+
+  // supla_log(LOG_DEBUG, "LOAD");
+}
+
+bool queue::is_preload_enabled(void) { return preload_horizon > 0; }
+
+void queue::plan(s_exec_t *s_exec, int due) {
+  lck_lock(lck);
+
+  std::map<int, int>::iterator it = planned_due.find(s_exec->id);
+  if (it != planned_due.end()) {
+    std::pair<int, int> key(it->second, s_exec->id);
+    queue_loop_s_exec_arr_free(planned[key]);
+    planned.erase(key);
+  }
+
+  planned[std::pair<int, int>(due, s_exec->id)] = s_exec;
+  planned_due[s_exec->id] = due;
+
+  lck_unlock(lck);
+}
+
+void queue::retry(const s_exec_t *s_exec, int sec) {
+  if (!is_preload_enabled() || s_exec == NULL) return;
+
+  s_exec_t *next = (s_exec_t *)malloc(sizeof(s_exec_t));
+  if (next == NULL) return;
+
+  *next = *s_exec;
+  next->retry_count++;
+
+  if (s_exec->action_param != NULL) {
+    next->action_param = strdup(s_exec->action_param);
+  }
+
   struct timeval now;
   gettimeofday(&now, NULL);
 
-  if (now.tv_sec - timer_one_min.tv_sec >= 60) {
-    timer_one_min = now;
+  next->retry_timestamp = now.tv_sec + sec;
+  plan(next, next->retry_timestamp);
+  raise_loop_event();
+}
 
-    set_zombie_result();
-    set_overdue_result();
+void queue::plan_loaded(s_exec_t *s_exec, int db_timestamp, int loaded_sec) {
+  int due = s_exec->retry_timestamp ? s_exec->retry_timestamp
+                                    : s_exec->planned_timestamp;
+  plan(s_exec, due - db_timestamp + loaded_sec);
+}
+
+void queue::preload_due(bool retry) {
+  int after_timestamp = 0;
+  int after_id = 0;
+  void *page = safe_array_init();
+
+  while (sthread_isterminated(q_sthread) == 0) {
+    int db_timestamp = 0;
+    int count = db->get_due_s_executions(
+        page, retry, after_timestamp, after_id, PRELOAD_SINCE_SEC,
+        preload_horizon, PRELOAD_PAGE_SIZE, &db_timestamp);
+
+    struct timeval loaded;
+    gettimeofday(&loaded, NULL);
+
+    s_exec_t *s_exec = NULL;
+    while ((s_exec = (s_exec_t *)safe_array_pop(page)) != NULL) {
+      after_timestamp =
+          retry ? s_exec->retry_timestamp : s_exec->planned_timestamp;
+      after_id = s_exec->id;
+      plan_loaded(s_exec, db_timestamp, loaded.tv_sec);
+    }
+
+    if (count < PRELOAD_PAGE_SIZE) break;
+  }
+
+  safe_array_free(page);
+}
+
+void queue::preload(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  // The full reload picks up executions that the incremental one cannot see:
+  // those planned further than the horizon at the time they were added and
+  // those rescheduled outside this process.
+  bool full = now.tv_sec - preload_full_timer.tv_sec >=
+              (preload_horizon > 1 ? preload_horizon / 2 : 1);
+
+  if (!full && now.tv_sec - preload_timer.tv_sec < preload_interval) return;
+
+  if (!db->connect()) return;
+
+  check_overdue();
+
+  int after_id = preload_last_id;
+  int to_id = db->get_last_s_execution_id();
+
+  if (full) {
+    // Reads only the rows within the time window instead of paging through
+    // the whole table by id.
+    preload_due(false);
+    preload_due(true);
+  } else {
+    void *page = safe_array_init();
+
+    while (to_id > after_id && sthread_isterminated(q_sthread) == 0) {
+      int db_timestamp = 0;
+      int count = db->get_planned_s_executions(
+          page, after_id, to_id, preload_horizon, PRELOAD_PAGE_SIZE,
+          &db_timestamp);
+
+      struct timeval loaded;
+      gettimeofday(&loaded, NULL);
+
+      s_exec_t *s_exec = NULL;
+      while ((s_exec = (s_exec_t *)safe_array_pop(page)) != NULL) {
+        if (s_exec->id > after_id) after_id = s_exec->id;
+        plan_loaded(s_exec, db_timestamp, loaded.tv_sec);
+      }
+
+      if (count < PRELOAD_PAGE_SIZE) break;
+    }
+
+    safe_array_free(page);
   }
 
-  db->get_s_executions(s_exec_arr, limit);
   db->disconnect();
 
-  // supla_log(LOG_DEBUG, "LOAD");
+  if (to_id > preload_last_id) preload_last_id = to_id;
+
+  preload_timer = now;
+  if (full) preload_full_timer = now;
+}
+
+void queue::release_due(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  int limit = max_workers * 10 - safe_array_count(s_exec_arr);
+
+  lck_lock(lck);
+
+  while (limit > 0 && !planned.empty() &&
+         planned.begin()->first.first <= now.tv_sec) {
+    s_exec_t *s_exec = planned.begin()->second;
+    planned_due.erase(s_exec->id);
+    planned.erase(planned.begin());
+
+    if (safe_array_add(s_exec_arr, s_exec) == -1) {
+      queue_loop_s_exec_arr_free(s_exec);
+    } else {
+      limit--;
+    }
+  }
+
+  lck_unlock(lck);
+}
+
+int queue::wait_usec(void) {
+  int result = 1000000;
+
+  lck_lock(lck);
+
+  if (!planned.empty()) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    long long usec =
+        (planned.begin()->first.first - (long long)now.tv_sec) * 1000000 -
+        now.tv_usec;
+
+    if (usec <= 0) {
+      // Due, but the workers have not taken the previous jobs yet.
+      result = 100000;
+    } else if (usec < result) {
+      result = usec;
+    }
+  }
+
+  lck_unlock(lck);
+
+  return result;
 }
 
 void queue::loop(void) {
@@ -256,14 +457,20 @@ void queue::loop(void) {
     }
 
     safe_array_clean(workers_thread_arr, queue_loop_worker_thread_cnd);
-    load();
+
+    if (is_preload_enabled()) {
+      preload();
+      release_due();
+    } else {
+      load();
+    }
 
     if (safe_array_count(s_exec_arr) > 0 &&
         safe_array_count(workers_thread_arr) == 0) {
       new_worker();
     }
 
-    eh_wait(loop_eh, 1000000);
+    eh_wait(loop_eh, wait_usec());
   }
 
   safe_array_lock(workers_thread_arr);
@@ -19,9 +19,17 @@
 #ifndef QUEUE_H_
 #define QUEUE_H_
 
+#include <map>
+#include <utility>
+
 #include "database.h"
 #include "eh.h"
 
+#define PRELOAD_PAGE_SIZE 1000
+// Older executions are expired by check_overdue() within a minute after
+// EXPIRE_TIME, so the full reload does not look further back.
+#define PRELOAD_SINCE_SEC (EXPIRE_TIME + 60)
+
 class queue {
  private:
   void *user;
@@ -30,7 +38,6 @@ class queue {
   TEventHandler *loop_eh;
   void *lck;
   void *workers_thread_arr;
-  void *s_exec_arr;
 
   int max_workers;
   int max_job_per_second;
@@ -43,11 +50,30 @@ class queue {
   struct timeval timer;
   struct timeval timer_one_min;
 
+  // Executions due within preload_horizon seconds, ordered by the local time
+  // at which they should start and by id.
+  std::map<std::pair<int, int>, s_exec_t *> planned;
+  std::map<int, int> planned_due;
+  int preload_horizon;
+  int preload_interval;
+  int preload_last_id;
+  struct timeval preload_timer;
+  struct timeval preload_full_timer;
+
   void new_worker(void);
   bool wait_for_fetch(void);
+  void check_overdue(void);
+  void plan_loaded(s_exec_t *s_exec, int db_timestamp, int loaded_sec);
+  void preload_due(bool retry);
+  void preload(void);
 
  protected:
   database *db;
+  void *s_exec_arr;
+
+  void plan(s_exec_t *s_exec, int due);
+  void release_due(void);
+  int wait_usec(void);
 
  public:
   queue(void *user, void *q_sthread);
@@ -58,6 +84,11 @@ class queue {
   void load(void);
   void raise_loop_event(void);
 
+  bool is_preload_enabled(void);
+  // Plans the next attempt of an execution that has just been rescheduled
+  // in the database.
+  void retry(const s_exec_t *s_exec, int sec);
+
   void set_overdue_result(void);
   void set_zombie_result(void);
 
@@ -49,6 +49,12 @@ unsigned char schedulercfg_init(int argc, char *argv[]) {
   scfg_add_str_param(s_ipc, "socket_path",
                      "/var/run/supla/supla-server-ctrl.sock");
 
+  // [sec] Executions due within this time are kept in memory and started at
+  // their planned second. 0 - legacy behaviour (polling every second)
+  scfg_add_int_param(s_scheduler, "preload_horizon", 300);
+  // [sec] How often newly planned executions are looked up
+  scfg_add_int_param(s_scheduler, "preload_interval", 5);
+
   result = scfg_load(argc, argv, "/etc/supla-server/supla.cfg");
   scfg_names_free();
   return result;
@@ -47,6 +47,9 @@ extern "C" {
 
 #define CFG_IPC_SOCKET_PATH 14
 
+#define CFG_PRELOAD_HORIZON 15
+#define CFG_PRELOAD_INTERVAL 16
+
 unsigned char schedulercfg_init(int argc, char* argv[]);
 
 #ifdef __cplusplus
@@ -0,0 +1,54 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "QueueMock.h"
+#include <stdlib.h>
+#include <string.h>
+#include "safearray.h"
+
+QueueMock::QueueMock(void) : queue(NULL, NULL) {}
+
+QueueMock::~QueueMock() {}
+
+void QueueMock::plan_at(int id, int due) {
+  s_exec_t *s_exec = (s_exec_t *)malloc(sizeof(s_exec_t));
+  memset(s_exec, 0, sizeof(s_exec_t));
+  s_exec->id = id;
+  s_exec->planned_timestamp = due;
+  plan(s_exec, due);
+}
+
+void QueueMock::release(void) { release_due(); }
+
+int QueueMock::get_wait_usec(void) { return wait_usec(); }
+
+int QueueMock::released_count(void) { return safe_array_count(s_exec_arr); }
+
+s_exec_t *QueueMock::pop_released(void) {
+  return (s_exec_t *)safe_array_pop(s_exec_arr);
+}
+
+// static
+void QueueMock::free_released(s_exec_t *s_exec) {
+  if (s_exec) {
+    if (s_exec->action_param) {
+      free(s_exec->action_param);
+    }
+    free(s_exec);
+  }
+}
@@ -0,0 +1,162 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "QueueTest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "QueueMock.h"
+#include "schedulercfg.h"
+
+namespace testing {
+
+int QueueTest::now(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec;
+}
+
+TEST_F(QueueTest, releaseOnlyDue) {
+  QueueMock q;
+  q.plan_at(1, now() - 1);
+  q.plan_at(2, now() + 100);
+
+  q.release();
+  ASSERT_EQ(q.released_count(), 1);
+
+  s_exec_t *s_exec = q.pop_released();
+  ASSERT_TRUE(s_exec != NULL);
+  EXPECT_EQ(s_exec->id, 1);
+  QueueMock::free_released(s_exec);
+}
+
+TEST_F(QueueTest, releaseInDueOrder) {
+  QueueMock q;
+  q.plan_at(3, now() - 1);
+  q.plan_at(1, now() - 5);
+  q.plan_at(2, now() - 1);
+
+  q.release();
+  ASSERT_EQ(q.released_count(), 3);
+
+  for (int id = 1; id <= 3; id++) {
+    s_exec_t *s_exec = q.pop_released();
+    ASSERT_TRUE(s_exec != NULL);
+    EXPECT_EQ(s_exec->id, id);
+    QueueMock::free_released(s_exec);
+  }
+}
+
+TEST_F(QueueTest, planAgainReplacesDueTime) {
+  QueueMock q;
+  q.plan_at(1, now() + 100);
+  q.plan_at(1, now() - 1);
+  q.plan_at(2, now() - 1);
+  q.plan_at(2, now() + 100);
+
+  q.release();
+  ASSERT_EQ(q.released_count(), 1);
+
+  s_exec_t *s_exec = q.pop_released();
+  ASSERT_TRUE(s_exec != NULL);
+  EXPECT_EQ(s_exec->id, 1);
+  QueueMock::free_released(s_exec);
+
+  q.release();
+  EXPECT_EQ(q.released_count(), 0);
+}
+
+TEST_F(QueueTest, releaseUpToWorkerCapacity) {
+  QueueMock q;
+  int capacity = scfg_int(CFG_MAX_WORKERS) * 10;
+
+  for (int id = 1; id <= capacity + 5; id++) {
+    q.plan_at(id, now() - 1);
+  }
+
+  q.release();
+  EXPECT_EQ(q.released_count(), capacity);
+
+  // The rest waits until the workers take some of the released ones.
+  q.release();
+  EXPECT_EQ(q.released_count(), capacity);
+
+  QueueMock::free_released(q.pop_released());
+  QueueMock::free_released(q.pop_released());
+  q.release();
+  EXPECT_EQ(q.released_count(), capacity);
+}
+
+TEST_F(QueueTest, waitUsec) {
+  QueueMock q;
+  EXPECT_EQ(q.get_wait_usec(), 1000000);
+
+  q.plan_at(1, now() + 5);
+  EXPECT_EQ(q.get_wait_usec(), 1000000);
+
+  // Due, but not taken yet.
+  q.plan_at(2, now() - 1);
+  EXPECT_EQ(q.get_wait_usec(), 100000);
+
+  q.release();
+  EXPECT_EQ(q.get_wait_usec(), 1000000);
+}
+
+TEST_F(QueueTest, waitUsecUntilNextSecond) {
+  QueueMock q;
+  q.plan_at(1, now() + 1);
+
+  int usec = q.get_wait_usec();
+  EXPECT_GT(usec, 0);
+  EXPECT_LE(usec, 1000000);
+}
+
+TEST_F(QueueTest, retry) {
+  QueueMock q;
+  ASSERT_TRUE(q.is_preload_enabled());
+
+  s_exec_t s_exec;
+  memset(&s_exec, 0, sizeof(s_exec_t));
+  s_exec.id = 5;
+  s_exec.retry_count = 1;
+  s_exec.action_param = strdup("{\"brightness\":10}");
+
+  q.retry(&s_exec, 10);
+  q.release();
+  EXPECT_EQ(q.released_count(), 0);
+  EXPECT_EQ(q.get_wait_usec(), 1000000);
+
+  // The next attempt replaces the planned one.
+  q.retry(&s_exec, -1);
+  q.release();
+  ASSERT_EQ(q.released_count(), 1);
+
+  s_exec_t *next = q.pop_released();
+  ASSERT_TRUE(next != NULL);
+  EXPECT_EQ(next->id, 5);
+  EXPECT_EQ(next->retry_count, 2);
+  EXPECT_LE(next->retry_timestamp, now() - 1);
+  ASSERT_TRUE(next->action_param != NULL);
+  EXPECT_NE(next->action_param, s_exec.action_param);
+  EXPECT_STREQ(next->action_param, s_exec.action_param);
+  QueueMock::free_released(next);
+
+  free(s_exec.action_param);
+}
+
+}  // namespace testing
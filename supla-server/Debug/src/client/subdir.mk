@@ -12,6 +12,8 @@ CPP_SRCS += \
 ../src/client/clientchannelgroupvalue.cpp \
 ../src/client/clientchannels.cpp \
 ../src/client/clientlocation.cpp \
+../src/client/clientmetadata.cpp \
+../src/client/clientmetadatacache.cpp \
 ../src/client/clientobjcontainer.cpp \
 ../src/client/clientobjcontaineritem.cpp 
 
@@ -24,6 +26,8 @@ OBJS += \
 ./src/client/clientchannelgroupvalue.o \
 ./src/client/clientchannels.o \
 ./src/client/clientlocation.o \
+./src/client/clientmetadata.o \
+./src/client/clientmetadatacache.o \
 ./src/client/clientobjcontainer.o \
 ./src/client/clientobjcontaineritem.o 
 
@@ -36,6 +40,8 @@ CPP_DEPS += \
 ./src/client/clientchannelgroupvalue.d \
 ./src/client/clientchannels.d \
 ./src/client/clientlocation.d \
+./src/client/clientmetadata.d \
+./src/client/clientmetadatacache.d \
 ./src/client/clientobjcontainer.d \
 ./src/client/clientobjcontaineritem.d 
 
@@ -9,7 +9,9 @@ CPP_SRCS += \
 ../src/device/action_executor.cpp \
 ../src/device/action_gate_openclose.cpp \
 ../src/device/action_gate_openclose_search_condition.cpp \
+../src/device/channel_value_writer.cpp \
 ../src/device/device.cpp \
+../src/device/device_registration_cache.cpp \
 ../src/device/devicechannel.cpp \
 ../src/device/gate_state_getter.cpp 
 
@@ -19,7 +21,9 @@ OBJS += \
 ./src/device/action_executor.o \
 ./src/device/action_gate_openclose.o \
 ./src/device/action_gate_openclose_search_condition.o \
+./src/device/channel_value_writer.o \
 ./src/device/device.o \
+./src/device/device_registration_cache.o \
 ./src/device/devicechannel.o \
 ./src/device/gate_state_getter.o 
 
@@ -29,7 +33,9 @@ CPP_DEPS += \
 ./src/device/action_executor.d \
 ./src/device/action_gate_openclose.d \
 ./src/device/action_gate_openclose_search_condition.d \
+./src/device/channel_value_writer.d \
 ./src/device/device.d \
+./src/device/device_registration_cache.d \
 ./src/device/devicechannel.d \
 ./src/device/gate_state_getter.d 
 
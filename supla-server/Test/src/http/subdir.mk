@@ -4,6 +4,7 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../src/http/httpengine.cpp \
 ../src/http/httprequest.cpp \
 ../src/http/httprequestqueue.cpp \
 ../src/http/trivialhttp.cpp \
@@ -11,6 +12,7 @@ CPP_SRCS += \
 ../src/http/trivialhttps.cpp 
 
 OBJS += \
+./src/http/httpengine.o \
 ./src/http/httprequest.o \
 ./src/http/httprequestqueue.o \
 ./src/http/trivialhttp.o \
@@ -18,6 +20,7 @@ OBJS += \
 ./src/http/trivialhttps.o 
 
 CPP_DEPS += \
+./src/http/httpengine.d \
 ./src/http/httprequest.d \
 ./src/http/httprequestqueue.d \
 ./src/http/trivialhttp.d \
@@ -23,10 +23,14 @@ CPP_SRCS += \
 ../src/accept_loop.cpp \
 ../src/cdbase.cpp \
 ../src/cdcontainer.cpp \
+../src/connection_reactor.cpp \
+../src/connection_reactor_task.cpp \
+../src/connection_reactor_thread_pool.cpp \
 ../src/database.cpp \
 ../src/datalogger.cpp \
 ../src/dbcommon.cpp \
 ../src/dcpair.cpp \
+../src/ipc_reactor.cpp \
 ../src/ipcctrl.cpp \
 ../src/objcontainer.cpp \
 ../src/objcontaineritem.cpp \
@@ -39,12 +43,16 @@ OBJS += \
 ./src/cdbase.o \
 ./src/cdcontainer.o \
 ./src/cfg.o \
+./src/connection_reactor.o \
+./src/connection_reactor_task.o \
+./src/connection_reactor_thread_pool.o \
 ./src/database.o \
 ./src/datalogger.o \
 ./src/dbcommon.o \
 ./src/dcpair.o \
 ./src/eh.o \
 ./src/ini.o \
+./src/ipc_reactor.o \
 ./src/ipcctrl.o \
 ./src/ipcsocket.o \
 ./src/lck.o \
@@ -83,10 +91,14 @@ CPP_DEPS += \
 ./src/accept_loop.d \
 ./src/cdbase.d \
 ./src/cdcontainer.d \
+./src/connection_reactor.d \
+./src/connection_reactor_task.d \
+./src/connection_reactor_thread_pool.d \
 ./src/database.d \
 ./src/datalogger.d \
 ./src/dbcommon.d \
 ./src/dcpair.d \
+./src/ipc_reactor.d \
 ./src/ipcctrl.d \
 ./src/objcontainer.d \
 ./src/objcontaineritem.d \
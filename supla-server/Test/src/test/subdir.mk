@@ -9,8 +9,23 @@ CPP_SRCS += \
 ../src/test/CDBaseMock.cpp \
 ../src/test/CDBaseTest.cpp \
 ../src/test/CDContainerTest.cpp \
+../src/test/ChannelValueWriterMock.cpp \
+../src/test/ChannelValueWriterTest.cpp \
+../src/test/ClientMetadataTest.cpp \
+../src/test/ClientMock.cpp \
+../src/test/ClientObjContainerMock.cpp \
+../src/test/ClientObjContainerTest.cpp \
+../src/test/ClientValueUpdateTest.cpp \
 ../src/test/DCPairTest.cpp \
 ../src/test/DeviceChannelTest.cpp \
+../src/test/DeviceContainerTest.cpp \
+../src/test/DeviceRegistrationCacheTest.cpp \
+../src/test/HttpEngineTest.cpp \
+../src/test/HttpRequestMock.cpp \
+../src/test/HttpRequestQueueMock.cpp \
+../src/test/HttpRequestQueueTest.cpp \
+../src/test/IpcCtrlTest.cpp \
+../src/test/IpcReactorTest.cpp \
 ../src/test/ProtoTest.cpp \
 ../src/test/STCDContainer.cpp \
 ../src/test/SafeArrayTest.cpp \
@@ -25,8 +40,23 @@ OBJS += \
 ./src/test/CDBaseMock.o \
 ./src/test/CDBaseTest.o \
 ./src/test/CDContainerTest.o \
+./src/test/ChannelValueWriterMock.o \
+./src/test/ChannelValueWriterTest.o \
+./src/test/ClientMetadataTest.o \
+./src/test/ClientMock.o \
+./src/test/ClientObjContainerMock.o \
+./src/test/ClientObjContainerTest.o \
+./src/test/ClientValueUpdateTest.o \
 ./src/test/DCPairTest.o \
 ./src/test/DeviceChannelTest.o \
+./src/test/DeviceContainerTest.o \
+./src/test/DeviceRegistrationCacheTest.o \
+./src/test/HttpEngineTest.o \
+./src/test/HttpRequestMock.o \
+./src/test/HttpRequestQueueMock.o \
+./src/test/HttpRequestQueueTest.o \
+./src/test/IpcCtrlTest.o \
+./src/test/IpcReactorTest.o \
 ./src/test/ProtoTest.o \
 ./src/test/STCDContainer.o \
 ./src/test/SafeArrayTest.o \
@@ -41,8 +71,23 @@ CPP_DEPS += \
 ./src/test/CDBaseMock.d \
 ./src/test/CDBaseTest.d \
 ./src/test/CDContainerTest.d \
+./src/test/ChannelValueWriterMock.d \
+./src/test/ChannelValueWriterTest.d \
+./src/test/ClientMetadataTest.d \
+./src/test/ClientMock.d \
+./src/test/ClientObjContainerMock.d \
+./src/test/ClientObjContainerTest.d \
+./src/test/ClientValueUpdateTest.d \
 ./src/test/DCPairTest.d \
 ./src/test/DeviceChannelTest.d \
+./src/test/DeviceContainerTest.d \
+./src/test/DeviceRegistrationCacheTest.d \
+./src/test/HttpEngineTest.d \
+./src/test/HttpRequestMock.d \
+./src/test/HttpRequestQueueMock.d \
+./src/test/HttpRequestQueueTest.d \
+./src/test/IpcCtrlTest.d \
+./src/test/IpcReactorTest.d \
 ./src/test/ProtoTest.d \
 ./src/test/STCDContainer.d \
 ./src/test/SafeArrayTest.d \
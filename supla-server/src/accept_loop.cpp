@@ -21,8 +21,10 @@
 
 #include "accept_loop.h"
 #include "client.h"
+#include "connection_reactor.h"
 #include "database.h"
 #include "device.h"
+#include "ipc_reactor.h"
 #include "ipcctrl.h"
 #include "ipcsocket.h"
 #include "log.h"
@@ -41,7 +43,7 @@ void accept_loop_srvconn_execute(void *svrconn, void *sthread) {
 }
 
 void accept_loop_srvconn_finish(void *svrconn, void *sthread) {
-  delete (serverconnection *)svrconn;
+  ((serverconnection *)svrconn)->epilogue_end();
   database::thread_end();
 }
 
@@ -66,6 +68,8 @@ void accept_loop(void *ssd, void *al_sthread) {
   int concurrent_registrations_limit =
       scfg_int(CFG_LIMIT_CONCURRENT_REGISTRATIONS);
 
+  bool event_loop = supla_connection_reactor::is_enabled();
+
   struct timeval reg_limit_exceeded_alert_time = {0, 0};
   struct timeval reg_limit_exceeded_time = {0, 0};
   struct timeval now;
@@ -105,6 +109,12 @@ void accept_loop(void *ssd, void *al_sthread) {
 
     if (ssocket_accept(ssd, &ipv4, &supla_socket) != 0 &&
         supla_socket != NULL) {
+      if (event_loop) {
+        supla_connection_reactor::dispatch(
+            new serverconnection(ssd, supla_socket, ipv4, true));
+        continue;
+      }
+
       Tsthread_params stp;
 
       stp.execute = accept_loop_srvconn_execute;
@@ -117,6 +127,10 @@ void accept_loop(void *ssd, void *al_sthread) {
     }
   }
 
+  if (event_loop) {
+    supla_connection_reactor::close_connections(ssd);
+  }
+
   safe_array_clean(svrconn_thread_arr, accept_loop_srvconn_thread_twt);
   safe_array_free(svrconn_thread_arr);
 }
@@ -152,12 +166,15 @@ char accept_loop_ipcctrl_thread_twt(void *ipcctrl_sthread) {
 void ipc_accept_loop(void *ipc, void *ipc_al_sthread) {
   int client_sd;
   void *ipcctrl_thread_arr = safe_array_init();
+  bool event_loop = supla_ipc_reactor::is_enabled();
 
   while (sthread_isterminated(ipc_al_sthread) == 0 && st_app_terminate == 0) {
     safe_array_clean(ipcctrl_thread_arr, accept_loop_ipcctrl_thread_cnd);
 
     if (-1 == (client_sd = ipcsocket_accept(ipc))) {
       break;
+    } else if (event_loop) {
+      supla_ipc_reactor::dispatch(new svr_ipcctrl(client_sd));
     } else {
       Tsthread_params stp;
 
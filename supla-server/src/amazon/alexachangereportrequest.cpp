@@ -41,7 +41,7 @@ bool supla_alexa_changereport_request::queueUp(void) {
 bool supla_alexa_changereport_request::verifyExisting(
     supla_http_request *existing) {
   duplicateExists = true;
-  existing->setDelay(1000000);
+  existing->postpone(1000000);
   return true;
 }
 
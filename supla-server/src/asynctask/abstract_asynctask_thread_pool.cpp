@@ -149,9 +149,15 @@ void supla_abstract_asynctask_thread_pool::_execute(void *_pool,
   static_cast<supla_abstract_asynctask_thread_pool *>(_pool)->execute(sthread);
 }
 
+void supla_abstract_asynctask_thread_pool::thread_init(void) {}
+
+void supla_abstract_asynctask_thread_pool::thread_end(void) {}
+
 void supla_abstract_asynctask_thread_pool::execute(void *sthread) {
   bool iterate = true;
 
+  thread_init();
+
   do {
     supla_abstract_asynctask *task = queue->pick(this);
 
@@ -189,6 +195,8 @@ void supla_abstract_asynctask_thread_pool::_on_thread_finish(void *_pool,
 }
 
 void supla_abstract_asynctask_thread_pool::on_thread_finish(void *sthread) {
+  thread_end();
+
   lck_lock(lck);
   for (std::vector<void *>::iterator it = threads.begin(); it != threads.end();
        ++it) {
@@ -48,6 +48,9 @@ class supla_abstract_asynctask_thread_pool {
   void execution_request(supla_abstract_asynctask *task);
   void remove_task(supla_abstract_asynctask *task);
   void terminate(void);
+  // Called by each thread of the pool when it starts and before it ends.
+  virtual void thread_init(void);
+  virtual void thread_end(void);
 
  public:
   explicit supla_abstract_asynctask_thread_pool(supla_asynctask_queue *queue);
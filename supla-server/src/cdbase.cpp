@@ -31,14 +31,17 @@ typedef struct {
   char AuthKey[SUPLA_AUTHKEY_SIZE];
   int UserID;
   bool result;
+  struct timeval time;
 } authkey_cache_item_t;
 
 void *cdbase::authkey_auth_cache_arr = NULL;
 int cdbase::authkey_auth_cache_size = 0;
+int cdbase::authkey_auth_cache_ttl = 0;
 
 // static
 void cdbase::init(void) {
   cdbase::authkey_auth_cache_size = scfg_int(CFG_LIMIT_AUTHKEY_AUTH_CACHE_SIZE);
+  cdbase::authkey_auth_cache_ttl = scfg_int(CFG_LIMIT_REGISTRATION_CACHE_TTL);
   cdbase::authkey_auth_cache_arr = safe_array_init();
 }
 
@@ -61,6 +64,7 @@ void cdbase::cdbase_free(void) {
 cdbase::cdbase(serverconnection *svrconn) {
   this->user = NULL;
   this->svrconn = svrconn;
+  this->svrconn_owner = false;
   this->lck = lck_init();
   this->ID = 0;
   this->ptr_counter = 0;
@@ -70,7 +74,13 @@ cdbase::cdbase(serverconnection *svrconn) {
   updateLastActivity();  // last line / after lck_init
 }
 
-cdbase::~cdbase() { lck_free(this->lck); }
+cdbase::~cdbase() {
+  if (svrconn_owner && svrconn) {
+    delete svrconn;
+  }
+
+  lck_free(this->lck);
+}
 
 void cdbase::terminate(void) {
   lck_lock(lck);
@@ -227,11 +237,40 @@ unsigned long cdbase::ptrCounter(void) {
   return result;
 }
 
+void cdbase::takeOverSvrConn(void) {
+  lck_lock(lck);
+  svrconn_owner = true;
+  lck_unlock(lck);
+}
+
 // static
 int cdbase::getAuthKeyCacheSize(void) {
   return safe_array_count(cdbase::authkey_auth_cache_arr);
 }
 
+// static
+void cdbase::authkey_auth_cache_user_invalidate(int UserID) {
+  safe_array_lock(cdbase::authkey_auth_cache_arr);
+
+  int a = 0;
+  authkey_cache_item_t *i = NULL;
+
+  while ((i = static_cast<authkey_cache_item_t *>(
+              safe_array_get(cdbase::authkey_auth_cache_arr, a))) != NULL) {
+    if (i->UserID == UserID) {
+      safe_array_delete(cdbase::authkey_auth_cache_arr, a);
+      if (i->Email) {
+        free(i->Email);
+      }
+      free(i);
+    } else {
+      a++;
+    }
+  }
+
+  safe_array_unlock(cdbase::authkey_auth_cache_arr);
+}
+
 bool cdbase::authkey_auth(const char GUID[SUPLA_GUID_SIZE],
                           const char Email[SUPLA_EMAIL_MAXSIZE],
                           const char AuthKey[SUPLA_AUTHKEY_SIZE], int *UserID,
@@ -253,6 +292,19 @@ bool cdbase::authkey_auth(const char GUID[SUPLA_GUID_SIZE],
       if (i && strncmp(i->Email, Email, SUPLA_EMAIL_MAXSIZE) == 0 &&
           memcmp(i->GUID, GUID, SUPLA_GUID_SIZE) == 0 &&
           memcmp(i->AuthKey, AuthKey, SUPLA_AUTHKEY_SIZE) == 0) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+
+        if (cdbase::authkey_auth_cache_ttl > 0 &&
+            now.tv_sec - i->time.tv_sec >= cdbase::authkey_auth_cache_ttl) {
+          safe_array_delete(cdbase::authkey_auth_cache_arr, a);
+          if (i->Email) {
+            free(i->Email);
+          }
+          free(i);
+          break;
+        }
+
         bool result = i->result;
         *UserID = i->UserID;
         safe_array_move_to_begin(cdbase::authkey_auth_cache_arr, a);
@@ -304,6 +356,7 @@ bool cdbase::authkey_auth(const char GUID[SUPLA_GUID_SIZE],
 
       i->result = result;
       i->UserID = *UserID;
+      gettimeofday(&i->time, NULL);
     }
 
     safe_array_unlock(cdbase::authkey_auth_cache_arr);
@@ -30,6 +30,7 @@ class cdbase {
   char GUID[SUPLA_GUID_SIZE];
   char AuthKey[SUPLA_AUTHKEY_SIZE];
   serverconnection *svrconn;
+  bool svrconn_owner;
   int ID;
   unsigned long ptr_counter;
   supla_user *user;
@@ -38,6 +39,7 @@ class cdbase {
   void *lck;
   static void *authkey_auth_cache_arr;
   static int authkey_auth_cache_size;
+  static int authkey_auth_cache_ttl;
 
   // Thread safe start
   bool setGUID(char GUID[SUPLA_GUID_SIZE]);
@@ -60,6 +62,7 @@ class cdbase {
   static void init(void);
   static void cdbase_free(void);
   static int getAuthKeyCacheSize(void);
+  static void authkey_auth_cache_user_invalidate(int UserID);
   explicit cdbase(serverconnection *svrconn);
   virtual ~cdbase();
   virtual void iterate();
@@ -81,6 +84,9 @@ class cdbase {
   void releasePtr(void);
   bool ptrIsUsed(void);
   unsigned long ptrCounter(void);
+  // The connection is deleted together with this object. The connection
+  // calls it when it ends while other threads may still use this object.
+  void takeOverSvrConn(void);
   // Thread safe end
 };
 
@@ -21,6 +21,25 @@
 cdcontainer::cdcontainer() {
   arr = safe_array_init();
   trash_arr = safe_array_init();
+  id_index = safe_array_add_index(arr, id_key);
+  guid_index = safe_array_add_index(arr, guid_key);
+}
+
+// static
+unsigned long long cdcontainer::id_key(void *ptr) {
+  return static_cast<cdbase *>(ptr)->getID();
+}
+
+// static
+unsigned long long cdcontainer::guid_key(void *ptr) {
+  char GUID[SUPLA_GUID_SIZE];
+  static_cast<cdbase *>(ptr)->getGUID(GUID);
+  return safe_array_key_hash(GUID, SUPLA_GUID_SIZE);
+}
+
+// static
+char cdcontainer::guid_cmp(void *ptr, void *GUID) {
+  return static_cast<cdbase *>(ptr)->cmpGUID((char *)GUID) ? 1 : 0;
 }
 
 cdcontainer::~cdcontainer() {
@@ -43,6 +62,36 @@ cdbase *cdcontainer::find(_func_sa_cnd_param find_cnd, void *user_param) {
   return result;
 }
 
+cdbase *cdcontainer::findBaseByID(int ID) {
+  cdbase *result = NULL;
+
+  safe_array_lock(arr);
+  result = static_cast<cdbase *>(
+      safe_array_findkey(arr, id_index, ID, NULL, NULL));
+  if (result != NULL) {
+    result = result->retainPtr();
+  }
+  safe_array_unlock(arr);
+
+  return result;
+}
+
+cdbase *cdcontainer::findBaseByGUID(const char GUID[SUPLA_GUID_SIZE]) {
+  cdbase *result = NULL;
+
+  safe_array_lock(arr);
+  result = static_cast<cdbase *>(
+      safe_array_findkey(arr, guid_index,
+                         safe_array_key_hash(GUID, SUPLA_GUID_SIZE), guid_cmp,
+                         (void *)GUID));
+  if (result != NULL) {
+    result = result->retainPtr();
+  }
+  safe_array_unlock(arr);
+
+  return result;
+}
+
 cdbase *cdcontainer::get(int idx) {
   cdbase *result = NULL;
 
@@ -56,6 +105,10 @@ cdbase *cdcontainer::get(int idx) {
   return result;
 }
 
+void cdcontainer::onItemAdded(cdbase *cd) {}
+
+void cdcontainer::onItemRemoved(cdbase *cd) {}
+
 void cdcontainer::releasePtr(cdbase *cd) {
   if (cd != NULL) {
     cd->releasePtr();
@@ -69,8 +122,8 @@ void cdcontainer::addToList(cdbase *cd) {
 
     safe_array_remove(trash_arr, cd);
 
-    if (safe_array_find(arr, cd) == -1) {
-      safe_array_add(arr, cd);
+    if (safe_array_find(arr, cd) == -1 && safe_array_add(arr, cd) > -1) {
+      onItemAdded(cd);
     }
 
     safe_array_unlock(arr);
@@ -84,7 +137,12 @@ void cdcontainer::moveToTrash(cdbase *cd) {
     safe_array_lock(arr);
 
     safe_array_add(trash_arr, cd);
-    safe_array_remove(arr, cd);
+
+    int idx = safe_array_find(arr, cd);
+    if (idx > -1) {
+      safe_array_delete(arr, idx);
+      onItemRemoved(cd);
+    }
 
     safe_array_unlock(arr);
     safe_array_unlock(trash_arr);
@@ -26,11 +26,22 @@ class cdcontainer {
  private:
   void *arr;
   void *trash_arr;
+  int id_index;
+  int guid_index;
+
+  static unsigned long long id_key(void *ptr);
+  static unsigned long long guid_key(void *ptr);
+  static char guid_cmp(void *ptr, void *GUID);
 
  protected:
   cdbase *find(_func_sa_cnd_param find_cnd,
                            void *user_param);
+  cdbase *findBaseByID(int ID);
+  cdbase *findBaseByGUID(const char GUID[SUPLA_GUID_SIZE]);
   virtual void cd_delete(cdbase *cd) = 0;
+  // Called with the list locked when an item is added to or removed from it.
+  virtual void onItemAdded(cdbase *cd);
+  virtual void onItemRemoved(cdbase *cd);
  public:
   cdcontainer();
   virtual ~cdcontainer();
@@ -22,11 +22,13 @@
 
 #include "client.h"
 #include "clientlocation.h"
+#include "clientmetadatacache.h"
 #include "database.h"
 #include "lck.h"
 #include "log.h"
 #include "safearray.h"
 #include "srpc.h"
+#include "svrcfg.h"
 #include "user.h"
 
 supla_client::supla_client(serverconnection *svrconn) : cdbase(svrconn) {
@@ -36,6 +38,7 @@ supla_client::supla_client(serverconnection *svrconn) : cdbase(svrconn) {
   this->name[0] = 0;
   this->superuser_authorized = false;
   this->access_id = 0;
+  this->value_update_time = (struct timeval){0};
 }
 
 supla_client::~supla_client() {
@@ -333,14 +336,62 @@ void supla_client::update_device_channels(int LocationID, int DeviceID) {
 
 void supla_client::on_channel_value_changed(int DeviceId, int ChannelId,
                                             bool Extended) {
-  channels->on_channel_value_changed(getSvrConn()->srpc(), DeviceId, ChannelId,
-                                     Extended);
+  int window_ms = scfg_int(CFG_NET_CLIENT_VALUE_UPDATE_WINDOW);
+
+  // Within the window, changes are only marked and then sent together by
+  // iterate(). Each channel is sent once no matter how many times it changed.
+  void *srpc = window_ms > 0 ? NULL : getSvrConn()->srpc();
+
+  channels->on_channel_value_changed(srpc, DeviceId, ChannelId, Extended);
   if (!Extended) {
-    cgroups->on_channel_value_changed(getSvrConn()->srpc(), DeviceId,
-                                      ChannelId);
+    cgroups->on_channel_value_changed(srpc, DeviceId, ChannelId);
+  }
+
+  if (srpc == NULL) {
+    schedule_value_update(window_ms);
   }
 }
 
+void supla_client::schedule_value_update(int window_ms) {
+  bool scheduled = false;
+
+  lck_lock(lck);
+  if (value_update_time.tv_sec == 0 && value_update_time.tv_usec == 0) {
+    gettimeofday(&value_update_time, NULL);
+    value_update_time.tv_sec += window_ms / 1000;
+    value_update_time.tv_usec += (window_ms % 1000) * 1000;
+    if (value_update_time.tv_usec >= 1000000) {
+      value_update_time.tv_sec++;
+      value_update_time.tv_usec -= 1000000;
+    }
+    scheduled = true;
+  }
+  lck_unlock(lck);
+
+  if (scheduled && getSvrConn()) {
+    // Wake up the connection so that it recalculates its wait time.
+    eh_raise_event(getSvrConn()->get_eh());
+  }
+}
+
+bool supla_client::value_update_due(void) {
+  bool result = false;
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  lck_lock(lck);
+  if ((value_update_time.tv_sec != 0 || value_update_time.tv_usec != 0) &&
+      (now.tv_sec > value_update_time.tv_sec ||
+       (now.tv_sec == value_update_time.tv_sec &&
+        now.tv_usec >= value_update_time.tv_usec))) {
+    value_update_time = (struct timeval){0};
+    result = true;
+  }
+  lck_unlock(lck);
+
+  return result;
+}
+
 void supla_client::remote_update_lists(void) {
   if (locations->remote_update(getSvrConn()->srpc())) return;
 
@@ -350,9 +401,16 @@ void supla_client::remote_update_lists(void) {
 }
 
 void supla_client::loadConfig(void) {
-  locations->load(getID());
-  channels->load();
-  cgroups->load();
+  supla_client_metadata *md =
+      supla_client_metadata_cache::global_instance()->get(
+          getUserID(), getAccessID(), getID(), 0);
+
+  if (md) {
+    locations->load(md);
+    channels->load(md);
+    cgroups->load(md);
+    md->release();
+  }
 }
 
 void supla_client::get_next(void) { remote_update_lists(); }
@@ -542,16 +600,43 @@ void supla_client::set_caption_result(TSC_SetCaptionResult *result,
   }
 }
 
-void supla_client::iterate() { channels->update_expired(getSvrConn()->srpc()); }
+void supla_client::iterate() {
+  channels->update_expired(getSvrConn()->srpc());
+
+  if (value_update_due()) {
+    bool more = channels->remote_update(getSvrConn()->srpc());
+    more = cgroups->remote_update(getSvrConn()->srpc()) || more;
+
+    if (more) {
+      // Whatever did not fit into this update goes out in the next window.
+      schedule_value_update(scfg_int(CFG_NET_CLIENT_VALUE_UPDATE_WINDOW));
+    }
+  }
+}
 
 unsigned _supla_int64_t supla_client::waitTimeUSec() {
+  unsigned _supla_int64_t result = 120000000;
   unsigned _supla_int64_t time = channels->value_validity_time_usec();
   if (time > 0 && time < 120000000) {
-    if (time < 1000000) {
-      return 1000000;
+    result = time < 1000000 ? 1000000 : time + 500000;
+  }
+
+  lck_lock(lck);
+  if (value_update_time.tv_sec != 0 || value_update_time.tv_usec != 0) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    _supla_int64_t left =
+        (value_update_time.tv_sec - now.tv_sec) * (_supla_int64_t)1000000 +
+        value_update_time.tv_usec - now.tv_usec;
+
+    if (left <= 0) {
+      result = 0;
+    } else if ((unsigned _supla_int64_t)left < result) {
+      result = left;
     }
-    return time + 500000;
   }
+  lck_unlock(lck);
 
-  return 120000000;
+  return result;
 }
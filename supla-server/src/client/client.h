@@ -31,6 +31,7 @@ class supla_client : public cdbase {
   char name[SUPLA_CLIENT_NAME_MAXSIZE];
   bool superuser_authorized;
   int access_id;
+  struct timeval value_update_time;
 
  protected:
   supla_client_locations *locations;
@@ -40,6 +41,9 @@ class supla_client : public cdbase {
   void loadIODevices(void);
   void loadConfig(void);
 
+  void schedule_value_update(int window_ms);
+  bool value_update_due(void);
+
   void remote_update_lists(void);
   void setName(const char *name);
   void setAccessID(int AccessID);
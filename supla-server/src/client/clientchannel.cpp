@@ -30,57 +30,21 @@
 #include "user.h"
 
 supla_client_channel::supla_client_channel(
-    supla_client_channels *Container, int Id, int DeviceId, int LocationID,
-    int Type, int Func, int Param1, int Param2, int Param3, char *TextParam1,
-    char *TextParam2, char *TextParam3, const char *Caption, int AltIcon,
-    int UserIcon, short ManufacturerID, short ProductID,
-    unsigned char ProtocolVersion, int Flags,
-    const char value[SUPLA_CHANNELVALUE_SIZE],
-    unsigned _supla_int_t validity_time_sec)
-    : supla_client_objcontainer_item(Container, Id, Caption) {
-  this->DeviceId = DeviceId;
-  this->LocationId = LocationID;
-  this->Type = Type;
-  this->Func = Func;
-  this->Param1 = Param1;
-  this->Param2 = Param2;
-  this->Param3 = Param3;
-  this->TextParam1 = TextParam1 ? strndup(TextParam1, 255) : NULL;
-  this->TextParam2 = TextParam2 ? strndup(TextParam2, 255) : NULL;
-  this->TextParam3 = TextParam3 ? strndup(TextParam3, 255) : NULL;
-  this->AltIcon = AltIcon;
-  this->UserIcon = UserIcon;
-  this->ManufacturerID = ManufacturerID;
-  this->ProductID = ProductID;
-  this->ProtocolVersion = ProtocolVersion;
-  this->Flags = Flags;
-  setValueValidityTimeSec(validity_time_sec);
-
-  memcpy(this->value, value, SUPLA_CHANNELVALUE_SIZE);
+    supla_client_channels *Container, const supla_client_metadata *md,
+    const supla_client_metadata_channel_t *row)
+    : supla_client_objcontainer_item(Container, row->Id, row->Caption) {
+  this->row = row;
+  this->Func = row->Func;
+  setValueValidityTimeSec(md->get_validity_time_sec(row));
 }
 
-supla_client_channel::~supla_client_channel(void) {
-  if (this->TextParam1) {
-    free(this->TextParam1);
-    this->TextParam1 = NULL;
-  }
+supla_client_channel::~supla_client_channel(void) {}
 
-  if (this->TextParam2) {
-    free(this->TextParam2);
-    this->TextParam2 = NULL;
-  }
+int supla_client_channel::getDeviceId() { return row->DeviceId; }
 
-  if (this->TextParam3) {
-    free(this->TextParam3);
-    this->TextParam3 = NULL;
-  }
-}
+int supla_client_channel::getExtraId() { return row->DeviceId; }
 
-int supla_client_channel::getDeviceId() { return DeviceId; }
-
-int supla_client_channel::getExtraId() { return DeviceId; }
-
-int supla_client_channel::getType() { return Type; }
+int supla_client_channel::getType() { return row->Type; }
 
 int supla_client_channel::getFunc() { return Func; }
 
@@ -100,11 +64,13 @@ void supla_client_channel::setCaption(const char *Caption) {
   }
 }
 
-short supla_client_channel::getManufacturerID() { return ManufacturerID; }
+short supla_client_channel::getManufacturerID() {
+  return row->ManufacturerID;
+}
 
-short supla_client_channel::getProductID() { return ProductID; }
+short supla_client_channel::getProductID() { return row->ProductID; }
 
-int supla_client_channel::getFlags() { return Flags; }
+int supla_client_channel::getFlags() { return row->Flags; }
 
 void supla_client_channel::setValueValidityTimeSec(
     unsigned _supla_int_t validity_time_sec) {
@@ -188,14 +154,14 @@ bool supla_client_channel::remote_update_is_possible(void) {
     case SUPLA_CHANNELFNC_OPENINGSENSOR_ROOFWINDOW:
     case SUPLA_CHANNELFNC_OPENINGSENSOR_WINDOW:
 
-      if (Param1 == 0 && Param2 == 0) {
+      if (row->Param1 == 0 && row->Param2 == 0) {
         return true;
       }
 
       break;
   }
 
-  return Type == SUPLA_CHANNELTYPE_BRIDGE && Func == 0;
+  return row->Type == SUPLA_CHANNELTYPE_BRIDGE && Func == 0;
 }
 
 void supla_client_channel::proto_get_value(TSuplaChannelValue *value,
@@ -204,8 +170,8 @@ void supla_client_channel::proto_get_value(TSuplaChannelValue *value,
 
   if (client && client->getUser()) {
     unsigned _supla_int_t validity_time_sec = 0;
-    result = client->getUser()->get_channel_value(DeviceId, getId(), value,
-                                                  online, &validity_time_sec);
+    result = client->getUser()->get_channel_value(
+        row->DeviceId, getId(), value, online, &validity_time_sec);
     if (result) {
       setValueValidityTimeSec(validity_time_sec);
     }
@@ -217,12 +183,12 @@ void supla_client_channel::proto_get_value(TSuplaChannelValue *value,
     if (online) {
       *online = true;
     }
-    memcpy(value->value, this->value, SUPLA_CHANNELVALUE_SIZE);
+    memcpy(value->value, row->Value, SUPLA_CHANNELVALUE_SIZE);
   }
 
   if (result) {
 #ifdef SERVER_VERSION_23
-    if (Type == SUPLA_CHANNELTYPE_IMPULSE_COUNTER) {
+    if (row->Type == SUPLA_CHANNELTYPE_IMPULSE_COUNTER) {
 #endif /*SERVER_VERSION_23*/
       switch (Func) {
 #ifdef SERVER_VERSION_23
@@ -238,7 +204,7 @@ void supla_client_channel::proto_get_value(TSuplaChannelValue *value,
 
           TSC_ImpulseCounter_Value sc;
           sc.calculated_value = supla_channel_ic_measurement::get_calculated_i(
-              Param3, ds.counter);
+              row->Param3, ds.counter);
 
           memcpy(value->value, &sc, sizeof(TSC_ImpulseCounter_Value));
           break;
@@ -256,7 +222,7 @@ void supla_client_channel::proto_get(TSC_SuplaChannel *channel,
 
   channel->Id = getId();
   channel->Func = Func;
-  channel->LocationID = this->LocationId;
+  channel->LocationID = row->LocationId;
 
   proto_get_value(&channel->value, &channel->online, client);
   proto_get_caption(channel->Caption, &channel->CaptionSize,
@@ -269,10 +235,10 @@ void supla_client_channel::proto_get(TSC_SuplaChannel_B *channel,
 
   channel->Id = getId();
   channel->Func = Func;
-  channel->LocationID = this->LocationId;
-  channel->AltIcon = this->AltIcon;
-  channel->ProtocolVersion = this->ProtocolVersion;
-  channel->Flags = this->Flags;
+  channel->LocationID = row->LocationId;
+  channel->AltIcon = row->AltIcon;
+  channel->ProtocolVersion = row->ProtocolVersion;
+  channel->Flags = row->Flags;
 
   proto_get_value(&channel->value, &channel->online, client);
   proto_get_caption(channel->Caption, &channel->CaptionSize,
@@ -285,15 +251,15 @@ void supla_client_channel::proto_get(TSC_SuplaChannel_C *channel,
 
   channel->Id = getId();
   channel->DeviceID = getDeviceId();
-  channel->Type = this->Type;
+  channel->Type = row->Type;
   channel->Func = Func;
-  channel->LocationID = this->LocationId;
-  channel->AltIcon = this->AltIcon;
-  channel->UserIcon = this->UserIcon;
-  channel->ManufacturerID = this->ManufacturerID;
-  channel->ProductID = this->ProductID;
-  channel->ProtocolVersion = this->ProtocolVersion;
-  channel->Flags = this->Flags;
+  channel->LocationID = row->LocationId;
+  channel->AltIcon = row->AltIcon;
+  channel->UserIcon = row->UserIcon;
+  channel->ManufacturerID = row->ManufacturerID;
+  channel->ProductID = row->ProductID;
+  channel->ProtocolVersion = row->ProtocolVersion;
+  channel->Flags = row->Flags;
 
   proto_get_value(&channel->value, &channel->online, client);
   proto_get_caption(channel->Caption, &channel->CaptionSize,
@@ -317,17 +283,19 @@ bool supla_client_channel::proto_get(TSC_SuplaChannelExtendedValue *cev,
   cev->Id = getId();
 
   if (client && client->getUser() &&
-      client->getUser()->get_channel_extendedvalue(DeviceId, getId(),
+      client->getUser()->get_channel_extendedvalue(row->DeviceId, getId(),
                                                    &cev->value)) {
     switch (cev->value.type) {
       case EV_TYPE_ELECTRICITY_METER_MEASUREMENT_V1:
       case EV_TYPE_ELECTRICITY_METER_MEASUREMENT_V2:
         return supla_channel_electricity_measurement::update_cev(
-            cev, Param2, TextParam1, client->getProtocolVersion() < 12);
+            cev, row->Param2, row->TextParam1,
+            client->getProtocolVersion() < 12);
 
       case EV_TYPE_IMPULSE_COUNTER_DETAILS_V1:
         return supla_channel_ic_measurement::update_cev(
-            cev, Func, Param2, Param3, TextParam1, TextParam2);
+            cev, Func, row->Param2, row->Param3, row->TextParam1,
+            row->TextParam2);
     }
 
     return true;
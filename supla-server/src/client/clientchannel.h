@@ -20,6 +20,7 @@
 #define CLIENTCHANNEL_H_
 
 #include "clientchannels.h"
+#include "clientmetadata.h"
 #include "clientobjcontaineritem.h"
 #include "proto.h"
 
@@ -27,25 +28,11 @@ class supla_client;
 class supla_client_channels;
 class supla_client_channel : public supla_client_objcontainer_item {
  private:
-  int DeviceId;
-  int LocationId;
-  int Type;
+  // Owned by the metadata the container holds
+  const supla_client_metadata_channel_t *row;
   int Func;
-  int Param1;
-  int Param2;
-  int Param3;
-  char *TextParam1;
-  char *TextParam2;
-  char *TextParam3;
-  int AltIcon;
-  int UserIcon;
-  short ManufacturerID;
-  short ProductID;
-  unsigned char ProtocolVersion;
-  unsigned int Flags;
 
   // during offline
-  char value[SUPLA_CHANNELVALUE_SIZE];
   struct timeval value_valid_to;
   // --------------
 
@@ -58,14 +45,9 @@ class supla_client_channel : public supla_client_objcontainer_item {
                        supla_client *client);
 
  public:
-  supla_client_channel(supla_client_channels *Container, int Id, int DeviceId,
-                       int LocationID, int Type, int Func, int Param1,
-                       int Param2, int Param3, char *TextParam1,
-                       char *TextParam2, char *TextParam3, const char *Caption,
-                       int AltIcon, int UserIcon, short ManufacturerID,
-                       short ProductID, unsigned char ProtocolVersion,
-                       int Flags, const char value[SUPLA_CHANNELVALUE_SIZE],
-                       unsigned _supla_int_t validity_time_sec);
+  supla_client_channel(supla_client_channels *Container,
+                       const supla_client_metadata *md,
+                       const supla_client_metadata_channel_t *row);
   virtual ~supla_client_channel(void);
   void mark_for_remote_update(int mark);
   bool remote_update_is_possible(void);
@@ -34,24 +34,50 @@ supla_client_channelgroups::supla_client_channelgroups(supla_client *client)
   id_cmp_use_both[detail1] = true;
 }
 
-void supla_client_channelgroups::_load(database *db, e_objc_scope scope) {
+void supla_client_channelgroups::_load(supla_client_metadata *md,
+                                       e_objc_scope scope) {
   switch (scope) {
     case master:
-      db->get_client_channel_groups(getClient()->getID(), this);
+      for (std::vector<supla_client_metadata_channelgroup_t>::const_iterator
+               it = md->get_channel_groups().begin();
+           it != md->get_channel_groups().end(); ++it) {
+        supla_client_channelgroup *cg = new supla_client_channelgroup(
+            this, it->Id, it->LocationId, it->Func, it->Caption, it->AltIcon,
+            it->UserIcon);
+        if (!add(cg, master)) {
+          delete cg;
+        }
+      }
       break;
     case detail1:
-      db->get_client_channel_group_relations(getClient()->getID(), this);
+      for (std::vector<supla_client_metadata_relation_t>::const_iterator it =
+               md->get_relations().begin();
+           it != md->get_relations().end(); ++it) {
+        supla_client_channelgroup_relation *cg_rel =
+            new supla_client_channelgroup_relation(this, it->DeviceId,
+                                                   it->ChannelId, it->GroupId);
+        if (!add(cg_rel, detail1)) {
+          delete cg_rel;
+        }
+      }
       break;
     case detail2:
+      for (std::vector<supla_client_metadata_relation_t>::const_iterator it =
+               md->get_relations().begin();
+           it != md->get_relations().end(); ++it) {
+        if (it->Hidden) {
+          supla_client_channelgroup_value *cg_value =
+              new supla_client_channelgroup_value(this, it->ChannelId,
+                                                  it->DeviceId);
+          if (!add(cg_value, detail2)) {
+            delete cg_value;
+          }
+        }
+      }
       break;
   }
 }
 
-void supla_client_channelgroups::load(void) {
-  supla_client_objcontainer::load(master);
-  supla_client_objcontainer::load(detail1);
-}
-
 bool supla_client_channelgroups::add(supla_client_objcontainer_item *obj,
                                      e_objc_scope scope) {
   bool result = false;
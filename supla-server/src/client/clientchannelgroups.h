@@ -35,7 +35,7 @@ class supla_client_channelgroups : public supla_client_objcontainer {
   void set_pack_eol(void *data);
 
  protected:
-  void _load(database *db, e_objc_scope scope);
+  void _load(supla_client_metadata *md, e_objc_scope scope);
   bool get_data_for_remote(supla_client_objcontainer_item *obj, void **data,
                            int data_type, bool *check_more, e_objc_scope scope);
   void send_data_to_remote_and_free(void *srpc, void *data, int data_type,
@@ -44,7 +44,6 @@ class supla_client_channelgroups : public supla_client_objcontainer {
 
  public:
   explicit supla_client_channelgroups(supla_client *client);
-  void load(void);
   virtual bool add(supla_client_objcontainer_item *obj, e_objc_scope scope);
   supla_client_channelgroup *findGroup(int Id);
   void on_channel_value_changed(void *srpc, int DeviceId, int ChannelId);
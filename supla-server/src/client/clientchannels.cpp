@@ -20,10 +20,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "client.h"
 #include "clientchannel.h"
 #include "clientchannels.h"
+#include "clientmetadatacache.h"
 #include "commontypes.h"
-#include "database.h"
 #include "log.h"
 #include "safearray.h"
 #include "srpc.h"
@@ -53,30 +54,48 @@ bool supla_client_channels::channel_exists(int ChannelID) {
   return result;
 }
 
-void supla_client_channels::_load(database *db, e_objc_scope scope) {
-  db->get_client_channels(getClient()->getID(), NULL, this);
+void supla_client_channels::_load(supla_client_metadata *md,
+                                  e_objc_scope scope) {
+  if (scope != master) {
+    return;
+  }
+
+  for (std::vector<supla_client_metadata_channel_t>::const_iterator it =
+           md->get_channels().begin();
+       it != md->get_channels().end(); ++it) {
+    supla_client_channel *channel = new supla_client_channel(this, md, &(*it));
+    if (!add(channel)) {
+      delete channel;
+    }
+  }
 }
 
 void supla_client_channels::update_device_channels(int DeviceId) {
-  database *db = new database();
-  if (db->connect() == true) {
-    safe_array_lock(getArr());
-    db->get_client_channels(getClient()->getID(), &DeviceId, this);
-    safe_array_unlock(getArr());
-  }
-  delete db;
+  supla_client_metadata *md =
+      supla_client_metadata_cache::global_instance()->get(
+          getClient()->getUserID(), getClient()->getAccessID(),
+          getClient()->getID(), DeviceId);
 
-  void *arr = getArr();
-  supla_client_channel *channel = NULL;
+  if (md) {
+    safe_array_lock(getArr());
 
-  safe_array_lock(arr);
-  for (int a = 0; a < safe_array_count(arr); a++) {
-    channel = static_cast<supla_client_channel *>(safe_array_get(arr, a));
-    if (channel && channel->getDeviceId() == DeviceId) {
-      channel->mark_for_remote_update(OI_REMOTEUPDATE_DATA2);
+    // The metadata is held only when the device brings new channels.
+    for (std::vector<supla_client_metadata_channel_t>::const_iterator it =
+             md->get_channels().begin();
+         it != md->get_channels().end(); ++it) {
+      if (find_channel(it->Id) == NULL) {
+        hold_metadata(md);
+        _load(md, master);
+        break;
+      }
     }
+
+    safe_array_unlock(getArr());
+
+    md->release();
   }
-  safe_array_unlock(arr);
+
+  on_value_changed(NULL, 0, DeviceId, master, OI_REMOTEUPDATE_DATA2);
 }
 
 template <typename TSuplaDataPack, class TObjClass>
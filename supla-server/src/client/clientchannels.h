@@ -42,7 +42,7 @@ class supla_client_channels : public supla_client_objcontainer {
   void send_data_to_remote_and_free(void *srpc, void *data, int data_type,
                                     e_objc_scope scope);
   int available_data_types_for_remote(e_objc_scope scope);
-  void _load(database *db, e_objc_scope scope);
+  void _load(supla_client_metadata *md, e_objc_scope scope);
   bool set_device_channel_new_value(int ChannelId, char *value);
 
  public:
@@ -20,7 +20,6 @@
 #include <string.h>
 
 #include "clientlocation.h"
-#include "database.h"
 #include "lck.h"
 #include "log.h"
 #include "safearray.h"
@@ -131,17 +130,17 @@ bool supla_client_locations::add_location(int Id, const char *Caption) {
   return result;
 }
 
-void supla_client_locations::load(int ClientID) {
-  database *db = new database();
+void supla_client_locations::load(supla_client_metadata *md) {
+  safe_array_lock(arr);
+  arr_clean();
 
-  if (db->connect() == true) {
-    safe_array_lock(arr);
-    arr_clean();
-    db->get_client_locations(ClientID, this);
-    safe_array_unlock(arr);
+  for (std::vector<supla_client_metadata_location_t>::const_iterator it =
+           md->get_locations().begin();
+       it != md->get_locations().end(); ++it) {
+    add_location(it->Id, it->Caption);
   }
 
-  delete db;
+  safe_array_unlock(arr);
 }
 
 bool supla_client_locations::remote_update(void *srpc) {
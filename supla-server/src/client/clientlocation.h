@@ -20,6 +20,7 @@
 #define CLIENTLOCATION_H_
 
 #include <vector>
+#include "clientmetadata.h"
 #include "proto.h"
 
 class supla_client_location {
@@ -50,7 +51,7 @@ class supla_client_locations {
  public:
   supla_client_locations();
   virtual ~supla_client_locations();
-  void load(int ClientID);
+  void load(supla_client_metadata *md);
   int count();
   bool add_location(int Id, const char *Caption);
   void set_caption(int Id, const char *Caption);
@@ -0,0 +1,220 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "clientmetadata.h"
+#include <stdlib.h>
+#include <string.h>
+#include "database.h"
+#include "lck.h"
+
+supla_client_metadata::supla_client_metadata(int UserID, int AccessID,
+                                             int DeviceID) {
+  this->lck = lck_init();
+  this->ref_count = 1;
+  this->UserID = UserID;
+  this->AccessID = AccessID;
+  this->DeviceID = DeviceID;
+  gettimeofday(&load_time, NULL);
+}
+
+supla_client_metadata::~supla_client_metadata(void) {
+  for (std::vector<supla_client_metadata_location_t>::iterator it =
+           locations.begin();
+       it != locations.end(); ++it) {
+    free(it->Caption);
+  }
+
+  for (std::vector<supla_client_metadata_channel_t>::iterator it =
+           channels.begin();
+       it != channels.end(); ++it) {
+    free(it->TextParam1);
+    free(it->TextParam2);
+    free(it->TextParam3);
+    free(it->Caption);
+  }
+
+  for (std::vector<supla_client_metadata_channelgroup_t>::iterator it =
+           channel_groups.begin();
+       it != channel_groups.end(); ++it) {
+    free(it->Caption);
+  }
+
+  lck_free(lck);
+}
+
+// static
+char *supla_client_metadata::strdup_max(const char *str, size_t max) {
+  return str ? strndup(str, max) : NULL;
+}
+
+bool supla_client_metadata::load(int ClientID) {
+  bool result = false;
+  database *db = new database();
+
+  if (db->connect() == true) {
+    gettimeofday(&load_time, NULL);
+
+    if (DeviceID) {
+      db->get_client_channels(ClientID, &DeviceID, this);
+    } else {
+      db->get_client_locations(ClientID, this);
+      db->get_client_channels(ClientID, NULL, this);
+      db->get_client_channel_groups(ClientID, this);
+      db->get_client_channel_group_relations(ClientID, this);
+    }
+
+    result = true;
+  }
+
+  delete db;
+
+  return result;
+}
+
+void supla_client_metadata::add_location(int Id, const char *Caption) {
+  supla_client_metadata_location_t location;
+  location.Id = Id;
+  location.Caption = strdup_max(Caption, SUPLA_LOCATION_CAPTION_MAXSIZE);
+
+  locations.push_back(location);
+}
+
+void supla_client_metadata::add_channel(
+    int Id, int DeviceId, int LocationId, int Type, int Func, int Param1,
+    int Param2, int Param3, const char *TextParam1, const char *TextParam2,
+    const char *TextParam3, const char *Caption, int AltIcon, int UserIcon,
+    short ManufacturerID, short ProductID, unsigned char ProtocolVersion,
+    int Flags, const char Value[SUPLA_CHANNELVALUE_SIZE],
+    unsigned _supla_int_t ValidityTimeSec) {
+  supla_client_metadata_channel_t channel;
+  channel.Id = Id;
+  channel.DeviceId = DeviceId;
+  channel.LocationId = LocationId;
+  channel.Type = Type;
+  channel.Func = Func;
+  channel.Param1 = Param1;
+  channel.Param2 = Param2;
+  channel.Param3 = Param3;
+  channel.TextParam1 = strdup_max(TextParam1, 255);
+  channel.TextParam2 = strdup_max(TextParam2, 255);
+  channel.TextParam3 = strdup_max(TextParam3, 255);
+  channel.Caption = strdup_max(Caption, SUPLA_CHANNEL_CAPTION_MAXSIZE);
+  channel.AltIcon = AltIcon;
+  channel.UserIcon = UserIcon;
+  channel.ManufacturerID = ManufacturerID;
+  channel.ProductID = ProductID;
+  channel.ProtocolVersion = ProtocolVersion;
+  channel.Flags = Flags;
+  memcpy(channel.Value, Value, SUPLA_CHANNELVALUE_SIZE);
+  channel.ValidityTimeSec = ValidityTimeSec;
+
+  channels.push_back(channel);
+}
+
+void supla_client_metadata::add_channel_group(int Id, int LocationId,
+                                              int Func, const char *Caption,
+                                              int AltIcon, int UserIcon) {
+  supla_client_metadata_channelgroup_t group;
+  group.Id = Id;
+  group.LocationId = LocationId;
+  group.Func = Func;
+  group.Caption = strdup_max(Caption, SUPLA_CHANNELGROUP_CAPTION_MAXSIZE);
+  group.AltIcon = AltIcon;
+  group.UserIcon = UserIcon;
+
+  channel_groups.push_back(group);
+}
+
+void supla_client_metadata::add_relation(int ChannelId, int GroupId,
+                                         bool Hidden, int DeviceId) {
+  supla_client_metadata_relation_t relation;
+  relation.ChannelId = ChannelId;
+  relation.GroupId = GroupId;
+  relation.Hidden = Hidden;
+  relation.DeviceId = DeviceId;
+
+  relations.push_back(relation);
+}
+
+supla_client_metadata *supla_client_metadata::retain(void) {
+  lck_lock(lck);
+  ref_count++;
+  lck_unlock(lck);
+  return this;
+}
+
+void supla_client_metadata::release(void) {
+  lck_lock(lck);
+  bool last = --ref_count <= 0;
+  lck_unlock(lck);
+
+  if (last) {
+    delete this;
+  }
+}
+
+int supla_client_metadata::get_user_id(void) const { return UserID; }
+
+int supla_client_metadata::get_access_id(void) const { return AccessID; }
+
+int supla_client_metadata::get_device_id(void) const { return DeviceID; }
+
+const struct timeval *supla_client_metadata::get_load_time(void) const {
+  return &load_time;
+}
+
+const std::vector<supla_client_metadata_location_t>
+    &supla_client_metadata::get_locations(void) const {
+  return locations;
+}
+
+const std::vector<supla_client_metadata_channel_t>
+    &supla_client_metadata::get_channels(void) const {
+  return channels;
+}
+
+const std::vector<supla_client_metadata_channelgroup_t>
+    &supla_client_metadata::get_channel_groups(void) const {
+  return channel_groups;
+}
+
+const std::vector<supla_client_metadata_relation_t>
+    &supla_client_metadata::get_relations(void) const {
+  return relations;
+}
+
+unsigned _supla_int_t supla_client_metadata::get_validity_time_sec(
+    const supla_client_metadata_channel_t *channel) const {
+  if (channel == NULL || channel->ValidityTimeSec == 0) {
+    return 0;
+  }
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  long long elapsed = now.tv_sec - load_time.tv_sec;
+  if (elapsed < 0) {
+    elapsed = 0;
+  }
+
+  if (elapsed >= channel->ValidityTimeSec) {
+    return 0;
+  }
+
+  return channel->ValidityTimeSec - elapsed;
+}
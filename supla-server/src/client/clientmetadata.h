@@ -0,0 +1,135 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CLIENT_CLIENTMETADATA_H_
+#define CLIENT_CLIENTMETADATA_H_
+
+#include <stddef.h>
+#include <sys/time.h>
+#include <vector>
+#include "proto.h"
+
+typedef struct {
+  int Id;
+  char *Caption;
+} supla_client_metadata_location_t;
+
+typedef struct {
+  int Id;
+  int DeviceId;
+  int LocationId;
+  int Type;
+  int Func;
+  int Param1;
+  int Param2;
+  int Param3;
+  char *TextParam1;
+  char *TextParam2;
+  char *TextParam3;
+  char *Caption;
+  int AltIcon;
+  int UserIcon;
+  short ManufacturerID;
+  short ProductID;
+  unsigned char ProtocolVersion;
+  int Flags;
+  char Value[SUPLA_CHANNELVALUE_SIZE];
+  unsigned _supla_int_t ValidityTimeSec;
+} supla_client_metadata_channel_t;
+
+typedef struct {
+  int Id;
+  int LocationId;
+  int Func;
+  char *Caption;
+  int AltIcon;
+  int UserIcon;
+} supla_client_metadata_channelgroup_t;
+
+typedef struct {
+  int ChannelId;
+  int GroupId;
+  bool Hidden;
+  int DeviceId;
+} supla_client_metadata_relation_t;
+
+// Locations, channels and channel groups visible to the clients of one
+// access identifier, as read from the database. The object does not change
+// after load() and is shared by all these clients. Client containers keep
+// pointers to its rows, so they retain it for as long as they use them.
+// DeviceID != 0 limits the channels to one device and skips the rest.
+class supla_client_metadata {
+ private:
+  void *lck;
+  int ref_count;
+  int UserID;
+  int AccessID;
+  int DeviceID;
+  struct timeval load_time;
+
+  std::vector<supla_client_metadata_location_t> locations;
+  std::vector<supla_client_metadata_channel_t> channels;
+  std::vector<supla_client_metadata_channelgroup_t> channel_groups;
+  std::vector<supla_client_metadata_relation_t> relations;
+
+  static char *strdup_max(const char *str, size_t max);
+
+ protected:
+  // Use release() instead.
+  virtual ~supla_client_metadata(void);
+
+ public:
+  supla_client_metadata(int UserID, int AccessID, int DeviceID);
+
+  bool load(int ClientID);
+  void add_location(int Id, const char *Caption);
+  void add_channel(int Id, int DeviceId, int LocationId, int Type, int Func,
+                   int Param1, int Param2, int Param3, const char *TextParam1,
+                   const char *TextParam2, const char *TextParam3,
+                   const char *Caption, int AltIcon, int UserIcon,
+                   short ManufacturerID, short ProductID,
+                   unsigned char ProtocolVersion, int Flags,
+                   const char Value[SUPLA_CHANNELVALUE_SIZE],
+                   unsigned _supla_int_t ValidityTimeSec);
+  void add_channel_group(int Id, int LocationId, int Func, const char *Caption,
+                         int AltIcon, int UserIcon);
+  void add_relation(int ChannelId, int GroupId, bool Hidden, int DeviceId);
+
+  supla_client_metadata *retain(void);
+  void release(void);
+
+  int get_user_id(void) const;
+  int get_access_id(void) const;
+  int get_device_id(void) const;
+  const struct timeval *get_load_time(void) const;
+
+  const std::vector<supla_client_metadata_location_t> &get_locations(
+      void) const;
+  const std::vector<supla_client_metadata_channel_t> &get_channels(
+      void) const;
+  const std::vector<supla_client_metadata_channelgroup_t> &get_channel_groups(
+      void) const;
+  const std::vector<supla_client_metadata_relation_t> &get_relations(
+      void) const;
+
+  // The value validity time counted from now instead of from load().
+  unsigned _supla_int_t get_validity_time_sec(
+      const supla_client_metadata_channel_t *channel) const;
+};
+
+#endif /* CLIENT_CLIENTMETADATA_H_ */
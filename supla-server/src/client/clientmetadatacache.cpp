@@ -0,0 +1,183 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "clientmetadatacache.h"
+#include <stddef.h>
+#include "lck.h"
+#include "svrcfg.h"
+
+supla_client_metadata_cache *supla_client_metadata_cache::_global_instance =
+    NULL;
+
+// static
+supla_client_metadata_cache *supla_client_metadata_cache::global_instance(
+    void) {
+  if (_global_instance == NULL) {
+    _global_instance = new supla_client_metadata_cache(
+        scfg_int(CFG_LIMIT_CLIENT_METADATA_CACHE_TTL));
+  }
+
+  return _global_instance;
+}
+
+// static
+void supla_client_metadata_cache::global_instance_release(void) {
+  if (_global_instance) {
+    delete _global_instance;
+    _global_instance = NULL;
+  }
+}
+
+supla_client_metadata_cache::supla_client_metadata_cache(int ttl_sec) {
+  this->ttl_sec = ttl_sec;
+  this->lck = lck_init();
+  this->generation = 0;
+  gettimeofday(&last_purge_time, NULL);
+}
+
+supla_client_metadata_cache::~supla_client_metadata_cache(void) {
+  for (std::map<std::pair<int, int>, supla_client_metadata *>::iterator it =
+           items.begin();
+       it != items.end(); ++it) {
+    it->second->release();
+  }
+
+  items.clear();
+  lck_free(lck);
+}
+
+bool supla_client_metadata_cache::is_expired(const supla_client_metadata *md,
+                                             struct timeval *now) {
+  return now->tv_sec - md->get_load_time()->tv_sec >= ttl_sec;
+}
+
+void supla_client_metadata_cache::purge_expired(struct timeval *now) {
+  if (now->tv_sec - last_purge_time.tv_sec < ttl_sec) {
+    return;
+  }
+
+  last_purge_time = *now;
+
+  for (std::map<std::pair<int, int>, supla_client_metadata *>::iterator it =
+           items.begin();
+       it != items.end();) {
+    if (is_expired(it->second, now)) {
+      it->second->release();
+      items.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+supla_client_metadata *supla_client_metadata_cache::get(int UserID,
+                                                        int AccessID,
+                                                        int ClientID,
+                                                        int DeviceID) {
+  supla_client_metadata *md = NULL;
+  unsigned long long _generation = 0;
+  std::pair<int, int> key(AccessID, DeviceID);
+
+  if (ttl_sec > 0 && AccessID) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    lck_lock(lck);
+
+    std::map<std::pair<int, int>, supla_client_metadata *>::iterator it =
+        items.find(key);
+
+    if (it != items.end()) {
+      if (it->second->get_user_id() == UserID &&
+          !is_expired(it->second, &now)) {
+        md = it->second->retain();
+      } else {
+        it->second->release();
+        items.erase(it);
+      }
+    }
+
+    _generation = generation;
+    lck_unlock(lck);
+
+    if (md) {
+      return md;
+    }
+  }
+
+  // The database is read outside of the lock, so the clients of other
+  // users do not wait for it.
+  md = new supla_client_metadata(UserID, AccessID, DeviceID);
+  if (!md->load(ClientID)) {
+    md->release();
+    return NULL;
+  }
+
+  if (ttl_sec > 0 && AccessID) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    lck_lock(lck);
+
+    // Data read before an invalidation may already be out of date.
+    if (_generation == generation) {
+      std::map<std::pair<int, int>, supla_client_metadata *>::iterator it =
+          items.find(key);
+
+      if (it != items.end()) {
+        it->second->release();
+        it->second = md->retain();
+      } else {
+        items[key] = md->retain();
+      }
+    }
+
+    purge_expired(&now);
+
+    lck_unlock(lck);
+  }
+
+  return md;
+}
+
+void supla_client_metadata_cache::user_invalidate(int UserID) {
+  lck_lock(lck);
+
+  generation++;
+
+  for (std::map<std::pair<int, int>, supla_client_metadata *>::iterator it =
+           items.begin();
+       it != items.end();) {
+    if (it->second->get_user_id() == UserID) {
+      it->second->release();
+      items.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  lck_unlock(lck);
+}
+
+int supla_client_metadata_cache::count(void) {
+  lck_lock(lck);
+  int result = items.size();
+  lck_unlock(lck);
+
+  return result;
+}
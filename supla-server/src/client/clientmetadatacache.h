@@ -0,0 +1,60 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CLIENT_CLIENTMETADATACACHE_H_
+#define CLIENT_CLIENTMETADATACACHE_H_
+
+#include <map>
+#include <utility>
+#include "clientmetadata.h"
+
+// Keeps the last metadata loaded for each access identifier, so that the
+// clients which connect one after another do not read the same rows again.
+// Any change of the user's devices, channels, locations or access
+// identifiers has to invalidate the user's entries.
+class supla_client_metadata_cache {
+ private:
+  static supla_client_metadata_cache *_global_instance;
+
+  void *lck;
+  int ttl_sec;
+  unsigned long long generation;
+  struct timeval last_purge_time;
+
+  // AccessID, DeviceID
+  std::map<std::pair<int, int>, supla_client_metadata *> items;
+
+  bool is_expired(const supla_client_metadata *md, struct timeval *now);
+  void purge_expired(struct timeval *now);
+
+ public:
+  static supla_client_metadata_cache *global_instance(void);
+  static void global_instance_release(void);
+
+  explicit supla_client_metadata_cache(int ttl_sec);
+  virtual ~supla_client_metadata_cache(void);
+
+  // Returns retained metadata or NULL if the database is not available.
+  // The caller has to release() it.
+  supla_client_metadata *get(int UserID, int AccessID, int ClientID,
+                             int DeviceID);
+  void user_invalidate(int UserID);
+  int count(void);
+};
+
+#endif /* CLIENT_CLIENTMETADATACACHE_H_ */
@@ -19,32 +19,190 @@
 #include "clientobjcontainer.h"
 #include <stdlib.h>  // NOLINT
 #include "../database.h"
+#include "../lck.h"
 #include "../log.h"
 #include "../safearray.h"
 #include "client.h"
+#include "clientmetadatacache.h"
 
 supla_client_objcontainer::supla_client_objcontainer(supla_client *client)
     : supla_objcontainer() {
   this->client = client;
+  this->metadata_lck = lck_init();
+  this->dirty_lck = lck_init();
 }
 
-supla_client_objcontainer::~supla_client_objcontainer(void) {}
+supla_client_objcontainer::~supla_client_objcontainer(void) {
+  // The items have to go first because they point to the metadata.
+  for (int a = 0; a < OBJC_SCOPE_COUNT; a++) {
+    clean(static_cast<e_objc_scope>(a));
+  }
+
+  release_metadata();
+  lck_free(metadata_lck);
+  lck_free(dirty_lck);
+}
 
 supla_client *supla_client_objcontainer::getClient() { return client; }
 
+void supla_client_objcontainer::_load(database *db, e_objc_scope scope) {}
+
+void supla_client_objcontainer::clean(e_objc_scope scope) {
+  safe_array_lock(getArr(scope));
+
+  lck_lock(dirty_lck);
+  dirty[scope].clear();
+  lck_unlock(dirty_lck);
+
+  extra_id_index[scope].clear();
+  arr_clean(getArr(scope));
+
+  safe_array_unlock(getArr(scope));
+}
+
+bool supla_client_objcontainer::add(supla_objcontainer_item *obj,
+                                    e_objc_scope scope) {
+  if (obj == NULL) {
+    return false;
+  }
+
+  supla_client_objcontainer_item *item =
+      static_cast<supla_client_objcontainer_item *>(obj);
+
+  safe_array_lock(getArr(scope));
+
+  // The scope has to be known before supla_objcontainer::add marks the item.
+  item->Scope = scope;
+  bool result = supla_objcontainer::add(obj, scope);
+
+  if (result) {
+    extra_id_index[scope].insert(std::make_pair(item->getExtraId(), item));
+  } else {
+    item->Scope = -1;
+  }
+
+  safe_array_unlock(getArr(scope));
+
+  return result;
+}
+
+bool supla_client_objcontainer::add(supla_objcontainer_item *obj) {
+  return add(obj, master);
+}
+
+void supla_client_objcontainer::on_marked_for_remote_update(
+    supla_client_objcontainer_item *obj) {
+  lck_lock(dirty_lck);
+
+  if (!obj->Queued) {
+    obj->Queued = true;
+    dirty[obj->Scope].push_back(obj);
+  }
+
+  lck_unlock(dirty_lck);
+}
+
+bool supla_client_objcontainer::is_dirty(e_objc_scope scope) {
+  lck_lock(dirty_lck);
+  bool result = !dirty[scope].empty();
+  lck_unlock(dirty_lck);
+
+  return result;
+}
+
+void supla_client_objcontainer::release_metadata(void) {
+  lck_lock(metadata_lck);
+  for (std::vector<supla_client_metadata *>::iterator it = metadata.begin();
+       it != metadata.end(); ++it) {
+    (*it)->release();
+  }
+
+  metadata.clear();
+  lck_unlock(metadata_lck);
+}
+
+void supla_client_objcontainer::hold_metadata(supla_client_metadata *md) {
+  lck_lock(metadata_lck);
+
+  bool held = false;
+  for (std::vector<supla_client_metadata *>::iterator it = metadata.begin();
+       it != metadata.end(); ++it) {
+    if (*it == md) {
+      held = true;
+      break;
+    }
+  }
+
+  if (!held) {
+    metadata.push_back(md->retain());
+  }
+
+  lck_unlock(metadata_lck);
+}
+
+void supla_client_objcontainer::load(supla_client_metadata *md) {
+  if (md == NULL) {
+    return;
+  }
+
+  // The new metadata is held before the items that point to it are added
+  // and the old one is released after the items that point to it are gone.
+  lck_lock(metadata_lck);
+  std::vector<supla_client_metadata *> old_metadata = metadata;
+  metadata.clear();
+  lck_unlock(metadata_lck);
+
+  hold_metadata(md);
+
+  for (int a = 0; a < OBJC_SCOPE_COUNT; a++) {
+    clean(static_cast<e_objc_scope>(a));
+  }
+
+  for (int a = 0; a < OBJC_SCOPE_COUNT; a++) {
+    e_objc_scope scope = static_cast<e_objc_scope>(a);
+    safe_array_lock(getArr(scope));
+    _load(md, scope);
+    safe_array_unlock(getArr(scope));
+  }
+
+  for (std::vector<supla_client_metadata *>::iterator it =
+           old_metadata.begin();
+       it != old_metadata.end(); ++it) {
+    (*it)->release();
+  }
+}
+
+void supla_client_objcontainer::load(void) {
+  supla_client_metadata *md =
+      supla_client_metadata_cache::global_instance()->get(
+          client->getUserID(), client->getAccessID(), client->getID(), 0);
+
+  if (md) {
+    load(md);
+    md->release();
+  }
+}
+
 bool supla_client_objcontainer::do_remote_update(void *srpc, int data_type,
                                                  e_objc_scope scope) {
   void *data = NULL;
-  supla_client_objcontainer_item *obj = NULL;
 
   safe_array_lock(getArr(scope));
 
+  // The items cannot be removed while the array is locked, so the queue can
+  // be walked without holding dirty_lck during get_data_for_remote().
+  lck_lock(dirty_lck);
+  std::vector<supla_client_objcontainer_item *> items(dirty[scope].begin(),
+                                                      dirty[scope].end());
+  lck_unlock(dirty_lck);
+
   bool check_more = false;
   bool result = false;
 
-  for (int a = 0; a < safe_array_count(getArr(scope)); a++) {
-    obj = static_cast<supla_client_objcontainer_item *>(
-        safe_array_get(getArr(scope), a));
+  for (std::vector<supla_client_objcontainer_item *>::iterator it =
+           items.begin();
+       it != items.end(); ++it) {
+    supla_client_objcontainer_item *obj = *it;
     if (obj->marked_for_remote_update() & data_type) {
       if (get_data_for_remote(obj, &data, data_type, &check_more, scope)) {
         obj->unmark_for_remote_update(data_type);
@@ -57,6 +215,19 @@ bool supla_client_objcontainer::do_remote_update(void *srpc, int data_type,
     }
   }
 
+  lck_lock(dirty_lck);
+  for (std::list<supla_client_objcontainer_item *>::iterator it =
+           dirty[scope].begin();
+       it != dirty[scope].end();) {
+    if ((*it)->marked_for_remote_update() == 0) {
+      (*it)->Queued = false;
+      it = dirty[scope].erase(it);
+    } else {
+      ++it;
+    }
+  }
+  lck_unlock(dirty_lck);
+
   safe_array_unlock(getArr(scope));
 
   if (data) {
@@ -71,7 +242,7 @@ bool supla_client_objcontainer::remote_update(void *srpc) {
     e_objc_scope scope = static_cast<e_objc_scope>(a);
     int a_data_types = available_data_types_for_remote(scope);
     int data_type = 0x1;
-    if (count(scope) > 0) {
+    if (is_dirty(scope)) {
       for (int b = 0; b < 4; b++) {
         if (a_data_types & data_type) {
           if (do_remote_update(srpc, data_type, scope)) {
@@ -102,18 +273,21 @@ void supla_client_objcontainer::on_value_changed(void *srpc, int Id,
                                                  int ExtraId,
                                                  e_objc_scope scope,
                                                  int data_type) {
-  supla_client_objcontainer_item *obj;
   bool r = false;
 
   void *arr = getArr(scope);
 
   safe_array_lock(arr);
 
-  for (int a = 0; a < safe_array_count(arr); a++) {
-    obj = static_cast<supla_client_objcontainer_item *>(safe_array_get(arr, a));
-    if (obj && obj->getExtraId() == ExtraId &&
-        (Id == 0 || obj->getId() == Id)) {
-      obj->mark_for_remote_update(data_type);
+  std::pair<std::multimap<int, supla_client_objcontainer_item *>::iterator,
+            std::multimap<int, supla_client_objcontainer_item *>::iterator>
+      range = extra_id_index[scope].equal_range(ExtraId);
+
+  for (std::multimap<int, supla_client_objcontainer_item *>::iterator it =
+           range.first;
+       it != range.second; ++it) {
+    if (Id == 0 || it->second->getId() == Id) {
+      it->second->mark_for_remote_update(data_type);
       r = true;
     }
   }
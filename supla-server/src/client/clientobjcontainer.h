@@ -19,6 +19,11 @@
 #ifndef CLIENTOBJCONTAINER_H_
 #define CLIENTOBJCONTAINER_H_
 
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+#include "clientmetadata.h"
 #include "objcontainer.h"
 #include "objcontaineritem.h"
 
@@ -27,9 +32,28 @@ class supla_client_objcontainer_item;
 class supla_client_objcontainer : public supla_objcontainer {
  private:
   supla_client *client;
+  // Metadata the items point to
+  void *metadata_lck;
+  std::vector<supla_client_metadata *> metadata;
+  // Items marked for remote update, in the order they were marked
+  void *dirty_lck;
+  std::list<supla_client_objcontainer_item *> dirty[OBJC_SCOPE_COUNT];
+  // Items by ExtraId. Guarded by the array lock of the scope.
+  std::multimap<int, supla_client_objcontainer_item *>
+      extra_id_index[OBJC_SCOPE_COUNT];
+
   bool do_remote_update(void *srpc, int data_type, e_objc_scope scope);
+  bool is_dirty(e_objc_scope scope);
+  void release_metadata(void);
+  void clean(e_objc_scope scope);
 
  protected:
+  // The items are created from supla_client_metadata, not from the database.
+  void _load(database *db, e_objc_scope scope);
+  virtual void _load(supla_client_metadata *md, e_objc_scope scope) = 0;
+  // Keeps md alive as long as the container.
+  void hold_metadata(supla_client_metadata *md);
+
   virtual bool get_data_for_remote(supla_client_objcontainer_item *obj,
                                    void **data, int data_type, bool *check_more,
                                    e_objc_scope scope) = 0;
@@ -47,7 +71,13 @@ class supla_client_objcontainer : public supla_objcontainer {
   virtual ~supla_client_objcontainer(void);
 
   supla_client *getClient();
+  virtual bool add(supla_objcontainer_item *obj, e_objc_scope scope);
+  virtual bool add(supla_objcontainer_item *obj);
+  // Called by the item after it has been marked for remote update.
+  void on_marked_for_remote_update(supla_client_objcontainer_item *obj);
   bool remote_update(void *srpc);
+  void load(supla_client_metadata *md);
+  void load(void);
 };
 
 #endif /* CLIENTOBJCONTAINER_H_ */
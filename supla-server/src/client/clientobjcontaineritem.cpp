@@ -26,8 +26,10 @@
 supla_client_objcontainer_item::supla_client_objcontainer_item(
     supla_client_objcontainer *Container, int Id, const char *Caption)
     : supla_objcontainer_item(Container, Id) {
-  this->Caption = NULL;
-  setCaption(Caption);
+  this->Caption = Caption;
+  this->CaptionOwned = false;
+  this->Scope = -1;
+  this->Queued = false;
 }
 
 supla_client_objcontainer_item::~supla_client_objcontainer_item(void) {
@@ -39,18 +41,31 @@ supla_client_objcontainer *supla_client_objcontainer_item::getContainer(void) {
       supla_objcontainer_item::getContainer());
 }
 
+void supla_client_objcontainer_item::mark_for_remote_update(int mark) {
+  supla_objcontainer_item::mark_for_remote_update(mark);
+
+  if (marked_for_remote_update() && Scope != -1) {
+    getContainer()->on_marked_for_remote_update(this);
+  }
+}
+
 void supla_client_objcontainer_item::setCaption(const char *Caption) {
-  if (this->Caption != NULL) {
-    free(this->Caption);
-    this->Caption = NULL;
+  if (this->CaptionOwned) {
+    free(const_cast<char *>(this->Caption));
   }
 
+  this->Caption = NULL;
+  this->CaptionOwned = false;
+
   if (Caption) {
     this->Caption = strdup(Caption);
+    this->CaptionOwned = true;
   }
 }
 
-char *supla_client_objcontainer_item::getCaption(void) { return Caption; }
+const char *supla_client_objcontainer_item::getCaption(void) {
+  return Caption;
+}
 
 void supla_client_objcontainer_item::proto_get_caption(
     char *Caption, unsigned _supla_int_t *CaptionSize, unsigned int MaxSize) {
@@ -32,18 +32,27 @@ class supla_client;
 class supla_client_objcontainer;
 class supla_client_objcontainer_item : public supla_objcontainer_item {
  private:
-  char *Caption;
+  // Points into the container's metadata until setCaption() makes a copy.
+  const char *Caption;
+  bool CaptionOwned;
+  // Set by the container
+  int Scope;
+  bool Queued;
+
+  friend class supla_client_objcontainer;
 
  protected:
   void proto_get_caption(char *Caption, unsigned _supla_int_t *CaptionSize,
                          unsigned int MaxSize);
 
  public:
+  // Caption is not copied. It has to live as long as the item.
   explicit supla_client_objcontainer_item(supla_client_objcontainer *Container,
                                           int Id, const char *Caption);
   virtual ~supla_client_objcontainer_item(void);
   supla_client_objcontainer *getContainer(void);
-  char *getCaption(void);
+  virtual void mark_for_remote_update(int mark);
+  const char *getCaption(void);
   void setCaption(const char *Caption);
 };
 
@@ -0,0 +1,612 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "connection_reactor.h"
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "asynctask/asynctask_queue.h"
+#include "connection_reactor_task.h"
+#include "connection_reactor_thread_pool.h"
+#include "database.h"
+#include "lck.h"
+#include "log.h"
+#include "serverconnection.h"
+#include "srpc.h"
+#include "sthread.h"
+#include "supla-socket.h"
+#include "svrcfg.h"
+
+#define REACTOR_MAX_EVENTS 256
+#define REACTOR_MAX_WAIT_MSEC 1000
+// The handshake proceeds on socket readiness. The timer only checks the
+// registration timeout.
+#define REACTOR_HANDSHAKE_CHECK_USEC 1000000
+
+#define RC_STAGE_HANDSHAKE 0
+#define RC_STAGE_RUNNING 1
+#define RC_STAGE_CLOSING 2
+
+struct supla_reactor_conn {
+  serverconnection *conn;
+  int sfd;
+  int efd;
+  char stage;
+  bool scheduled;
+  // Iterated on a pool thread. Its descriptors are not monitored meanwhile.
+  bool busy;
+  bool iterate_result;
+  unsigned int sfd_events;
+  unsigned int efd_events;
+  std::multimap<unsigned _supla_int64_t, supla_reactor_conn *>::iterator timer;
+};
+
+void *supla_connection_reactor::reactors_lck = NULL;
+std::vector<supla_connection_reactor *> supla_connection_reactor::reactors;
+TEventHandler *supla_connection_reactor::closed_eh = NULL;
+
+supla_connection_reactor::supla_connection_reactor(void) {
+  struct epoll_event evnt = {};
+
+  lck = lck_init();
+  sthread = NULL;
+  busy_count = 0;
+  epoll_fd = epoll_create1(0);
+  wakeup_fd = eventfd(0, EFD_NONBLOCK);
+
+  if (epoll_fd != -1 && wakeup_fd != -1) {
+    evnt.events = EPOLLIN;
+    evnt.data.ptr = NULL;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &evnt) == -1) {
+      supla_log(LOG_ERR, "Reactor: unable to add the wakeup descriptor");
+    }
+
+    Tsthread_params stp;
+    stp.execute = _execute;
+    stp.finish = _finish;
+    stp.user_data = this;
+    stp.free_on_finish = 0;
+    stp.initialize = NULL;
+
+    sthread = sthread_run(&stp);
+  } else {
+    supla_log(LOG_ERR, "Reactor: epoll/eventfd initialization error");
+  }
+}
+
+supla_connection_reactor::~supla_connection_reactor(void) {
+  if (sthread) {
+    sthread_terminate(sthread);
+    wakeup();
+    sthread_wait(sthread);
+    sthread_free(sthread);
+    sthread = NULL;
+  }
+
+  if (wakeup_fd != -1) {
+    ::close(wakeup_fd);
+  }
+
+  if (epoll_fd != -1) {
+    ::close(epoll_fd);
+  }
+
+  lck_free(lck);
+}
+
+// static
+void supla_connection_reactor::init(void) {
+  reactors_lck = lck_init();
+  closed_eh = eh_init();
+
+  int count = scfg_int(CFG_NET_EVENT_LOOP_THREADS);
+  if (count <= 0) {
+    return;
+  }
+
+  // Before the first connection, while only the main thread is running.
+  supla_connection_reactor_thread_pool::global_instance();
+
+  lck_lock(reactors_lck);
+  for (int a = 0; a < count; a++) {
+    reactors.push_back(new supla_connection_reactor());
+  }
+  lck_unlock(reactors_lck);
+
+  supla_log(LOG_INFO, "Connections are served by %i event loop threads",
+            count);
+}
+
+// static
+void supla_connection_reactor::reactor_free(void) {
+  lck_lock(reactors_lck);
+  for (std::vector<supla_connection_reactor *>::iterator it =
+           reactors.begin();
+       it != reactors.end(); ++it) {
+    delete *it;
+  }
+  reactors.clear();
+  lck_unlock(reactors_lck);
+
+  lck_free(reactors_lck);
+  reactors_lck = NULL;
+
+  eh_free(closed_eh);
+  closed_eh = NULL;
+}
+
+// static
+bool supla_connection_reactor::is_enabled(void) {
+  bool result = false;
+
+  lck_lock(reactors_lck);
+  result = reactors.size() > 0;
+  lck_unlock(reactors_lck);
+
+  return result;
+}
+
+// static
+void supla_connection_reactor::dispatch(serverconnection *conn) {
+  if (!conn->prologue()) {
+    delete conn;
+    return;
+  }
+
+  supla_connection_reactor *reactor = NULL;
+  unsigned int min_count = 0;
+
+  lck_lock(reactors_lck);
+  for (std::vector<supla_connection_reactor *>::iterator it =
+           reactors.begin();
+       it != reactors.end(); ++it) {
+    unsigned int count = (*it)->connection_count();
+    if (reactor == NULL || count < min_count) {
+      reactor = *it;
+      min_count = count;
+    }
+  }
+
+  if (reactor) {
+    reactor->add(conn);
+  }
+  lck_unlock(reactors_lck);
+
+  if (reactor == NULL) {
+    delete conn;
+  }
+}
+
+// static
+void supla_connection_reactor::close_connections(void *ssd) {
+  lck_lock(reactors_lck);
+  for (std::vector<supla_connection_reactor *>::iterator it =
+           reactors.begin();
+       it != reactors.end(); ++it) {
+    (*it)->terminate_connections(ssd);
+  }
+  lck_unlock(reactors_lck);
+
+  unsigned int count = 0;
+  do {
+    count = 0;
+
+    lck_lock(reactors_lck);
+    for (std::vector<supla_connection_reactor *>::iterator it =
+             reactors.begin();
+         it != reactors.end(); ++it) {
+      count += (*it)->connection_count(ssd);
+    }
+    lck_unlock(reactors_lck);
+
+    if (count) {
+      eh_wait(closed_eh, 1000000);
+    }
+  } while (count);
+}
+
+// static
+unsigned _supla_int64_t supla_connection_reactor::now_usec(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  return now.tv_sec * (unsigned _supla_int64_t)1000000 + now.tv_usec;
+}
+
+// static
+void supla_connection_reactor::_execute(void *reactor, void *sthread) {
+  database::thread_init();
+  static_cast<supla_connection_reactor *>(reactor)->execute(sthread);
+}
+
+// static
+void supla_connection_reactor::_finish(void *reactor, void *sthread) {
+  database::thread_end();
+}
+
+void supla_connection_reactor::wakeup(void) {
+  uint64_t u = 1;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+  write(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+}
+
+void supla_connection_reactor::add(serverconnection *conn) {
+  lck_lock(lck);
+  incoming.push_back(conn);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+void supla_connection_reactor::terminate_connections(void *ssd) {
+  lck_lock(lck);
+  terminate_requests.push_back(ssd);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+unsigned int supla_connection_reactor::connection_count(void *ssd) {
+  unsigned int result = 0;
+
+  lck_lock(lck);
+  for (std::list<serverconnection *>::iterator it = incoming.begin();
+       it != incoming.end(); ++it) {
+    if ((*it)->ssd == ssd) {
+      result++;
+    }
+  }
+
+  for (std::list<supla_reactor_conn *>::iterator it = connections.begin();
+       it != connections.end(); ++it) {
+    if ((*it)->conn->ssd == ssd) {
+      result++;
+    }
+  }
+  lck_unlock(lck);
+
+  return result;
+}
+
+unsigned int supla_connection_reactor::connection_count(void) {
+  unsigned int result = 0;
+
+  lck_lock(lck);
+  result = incoming.size() + connections.size();
+  lck_unlock(lck);
+
+  return result;
+}
+
+void supla_connection_reactor::accept_incoming(void) {
+  std::list<serverconnection *> conns;
+
+  lck_lock(lck);
+  conns.swap(incoming);
+  lck_unlock(lck);
+
+  for (std::list<serverconnection *>::iterator it = conns.begin();
+       it != conns.end(); ++it) {
+    supla_reactor_conn *rc = new supla_reactor_conn();
+    rc->conn = *it;
+    rc->sfd = ssocket_supla_socket_getsfd(rc->conn->supla_socket);
+    rc->efd = rc->conn->get_eh() ? rc->conn->get_eh()->fd1 : -1;
+    rc->stage = RC_STAGE_HANDSHAKE;
+    rc->scheduled = false;
+    rc->busy = false;
+    rc->iterate_result = false;
+    rc->sfd_events = 0;
+    rc->efd_events = 0;
+
+    lck_lock(lck);
+    connections.push_back(rc);
+    lck_unlock(lck);
+
+    if (rc->sfd == -1 || rc->efd == -1) {
+      supla_log(LOG_ERR, "Reactor: unable to monitor the connection %i",
+                rc->sfd);
+      close(rc);
+    } else {
+      handle(rc);
+    }
+  }
+}
+
+void supla_connection_reactor::process_terminate_requests(void) {
+  std::list<void *> requests;
+
+  lck_lock(lck);
+  requests.swap(terminate_requests);
+  lck_unlock(lck);
+
+  for (std::list<void *>::iterator rit = requests.begin();
+       rit != requests.end(); ++rit) {
+    for (std::list<supla_reactor_conn *>::iterator it = connections.begin();
+         it != connections.end(); ++it) {
+      if ((*it)->conn->ssd == *rit && (*it)->stage != RC_STAGE_CLOSING) {
+        (*it)->conn->terminate();
+        close(*it);
+      }
+    }
+  }
+}
+
+void supla_connection_reactor::schedule(supla_reactor_conn *rc,
+                                        unsigned _supla_int64_t usec) {
+  unschedule(rc);
+
+  rc->timer = timers.insert(std::pair<unsigned _supla_int64_t,
+                                      supla_reactor_conn *>(now_usec() + usec,
+                                                            rc));
+  rc->scheduled = true;
+}
+
+void supla_connection_reactor::unschedule(supla_reactor_conn *rc) {
+  if (rc->scheduled) {
+    timers.erase(rc->timer);
+    rc->scheduled = false;
+  }
+}
+
+void supla_connection_reactor::process_timers(void) {
+  unsigned _supla_int64_t now = now_usec();
+
+  while (!timers.empty() && timers.begin()->first <= now) {
+    supla_reactor_conn *rc = timers.begin()->second;
+    unschedule(rc);
+    handle(rc);
+  }
+}
+
+int supla_connection_reactor::wait_timeout_msec(void) {
+  int result = REACTOR_MAX_WAIT_MSEC;
+
+  if (!timers.empty()) {
+    unsigned _supla_int64_t now = now_usec();
+    unsigned _supla_int64_t deadline = timers.begin()->first;
+
+    if (deadline <= now) {
+      result = 0;
+    } else if ((deadline - now) / 1000 < (unsigned _supla_int64_t)result) {
+      // Round up so as not to wake up before the deadline
+      result = (deadline - now + 999) / 1000;
+    }
+  }
+
+  return result;
+}
+
+void supla_connection_reactor::watch(supla_reactor_conn *rc,
+                                     unsigned int sfd_events,
+                                     unsigned int efd_events) {
+  int fd[2] = {rc->sfd, rc->efd};
+  unsigned int *current[2] = {&rc->sfd_events, &rc->efd_events};
+  unsigned int events[2] = {sfd_events, efd_events};
+
+  for (int a = 0; a < 2; a++) {
+    if (*current[a] == events[a]) {
+      continue;
+    }
+
+    // A descriptor left in the set with no events would still report
+    // EPOLLHUP, so it is removed instead.
+    int op = EPOLL_CTL_MOD;
+    if (*current[a] == 0) {
+      op = EPOLL_CTL_ADD;
+    } else if (events[a] == 0) {
+      op = EPOLL_CTL_DEL;
+    }
+
+    struct epoll_event evnt = {};
+    evnt.events = events[a];
+    evnt.data.ptr = rc;
+
+    if (epoll_ctl(epoll_fd, op, fd[a], &evnt) == -1 && op != EPOLL_CTL_DEL) {
+      supla_log(LOG_ERR, "Reactor: unable to monitor the connection %i",
+                rc->sfd);
+      rc->conn->terminate();
+    }
+
+    *current[a] = events[a];
+  }
+}
+
+void supla_connection_reactor::handle(supla_reactor_conn *rc) {
+  if (rc->stage == RC_STAGE_CLOSING || rc->busy) {
+    return;
+  }
+
+  serverconnection *conn = rc->conn;
+
+  if (conn->is_terminated()) {
+    close(rc);
+    return;
+  }
+
+  if (rc->stage == RC_STAGE_HANDSHAKE) {
+    char result = ssocket_accept_ssl_nonblock(conn->ssd, conn->supla_socket);
+    switch (result) {
+      case 1:
+        rc->stage = RC_STAGE_RUNNING;
+        supla_log(LOG_DEBUG, "Connection Started %i, secure=%i", conn,
+                  ssocket_is_secure(conn->ssd));
+        break;
+      case -1:
+      case -2:
+        if (conn->register_wait_timeout_exceeded()) {
+          supla_log(LOG_DEBUG, "Handshake timeout", conn);
+          close(rc);
+        } else {
+          watch(rc, result == -2 ? EPOLLOUT : EPOLLIN, EPOLLIN);
+          schedule(rc, REACTOR_HANDSHAKE_CHECK_USEC);
+        }
+        return;
+      default:
+        close(rc);
+        return;
+    }
+  }
+
+  unschedule(rc);
+  watch(rc, 0, 0);
+  rc->busy = true;
+  busy_count++;
+
+  // Released by the pool after the execution
+  new supla_connection_reactor_task(
+      supla_asynctask_queue::global_instance(),
+      supla_connection_reactor_thread_pool::global_instance(), this, rc);
+}
+
+void supla_connection_reactor::iterate(supla_reactor_conn *rc) {
+  bool result = rc->conn->iterate() && !rc->conn->is_terminated();
+
+  lck_lock(lck);
+  rc->iterate_result = result;
+  iterated.push_back(rc);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+void supla_connection_reactor::process_iterated(void) {
+  std::list<supla_reactor_conn *> conns;
+
+  lck_lock(lck);
+  conns.swap(iterated);
+  lck_unlock(lck);
+
+  for (std::list<supla_reactor_conn *>::iterator it = conns.begin();
+       it != conns.end(); ++it) {
+    supla_reactor_conn *rc = *it;
+    rc->busy = false;
+    busy_count--;
+
+    if (!rc->iterate_result || rc->conn->is_terminated()) {
+      close(rc);
+      continue;
+    }
+
+    // The output the socket did not accept waits in srpc for the next
+    // iteration.
+    bool output_pending =
+        srpc_output_dataexists(rc->conn->srpc()) == SUPLA_RESULT_TRUE;
+    watch(rc, output_pending ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLLIN);
+    schedule(rc, rc->conn->wait_time_usec());
+  }
+}
+
+void supla_connection_reactor::close(supla_reactor_conn *rc) {
+  if (rc->stage == RC_STAGE_CLOSING) {
+    return;
+  }
+
+  if (rc->busy) {
+    // Closed once its iteration is over
+    rc->conn->terminate();
+    return;
+  }
+
+  unschedule(rc);
+  watch(rc, 0, 0);
+
+  rc->stage = RC_STAGE_CLOSING;
+  rc->conn->epilogue_begin();
+  closing.push_back(rc);
+}
+
+void supla_connection_reactor::process_closing(void) {
+  for (std::list<supla_reactor_conn *>::iterator it = closing.begin();
+       it != closing.end();) {
+    supla_reactor_conn *rc = *it;
+    it = closing.erase(it);
+
+    lck_lock(lck);
+    connections.remove(rc);
+    lck_unlock(lck);
+
+    // Deletes the connection or hands it over to its device/client
+    rc->conn->epilogue_end();
+    delete rc;
+
+    eh_raise_event(closed_eh);
+  }
+}
+
+void supla_connection_reactor::execute(void *sthread) {
+  struct epoll_event events[REACTOR_MAX_EVENTS];
+  uint64_t u = 0;
+
+  while (!sthread_isterminated(sthread)) {
+    int n = epoll_wait(epoll_fd, events, REACTOR_MAX_EVENTS,
+                       wait_timeout_msec());
+
+    for (int a = 0; a < n; a++) {
+      supla_reactor_conn *rc =
+          static_cast<supla_reactor_conn *>(events[a].data.ptr);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+      if (rc == NULL) {
+        read(wakeup_fd, &u, sizeof(uint64_t));
+      } else if (rc->stage != RC_STAGE_CLOSING) {
+        read(rc->efd, &u, sizeof(uint64_t));
+        handle(rc);
+      }
+#pragma GCC diagnostic pop
+    }
+
+    accept_incoming();
+    process_iterated();
+    process_terminate_requests();
+    process_timers();
+    process_closing();
+  }
+
+  accept_incoming();
+
+  for (std::list<supla_reactor_conn *>::iterator it = connections.begin();
+       it != connections.end(); ++it) {
+    (*it)->conn->terminate();
+    close(*it);
+  }
+
+  // The connections still iterated on the pool are closed when they return.
+  while (busy_count) {
+    int n = epoll_wait(epoll_fd, events, REACTOR_MAX_EVENTS,
+                       REACTOR_MAX_WAIT_MSEC);
+
+    for (int a = 0; a < n; a++) {
+      if (events[a].data.ptr == NULL) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+        read(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+      }
+    }
+
+    process_iterated();
+  }
+
+  process_closing();
+}
@@ -0,0 +1,96 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CONNECTION_REACTOR_H_
+#define CONNECTION_REACTOR_H_
+
+#include <list>
+#include <map>
+#include <vector>
+#include "eh.h"
+#include "proto.h"
+
+// The reactor serves many server connections from a single thread. Each
+// reactor owns one epoll instance that monitors the sockets and the event
+// descriptors of its connections. Connections are iterated when data arrives,
+// when the socket accepts pending output, when an event is raised or when
+// their waitTimeUSec() timeout expires. The iterations run on the threads of
+// supla_connection_reactor_thread_pool and the connection is not monitored
+// until its iteration finishes.
+
+class serverconnection;
+class supla_connection_reactor_task;
+struct supla_reactor_conn;
+class supla_connection_reactor {
+ private:
+  static void *reactors_lck;
+  static std::vector<supla_connection_reactor *> reactors;
+  static TEventHandler *closed_eh;
+
+  void *lck;
+  void *sthread;
+  int epoll_fd;
+  int wakeup_fd;
+  std::list<serverconnection *> incoming;
+  std::list<void *> terminate_requests;
+  std::list<supla_reactor_conn *> connections;
+  std::list<supla_reactor_conn *> closing;
+  std::list<supla_reactor_conn *> iterated;
+  unsigned int busy_count;
+  std::multimap<unsigned _supla_int64_t, supla_reactor_conn *> timers;
+
+  static void _execute(void *reactor, void *sthread);
+  static void _finish(void *reactor, void *sthread);
+  static unsigned _supla_int64_t now_usec(void);
+
+  void execute(void *sthread);
+  void wakeup(void);
+  void accept_incoming(void);
+  void process_terminate_requests(void);
+  void process_timers(void);
+  void process_closing(void);
+  void process_iterated(void);
+  void watch(supla_reactor_conn *rc, unsigned int sfd_events,
+             unsigned int efd_events);
+  void handle(supla_reactor_conn *rc);
+  void schedule(supla_reactor_conn *rc, unsigned _supla_int64_t usec);
+  void unschedule(supla_reactor_conn *rc);
+  void close(supla_reactor_conn *rc);
+  int wait_timeout_msec(void);
+  void add(serverconnection *conn);
+  void terminate_connections(void *ssd);
+  unsigned int connection_count(void *ssd);
+  unsigned int connection_count(void);
+
+ protected:
+  friend class supla_connection_reactor_task;
+  // Called on a pool thread.
+  void iterate(supla_reactor_conn *rc);
+
+ public:
+  supla_connection_reactor(void);
+  virtual ~supla_connection_reactor(void);
+
+  static void init(void);
+  static void reactor_free(void);
+  static bool is_enabled(void);
+  static void dispatch(serverconnection *conn);
+  static void close_connections(void *ssd);
+};
+
+#endif /* CONNECTION_REACTOR_H_ */
@@ -0,0 +1,36 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "connection_reactor_task.h"
+#include "connection_reactor.h"
+
+supla_connection_reactor_task::supla_connection_reactor_task(
+    supla_asynctask_queue *queue, supla_abstract_asynctask_thread_pool *pool,
+    supla_connection_reactor *reactor, supla_reactor_conn *rc)
+    : supla_abstract_asynctask(queue, pool) {
+  this->reactor = reactor;
+  this->rc = rc;
+  set_waiting();
+}
+
+supla_connection_reactor_task::~supla_connection_reactor_task(void) {}
+
+bool supla_connection_reactor_task::_execute(bool *execute_again) {
+  reactor->iterate(rc);
+  return true;
+}
@@ -0,0 +1,46 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CONNECTION_REACTOR_TASK_H_
+#define CONNECTION_REACTOR_TASK_H_
+
+#include "asynctask/abstract_asynctask.h"
+
+// One iteration of a reactor connection. It may block on registration or on
+// the database, so it runs on a pool thread while the reactor keeps serving
+// the other connections.
+
+class supla_connection_reactor;
+struct supla_reactor_conn;
+class supla_connection_reactor_task : public supla_abstract_asynctask {
+ private:
+  supla_connection_reactor *reactor;
+  supla_reactor_conn *rc;
+
+ protected:
+  virtual bool _execute(bool *execute_again);
+
+ public:
+  supla_connection_reactor_task(supla_asynctask_queue *queue,
+                                supla_abstract_asynctask_thread_pool *pool,
+                                supla_connection_reactor *reactor,
+                                supla_reactor_conn *rc);
+  virtual ~supla_connection_reactor_task(void);
+};
+
+#endif /*CONNECTION_REACTOR_TASK_H_*/
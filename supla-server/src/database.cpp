@@ -33,6 +33,8 @@
 #endif
 
 #include <string.h>
+#include <string>
+#include <vector>
 
 #include "database.h"
 #include "log.h"
@@ -1131,7 +1133,7 @@ bool database::update_client(int ClientID, int AccessID, const char *AuthKey,
 }
 
 void database::get_client_locations(int ClientID,
-                                    supla_client_locations *locs) {
+                                    supla_client_metadata *md) {
   MYSQL_STMT *stmt = NULL;
 
   const char sql[] =
@@ -1176,7 +1178,7 @@ void database::get_client_locations(int ClientID,
             size = SUPLA_LOCATION_CAPTION_MAXSIZE - 1;
           }
           caption[is_null[1] ? 0 : size] = 0;
-          locs->add_location(id, caption);
+          md->add_location(id, caption);
         }
       }
     }
@@ -1186,7 +1188,7 @@ void database::get_client_locations(int ClientID,
 }
 
 void database::get_client_channels(int ClientID, int *DeviceID,
-                                   supla_client_channels *channels) {
+                                   supla_client_metadata *md) {
   MYSQL_STMT *stmt = NULL;
   const char sql1[] =
       "SELECT `id`, `type`, `func`, `param1`, `param2`, `param3`, "
@@ -1348,18 +1350,14 @@ void database::get_client_channels(int ClientID, int *DeviceID,
             validity_time_sec = 0;
           }
 
-          supla_client_channel *channel = new supla_client_channel(
-              channels, id, iodevice_id, location_id, type, func, param1,
-              param2, param3, text_param1_is_null ? NULL : text_param1,
-              text_param2_is_null ? NULL : text_param2,
-              text_param3_is_null ? NULL : text_param3,
-              caption_is_null ? NULL : caption, alt_icon, user_icon,
-              manufacturer_id, product_id, protocol_version, flags, value,
-              validity_time_sec);
-
-          if (!channels->add(channel)) {
-            delete channel;
-          }
+          md->add_channel(id, iodevice_id, location_id, type, func, param1,
+                          param2, param3,
+                          text_param1_is_null ? NULL : text_param1,
+                          text_param2_is_null ? NULL : text_param2,
+                          text_param3_is_null ? NULL : text_param3,
+                          caption_is_null ? NULL : caption, alt_icon,
+                          user_icon, manufacturer_id, product_id,
+                          protocol_version, flags, value, validity_time_sec);
         }
       }
     }
@@ -1419,7 +1417,7 @@ void database::get_user_channel_groups(int UserID,
 }
 
 void database::get_client_channel_groups(int ClientID,
-                                         supla_client_channelgroups *cgroups) {
+                                         supla_client_metadata *md) {
   MYSQL_STMT *stmt = NULL;
   const char sql[] =
       "SELECT `id`, `func`, `location_id`, `caption`, `alt_icon`, "
@@ -1480,12 +1478,8 @@ void database::get_client_channel_groups(int ClientID,
           }
           caption[size] = 0;
 
-          supla_client_channelgroup *cg = new supla_client_channelgroup(
-              cgroups, id, location_id, func, is_null ? NULL : caption,
-              alt_icon, user_icon);
-          if (!cgroups->add(cg, master)) {
-            delete cg;
-          }
+          md->add_channel_group(id, location_id, func,
+                                is_null ? NULL : caption, alt_icon, user_icon);
         }
       }
     }
@@ -1495,7 +1489,7 @@ void database::get_client_channel_groups(int ClientID,
 }
 
 void database::get_client_channel_group_relations(
-    int ClientID, supla_client_channelgroups *cgroups) {
+    int ClientID, supla_client_metadata *md) {
   MYSQL_STMT *stmt = NULL;
   const char sql[] =
       "SELECT `channel_id`, `group_id`, `channel_hidden`, `iodevice_id` FROM "
@@ -1535,20 +1529,7 @@ void database::get_client_channel_group_relations(
 
       if (mysql_stmt_num_rows(stmt) > 0) {
         while (!mysql_stmt_fetch(stmt)) {
-          supla_client_channelgroup_relation *cg_rel =
-              new supla_client_channelgroup_relation(cgroups, iodevice_id,
-                                                     channel_id, group_id);
-          if (!cgroups->add(cg_rel, detail1)) {
-            delete cg_rel;
-          }
-          if (hidden > 0) {
-            supla_client_channelgroup_value *cg_value =
-                new supla_client_channelgroup_value(cgroups, channel_id,
-                                                    iodevice_id);
-            if (!cgroups->add(cg_value, detail2)) {
-              delete cg_value;
-            }
-          }
+          md->add_relation(channel_id, group_id, hidden > 0, iodevice_id);
         }
       }
     }
@@ -1557,62 +1538,138 @@ void database::get_client_channel_group_relations(
   }
 }
 
-void database::add_temperature(int ChannelID, double temperature) {
-  char buff[20];
-  memset(buff, 0, sizeof(buff));
+bool database::log_items_insert(const char *insert, const char *row,
+                                int row_count, void *pbind, int bind_size,
+                                const char *suffix) {
+  std::string sql = insert;
+  sql.reserve(sql.size() + row_count * (strlen(row) + 1));
 
-  MYSQL_BIND pbind[2];
-  memset(pbind, 0, sizeof(pbind));
+  for (int a = 0; a < row_count; a++) {
+    if (a > 0) {
+      sql.append(",");
+    }
+    sql.append(row);
+  }
 
-  snprintf(buff, sizeof(buff), "%04.4f", temperature);
+  if (suffix) {
+    sql.append(suffix);
+  }
 
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&ChannelID;
+  MYSQL_STMT *stmt = NULL;
+  bool result =
+      stmt_execute((void **)&stmt, sql.c_str(), pbind, bind_size, true);
 
-  pbind[1].buffer_type = MYSQL_TYPE_DECIMAL;
-  pbind[1].buffer = (char *)buff;
-  pbind[1].buffer_length = strnlen(buff, 20);
+  if (stmt != NULL) mysql_stmt_close(stmt);
 
-  const char sql[] = "CALL `supla_add_temperature_log_item`(?,?)";
+  if (!result && row_count > 1 && bind_size % row_count == 0) {
+    // One bad row must not cost the others, so the rows are written one by
+    // one.
+    supla_log(LOG_WARNING,
+              "MySQL - batch insert of %i rows failed, retrying row by row",
+              row_count);
 
-  MYSQL_STMT *stmt = NULL;
-  stmt_execute((void **)&stmt, sql, pbind, 2, true);
+    int cols = bind_size / row_count;
+    result = true;
 
-  if (stmt != NULL) mysql_stmt_close(stmt);
+    for (int a = 0; a < row_count; a++) {
+      if (!log_items_insert(insert, row, 1, &((MYSQL_BIND *)pbind)[a * cols],
+                            cols, suffix)) {
+        result = false;
+      }
+    }
+  }
+
+  return result;
 }
 
-void database::add_temperature_and_humidity(int ChannelID, double temperature,
-                                            double humidity) {
-  char buff1[20];
-  memset(buff1, 0, sizeof(buff1));
+void database::log_bind_delay(int *delay_sec, void *pbind) {
+  ((MYSQL_BIND *)pbind)->buffer_type = MYSQL_TYPE_LONG;
+  ((MYSQL_BIND *)pbind)->buffer = (char *)delay_sec;
+}
 
-  char buff2[20];
-  memset(buff2, 0, sizeof(buff2));
+void database::log_bind_decimal(char *buff, double value, const char *format,
+                                void *pbind) {
+  snprintf(buff, LOG_DECIMAL_BUFFER_SIZE, format, value);
+  ((MYSQL_BIND *)pbind)->buffer_type = MYSQL_TYPE_DECIMAL;
+  ((MYSQL_BIND *)pbind)->buffer = buff;
+  ((MYSQL_BIND *)pbind)->buffer_length =
+      strnlen(buff, LOG_DECIMAL_BUFFER_SIZE);
+}
 
-  MYSQL_BIND pbind[3];
-  memset(pbind, 0, sizeof(pbind));
+void database::add_temperatures(std::vector<supla_channel_temphum *> *items,
+                                int delay_sec) {
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_temperature_log`(`channel_id`, `date`, "
+      "`temperature`) VALUES ";
+  const char row[] = "(?,UTC_TIMESTAMP() - INTERVAL ? SECOND,?)";
+  const int cols = 3;
+
+  for (size_t offset = 0; offset < items->size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = items->size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
 
-  snprintf(buff1, sizeof(buff1), "%04.3f", temperature);
-  snprintf(buff2, sizeof(buff2), "%04.3f", humidity);
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
 
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&ChannelID;
+    int ChannelID[LOG_ITEMS_PER_INSERT];
+    char buff[LOG_ITEMS_PER_INSERT][LOG_DECIMAL_BUFFER_SIZE];
 
-  pbind[1].buffer_type = MYSQL_TYPE_DECIMAL;
-  pbind[1].buffer = (char *)buff1;
-  pbind[1].buffer_length = strnlen(buff1, 20);
+    for (int a = 0; a < count; a++) {
+      supla_channel_temphum *sct = items->at(offset + a);
+      MYSQL_BIND *b = &pbind[a * cols];
 
-  pbind[2].buffer_type = MYSQL_TYPE_DECIMAL;
-  pbind[2].buffer = (char *)buff2;
-  pbind[2].buffer_length = strnlen(buff2, 20);
+      ChannelID[a] = sct->getChannelId();
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&ChannelID[a];
 
-  const char sql[] = "CALL `supla_add_temphumidity_log_item`(?,?,?)";
+      log_bind_delay(&delay_sec, &b[1]);
+      log_bind_decimal(buff[a], sct->getTemperature(), "%04.4f", &b[2]);
+    }
 
-  MYSQL_STMT *stmt = NULL;
-  stmt_execute((void **)&stmt, sql, pbind, 3, true);
+    log_items_insert(insert, row, count, pbind.data(), count * cols);
+  }
+}
 
-  if (stmt != NULL) mysql_stmt_close(stmt);
+void database::add_temperatures_and_humidity(
+    std::vector<supla_channel_temphum *> *items, int delay_sec) {
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_temphumidity_log`(`channel_id`, `date`, "
+      "`temperature`, `humidity`) VALUES ";
+  const char row[] = "(?,UTC_TIMESTAMP() - INTERVAL ? SECOND,?,?)";
+  const int cols = 4;
+
+  for (size_t offset = 0; offset < items->size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = items->size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
+
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
+
+    int ChannelID[LOG_ITEMS_PER_INSERT];
+    char buff1[LOG_ITEMS_PER_INSERT][LOG_DECIMAL_BUFFER_SIZE];
+    char buff2[LOG_ITEMS_PER_INSERT][LOG_DECIMAL_BUFFER_SIZE];
+
+    for (int a = 0; a < count; a++) {
+      supla_channel_temphum *sct = items->at(offset + a);
+      MYSQL_BIND *b = &pbind[a * cols];
+
+      ChannelID[a] = sct->getChannelId();
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&ChannelID[a];
+
+      log_bind_delay(&delay_sec, &b[1]);
+      log_bind_decimal(buff1[a], sct->getTemperature(), "%04.3f", &b[2]);
+      log_bind_decimal(buff2[a], sct->getHumidity(), "%04.3f", &b[3]);
+    }
+
+    log_items_insert(insert, row, count, pbind.data(), count * cols);
+  }
 }
+
 void database::em_set_longlong(unsigned _supla_int64_t *v, void *pbind,
                                bool *not_null_flag) {
   if (*v == 0) {
@@ -1626,112 +1683,162 @@ void database::em_set_longlong(unsigned _supla_int64_t *v, void *pbind,
   }
 }
 
-void database::add_electricity_measurement(
-    supla_channel_electricity_measurement *em) {
-  MYSQL_BIND pbind[15];
-  memset(pbind, 0, sizeof(pbind));
-
-  int ChannelID = em->getChannelId();
-  TElectricityMeter_ExtendedValue_V2 em_ev;
-  em->getMeasurement(&em_ev);
+void database::add_electricity_measurements(
+    std::vector<supla_channel_electricity_measurement *> *items,
+    int delay_sec) {
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_em_log`(`channel_id`, `date`, `phase1_fae`, "
+      "`phase1_rae`, `phase1_fre`, `phase1_rre`, `phase2_fae`, `phase2_rae`, "
+      "`phase2_fre`, `phase2_rre`, `phase3_fae`, `phase3_rae`, `phase3_fre`, "
+      "`phase3_rre`, `fae_balanced`, `rae_balanced`) VALUES ";
+  const char row[] =
+      "(?,UTC_TIMESTAMP() - INTERVAL ? SECOND,?,?,?,?,?,?,?,?,?,?,?,?,?,?)";
+  const int cols = 16;
+
+  size_t offset = 0;
+
+  while (offset < items->size()) {
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
+
+    int ChannelID[LOG_ITEMS_PER_INSERT];
+    std::vector<TElectricityMeter_ExtendedValue_V2> em_ev(
+        LOG_ITEMS_PER_INSERT);
+
+    int count = 0;
+    for (; offset < items->size() && count < LOG_ITEMS_PER_INSERT; offset++) {
+      supla_channel_electricity_measurement *em = items->at(offset);
+      MYSQL_BIND *b = &pbind[count * cols];
+
+      ChannelID[count] = em->getChannelId();
+      em->getMeasurement(&em_ev[count]);
+
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&ChannelID[count];
+
+      log_bind_delay(&delay_sec, &b[1]);
+
+      int n = 0;
+      bool not_null = false;
+      for (int a = 0; a < 3; a++) {
+        em_set_longlong(&em_ev[count].total_forward_active_energy[a],
+                        &b[2 + n], &not_null);
+        em_set_longlong(&em_ev[count].total_reverse_active_energy[a],
+                        &b[3 + n], &not_null);
+        em_set_longlong(&em_ev[count].total_forward_reactive_energy[a],
+                        &b[4 + n], &not_null);
+        em_set_longlong(&em_ev[count].total_reverse_reactive_energy[a],
+                        &b[5 + n], &not_null);
+
+        n += 4;
+      }
 
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&ChannelID;
+      em_set_longlong(&em_ev[count].total_forward_active_energy_balanced,
+                      &b[14], &not_null);
+      em_set_longlong(&em_ev[count].total_reverse_active_energy_balanced,
+                      &b[15], &not_null);
 
-  int n = 0;
-  bool not_null = false;
-  for (int a = 0; a < 3; a++) {
-    em_set_longlong(&em_ev.total_forward_active_energy[a], &pbind[1 + n],
-                    &not_null);
-    em_set_longlong(&em_ev.total_reverse_active_energy[a], &pbind[2 + n],
-                    &not_null);
-    em_set_longlong(&em_ev.total_forward_reactive_energy[a], &pbind[3 + n],
-                    &not_null);
-    em_set_longlong(&em_ev.total_reverse_reactive_energy[a], &pbind[4 + n],
-                    &not_null);
+      if (not_null) {
+        count++;
+      } else {
+        memset(b, 0, sizeof(MYSQL_BIND) * cols);
+      }
+    }
 
-    n += 4;
+    if (count > 0) {
+      log_items_insert(insert, row, count, pbind.data(), count * cols);
+    }
   }
+}
 
-  em_set_longlong(&em_ev.total_forward_active_energy_balanced, &pbind[13],
-                  &not_null);
-  em_set_longlong(&em_ev.total_reverse_active_energy_balanced, &pbind[14],
-                  &not_null);
+void database::add_impulses(std::vector<supla_channel_ic_measurement *> *items,
+                            int delay_sec) {
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_ic_log`(`channel_id`, `date`, `counter`, "
+      "`calculated_value`) VALUES ";
+  const char row[] = "(?,UTC_TIMESTAMP() - INTERVAL ? SECOND,?,?)";
+  const int cols = 4;
 
-  if (!not_null) {
-    return;
-  }
+  for (size_t offset = 0; offset < items->size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = items->size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
 
-  const char sql[] =
-      "CALL `supla_add_em_log_item`(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)";
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
 
-  MYSQL_STMT *stmt = NULL;
-  stmt_execute((void **)&stmt, sql, pbind, 15, true);
+    int ChannelID[LOG_ITEMS_PER_INSERT];
+    unsigned _supla_int64_t counter[LOG_ITEMS_PER_INSERT];
+    unsigned _supla_int64_t calculatedValue[LOG_ITEMS_PER_INSERT];
 
-  if (stmt != NULL) mysql_stmt_close(stmt);
-}
+    for (int a = 0; a < count; a++) {
+      supla_channel_ic_measurement *ic = items->at(offset + a);
+      MYSQL_BIND *b = &pbind[a * cols];
 
-void database::add_impulses(supla_channel_ic_measurement *ic) {
-  MYSQL_BIND pbind[3];
-  memset(pbind, 0, sizeof(pbind));
+      ChannelID[a] = ic->getChannelId();
+      counter[a] = ic->getCounter();
+      calculatedValue[a] = ic->getCalculatedValue();
 
-  int ChannelId = ic->getChannelId();
-  unsigned _supla_int64_t counter = ic->getCounter();
-  unsigned _supla_int64_t calculatedValue = ic->getCalculatedValue();
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&ChannelID[a];
 
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&ChannelId;
-  pbind[1].buffer_type = MYSQL_TYPE_LONGLONG;
-  pbind[1].buffer = (char *)&counter;
-  pbind[2].buffer_type = MYSQL_TYPE_LONGLONG;
-  pbind[2].buffer = (char *)&calculatedValue;
-
-  const char sql[] = "CALL `supla_add_ic_log_item`(?,?,?)";
+      log_bind_delay(&delay_sec, &b[1]);
 
-  MYSQL_STMT *stmt = NULL;
-  stmt_execute((void **)&stmt, sql, pbind, 3, true);
+      b[2].buffer_type = MYSQL_TYPE_LONGLONG;
+      b[2].buffer = (char *)&counter[a];
+      b[3].buffer_type = MYSQL_TYPE_LONGLONG;
+      b[3].buffer = (char *)&calculatedValue[a];
+    }
 
-  if (stmt != NULL) mysql_stmt_close(stmt);
+    log_items_insert(insert, row, count, pbind.data(), count * cols);
+  }
 }
 
 void database::add_thermostat_measurements(
-    supla_channel_thermostat_measurement *th) {
-  char buff1[20];
-  memset(buff1, 0, sizeof(buff1));
-
-  char buff2[20];
-  memset(buff2, 0, sizeof(buff2));
-
-  MYSQL_BIND pbind[4];
-  memset(pbind, 0, sizeof(pbind));
-
-  int ChannelId = th->getChannelId();
-  snprintf(buff1, sizeof(buff1), "%05.2f", th->getMeasuredTemperature());
-  snprintf(buff2, sizeof(buff2), "%05.2f", th->getPresetTemperature());
+    std::vector<supla_channel_thermostat_measurement *> *items,
+    int delay_sec) {
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_thermostat_log`(`channel_id`, `date`, "
+      "`measured_temperature`, `preset_temperature`, `on`) VALUES ";
+  const char row[] = "(?,UTC_TIMESTAMP() - INTERVAL ? SECOND,?,?,?)";
+  const int cols = 5;
+
+  for (size_t offset = 0; offset < items->size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = items->size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
 
-  char on = th->getOn() ? 1 : 0;
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
 
-  pbind[0].buffer_type = MYSQL_TYPE_LONG;
-  pbind[0].buffer = (char *)&ChannelId;
+    int ChannelID[LOG_ITEMS_PER_INSERT];
+    char buff1[LOG_ITEMS_PER_INSERT][LOG_DECIMAL_BUFFER_SIZE];
+    char buff2[LOG_ITEMS_PER_INSERT][LOG_DECIMAL_BUFFER_SIZE];
+    char on[LOG_ITEMS_PER_INSERT];
 
-  pbind[1].buffer_type = MYSQL_TYPE_DECIMAL;
-  pbind[1].buffer = (char *)buff1;
-  pbind[1].buffer_length = strnlen(buff1, 20);
+    for (int a = 0; a < count; a++) {
+      supla_channel_thermostat_measurement *th = items->at(offset + a);
+      MYSQL_BIND *b = &pbind[a * cols];
 
-  pbind[2].buffer_type = MYSQL_TYPE_DECIMAL;
-  pbind[2].buffer = (char *)buff2;
-  pbind[2].buffer_length = strnlen(buff2, 20);
+      ChannelID[a] = th->getChannelId();
+      on[a] = th->getOn() ? 1 : 0;
 
-  pbind[3].buffer_type = MYSQL_TYPE_TINY;
-  pbind[3].buffer = (char *)&on;
-  pbind[3].buffer_length = sizeof(char);
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&ChannelID[a];
 
-  const char sql[] = "CALL `supla_add_thermostat_log_item`(?,?,?,?)";
+      log_bind_delay(&delay_sec, &b[1]);
+      log_bind_decimal(buff1[a], th->getMeasuredTemperature(), "%05.2f",
+                       &b[2]);
+      log_bind_decimal(buff2[a], th->getPresetTemperature(), "%05.2f", &b[3]);
 
-  MYSQL_STMT *stmt = NULL;
-  stmt_execute((void **)&stmt, sql, pbind, 4, true);
+      b[4].buffer_type = MYSQL_TYPE_TINY;
+      b[4].buffer = &on[a];
+      b[4].buffer_length = sizeof(char);
+    }
 
-  if (stmt != NULL) mysql_stmt_close(stmt);
+    log_items_insert(insert, row, count, pbind.data(), count * cols);
+  }
 }
 
 bool database::get_device_firmware_update_url(
@@ -2699,6 +2806,99 @@ void database::update_channel_value(int channel_id, int user_id,
   }
 }
 
+// Does the same as supla_update_channel_value for many channels at once.
+bool database::update_channel_values(
+    std::vector<supla_channel_value_write_t *> *items) {
+  std::vector<supla_channel_value_write_t *> updates;
+  std::vector<supla_channel_value_write_t *> deletes;
+  bool result = true;
+
+  for (std::vector<supla_channel_value_write_t *>::iterator it =
+           items->begin();
+       it != items->end(); ++it) {
+    if ((*it)->validity_time_sec > 0) {
+      updates.push_back(*it);
+    } else {
+      deletes.push_back(*it);
+    }
+  }
+
+  // IGNORE skips the channels deleted since the values were queued, instead
+  // of failing the values of all other channels in the batch.
+  const char insert[] =
+      "INSERT IGNORE INTO `supla_dev_channel_value` (`channel_id`, "
+      "`user_id`, `update_time`, `valid_to`, `value`) VALUES ";
+  const char row[] =
+      "(?,?,UTC_TIMESTAMP(),DATE_ADD(UTC_TIMESTAMP(), INTERVAL ? SECOND),?)";
+  const char suffix[] =
+      " ON DUPLICATE KEY UPDATE `value` = VALUES(`value`), `update_time` = "
+      "VALUES(`update_time`), `valid_to` = VALUES(`valid_to`)";
+  const int cols = 4;
+
+  for (size_t offset = 0; offset < updates.size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = updates.size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
+
+    std::vector<MYSQL_BIND> pbind(LOG_ITEMS_PER_INSERT * cols);
+
+    for (int a = 0; a < count; a++) {
+      supla_channel_value_write_t *item = updates.at(offset + a);
+      MYSQL_BIND *b = &pbind[a * cols];
+
+      b[0].buffer_type = MYSQL_TYPE_LONG;
+      b[0].buffer = (char *)&item->ChannelID;
+
+      b[1].buffer_type = MYSQL_TYPE_LONG;
+      b[1].buffer = (char *)&item->UserID;
+
+      b[2].buffer_type = MYSQL_TYPE_LONG;
+      b[2].buffer = (char *)&item->validity_time_sec;
+      b[2].is_unsigned = true;
+
+      b[3].buffer_type = MYSQL_TYPE_BLOB;
+      b[3].buffer = item->value;
+      b[3].buffer_length = SUPLA_CHANNELVALUE_SIZE;
+    }
+
+    if (!log_items_insert(insert, row, count, pbind.data(), count * cols,
+                          suffix)) {
+      result = false;
+    }
+  }
+
+  for (size_t offset = 0; offset < deletes.size();
+       offset += LOG_ITEMS_PER_INSERT) {
+    int count = deletes.size() - offset;
+    if (count > LOG_ITEMS_PER_INSERT) {
+      count = LOG_ITEMS_PER_INSERT;
+    }
+
+    std::string sql =
+        "DELETE FROM `supla_dev_channel_value` WHERE `channel_id` IN (";
+    std::vector<MYSQL_BIND> pbind(count);
+
+    for (int a = 0; a < count; a++) {
+      sql.append(a > 0 ? ",?" : "?");
+      pbind[a].buffer_type = MYSQL_TYPE_LONG;
+      pbind[a].buffer = (char *)&deletes.at(offset + a)->ChannelID;
+    }
+
+    sql.append(")");
+
+    MYSQL_STMT *stmt = NULL;
+    if (!stmt_execute((void **)&stmt, sql.c_str(), pbind.data(), count,
+                      true)) {
+      result = false;
+    }
+    if (stmt != NULL) mysql_stmt_close(stmt);
+  }
+
+  return result;
+}
+
 bool database::get_channel_value(int user_id, int channel_id,
                                  char value[SUPLA_CHANNELVALUE_SIZE],
                                  unsigned _supla_int_t *validity_time_sec) {
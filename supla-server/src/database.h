@@ -19,12 +19,19 @@
 #ifndef DATABASE_H_
 #define DATABASE_H_
 
+#include <vector>
+#include "channel_value_writer.h"
 #include "client.h"
+#include "clientmetadata.h"
 #include "device.h"
 #include "proto.h"
 #include "svrdb.h"
 #include "user.h"
 
+// Rows per multi-row INSERT of measurement logs
+#define LOG_ITEMS_PER_INSERT 100
+#define LOG_DECIMAL_BUFFER_SIZE 20
+
 class database : public svrdb {
  private:
   bool auth(const char *query, int ID, char *PWD, int PWD_MAXXSIZE, int *UserID,
@@ -39,6 +46,13 @@ class database : public svrdb {
 
   void em_set_longlong(unsigned _supla_int64_t *v, void *pbind,
                        bool *not_null_flag);
+  // Falls back to row-by-row inserts when the batch fails.
+  bool log_items_insert(const char *insert, const char *row, int row_count,
+                        void *pbind, int bind_size,
+                        const char *suffix = NULL);
+  void log_bind_delay(int *delay_sec, void *pbind);
+  void log_bind_decimal(char *buff, double value, const char *format,
+                        void *pbind);
   int get_device_client_id(int UserID, const char GUID[SUPLA_GUID_SIZE],
                            bool client);
 
@@ -120,25 +134,31 @@ class database : public svrdb {
                      const char *Name, unsigned int ipv4, const char *softver,
                      int proto_version);
 
-  void get_client_locations(int ClientID, supla_client_locations *locs);
+  void get_client_locations(int ClientID, supla_client_metadata *md);
   void get_client_channels(int ClientID, int *DeviceID,
-                           supla_client_channels *channels);
+                           supla_client_metadata *md);
 
   void get_user_channel_groups(int UserID, supla_user_channelgroups *cgroups);
 
-  void get_client_channel_groups(int ClientID,
-                                 supla_client_channelgroups *cgroups);
+  void get_client_channel_groups(int ClientID, supla_client_metadata *md);
 
   void get_client_channel_group_relations(int ClientID,
-                                          supla_client_channelgroups *cgroups);
-
-  void add_temperature(int ChannelID, double temperature);
-  void add_temperature_and_humidity(int ChannelID, double temperature,
-                                    double humidity);
-
-  void add_electricity_measurement(supla_channel_electricity_measurement *em);
-  void add_impulses(supla_channel_ic_measurement *ic);
-  void add_thermostat_measurements(supla_channel_thermostat_measurement *th);
+                                          supla_client_metadata *md);
+
+  // The log items are inserted in batches of LOG_ITEMS_PER_INSERT rows.
+  // delay_sec is the age of the measurements at the time of the call.
+  void add_temperatures(std::vector<supla_channel_temphum *> *items,
+                        int delay_sec);
+  void add_temperatures_and_humidity(
+      std::vector<supla_channel_temphum *> *items, int delay_sec);
+  void add_electricity_measurements(
+      std::vector<supla_channel_electricity_measurement *> *items,
+      int delay_sec);
+  void add_impulses(std::vector<supla_channel_ic_measurement *> *items,
+                    int delay_sec);
+  void add_thermostat_measurements(
+      std::vector<supla_channel_thermostat_measurement *> *items,
+      int delay_sec);
 
   bool get_reg_enabled(int UserID, unsigned int *client,
                        unsigned int *iodevice);
@@ -178,6 +198,7 @@ class database : public svrdb {
   void update_channel_value(int channel_id, int user_id,
                             const char value[SUPLA_CHANNELVALUE_SIZE],
                             unsigned _supla_int_t validity_time_sec);
+  bool update_channel_values(std::vector<supla_channel_value_write_t *> *items);
   bool get_channel_value(int channel_id, int user_id,
                          char value[SUPLA_CHANNELVALUE_SIZE],
                          unsigned _supla_int_t *validity_time_sec);
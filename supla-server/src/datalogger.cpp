@@ -17,116 +17,326 @@
  */
 
 #include <unistd.h>
+#include <vector>
 
 #include "datalogger.h"
+#include "lck.h"
 #include "log.h"
 #include "safearray.h"
 #include "sthread.h"
+#include "svrcfg.h"
 #include "user.h"
 
 supla_datalogger::supla_datalogger() {
-  this->temperature_tv.tv_sec = 0;
-  this->temperature_tv.tv_usec = 0;
-  this->electricitymeter_tv = this->temperature_tv;
-  this->impulsecounter_tv = this->temperature_tv;
-  this->thermostat_tv = this->temperature_tv;
+  this->shard_count = scfg_int(CFG_DATALOGGER_SHARD_COUNT);
+  if (this->shard_count < 1) {
+    this->shard_count = 1;
+  }
+
+  // Each shard slot queues up to one snapshot of every type.
+  this->writer_queue_limit = DATALOGGER_WRITER_QUEUE_LIMIT * this->shard_count;
+
+  schedule_init(&temperature, DLS_TEMPERATURE, TEMPLOG_INTERVAL);
+  schedule_init(&electricity_measurement, DLS_ELECTRICITY_MEASUREMENT,
+                ELECTRICITYMETERLOG_INTERVAL);
+  schedule_init(&ic_measurement, DLS_IC_MEASUREMENT,
+                IMPULSECOUNTERLOG_INTERVAL);
+  schedule_init(&thermostat_measurement, DLS_THERMOSTAT_MEASUREMENT,
+                THERMOSTATLOG_INTERVAL);
+
   this->db = NULL;
+  this->writer_lck = lck_init();
+  this->writer_eh = eh_init();
+  this->collector_eh = eh_init();
+  this->metric_tv.tv_sec = 0;
+  this->metric_tv.tv_usec = 0;
+  this->queue_max_metric = 0;
+  this->wait_metric = 0;
+  this->drop_metric = 0;
+  this->writer_sthread = sthread_simple_run(writer_loop, this, 0);
 }
 
-void supla_datalogger::log_temperature() {
-  supla_user *user;
-  int a;
-  int n = 0;
-  void *tarr = safe_array_init();
+supla_datalogger::~supla_datalogger() {
+  // The writer stores what is left in the queue before it finishes.
+  sthread_terminate(writer_sthread);
+  eh_raise_event(writer_eh);
+  sthread_twf(writer_sthread);
 
-  while ((user = supla_user::get_user(n)) != NULL) {
-    n++;
-    user->get_temp_and_humidity(tarr);
+  supla_datalogger_snapshot snapshot;
+  while (dequeue(&snapshot)) {
+    snapshot_free(&snapshot);
   }
 
-  for (a = 0; a < safe_array_count(tarr); a++) {
-    supla_channel_temphum *sct =
-        (supla_channel_temphum *)safe_array_get(tarr, a);
+  eh_free(collector_eh);
+  eh_free(writer_eh);
+  lck_free(writer_lck);
+}
 
-    if (sct->isTempAndHumidity() == 1) {
-      if (sct->getTemperature() > -273 || sct->getHumidity() > -1) {
-        db->add_temperature_and_humidity(
-            sct->getChannelId(), sct->getTemperature(), sct->getHumidity());
-      }
-    } else if (sct->getTemperature() > -273) {
-      db->add_temperature(sct->getChannelId(), sct->getTemperature());
-    }
+// static
+void supla_datalogger::snapshot_free(supla_datalogger_snapshot *snapshot) {
+  switch (snapshot->type) {
+    case DLS_TEMPERATURE:
+      supla_channel_temphum::free(snapshot->arr);
+      break;
+    case DLS_ELECTRICITY_MEASUREMENT:
+      supla_channel_electricity_measurement::free(snapshot->arr);
+      break;
+    case DLS_IC_MEASUREMENT:
+      supla_channel_ic_measurement::free(snapshot->arr);
+      break;
+    case DLS_THERMOSTAT_MEASUREMENT:
+      supla_channel_thermostat_measurement::free(snapshot->arr);
+      break;
   }
 
-  supla_channel_temphum::free(tarr);
+  snapshot->arr = NULL;
 }
 
-void supla_datalogger::log_electricity_measurement(void) {
-  supla_user *user;
-  int a;
-  int n = 0;
-  void *emarr = safe_array_init();
+void supla_datalogger::enqueue(datalogger_snapshot_type type, void *arr) {
+  supla_datalogger_snapshot snapshot;
+  snapshot.type = type;
+  snapshot.arr = arr;
+  snapshot.time = now;
 
-  while ((user = supla_user::get_user(n)) != NULL) {
-    n++;
-    user->get_electricity_measurements(emarr);
+  lck_lock(writer_lck);
+  if (writer_queue.size() >= writer_queue_limit) {
+    wait_metric++;
   }
 
-  for (a = 0; a < safe_array_count(emarr); a++) {
-    supla_channel_electricity_measurement *em =
-        (supla_channel_electricity_measurement *)safe_array_get(emarr, a);
-    if (em) {
-      db->add_electricity_measurement(em);
-    }
+  // The writer always makes progress. When it can't connect to the database,
+  // it drops the snapshot and counts it.
+  while (writer_queue.size() >= writer_queue_limit) {
+    lck_unlock(writer_lck);
+    eh_wait(collector_eh, 1000000);
+    lck_lock(writer_lck);
+  }
+
+  writer_queue.push_back(snapshot);
+  if (writer_queue.size() > queue_max_metric) {
+    queue_max_metric = writer_queue.size();
   }
+  lck_unlock(writer_lck);
 
-  supla_channel_electricity_measurement::free(emarr);
+  eh_raise_event(writer_eh);
 }
 
-void supla_datalogger::log_ic_measurement(void) {
-  supla_user *user;
-  int a;
-  int n = 0;
-  void *icarr = safe_array_init();
+bool supla_datalogger::dequeue(supla_datalogger_snapshot *snapshot) {
+  bool result = false;
 
-  while ((user = supla_user::get_user(n)) != NULL) {
-    n++;
-    user->get_ic_measurements(icarr);
+  lck_lock(writer_lck);
+  if (!writer_queue.empty()) {
+    *snapshot = writer_queue.front();
+    writer_queue.pop_front();
+    result = true;
+  }
+  lck_unlock(writer_lck);
+
+  if (result) {
+    eh_raise_event(collector_eh);
+  }
+
+  return result;
+}
+
+void supla_datalogger::write(supla_datalogger_snapshot *snapshot) {
+  struct timeval write_time;
+  gettimeofday(&write_time, NULL);
+
+  int delay_sec = write_time.tv_sec - snapshot->time.tv_sec;
+  if (delay_sec < 0) {
+    delay_sec = 0;
   }
 
-  for (a = 0; a < safe_array_count(icarr); a++) {
-    supla_channel_ic_measurement *ic =
-        (supla_channel_ic_measurement *)safe_array_get(icarr, a);
-    if (ic) {
-      db->add_impulses(ic);
+  int count = safe_array_count(snapshot->arr);
+
+  switch (snapshot->type) {
+    case DLS_TEMPERATURE: {
+      std::vector<supla_channel_temphum *> t;
+      std::vector<supla_channel_temphum *> th;
+
+      for (int a = 0; a < count; a++) {
+        supla_channel_temphum *sct =
+            (supla_channel_temphum *)safe_array_get(snapshot->arr, a);
+
+        if (sct->isTempAndHumidity() == 1) {
+          if (sct->getTemperature() > -273 || sct->getHumidity() > -1) {
+            th.push_back(sct);
+          }
+        } else if (sct->getTemperature() > -273) {
+          t.push_back(sct);
+        }
+      }
+
+      db->add_temperatures(&t, delay_sec);
+      db->add_temperatures_and_humidity(&th, delay_sec);
+    } break;
+    case DLS_ELECTRICITY_MEASUREMENT: {
+      std::vector<supla_channel_electricity_measurement *> items;
+      for (int a = 0; a < count; a++) {
+        supla_channel_electricity_measurement *em =
+            (supla_channel_electricity_measurement *)safe_array_get(
+                snapshot->arr, a);
+        if (em) {
+          items.push_back(em);
+        }
+      }
+
+      db->add_electricity_measurements(&items, delay_sec);
+    } break;
+    case DLS_IC_MEASUREMENT: {
+      std::vector<supla_channel_ic_measurement *> items;
+      for (int a = 0; a < count; a++) {
+        supla_channel_ic_measurement *ic =
+            (supla_channel_ic_measurement *)safe_array_get(snapshot->arr, a);
+        if (ic) {
+          items.push_back(ic);
+        }
+      }
+
+      db->add_impulses(&items, delay_sec);
+    } break;
+    case DLS_THERMOSTAT_MEASUREMENT: {
+      std::vector<supla_channel_thermostat_measurement *> items;
+      for (int a = 0; a < count; a++) {
+        supla_channel_thermostat_measurement *th =
+            (supla_channel_thermostat_measurement *)safe_array_get(
+                snapshot->arr, a);
+        if (th) {
+          items.push_back(th);
+        }
+      }
+
+      db->add_thermostat_measurements(&items, delay_sec);
+    } break;
+  }
+}
+
+// static
+void supla_datalogger::writer_loop(void *logger, void *sthread) {
+  supla_datalogger *dl = static_cast<supla_datalogger *>(logger);
+  supla_datalogger_snapshot snapshot;
+
+  database::thread_init();
+
+  while (true) {
+    bool terminated = sthread_isterminated(sthread);
+
+    if (dl->dequeue(&snapshot)) {
+      if (dl->dbinit()) {
+        dl->write(&snapshot);
+      } else {
+        lck_lock(dl->writer_lck);
+        dl->drop_metric++;
+        lck_unlock(dl->writer_lck);
+      }
+      snapshot_free(&snapshot);
+      continue;
+    }
+
+    if (dl->db != NULL) {
+      delete dl->db;
+      dl->db = NULL;
     }
+
+    if (terminated) {
+      break;
+    }
+
+    eh_wait(dl->writer_eh, 1000000);
+  }
+
+  database::thread_end();
+}
+
+void supla_datalogger::schedule_init(supla_datalogger_schedule *schedule,
+                                     datalogger_snapshot_type type,
+                                     int interval) {
+  schedule->type = type;
+  schedule->interval = interval;
+  schedule->tv.tv_sec = 0;
+  schedule->tv.tv_usec = 0;
+  schedule->slot = -1;
+}
+
+// static
+bool supla_datalogger::in_shard(int id, int shard, int shard_count) {
+  if (shard_count <= 1) {
+    return true;
   }
 
-  supla_channel_ic_measurement::free(icarr);
+  return safe_array_key_hash(&id, sizeof(id)) % shard_count ==
+         (unsigned long long)shard;
 }
 
-void supla_datalogger::log_thermostat_measurement(void) {
+void supla_datalogger::collect(datalogger_snapshot_type type, void *arr,
+                               int shard, int shard_count) {
   supla_user *user;
-  int a;
   int n = 0;
-  void *tharr = safe_array_init();
 
   while ((user = supla_user::get_user(n)) != NULL) {
     n++;
-    user->get_thermostat_measurements(tharr);
+    switch (type) {
+      case DLS_TEMPERATURE:
+        user->get_temp_and_humidity(arr, shard, shard_count);
+        break;
+      case DLS_ELECTRICITY_MEASUREMENT:
+        user->get_electricity_measurements(arr, shard, shard_count);
+        break;
+      case DLS_IC_MEASUREMENT:
+        user->get_ic_measurements(arr, shard, shard_count);
+        break;
+      case DLS_THERMOSTAT_MEASUREMENT:
+        user->get_thermostat_measurements(arr, shard, shard_count);
+        break;
+    }
   }
+}
 
-  for (a = 0; a < safe_array_count(tharr); a++) {
-    supla_channel_thermostat_measurement *th =
-        (supla_channel_thermostat_measurement *)safe_array_get(tharr, a);
-    if (th) {
-      db->add_thermostat_measurements(th);
+void supla_datalogger::log(supla_datalogger_schedule *schedule) {
+  if (shard_count == 1) {
+    if (now.tv_sec - schedule->tv.tv_sec >= schedule->interval) {
+      schedule->tv = now;
+      void *arr = safe_array_init();
+      collect(schedule->type, arr, 0, 1);
+      enqueue(schedule->type, arr);
     }
+    return;
+  }
+
+  _supla_int64_t slot =
+      (_supla_int64_t)now.tv_sec * shard_count / schedule->interval;
+
+  if (slot <= schedule->slot) {
+    return;
   }
 
-  supla_channel_thermostat_measurement::free(tharr);
+  // Slots missed because of a delay are caught up, but none of them is
+  // collected twice within one interval.
+  _supla_int64_t first = slot - shard_count + 1;
+  if (schedule->slot >= first) {
+    first = schedule->slot + 1;
+  } else if (schedule->slot == -1) {
+    first = slot;
+  }
+
+  schedule->slot = slot;
+
+  supla_datalogger_snapshot snapshot;
+  snapshot.type = schedule->type;
+  snapshot.arr = safe_array_init();
+
+  for (_supla_int64_t a = first; a <= slot; a++) {
+    collect(schedule->type, snapshot.arr, a % shard_count, shard_count);
+  }
+
+  if (safe_array_count(snapshot.arr)) {
+    enqueue(snapshot.type, snapshot.arr);
+  } else {
+    snapshot_free(&snapshot);
+  }
 }
 
+// Called by the writer thread only.
 bool supla_datalogger::dbinit(void) {
   if (db == NULL) {
     db = new database();
@@ -143,34 +353,35 @@ bool supla_datalogger::dbinit(void) {
 void supla_datalogger::log(void) {
   gettimeofday(&now, NULL);
 
-  if (now.tv_sec - temperature_tv.tv_sec >= TEMPLOG_INTERVAL) {
-    temperature_tv = now;
-
-    if (dbinit()) log_temperature();
-  }
+  log(&temperature);
+  log(&electricity_measurement);
+  log(&ic_measurement);
+  log(&thermostat_measurement);
+}
 
-  if (now.tv_sec - electricitymeter_tv.tv_sec >= ELECTRICITYMETERLOG_INTERVAL) {
-    electricitymeter_tv = now;
+void supla_datalogger::log_metrics(int min_interval_sec) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
 
-    if (dbinit()) log_electricity_measurement();
+  if (metric_tv.tv_sec == 0) {
+    metric_tv = now;
   }
 
-  if (now.tv_sec - impulsecounter_tv.tv_sec >= IMPULSECOUNTERLOG_INTERVAL) {
-    impulsecounter_tv = now;
-
-    if (dbinit()) log_ic_measurement();
+  if (now.tv_sec - metric_tv.tv_sec < min_interval_sec) {
+    return;
   }
 
-  if (now.tv_sec - thermostat_tv.tv_sec >= THERMOSTATLOG_INTERVAL) {
-    thermostat_tv = now;
+  metric_tv = now;
 
-    if (dbinit()) log_thermostat_measurement();
-  }
+  lck_lock(writer_lck);
+  unsigned int queue_size = writer_queue.size();
+  unsigned int queue_max = queue_max_metric;
+  unsigned int wait = wait_metric;
+  unsigned int drop = drop_metric;
+  lck_unlock(writer_lck);
 
-  if (db != NULL) {
-    delete db;
-    db = NULL;
-  }
+  supla_log(LOG_INFO, "METRICS: DATALOGGER[QUEUE:%u MAX:%u WAIT:%u DROP:%u]",
+            queue_size, queue_max, wait, drop);
 }
 
 void datalogger_loop(void *ssd, void *dl_sthread) {
@@ -179,6 +390,7 @@ void datalogger_loop(void *ssd, void *dl_sthread) {
 
   while (sthread_isterminated(dl_sthread) == 0) {
     logger->log();
+    logger->log_metrics(3600);
     usleep(1000000);
   }
 
@@ -19,31 +19,88 @@
 #ifndef DATALOGGER_H_
 #define DATALOGGER_H_
 
+#include <list>
 #include "database.h"
+#include "eh.h"
 
 #define TEMPLOG_INTERVAL 600
 #define ELECTRICITYMETERLOG_INTERVAL 600
 #define IMPULSECOUNTERLOG_INTERVAL 600
 #define THERMOSTATLOG_INTERVAL 600
 
+// Snapshots waiting for the writer, per shard. When the database is slower
+// than the snapshots are taken, the collector waits for the writer to catch
+// up.
+#define DATALOGGER_WRITER_QUEUE_LIMIT 8
+
+enum datalogger_snapshot_type {
+  DLS_TEMPERATURE,
+  DLS_ELECTRICITY_MEASUREMENT,
+  DLS_IC_MEASUREMENT,
+  DLS_THERMOSTAT_MEASUREMENT
+};
+
+typedef struct {
+  datalogger_snapshot_type type;
+  void *arr;
+  struct timeval time;
+} supla_datalogger_snapshot;
+
+// With more than one shard, each interval is divided into shard_count slots
+// aligned to the wall clock. A channel is always logged in the same slot,
+// chosen by the hash of its ID, so the load is spread over the interval
+// while consecutive measurements of a channel remain exactly one interval
+// apart.
+typedef struct {
+  datalogger_snapshot_type type;
+  int interval;
+  struct timeval tv;
+  _supla_int64_t slot;
+} supla_datalogger_schedule;
+
 class supla_datalogger {
  private:
   database *db;
   struct timeval now;
-  struct timeval temperature_tv;
-  struct timeval electricitymeter_tv;
-  struct timeval impulsecounter_tv;
-  struct timeval thermostat_tv;
-
-  void log_temperature();
-  void log_electricity_measurement(void);
-  void log_ic_measurement(void);
-  void log_thermostat_measurement(void);
+  int shard_count;
+  supla_datalogger_schedule temperature;
+  supla_datalogger_schedule electricity_measurement;
+  supla_datalogger_schedule ic_measurement;
+  supla_datalogger_schedule thermostat_measurement;
+
+  void *writer_lck;
+  void *writer_sthread;
+  // Raised when a snapshot is queued and when one is taken by the writer.
+  TEventHandler *writer_eh;
+  TEventHandler *collector_eh;
+  std::list<supla_datalogger_snapshot> writer_queue;
+  unsigned int writer_queue_limit;
+
+  struct timeval metric_tv;
+  unsigned int queue_max_metric;
+  unsigned int wait_metric;
+  unsigned int drop_metric;
+
+  void schedule_init(supla_datalogger_schedule *schedule,
+                     datalogger_snapshot_type type, int interval);
+  void collect(datalogger_snapshot_type type, void *arr, int shard,
+               int shard_count);
+  void log(supla_datalogger_schedule *schedule);
   bool dbinit(void);
 
+  static void writer_loop(void *logger, void *sthread);
+  static void snapshot_free(supla_datalogger_snapshot *snapshot);
+  void enqueue(datalogger_snapshot_type type, void *arr);
+  bool dequeue(supla_datalogger_snapshot *snapshot);
+  void write(supla_datalogger_snapshot *snapshot);
+
  public:
   supla_datalogger();
+  virtual ~supla_datalogger();
   void log(void);
+  void log_metrics(int min_interval_sec);
+
+  static bool in_shard(int id, int shard, int shard_count);
 };
 
 void datalogger_loop(void *ssd, void *dl_sthread);
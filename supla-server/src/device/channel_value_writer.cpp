@@ -0,0 +1,263 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "channel_value_writer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "database.h"
+#include "safearray.h"
+#include "sthread.h"
+#include "svrcfg.h"
+
+supla_channel_value_writer *supla_channel_value_writer::_global_instance =
+    NULL;
+
+// static
+supla_channel_value_writer *supla_channel_value_writer::global_instance(void) {
+  if (_global_instance == NULL) {
+    _global_instance = new supla_channel_value_writer(
+        scfg_int(CFG_MYSQL_CHANNEL_VALUE_FLUSH_INTERVAL));
+  }
+
+  return _global_instance;
+}
+
+// static
+void supla_channel_value_writer::global_instance_release(void) {
+  if (_global_instance) {
+    delete _global_instance;
+    _global_instance = NULL;
+  }
+}
+
+supla_channel_value_writer::supla_channel_value_writer(int flush_interval_ms) {
+  this->flush_interval_ms = flush_interval_ms > 0 ? flush_interval_ms : 0;
+  this->arr = safe_array_init();
+  safe_array_add_index(arr, arr_key);
+  this->sthread = NULL;
+
+  if (this->flush_interval_ms > 0) {
+    this->sthread = sthread_simple_run(loop, this, 0);
+  }
+}
+
+supla_channel_value_writer::~supla_channel_value_writer(void) {
+  stop();
+  flush();
+  // Whatever could not be written by the last flush is lost.
+  safe_array_clean(arr, arr_delcnd);
+  safe_array_free(arr);
+}
+
+// static
+unsigned long long supla_channel_value_writer::arr_key(void *ptr) {
+  return static_cast<supla_channel_value_write_t *>(ptr)->ChannelID;
+}
+
+// static
+char supla_channel_value_writer::arr_delcnd(void *ptr) {
+  free(ptr);
+  return 1;
+}
+
+// static
+char supla_channel_value_writer::arr_findcmp(void *ptr, void *ChannelID) {
+  return static_cast<supla_channel_value_write_t *>(ptr)->ChannelID ==
+                 *static_cast<int *>(ChannelID)
+             ? 1
+             : 0;
+}
+
+// static
+void supla_channel_value_writer::loop(void *writer, void *sthread) {
+  supla_channel_value_writer *w =
+      static_cast<supla_channel_value_writer *>(writer);
+
+  database::thread_init();
+
+  struct timeval last_flush;
+  gettimeofday(&last_flush, NULL);
+
+  while (sthread_isterminated(sthread) == 0) {
+    usleep(w->flush_interval_ms < 100 ? w->flush_interval_ms * 1000 : 100000);
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    if ((now.tv_sec - last_flush.tv_sec) * 1000 +
+            (now.tv_usec - last_flush.tv_usec) / 1000 >=
+        w->flush_interval_ms) {
+      last_flush = now;
+      w->flush();
+    }
+  }
+
+  database::thread_end();
+}
+
+void supla_channel_value_writer::update(
+    int ChannelID, int UserID, const char value[SUPLA_CHANNELVALUE_SIZE],
+    unsigned _supla_int_t validity_time_sec) {
+  if (flush_interval_ms == 0) {
+    database *db = new database();
+
+    if (db->connect() == true) {
+      db->update_channel_value(ChannelID, UserID, value, validity_time_sec);
+    }
+
+    delete db;
+    return;
+  }
+
+  safe_array_lock(arr);
+
+  supla_channel_value_write_t *item =
+      static_cast<supla_channel_value_write_t *>(
+          safe_array_findkey(arr, 0, ChannelID, arr_findcmp, &ChannelID));
+
+  if (item == NULL) {
+    item = (supla_channel_value_write_t *)malloc(
+        sizeof(supla_channel_value_write_t));
+    item->ChannelID = ChannelID;
+    safe_array_add(arr, item);
+  }
+
+  item->UserID = UserID;
+  memcpy(item->value, value, SUPLA_CHANNELVALUE_SIZE);
+  item->validity_time_sec = validity_time_sec;
+  gettimeofday(&item->time, NULL);
+
+  safe_array_unlock(arr);
+}
+
+void supla_channel_value_writer::take(
+    std::vector<supla_channel_value_write_t *> *items) {
+  safe_array_lock(arr);
+
+  int count = safe_array_count(arr);
+  items->reserve(items->size() + count);
+
+  for (int a = 0; a < count; a++) {
+    items->push_back(
+        static_cast<supla_channel_value_write_t *>(safe_array_get(arr, a)));
+  }
+
+  // Deleting from the end does not move the remaining items.
+  for (int a = count - 1; a >= 0; a--) {
+    safe_array_delete(arr, a);
+  }
+
+  safe_array_unlock(arr);
+}
+
+void supla_channel_value_writer::give_back(
+    std::vector<supla_channel_value_write_t *> *items) {
+  safe_array_lock(arr);
+
+  for (std::vector<supla_channel_value_write_t *>::iterator it =
+           items->begin();
+       it != items->end(); ++it) {
+    supla_channel_value_write_t *item = *it;
+    // A value set in the meantime is newer than the one that was not written.
+    if (safe_array_findkey(arr, 0, item->ChannelID, arr_findcmp,
+                           &item->ChannelID) != NULL ||
+        safe_array_add(arr, item) == -1) {
+      free(item);
+    }
+  }
+
+  safe_array_unlock(arr);
+}
+
+bool supla_channel_value_writer::write(
+    std::vector<supla_channel_value_write_t *> *items) {
+  bool result = false;
+  database *db = new database();
+
+  if (db->connect() == true) {
+    result = db->update_channel_values(items);
+  }
+
+  delete db;
+  return result;
+}
+
+void supla_channel_value_writer::stop(void) {
+  if (sthread) {
+    sthread_twf(sthread);
+    sthread = NULL;
+  }
+}
+
+void supla_channel_value_writer::flush(void) {
+  std::vector<supla_channel_value_write_t *> items;
+  take(&items);
+
+  if (items.empty()) {
+    return;
+  }
+
+  // The validity is counted from the moment the value was set, not from the
+  // moment it is stored.
+  std::vector<supla_channel_value_write_t *> valid;
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  for (std::vector<supla_channel_value_write_t *>::iterator it =
+           items.begin();
+       it != items.end(); ++it) {
+    supla_channel_value_write_t *item = *it;
+    if (item->validity_time_sec > 0) {
+      long elapsed_sec = now.tv_sec - item->time.tv_sec;
+      if (elapsed_sec < 0) {
+        elapsed_sec = 0;
+      }
+
+      if ((unsigned long)elapsed_sec >= item->validity_time_sec) {
+        free(item);
+        continue;
+      }
+
+      // The rest of the validity is counted from now, also when the value
+      // has to wait for the next flush.
+      item->validity_time_sec -= elapsed_sec;
+      item->time.tv_sec += elapsed_sec;
+    }
+    valid.push_back(item);
+  }
+
+  if (valid.empty()) {
+    return;
+  }
+
+  if (!write(&valid)) {
+    give_back(&valid);
+    return;
+  }
+
+  for (std::vector<supla_channel_value_write_t *>::iterator it =
+           valid.begin();
+       it != valid.end(); ++it) {
+    free(*it);
+  }
+}
+
+int supla_channel_value_writer::pending_count(void) {
+  return safe_array_count(arr);
+}
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CHANNEL_VALUE_WRITER_H_
+#define CHANNEL_VALUE_WRITER_H_
+
+#include <sys/time.h>
+#include <vector>
+#include "proto.h"
+
+typedef struct {
+  int ChannelID;
+  int UserID;
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  unsigned _supla_int_t validity_time_sec;
+  struct timeval time;
+} supla_channel_value_write_t;
+
+// Persists channel values in the background. Only the latest value of each
+// channel waits for the write, the values it replaced are never stored.
+// Pending values are written every flush_interval_ms and when the writer is
+// released. Values that failed to be written wait for the next flush.
+// With flush_interval_ms == 0 values are written immediately.
+class supla_channel_value_writer {
+ private:
+  static supla_channel_value_writer *_global_instance;
+
+  void *arr;
+  void *sthread;
+  int flush_interval_ms;
+
+  static unsigned long long arr_key(void *ptr);
+  static char arr_findcmp(void *ptr, void *ChannelID);
+  static char arr_delcnd(void *ptr);
+  static void loop(void *writer, void *sthread);
+
+ protected:
+  void take(std::vector<supla_channel_value_write_t *> *items);
+  // Returns the items that could not be written to the queue. Takes the
+  // ownership of them.
+  void give_back(std::vector<supla_channel_value_write_t *> *items);
+  // Returns false when the values have to be written again.
+  virtual bool write(std::vector<supla_channel_value_write_t *> *items);
+
+ public:
+  static supla_channel_value_writer *global_instance(void);
+  static void global_instance_release(void);
+
+  explicit supla_channel_value_writer(int flush_interval_ms);
+  virtual ~supla_channel_value_writer(void);
+
+  void update(int ChannelID, int UserID,
+              const char value[SUPLA_CHANNELVALUE_SIZE],
+              unsigned _supla_int_t validity_time_sec);
+  void flush(void);
+  // Stops the flushing thread. Subclasses that override write() have to call
+  // it first in their destructors.
+  void stop(void);
+  int pending_count(void);
+};
+
+#endif /* CHANNEL_VALUE_WRITER_H_ */
@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include "database.h"
 #include "device.h"
+#include "device_registration_cache.h"
 #include "http/httprequestqueue.h"
 #include "lck.h"
 #include "log.h"
@@ -167,11 +168,26 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
           snprintf(Name, SUPLA_DEVICE_NAME_MAXSIZE, "unknown");
         }
 
+        supla_device_registration_cache *reg_cache =
+            supla_device_registration_cache::global_instance();
+        supla_device_registration_data_t reg;
+        bool reg_cached = reg_cache->get(UserID, GUID, &reg);
+
         db->start_transaction();
 
-        int DeviceID = db->get_device(db->get_device_id(UserID, GUID),
-                                      &DeviceEnabled, &_OriginalLocationID,
-                                      &_LocationID, &LocationEnabled);
+        int DeviceID = 0;
+
+        if (reg_cached) {
+          DeviceID = reg.DeviceID;
+          DeviceEnabled = reg.DeviceEnabled;
+          _OriginalLocationID = reg.OriginalLocationID;
+          _LocationID = reg.LocationID;
+          LocationEnabled = reg.LocationEnabled;
+        } else {
+          DeviceID = db->get_device(db->get_device_id(UserID, GUID),
+                                    &DeviceEnabled, &_OriginalLocationID,
+                                    &_LocationID, &LocationEnabled);
+        }
 
         if (LocationID == 0) LocationID = _LocationID;
 
@@ -234,6 +250,7 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
         if (DeviceID != 0) {
           int ChannelCount = 0;
           int ChannelType = 0;
+          std::vector<supla_device_registration_channel_t> reg_channels;
 
           for (int a = 0; a < SUPLA_CHANNELMAXCOUNT; a++)
             if (a >= channel_count) {
@@ -264,7 +281,12 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
                 break;
               }
 
-              if (db->get_device_channel(DeviceID, Number, &ChannelType) == 0) {
+              if (reg_cached) {
+                ChannelType =
+                    supla_device_registration_cache::get_channel_type(&reg,
+                                                                      Number);
+              } else if (db->get_device_channel(DeviceID, Number,
+                                                &ChannelType) == 0) {
                 ChannelType = 0;
               }
 #ifndef SERVER_VERSION_23
@@ -299,10 +321,17 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
                 ChannelCount = -1;
                 break;
               }
+
+              supla_device_registration_channel_t reg_channel;
+              reg_channel.Number = Number;
+              reg_channel.Type = Type;
+              reg_channels.push_back(reg_channel);
             }
 
           if (ChannelCount == -1 ||
-              db->get_device_channel_count(DeviceID) != ChannelCount) {
+              (reg_cached && !channels_added
+                   ? (int)reg.channels.size()
+                   : db->get_device_channel_count(DeviceID)) != ChannelCount) {
             db->rollback();
             resultcode = SUPLA_RESULTCODE_CHANNEL_CONFLICT;
 
@@ -324,6 +353,18 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
             if (DeviceID != 0) {
               db->commit();
 
+              if (!new_device) {
+                reg.UserID = UserID;
+                memcpy(reg.GUID, GUID, SUPLA_GUID_SIZE);
+                reg.DeviceID = DeviceID;
+                reg.DeviceEnabled = true;
+                reg.OriginalLocationID = _OriginalLocationID;
+                reg.LocationID = _LocationID;
+                reg.LocationEnabled = true;
+                reg.channels = reg_channels;
+                reg_cache->set(&reg);
+              }
+
               setID(DeviceID);
 
               load_config(UserID);
@@ -348,6 +389,11 @@ char supla_device::register_device(TDS_SuplaRegisterDevice_C *register_device_c,
             }
           }
         }
+
+        if (reg_cached && resultcode != SUPLA_RESULTCODE_TRUE) {
+          // Let the next attempt check the database.
+          reg_cache->device_invalidate(UserID, reg.DeviceID);
+        }
       }
     }
 
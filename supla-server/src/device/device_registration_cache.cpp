@@ -0,0 +1,199 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "device_registration_cache.h"
+#include <string.h>
+#include "lck.h"
+#include "svrcfg.h"
+
+supla_device_registration_cache
+    *supla_device_registration_cache::_global_instance = NULL;
+
+// static
+supla_device_registration_cache *
+supla_device_registration_cache::global_instance(void) {
+  if (_global_instance == NULL) {
+    _global_instance = new supla_device_registration_cache(
+        scfg_int(CFG_LIMIT_REGISTRATION_CACHE_SIZE),
+        scfg_int(CFG_LIMIT_REGISTRATION_CACHE_TTL));
+  }
+
+  return _global_instance;
+}
+
+// static
+void supla_device_registration_cache::global_instance_release(void) {
+  if (_global_instance) {
+    delete _global_instance;
+    _global_instance = NULL;
+  }
+}
+
+supla_device_registration_cache::supla_device_registration_cache(
+    int size_limit, int ttl_sec) {
+  this->size_limit = size_limit;
+  this->ttl_sec = ttl_sec;
+  lck = lck_init();
+}
+
+supla_device_registration_cache::~supla_device_registration_cache(void) {
+  lck_free(lck);
+}
+
+bool supla_device_registration_cache::is_expired(
+    supla_device_registration_data_t *data, struct timeval *now) {
+  return ttl_sec > 0 && now->tv_sec - data->time.tv_sec >= ttl_sec;
+}
+
+// Called with the cache locked.
+void supla_device_registration_cache::remove(int UserID,
+                                             const std::string &GUID) {
+  std::map<int, std::map<std::string, supla_device_registration_entry_t> >::
+      iterator user = users.find(UserID);
+  if (user == users.end()) {
+    return;
+  }
+
+  std::map<std::string, supla_device_registration_entry_t>::iterator entry =
+      user->second.find(GUID);
+  if (entry != user->second.end()) {
+    order.erase(entry->second.order_pos);
+    user->second.erase(entry);
+  }
+
+  if (user->second.empty()) {
+    users.erase(user);
+  }
+}
+
+bool supla_device_registration_cache::get(
+    int UserID, const char GUID[SUPLA_GUID_SIZE],
+    supla_device_registration_data_t *data) {
+  if (size_limit <= 0 || UserID == 0 || GUID == NULL) {
+    return false;
+  }
+
+  bool result = false;
+  std::string guid(GUID, SUPLA_GUID_SIZE);
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  lck_lock(lck);
+
+  std::map<int, std::map<std::string, supla_device_registration_entry_t> >::
+      iterator user = users.find(UserID);
+
+  if (user != users.end()) {
+    std::map<std::string, supla_device_registration_entry_t>::iterator entry =
+        user->second.find(guid);
+
+    if (entry != user->second.end()) {
+      if (is_expired(&entry->second.data, &now)) {
+        remove(UserID, guid);
+      } else {
+        *data = entry->second.data;
+        result = true;
+      }
+    }
+  }
+
+  lck_unlock(lck);
+
+  return result;
+}
+
+void supla_device_registration_cache::set(
+    const supla_device_registration_data_t *data) {
+  if (size_limit <= 0 || data == NULL || data->UserID == 0 ||
+      data->DeviceID == 0) {
+    return;
+  }
+
+  std::string guid(data->GUID, SUPLA_GUID_SIZE);
+
+  lck_lock(lck);
+
+  // A refreshed entry becomes the most recent one.
+  remove(data->UserID, guid);
+
+  while (!order.empty() && order.size() >= (size_t)size_limit) {
+    remove(order.front().first, order.front().second);
+  }
+
+  supla_device_registration_entry_t *entry = &users[data->UserID][guid];
+  entry->data = *data;
+  gettimeofday(&entry->data.time, NULL);
+  entry->order_pos =
+      order.insert(order.end(), std::make_pair(data->UserID, guid));
+
+  lck_unlock(lck);
+}
+
+void supla_device_registration_cache::user_invalidate(int UserID) {
+  device_invalidate(UserID, 0);
+}
+
+void supla_device_registration_cache::device_invalidate(int UserID,
+                                                        int DeviceID) {
+  lck_lock(lck);
+
+  std::map<int, std::map<std::string, supla_device_registration_entry_t> >::
+      iterator user = users.find(UserID);
+
+  if (user != users.end()) {
+    std::map<std::string, supla_device_registration_entry_t>::iterator it =
+        user->second.begin();
+
+    while (it != user->second.end()) {
+      if (DeviceID == 0 || it->second.data.DeviceID == DeviceID) {
+        order.erase(it->second.order_pos);
+        user->second.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+
+    if (user->second.empty()) {
+      users.erase(user);
+    }
+  }
+
+  lck_unlock(lck);
+}
+
+int supla_device_registration_cache::count(void) {
+  lck_lock(lck);
+  int result = order.size();
+  lck_unlock(lck);
+  return result;
+}
+
+// static
+int supla_device_registration_cache::get_channel_type(
+    const supla_device_registration_data_t *data, unsigned char Number) {
+  for (std::vector<supla_device_registration_channel_t>::const_iterator it =
+           data->channels.begin();
+       it != data->channels.end(); ++it) {
+    if (it->Number == Number) {
+      return it->Type;
+    }
+  }
+
+  return 0;
+}
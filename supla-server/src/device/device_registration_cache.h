@@ -0,0 +1,95 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef DEVICE_REGISTRATION_CACHE_H_
+#define DEVICE_REGISTRATION_CACHE_H_
+
+#include <sys/time.h>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "proto.h"
+
+typedef struct {
+  unsigned char Number;
+  int Type;
+} supla_device_registration_channel_t;
+
+// What the database said about a known device the last time it registered.
+// The data is valid as long as the device, its location and its channels
+// have not been changed outside of the registration.
+typedef struct {
+  int UserID;
+  char GUID[SUPLA_GUID_SIZE];
+  int DeviceID;
+  bool DeviceEnabled;
+  int OriginalLocationID;
+  int LocationID;
+  bool LocationEnabled;
+  std::vector<supla_device_registration_channel_t> channels;
+  struct timeval time;
+} supla_device_registration_data_t;
+
+// UserID and GUID of an entry, in the order the entries were set.
+typedef std::list<std::pair<int, std::string> >
+    supla_device_registration_order_t;
+
+typedef struct {
+  supla_device_registration_data_t data;
+  supla_device_registration_order_t::iterator order_pos;
+} supla_device_registration_entry_t;
+
+class supla_device_registration_cache {
+ private:
+  static supla_device_registration_cache *_global_instance;
+
+  void *lck;
+  // Entries grouped by UserID, so the entries of a user are invalidated
+  // without visiting the entries of the others.
+  std::map<int, std::map<std::string, supla_device_registration_entry_t> >
+      users;
+  // The least recently set entry first. It is evicted at the size limit.
+  supla_device_registration_order_t order;
+  int size_limit;
+  int ttl_sec;
+
+  bool is_expired(supla_device_registration_data_t *data,
+                  struct timeval *now);
+  void remove(int UserID, const std::string &GUID);
+
+ public:
+  static supla_device_registration_cache *global_instance(void);
+  static void global_instance_release(void);
+
+  supla_device_registration_cache(int size_limit, int ttl_sec);
+  virtual ~supla_device_registration_cache(void);
+
+  bool get(int UserID, const char GUID[SUPLA_GUID_SIZE],
+           supla_device_registration_data_t *data);
+  void set(const supla_device_registration_data_t *data);
+  void user_invalidate(int UserID);
+  void device_invalidate(int UserID, int DeviceID);
+  int count(void);
+
+  static int get_channel_type(const supla_device_registration_data_t *data,
+                              unsigned char Number);
+};
+
+#endif /* DEVICE_REGISTRATION_CACHE_H_ */
@@ -22,7 +22,9 @@
 #include <string.h>
 
 #include "action_gate_openclose.h"
+#include "channel_value_writer.h"
 #include "database.h"
+#include "datalogger.h"
 #include "devicechannel.h"
 #include "log.h"
 #include "safearray.h"
@@ -782,13 +784,8 @@ bool supla_device_channel::setValue(
     gettimeofday(&value_valid_to, NULL);
     value_valid_to.tv_sec += (*validity_time_sec);
 
-    database *db = new database();
-
-    if (db->connect() == true) {
-      db->update_channel_value(getId(), UserID, value, *validity_time_sec);
-    }
-
-    delete db;
+    supla_channel_value_writer::global_instance()->update(
+        getId(), UserID, value, *validity_time_sec);
   }
 
   bool differ = memcmp(this->value, old_value, SUPLA_CHANNELVALUE_SIZE) != 0;
@@ -1150,6 +1147,8 @@ bool supla_device_channel::converValueToExtended(void) {
 supla_device_channels::supla_device_channels(supla_device *device) {
   this->device = device;
   this->arr = safe_array_init();
+  safe_array_add_index(arr, arr_id_key);
+  safe_array_add_index(arr, arr_number_key);
 }
 
 supla_device_channels::~supla_device_channels() {
@@ -1157,12 +1156,12 @@ supla_device_channels::~supla_device_channels() {
   safe_array_free(arr);
 }
 
-char supla_device_channels::arr_findcmp(void *ptr, void *id) {
-  return ((supla_device_channel *)ptr)->getId() == *((int *)id) ? 1 : 0;
+unsigned long long supla_device_channels::arr_id_key(void *ptr) {
+  return ((supla_device_channel *)ptr)->getId();
 }
 
-char supla_device_channels::arr_findncmp(void *ptr, void *n) {
-  return ((supla_device_channel *)ptr)->getNumber() == *((int *)n) ? 1 : 0;
+unsigned long long supla_device_channels::arr_number_key(void *ptr) {
+  return ((supla_device_channel *)ptr)->getNumber();
 }
 
 char supla_device_channels::arr_delcnd(void *ptr) {
@@ -1185,12 +1184,13 @@ void *supla_device_channels::get_srpc(void) {
 }
 
 supla_device_channel *supla_device_channels::find_channel(int Id) {
-  return (supla_device_channel *)safe_array_findcnd(arr, arr_findcmp, &Id);
+  return (supla_device_channel *)safe_array_findkey(arr, 0, Id, NULL, NULL);
 }
 
 supla_device_channel *supla_device_channels::find_channel_by_number(
     int Number) {
-  return (supla_device_channel *)safe_array_findcnd(arr, arr_findncmp, &Number);
+  return (supla_device_channel *)safe_array_findkey(arr, 1, Number, NULL,
+                                                    NULL);
 }
 
 void supla_device_channels::add_channel(
@@ -1736,7 +1736,8 @@ bool supla_device_channels::set_device_channel_rgbw_value(
   return result;
 }
 
-void supla_device_channels::get_temp_and_humidity(void *tarr) {
+void supla_device_channels::get_temp_and_humidity(void *tarr, int shard,
+                                                  int shard_count) {
   int a;
   safe_array_lock(arr);
 
@@ -1744,7 +1745,8 @@ void supla_device_channels::get_temp_and_humidity(void *tarr) {
     supla_device_channel *channel =
         (supla_device_channel *)safe_array_get(arr, a);
 
-    if (channel != NULL && !channel->isOffline()) {
+    if (channel != NULL && !channel->isOffline() &&
+        supla_datalogger::in_shard(channel->getId(), shard, shard_count)) {
       supla_channel_temphum *temphum = channel->getTempHum();
 
       if (temphum != NULL) safe_array_add(tarr, temphum);
@@ -1789,7 +1791,9 @@ bool supla_device_channels::get_channel_rgbw_value(int ChannelID, int *color,
   return result;
 }
 
-void supla_device_channels::get_electricity_measurements(void *emarr) {
+void supla_device_channels::get_electricity_measurements(void *emarr,
+                                                         int shard,
+                                                         int shard_count) {
   int a;
   safe_array_lock(arr);
 
@@ -1797,7 +1801,8 @@ void supla_device_channels::get_electricity_measurements(void *emarr) {
     supla_device_channel *channel =
         (supla_device_channel *)safe_array_get(arr, a);
 
-    if (channel != NULL && !channel->isOffline()) {
+    if (channel != NULL && !channel->isOffline() &&
+        supla_datalogger::in_shard(channel->getId(), shard, shard_count)) {
       supla_channel_electricity_measurement *em =
           channel->getElectricityMeasurement();
       if (em) {
@@ -1826,7 +1831,8 @@ supla_device_channels::get_electricity_measurement(int ChannelID) {
   return result;
 }
 
-void supla_device_channels::get_ic_measurements(void *icarr) {
+void supla_device_channels::get_ic_measurements(void *icarr, int shard,
+                                                int shard_count) {
   int a;
   safe_array_lock(arr);
 
@@ -1834,7 +1840,8 @@ void supla_device_channels::get_ic_measurements(void *icarr) {
     supla_device_channel *channel =
         (supla_device_channel *)safe_array_get(arr, a);
 
-    if (channel != NULL && !channel->isOffline()) {
+    if (channel != NULL && !channel->isOffline() &&
+        supla_datalogger::in_shard(channel->getId(), shard, shard_count)) {
       supla_channel_ic_measurement *ic =
           channel->getImpulseCounterMeasurement();
       if (ic) {
@@ -1846,7 +1853,9 @@ void supla_device_channels::get_ic_measurements(void *icarr) {
   safe_array_unlock(arr);
 }
 
-void supla_device_channels::get_thermostat_measurements(void *tharr) {
+void supla_device_channels::get_thermostat_measurements(void *tharr,
+                                                        int shard,
+                                                        int shard_count) {
   int a;
   safe_array_lock(arr);
 
@@ -1854,7 +1863,8 @@ void supla_device_channels::get_thermostat_measurements(void *tharr) {
     supla_device_channel *channel =
         (supla_device_channel *)safe_array_get(arr, a);
 
-    if (channel != NULL && !channel->isOffline()) {
+    if (channel != NULL && !channel->isOffline() &&
+        supla_datalogger::in_shard(channel->getId(), shard, shard_count)) {
       supla_channel_thermostat_measurement *th =
           channel->getThermostatMeasurement();
       if (th) {
@@ -235,8 +235,8 @@ class supla_device_channels {
   void *arr;
   supla_device *device;
 
-  static char arr_findcmp(void *ptr, void *id);
-  static char arr_findncmp(void *ptr, void *n);
+  static unsigned long long arr_id_key(void *ptr);
+  static unsigned long long arr_number_key(void *ptr);
   static char arr_delcnd(void *ptr);
   void arr_clean(void);
 
@@ -322,13 +322,15 @@ class supla_device_channels {
   bool is_channel_online(int ChannelID);
   void load(int UserID, int DeviceID);
 
-  void get_temp_and_humidity(void *tarr);
-  void get_electricity_measurements(void *emarr);
+  void get_temp_and_humidity(void *tarr, int shard = 0, int shard_count = 1);
+  void get_electricity_measurements(void *emarr, int shard = 0,
+                                    int shard_count = 1);
   supla_channel_electricity_measurement *get_electricity_measurement(
       int ChannelID);
-  void get_ic_measurements(void *icarr);
+  void get_ic_measurements(void *icarr, int shard = 0, int shard_count = 1);
   supla_channel_ic_measurement *get_ic_measurement(int ChannelID);
-  void get_thermostat_measurements(void *tharr);
+  void get_thermostat_measurements(void *tharr, int shard = 0,
+                                   int shard_count = 1);
 
   bool calcfg_request(int SenderID, int ChannelID, bool SuperUserAuthorized,
                       TCS_DeviceCalCfgRequest_B *request);
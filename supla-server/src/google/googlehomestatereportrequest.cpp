@@ -70,7 +70,7 @@ bool supla_google_home_statereport_request::verifyExisting(
     existing->setGoogleRequestId(getGoogleRequestIdPtr());
   }
 
-  existing->setDelay(existing->getGoogleRequestIdPtr() ? 3000000 : 1000000);
+  existing->postpone(existing->getGoogleRequestIdPtr() ? 3000000 : 1000000);
 
   return true;
 }
@@ -0,0 +1,1060 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "http/httpengine.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#ifndef NOSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include "http/trivialhttps.h"
+#endif /*NOSSL*/
+#include "eh.h"
+#include "lck.h"
+#include "log.h"
+#include "safearray.h"
+#include "sthread.h"
+#include "svrcfg.h"
+
+#define ENGINE_MAX_EVENTS 256
+#define ENGINE_MAX_WAIT_MSEC 1000
+#define ENGINE_IN_BUFFER_SIZE 4096
+#define ENGINE_OUTDATA_MAXSIZE 102400
+#define ENGINE_INDATA_MAXSIZE 102400
+
+#define HT_STAGE_CONNECTING 0
+#define HT_STAGE_HANDSHAKE 1
+#define HT_STAGE_SENDING 2
+#define HT_STAGE_RECEIVING 3
+#define HT_STAGE_DONE 4
+
+struct supla_http_transfer {
+  unsigned long long id;
+  std::string key;
+  bool reused;
+  bool keep_alive;
+  int sfd;
+  int family;
+  int socktype;
+  int protocol;
+  struct sockaddr_storage addr;
+  socklen_t addr_len;
+  char *tls_host;
+  void *ssl;
+  char stage;
+  unsigned int events;
+  char *out;
+  size_t out_size;
+  size_t out_pos;
+  char *in;
+  size_t in_size;
+  unsigned long long deadline;
+  std::multimap<unsigned long long, supla_http_transfer *>::iterator timer;
+  supla_http_transfer_done_t on_done;
+  void *user_data;
+};
+
+struct supla_http_idle_conn {
+  int sfd;
+  void *ssl;
+  unsigned long long idle_since;
+};
+
+typedef struct {
+  TEventHandler *eh;
+  void *lck;
+  bool done;
+  bool success;
+  char *in;
+} _http_engine_sync_t;
+
+void *supla_http_engine::engines_lck = NULL;
+std::vector<supla_http_engine *> supla_http_engine::engines;
+unsigned long long supla_http_engine::last_transfer_id = 0;
+int supla_http_engine::default_timeout_ms = 0;
+unsigned int supla_http_engine::pool_size = 0;
+int supla_http_engine::idle_timeout_sec = 0;
+void *supla_http_engine::ssl_ctx = NULL;
+
+#ifndef NOSSL
+static void *supla_http_engine_sessions_lck = NULL;
+static std::map<std::string, SSL_SESSION *> supla_http_engine_sessions;
+
+static int supla_http_engine_new_session(SSL *ssl, SSL_SESSION *session) {
+  supla_http_transfer *t =
+      static_cast<supla_http_transfer *>(SSL_get_app_data(ssl));
+  if (t == NULL) {
+    return 0;
+  }
+
+  lck_lock(supla_http_engine_sessions_lck);
+  std::map<std::string, SSL_SESSION *>::iterator it =
+      supla_http_engine_sessions.find(t->key);
+  if (it != supla_http_engine_sessions.end()) {
+    SSL_SESSION_free(it->second);
+    it->second = session;
+  } else {
+    supla_http_engine_sessions[t->key] = session;
+  }
+  lck_unlock(supla_http_engine_sessions_lck);
+
+  // The reference to the session is kept.
+  return 1;
+}
+#endif /*NOSSL*/
+
+supla_http_engine::supla_http_engine(void) {
+  struct epoll_event evnt = {};
+
+  lck = lck_init();
+  sthread = NULL;
+  epoll_fd = epoll_create1(0);
+  wakeup_fd = eventfd(0, EFD_NONBLOCK);
+  last_idle_check_usec = 0;
+
+  if (epoll_fd != -1 && wakeup_fd != -1) {
+    evnt.events = EPOLLIN;
+    evnt.data.ptr = NULL;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &evnt) == -1) {
+      supla_log(LOG_ERR, "HTTP engine: unable to add the wakeup descriptor");
+    }
+
+    Tsthread_params stp;
+    stp.execute = _execute;
+    stp.finish = NULL;
+    stp.user_data = this;
+    stp.free_on_finish = 0;
+    stp.initialize = NULL;
+
+    sthread = sthread_run(&stp);
+  } else {
+    supla_log(LOG_ERR, "HTTP engine: epoll/eventfd initialization error");
+  }
+}
+
+supla_http_engine::~supla_http_engine(void) {
+  if (sthread) {
+    sthread_terminate(sthread);
+    wakeup();
+    sthread_wait(sthread);
+    sthread_free(sthread);
+    sthread = NULL;
+  }
+
+  if (wakeup_fd != -1) {
+    ::close(wakeup_fd);
+  }
+
+  if (epoll_fd != -1) {
+    ::close(epoll_fd);
+  }
+
+  lck_free(lck);
+}
+
+// static
+void supla_http_engine::init(void) {
+  engines_lck = lck_init();
+  default_timeout_ms = scfg_int(CFG_HTTP_TRANSFER_TIMEOUT);
+  pool_size = scfg_int(CFG_HTTP_CONNECTION_POOL_SIZE) > 0
+                  ? scfg_int(CFG_HTTP_CONNECTION_POOL_SIZE)
+                  : 0;
+  idle_timeout_sec = scfg_int(CFG_HTTP_CONNECTION_IDLE_TIMEOUT);
+
+  int count = scfg_int(CFG_HTTP_ENGINE_THREADS);
+  if (count <= 0) {
+    return;
+  }
+
+#ifndef NOSSL
+  // One context for all of the connections. Loading the CA certificates
+  // for every request was the most expensive part of the TLS setup.
+  SSL_CTX *ctx = SSL_CTX_new(SSLv23_method());
+  if (ctx == NULL) {
+    supla_log(LOG_ERR, "HTTP engine: CTX initialization failed!");
+    return;
+  }
+
+  if (supla_trivial_https::getCAFile()) {
+    SSL_CTX_load_verify_locations(ctx, supla_trivial_https::getCAFile(),
+                                  NULL);
+  }
+
+  SSL_CTX_set_options(ctx,
+                      SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION);
+  SSL_CTX_set_session_cache_mode(
+      ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(ctx, supla_http_engine_new_session);
+  supla_http_engine_sessions_lck = lck_init();
+  ssl_ctx = ctx;
+#endif /*NOSSL*/
+
+  lck_lock(engines_lck);
+  for (int a = 0; a < count; a++) {
+    supla_http_engine *engine = new supla_http_engine();
+    if (engine->sthread) {
+      engines.push_back(engine);
+    } else {
+      delete engine;
+    }
+  }
+  lck_unlock(engines_lck);
+
+  supla_log(LOG_INFO, "HTTP requests are served by %i engine threads",
+            count);
+}
+
+// static
+void supla_http_engine::engine_free(void) {
+  if (engines_lck == NULL) {
+    return;
+  }
+
+  lck_lock(engines_lck);
+  for (std::vector<supla_http_engine *>::iterator it = engines.begin();
+       it != engines.end(); ++it) {
+    delete *it;
+  }
+  engines.clear();
+  lck_unlock(engines_lck);
+
+#ifndef NOSSL
+  if (ssl_ctx) {
+    SSL_CTX_free(static_cast<SSL_CTX *>(ssl_ctx));
+    ssl_ctx = NULL;
+  }
+
+  if (supla_http_engine_sessions_lck) {
+    for (std::map<std::string, SSL_SESSION *>::iterator it =
+             supla_http_engine_sessions.begin();
+         it != supla_http_engine_sessions.end(); ++it) {
+      SSL_SESSION_free(it->second);
+    }
+    supla_http_engine_sessions.clear();
+
+    lck_free(supla_http_engine_sessions_lck);
+    supla_http_engine_sessions_lck = NULL;
+  }
+#endif /*NOSSL*/
+
+  lck_free(engines_lck);
+  engines_lck = NULL;
+}
+
+// static
+bool supla_http_engine::is_enabled(void) {
+  if (engines_lck == NULL) {
+    return false;
+  }
+
+  bool result = false;
+
+  lck_lock(engines_lck);
+  result = engines.size() > 0;
+  lck_unlock(engines_lck);
+
+  return result;
+}
+
+// static
+bool supla_http_engine::is_keep_alive_enabled(void) {
+  return pool_size > 0 && is_enabled();
+}
+
+// static
+unsigned long long supla_http_engine::submit(
+    const struct addrinfo *ai, const char *tls_host, const char *out,
+    int timeout_ms, supla_http_transfer_done_t on_done, void *user_data) {
+  if (ai == NULL || out == NULL || on_done == NULL ||
+      ai->ai_addrlen > sizeof(struct sockaddr_storage) ||
+      engines_lck == NULL) {
+    return 0;
+  }
+
+  supla_http_transfer *t = new supla_http_transfer();
+  t->id = 0;
+  t->key = std::string(tls_host ? tls_host : "") + "|" +
+           std::string((const char *)ai->ai_addr, ai->ai_addrlen);
+  t->reused = false;
+  t->keep_alive = false;
+  t->sfd = -1;
+  t->family = ai->ai_family;
+  t->socktype = ai->ai_socktype;
+  t->protocol = ai->ai_protocol;
+  memcpy(&t->addr, ai->ai_addr, ai->ai_addrlen);
+  t->addr_len = ai->ai_addrlen;
+  t->tls_host = tls_host ? strdup(tls_host) : NULL;
+  t->ssl = NULL;
+  t->stage = HT_STAGE_CONNECTING;
+  t->events = 0;
+  t->out_size = strnlen(out, ENGINE_OUTDATA_MAXSIZE);
+  t->out = strndup(out, t->out_size);
+  t->out_pos = 0;
+  t->in = NULL;
+  t->in_size = 0;
+  t->deadline =
+      now_usec() +
+      (timeout_ms > 0 ? timeout_ms : default_timeout_ms) * 1000ULL;
+  t->on_done = on_done;
+  t->user_data = user_data;
+
+  unsigned long long id = 0;
+
+  lck_lock(engines_lck);
+  if (engines.size() > 0) {
+    id = ++last_transfer_id;
+    t->id = id;
+    // Transfers to the same host go to the same engine, which holds the
+    // idle connections to that host.
+    engines[safe_array_key_hash(t->key.c_str(), t->key.size()) %
+            engines.size()]
+        ->add(t);
+  }
+  lck_unlock(engines_lck);
+
+  if (id == 0) {
+    free(t->out);
+    free(t->tls_host);
+    delete t;
+  }
+
+  return id;
+}
+
+// static
+void supla_http_engine::cancel_transfer(unsigned long long id) {
+  if (id == 0 || engines_lck == NULL) {
+    return;
+  }
+
+  lck_lock(engines_lck);
+  for (std::vector<supla_http_engine *>::iterator it = engines.begin();
+       it != engines.end(); ++it) {
+    (*it)->cancel(id);
+  }
+  lck_unlock(engines_lck);
+}
+
+// static
+void supla_http_engine::perform_done(void *_sync, bool success, char *in) {
+  _http_engine_sync_t *sync = static_cast<_http_engine_sync_t *>(_sync);
+
+  lck_lock(sync->lck);
+  sync->done = true;
+  sync->success = success;
+  sync->in = in;
+  eh_raise_event(sync->eh);
+  lck_unlock(sync->lck);
+}
+
+static bool supla_http_engine_chunked_complete(const char *body,
+                                               size_t size) {
+  size_t pos = 0;
+
+  while (pos < size) {
+    const char *crlf =
+        static_cast<const char *>(memmem(&body[pos], size - pos, "\r\n", 2));
+    if (crlf == NULL) {
+      return false;
+    }
+
+    unsigned long chunk_size = strtoul(&body[pos], NULL, 16);
+    pos = crlf - body + 2;
+
+    if (chunk_size == 0) {
+      // The last chunk is followed by optional trailers and an empty line.
+      return memmem(&body[pos - 2], size - pos + 2, "\r\n\r\n", 4) != NULL;
+    }
+
+    pos += chunk_size + 2;
+  }
+
+  return false;
+}
+
+// static
+bool supla_http_engine::response_complete(supla_http_transfer *t) {
+  const char *header_end = strstr(t->in, "\r\n\r\n");
+  if (header_end == NULL || strncmp(t->in, "HTTP/1.1 ", 9) != 0) {
+    // HTTP/1.0 responses end when the connection is closed.
+    return false;
+  }
+
+  int code = atoi(&t->in[9]);
+  long long content_length = -1;
+  bool chunked = false;
+  bool close = false;
+
+  const char *line = strstr(t->in, "\r\n") + 2;
+  while (line < header_end) {
+    const char *line_end = strstr(line, "\r\n");
+    std::string value;
+
+    if (strncasecmp(line, "Content-Length:", 15) == 0) {
+      content_length = atoll(&line[15]);
+    } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+      value = std::string(&line[18], line_end - line - 18);
+      chunked = strcasestr(value.c_str(), "chunked") != NULL;
+    } else if (strncasecmp(line, "Connection:", 11) == 0) {
+      value = std::string(&line[11], line_end - line - 11);
+      close = strcasestr(value.c_str(), "close") != NULL;
+    }
+
+    line = line_end + 2;
+  }
+
+  const char *body = header_end + 4;
+  size_t body_size = t->in_size - (body - t->in);
+  bool result = false;
+
+  if (code == 204 || code == 304) {
+    result = true;
+  } else if (chunked) {
+    result = supla_http_engine_chunked_complete(body, body_size);
+  } else if (content_length >= 0) {
+    result = body_size >= (unsigned long long)content_length;
+  }
+
+  if (result) {
+    t->keep_alive = !close;
+  }
+
+  return result;
+}
+
+// static
+bool supla_http_engine::perform(const struct addrinfo *ai,
+                                const char *tls_host, const char *out,
+                                char **in, int timeout_ms,
+                                unsigned long long *id, void *id_lck) {
+  _http_engine_sync_t sync = {};
+  sync.eh = eh_init();
+  sync.lck = lck_init();
+
+  *in = NULL;
+
+  unsigned long long _id =
+      submit(ai, tls_host, out, timeout_ms, perform_done, &sync);
+
+  if (id) {
+    if (id_lck) lck_lock(id_lck);
+    *id = _id;
+    if (id_lck) lck_unlock(id_lck);
+  }
+
+  // The engine completes every transfer, at the latest after its deadline.
+  bool done = _id == 0;
+  while (!done) {
+    eh_wait(sync.eh, 1000000);
+
+    lck_lock(sync.lck);
+    done = sync.done;
+    lck_unlock(sync.lck);
+  }
+
+  if (id) {
+    if (id_lck) lck_lock(id_lck);
+    *id = 0;
+    if (id_lck) lck_unlock(id_lck);
+  }
+
+  *in = sync.in;
+
+  lck_free(sync.lck);
+  eh_free(sync.eh);
+
+  return sync.success;
+}
+
+// static
+void supla_http_engine::_execute(void *engine, void *sthread) {
+  static_cast<supla_http_engine *>(engine)->execute(sthread);
+}
+
+// static
+unsigned long long supla_http_engine::now_usec(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  return now.tv_sec * (unsigned long long)1000000 + now.tv_usec;
+}
+
+void supla_http_engine::wakeup(void) {
+  uint64_t u = 1;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+  write(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+}
+
+void supla_http_engine::add(supla_http_transfer *t) {
+  lck_lock(lck);
+  incoming.push_back(t);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+void supla_http_engine::cancel(unsigned long long id) {
+  lck_lock(lck);
+  cancel_requests.push_back(id);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+void supla_http_engine::accept_incoming(void) {
+  std::list<supla_http_transfer *> ts;
+
+  lck_lock(lck);
+  ts.swap(incoming);
+  lck_unlock(lck);
+
+  for (std::list<supla_http_transfer *>::iterator it = ts.begin();
+       it != ts.end(); ++it) {
+    supla_http_transfer *t = *it;
+
+    transfers[t->id] = t;
+    t->timer = deadlines.insert(
+        std::pair<unsigned long long, supla_http_transfer *>(t->deadline, t));
+
+    start(t);
+  }
+}
+
+void supla_http_engine::start(supla_http_transfer *t) {
+  if (reuse(t)) {
+    t->stage = HT_STAGE_SENDING;
+    handle(t);
+    return;
+  }
+
+  t->sfd = socket(t->family, t->socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  t->protocol);
+
+  if (t->sfd == -1) {
+    finish(t, false);
+  } else if (::connect(t->sfd, (struct sockaddr *)&t->addr, t->addr_len) ==
+             0) {
+    t->stage = t->tls_host ? HT_STAGE_HANDSHAKE : HT_STAGE_SENDING;
+    handle(t);
+  } else if (errno == EINPROGRESS) {
+    watch(t, EPOLLOUT);
+  } else {
+    finish(t, false);
+  }
+}
+
+bool supla_http_engine::reuse(supla_http_transfer *t) {
+  std::map<std::string, std::list<supla_http_idle_conn *> >::iterator it =
+      idle_connections.find(t->key);
+
+  if (it == idle_connections.end()) {
+    return false;
+  }
+
+  // The most recently used connection is the least likely to be closed by
+  // the server.
+  while (!it->second.empty()) {
+    supla_http_idle_conn *c = it->second.back();
+    it->second.pop_back();
+
+    // An idle connection has nothing to read unless the server closed it.
+    char b = 0;
+    if (recv(c->sfd, &b, sizeof(b), MSG_PEEK | MSG_DONTWAIT) == -1 &&
+        (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      t->sfd = c->sfd;
+      t->ssl = c->ssl;
+      t->reused = true;
+#ifndef NOSSL
+      if (t->ssl) {
+        SSL_set_app_data(static_cast<SSL *>(t->ssl), t);
+      }
+#endif /*NOSSL*/
+      delete c;
+      return true;
+    }
+
+    close_connection(c);
+  }
+
+  return false;
+}
+
+void supla_http_engine::restart(supla_http_transfer *t) {
+  if (t->events) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, t->sfd, NULL);
+    t->events = 0;
+  }
+
+#ifndef NOSSL
+  if (t->ssl) {
+    SSL_free(static_cast<SSL *>(t->ssl));
+    t->ssl = NULL;
+  }
+#endif /*NOSSL*/
+
+  if (t->sfd != -1) {
+    ::close(t->sfd);
+    t->sfd = -1;
+  }
+
+  t->reused = false;
+  t->keep_alive = false;
+  t->stage = HT_STAGE_CONNECTING;
+  t->out_pos = 0;
+
+  start(t);
+}
+
+void supla_http_engine::release_connection(supla_http_transfer *t) {
+  if (t->sfd == -1 || !t->keep_alive || pool_size == 0) {
+    return;
+  }
+
+  std::list<supla_http_idle_conn *> *conns = &idle_connections[t->key];
+  if (conns->size() >= pool_size) {
+    return;
+  }
+
+  supla_http_idle_conn *c = new supla_http_idle_conn();
+  c->sfd = t->sfd;
+  c->ssl = t->ssl;
+  c->idle_since = now_usec();
+  conns->push_back(c);
+
+  t->sfd = -1;
+  t->ssl = NULL;
+}
+
+void supla_http_engine::close_connection(supla_http_idle_conn *c) {
+#ifndef NOSSL
+  if (c->ssl) {
+    SSL_free(static_cast<SSL *>(c->ssl));
+  }
+#endif /*NOSSL*/
+
+  ::close(c->sfd);
+  delete c;
+}
+
+void supla_http_engine::process_idle_connections(bool all) {
+  unsigned long long now = now_usec();
+
+  if (!all && now - last_idle_check_usec < 1000000) {
+    return;
+  }
+
+  last_idle_check_usec = now;
+
+  std::map<std::string, std::list<supla_http_idle_conn *> >::iterator it =
+      idle_connections.begin();
+
+  while (it != idle_connections.end()) {
+    // The oldest connections are at the front.
+    while (!it->second.empty() &&
+           (all || now - it->second.front()->idle_since >=
+                       idle_timeout_sec * 1000000ULL)) {
+      close_connection(it->second.front());
+      it->second.pop_front();
+    }
+
+    if (it->second.empty()) {
+      idle_connections.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void supla_http_engine::process_cancel_requests(void) {
+  std::list<unsigned long long> requests;
+
+  lck_lock(lck);
+  requests.swap(cancel_requests);
+  lck_unlock(lck);
+
+  for (std::list<unsigned long long>::iterator it = requests.begin();
+       it != requests.end(); ++it) {
+    std::map<unsigned long long, supla_http_transfer *>::iterator t =
+        transfers.find(*it);
+    if (t != transfers.end()) {
+      finish(t->second, false);
+    }
+  }
+}
+
+void supla_http_engine::process_deadlines(void) {
+  unsigned long long now = now_usec();
+
+  while (!deadlines.empty() && deadlines.begin()->first <= now) {
+    supla_http_transfer *t = deadlines.begin()->second;
+    supla_log(LOG_WARNING,
+              "HTTP engine: transfer deadline exceeded. Host: %s, Stage: %i",
+              t->tls_host ? t->tls_host : "-", t->stage);
+    finish(t, false);
+  }
+}
+
+int supla_http_engine::wait_timeout_msec(void) {
+  int result = ENGINE_MAX_WAIT_MSEC;
+
+  if (!deadlines.empty()) {
+    unsigned long long now = now_usec();
+    unsigned long long deadline = deadlines.begin()->first;
+
+    if (deadline <= now) {
+      return 0;
+    }
+
+    if ((deadline - now) / 1000 + 1 < (unsigned long long)result) {
+      result = (deadline - now) / 1000 + 1;
+    }
+  }
+
+  return result;
+}
+
+void supla_http_engine::watch(supla_http_transfer *t, unsigned int events) {
+  if (t->events == events) {
+    return;
+  }
+
+  struct epoll_event evnt = {};
+  evnt.events = events;
+  evnt.data.ptr = t;
+
+  // A transfer that can not be monitored fails on its deadline.
+  if (epoll_ctl(epoll_fd, t->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, t->sfd,
+                &evnt) == -1) {
+    supla_log(LOG_ERR, "HTTP engine: unable to monitor the transfer %i",
+              t->sfd);
+  }
+
+  t->events = events;
+}
+
+bool supla_http_engine::handle_connect(supla_http_transfer *t) {
+  int err = 0;
+  socklen_t len = sizeof(err);
+
+  if (getsockopt(t->sfd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 ||
+      err != 0) {
+    return false;
+  }
+
+  t->stage = t->tls_host ? HT_STAGE_HANDSHAKE : HT_STAGE_SENDING;
+  return true;
+}
+
+bool supla_http_engine::watch_ssl(supla_http_transfer *t, int ssl_error) {
+#ifndef NOSSL
+  if (ssl_error == SSL_ERROR_WANT_READ) {
+    watch(t, EPOLLIN);
+    return true;
+  } else if (ssl_error == SSL_ERROR_WANT_WRITE) {
+    watch(t, EPOLLOUT);
+    return true;
+  }
+#endif /*NOSSL*/
+
+  return false;
+}
+
+bool supla_http_engine::handle_handshake(supla_http_transfer *t) {
+#ifdef NOSSL
+  return false;
+#else
+  SSL *ssl = static_cast<SSL *>(t->ssl);
+
+  if (ssl == NULL) {
+    ssl = SSL_new(static_cast<SSL_CTX *>(ssl_ctx));
+    if (ssl == NULL) {
+      return false;
+    }
+
+    t->ssl = ssl;
+    SSL_set_fd(ssl, t->sfd);
+    SSL_set_connect_state(ssl);
+    SSL_set_app_data(ssl, t);
+
+    lck_lock(supla_http_engine_sessions_lck);
+    std::map<std::string, SSL_SESSION *>::iterator it =
+        supla_http_engine_sessions.find(t->key);
+    if (it != supla_http_engine_sessions.end()) {
+      SSL_set_session(ssl, it->second);
+    }
+    lck_unlock(supla_http_engine_sessions_lck);
+
+    if (SSL_set_tlsext_host_name(ssl, t->tls_host) != 1) {
+      supla_log(LOG_ERR, "Can't set the server name for ClientHello!");
+      return false;
+    }
+  }
+
+  int res = SSL_do_handshake(ssl);
+  if (res != 1) {
+    if (watch_ssl(t, SSL_get_error(ssl, res))) {
+      return true;
+    }
+
+    supla_log(LOG_ERR, "HTTP engine: handshake failed! Host: %s",
+              t->tls_host);
+    return false;
+  }
+
+  X509 *cert = SSL_get_peer_certificate(ssl);
+  if (cert) {
+    X509_free(cert);
+  } else {
+    supla_log(LOG_ERR, "Can't get server certificate!");
+    return false;
+  }
+
+  long verify_result = SSL_get_verify_result(ssl);
+  if (X509_V_OK != verify_result) {
+    supla_log(LOG_ERR, "Can't verify server certificate! Code: %i",
+              verify_result);
+    return false;
+  }
+
+  t->stage = HT_STAGE_SENDING;
+  return true;
+#endif /*NOSSL*/
+}
+
+bool supla_http_engine::handle_send(supla_http_transfer *t) {
+  while (t->out_pos < t->out_size) {
+    ssize_t n = 0;
+
+#ifndef NOSSL
+    if (t->ssl) {
+      SSL *ssl = static_cast<SSL *>(t->ssl);
+      int res = SSL_write(ssl, &t->out[t->out_pos], t->out_size - t->out_pos);
+      if (res <= 0) {
+        return watch_ssl(t, SSL_get_error(ssl, res));
+      }
+      n = res;
+    } else  // NOLINT
+#endif      /*NOSSL*/
+    {
+      n = send(t->sfd, &t->out[t->out_pos], t->out_size - t->out_pos,
+               MSG_NOSIGNAL);
+      if (n == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          watch(t, EPOLLOUT);
+          return true;
+        }
+        return false;
+      }
+    }
+
+    t->out_pos += n;
+  }
+
+  t->stage = HT_STAGE_RECEIVING;
+  return true;
+}
+
+bool supla_http_engine::handle_recv(supla_http_transfer *t) {
+  char buffer[ENGINE_IN_BUFFER_SIZE];
+
+  while (true) {
+    ssize_t n = 0;
+
+#ifndef NOSSL
+    if (t->ssl) {
+      SSL *ssl = static_cast<SSL *>(t->ssl);
+      int res = SSL_read(ssl, buffer, sizeof(buffer));
+      if (res <= 0) {
+        if (watch_ssl(t, SSL_get_error(ssl, res))) {
+          return true;
+        }
+
+        // Many servers close the connection without close_notify.
+        t->stage = HT_STAGE_DONE;
+        return t->in_size > 0;
+      }
+      n = res;
+    } else  // NOLINT
+#endif      /*NOSSL*/
+    {
+      n = recv(t->sfd, buffer, sizeof(buffer), 0);
+      if (n == 0) {
+        t->stage = HT_STAGE_DONE;
+        return true;
+      } else if (n == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          watch(t, EPOLLIN);
+          return true;
+        }
+
+        t->stage = HT_STAGE_DONE;
+        return t->in_size > 0;
+      }
+    }
+
+    if (t->in_size + n >= ENGINE_INDATA_MAXSIZE) {
+      n = ENGINE_INDATA_MAXSIZE - 1 - t->in_size;
+      t->stage = HT_STAGE_DONE;
+    }
+
+    if (n > 0) {
+      char *in = static_cast<char *>(realloc(t->in, t->in_size + n + 1));
+      if (in == NULL) {
+        return false;
+      }
+
+      t->in = in;
+      memcpy(&t->in[t->in_size], buffer, n);
+      t->in_size += n;
+      t->in[t->in_size] = 0;
+    }
+
+    if (t->stage == HT_STAGE_DONE) {
+      return true;
+    }
+
+    if (response_complete(t)) {
+      t->stage = HT_STAGE_DONE;
+      return true;
+    }
+  }
+}
+
+void supla_http_engine::handle(supla_http_transfer *t) {
+  bool result = true;
+
+  if (t->stage == HT_STAGE_CONNECTING) {
+    result = handle_connect(t);
+  }
+
+  if (result && t->stage == HT_STAGE_HANDSHAKE) {
+    result = handle_handshake(t);
+  }
+
+  if (result && t->stage == HT_STAGE_SENDING) {
+    result = handle_send(t);
+  }
+
+  if (result && t->stage == HT_STAGE_RECEIVING) {
+    result = handle_recv(t);
+  }
+
+  if (t->reused && t->in_size == 0 &&
+      (!result || t->stage == HT_STAGE_DONE)) {
+    // The server closed the idle connection before it got the request.
+    restart(t);
+  } else if (!result) {
+    finish(t, false);
+  } else if (t->stage == HT_STAGE_DONE) {
+    finish(t, true);
+  }
+}
+
+void supla_http_engine::finish(supla_http_transfer *t, bool success) {
+  if (t->events) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, t->sfd, NULL);
+  }
+
+  deadlines.erase(t->timer);
+  transfers.erase(t->id);
+
+  if (success) {
+    release_connection(t);
+  }
+
+#ifndef NOSSL
+  if (t->ssl) {
+    SSL_free(static_cast<SSL *>(t->ssl));
+  }
+#endif /*NOSSL*/
+
+  if (t->sfd != -1) {
+    ::close(t->sfd);
+  }
+
+  if (!success && t->in) {
+    free(t->in);
+    t->in = NULL;
+  }
+
+  t->on_done(t->user_data, success, t->in);
+
+  free(t->out);
+  free(t->tls_host);
+  delete t;
+}
+
+void supla_http_engine::execute(void *sthread) {
+  struct epoll_event events[ENGINE_MAX_EVENTS];
+  uint64_t u = 0;
+
+  while (!sthread_isterminated(sthread)) {
+    int n =
+        epoll_wait(epoll_fd, events, ENGINE_MAX_EVENTS, wait_timeout_msec());
+
+    for (int a = 0; a < n; a++) {
+      supla_http_transfer *t =
+          static_cast<supla_http_transfer *>(events[a].data.ptr);
+
+      if (t == NULL) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+        read(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+      } else {
+        handle(t);
+      }
+    }
+
+    accept_incoming();
+    process_cancel_requests();
+    process_deadlines();
+    process_idle_connections(false);
+  }
+
+  std::list<supla_http_transfer *> ts;
+
+  lck_lock(lck);
+  ts.swap(incoming);
+  lck_unlock(lck);
+
+  for (std::list<supla_http_transfer *>::iterator it = ts.begin();
+       it != ts.end(); ++it) {
+    transfers[(*it)->id] = *it;
+    (*it)->timer = deadlines.insert(
+        std::pair<unsigned long long, supla_http_transfer *>((*it)->deadline,
+                                                             *it));
+  }
+
+  while (!transfers.empty()) {
+    finish(transfers.begin()->second, false);
+  }
+
+  process_idle_connections(true);
+}
@@ -0,0 +1,119 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef HTTP_HTTPENGINE_H_
+#define HTTP_HTTPENGINE_H_
+
+#include <netdb.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// The engine exchanges HTTP/1.1 requests and responses on non-blocking
+// sockets. Each engine thread owns one epoll instance that drives the
+// connect, the TLS handshake, the write of the request and the read of the
+// response of all of its transfers at once. Every transfer has its own
+// deadline, after which it fails no matter how slow the other side is.
+// Connections are kept alive and reused by the next transfer to the same
+// host. New TLS connections resume the last session negotiated with the host.
+
+typedef void (*supla_http_transfer_done_t)(void *user_data, bool success,
+                                           char *in);
+
+struct supla_http_transfer;
+struct supla_http_idle_conn;
+class supla_http_engine {
+ private:
+  static void *engines_lck;
+  static std::vector<supla_http_engine *> engines;
+  static unsigned long long last_transfer_id;
+  static int default_timeout_ms;
+  static unsigned int pool_size;
+  static int idle_timeout_sec;
+  static void *ssl_ctx;
+
+  void *lck;
+  void *sthread;
+  int epoll_fd;
+  int wakeup_fd;
+  std::list<supla_http_transfer *> incoming;
+  std::list<unsigned long long> cancel_requests;
+  std::map<unsigned long long, supla_http_transfer *> transfers;
+  std::multimap<unsigned long long, supla_http_transfer *> deadlines;
+  std::map<std::string, std::list<supla_http_idle_conn *> > idle_connections;
+  unsigned long long last_idle_check_usec;
+
+  static void _execute(void *engine, void *sthread);
+  static unsigned long long now_usec(void);
+  static void perform_done(void *sync, bool success, char *in);
+  static bool response_complete(supla_http_transfer *t);
+
+  void execute(void *sthread);
+  void wakeup(void);
+  void accept_incoming(void);
+  void process_cancel_requests(void);
+  void process_deadlines(void);
+  void process_idle_connections(bool all);
+  void start(supla_http_transfer *t);
+  bool reuse(supla_http_transfer *t);
+  void restart(supla_http_transfer *t);
+  void release_connection(supla_http_transfer *t);
+  void close_connection(supla_http_idle_conn *c);
+  void handle(supla_http_transfer *t);
+  bool handle_connect(supla_http_transfer *t);
+  bool handle_handshake(supla_http_transfer *t);
+  bool handle_send(supla_http_transfer *t);
+  bool handle_recv(supla_http_transfer *t);
+  void watch(supla_http_transfer *t, unsigned int events);
+  bool watch_ssl(supla_http_transfer *t, int ssl_error);
+  void finish(supla_http_transfer *t, bool success);
+  int wait_timeout_msec(void);
+  void add(supla_http_transfer *t);
+  void cancel(unsigned long long id);
+
+ public:
+  supla_http_engine(void);
+  virtual ~supla_http_engine(void);
+
+  static void init(void);
+  static void engine_free(void);
+  static bool is_enabled(void);
+  static bool is_keep_alive_enabled(void);
+
+  // Starts the transfer and returns its identifier. on_done is called from
+  // the engine thread and takes over the response buffer. tls_host is the
+  // name sent in the TLS ClientHello, NULL for a plain connection.
+  // timeout_ms <= 0 means the [HTTP] transfer_timeout.
+  static unsigned long long submit(const struct addrinfo *ai,
+                                   const char *tls_host, const char *out,
+                                   int timeout_ms,
+                                   supla_http_transfer_done_t on_done,
+                                   void *user_data);
+  static void cancel_transfer(unsigned long long id);
+
+  // Blocking variant of submit() for callers that need the response
+  // before going on. The identifier is stored in *id before waiting so that
+  // the transfer can be cancelled from another thread. id_lck, if not NULL,
+  // is held while *id is written.
+  static bool perform(const struct addrinfo *ai, const char *tls_host,
+                      const char *out, char **in, int timeout_ms,
+                      unsigned long long *id, void *id_lck = NULL);
+};
+
+#endif /* HTTP_HTTPENGINE_H_ */
@@ -44,6 +44,8 @@ supla_http_request::supla_http_request(supla_user *user, int ClassID,
   this->googleRequestId = NULL;
   this->touchTimeSec = 0;
   this->touchCount = 0;
+  this->batchWindowUs = scfg_int(CFG_HTTP_BATCH_WINDOW) * 1000ULL;
+  gettimeofday(&createTime, NULL);
 
   setTimeout(scfg_int(CFG_HTTP_REQUEST_TIMEOUT) * 1000);
   setDelay(0);
@@ -193,6 +195,24 @@ void supla_http_request::setDelay(unsigned long long delayUs) {
   supla_http_request_queue::getInstance()->recalculateTime();
 }
 
+// Events gathered into a queued request postpone its execution, but only
+// within the batch window counted from the first event. Otherwise a channel
+// that changes all the time would never be reported.
+void supla_http_request::postpone(unsigned long long delayUs) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  unsigned long long now_usec = now.tv_sec * 1000000ULL + now.tv_usec;
+  unsigned long long limit_usec =
+      createTime.tv_sec * 1000000ULL + createTime.tv_usec + batchWindowUs;
+
+  if (now_usec + delayUs > limit_usec) {
+    delayUs = limit_usec > now_usec ? limit_usec - now_usec : 0;
+  }
+
+  setDelay(delayUs);
+}
+
 void supla_http_request::setTimeout(unsigned long long timeoutUs) {
   this->timeoutUs = timeoutUs;
 }
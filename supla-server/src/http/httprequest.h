@@ -42,7 +42,9 @@ class supla_http_request {
   int DeviceId;
   int ChannelId;
   struct timeval startTime;
+  struct timeval createTime;
   unsigned long long timeoutUs;
+  unsigned long long batchWindowUs;
   unsigned long long touchTimeSec;
   unsigned long long touchCount;
 
@@ -73,6 +75,7 @@ class supla_http_request {
   virtual void setGoogleRequestId(const char googleRequestId[]);
   const char *getGoogleRequestIdPtr(void);
   void setDelay(unsigned long long delayUs);
+  void postpone(unsigned long long delayUs);
   void setTimeout(unsigned long long timeoutUs);
   unsigned long long getTimeout(void);
   unsigned long long getStartTime(void);
@@ -40,16 +40,6 @@ typedef struct {
 
 supla_http_request_queue *supla_http_request_queue::instance = NULL;
 
-char supla_http_request_queue_arr_queue_clean(void *_request) {
-  supla_http_request *request = static_cast<supla_http_request *>(_request);
-  if (request) {
-    delete request;
-    return 1;
-  }
-
-  return 0;
-}
-
 void supla_http_request_thread_execute(void *ptr, void *sthread) {
   database::thread_init();
   static_cast<_request_thread_ptr_t *>(ptr)->request->execute(sthread);
@@ -90,11 +80,10 @@ supla_http_request_queue *supla_http_request_queue::getInstance(void) {
 supla_http_request_queue::supla_http_request_queue() {
   this->main_eh = eh_init();
   this->lck = lck_init();
-  this->arr_queue = safe_array_init();
+  this->queue_lck = lck_init();
+  this->queue_size = 0;
   this->arr_thread = safe_array_init();
   this->thread_count_limit = scfg_int(CFG_HTTP_THREAD_COUNT_LIMIT);
-  this->queue_offset = 0;
-  this->last_user_id = 0;
   this->last_iterate_time_sec = 0;
   this->time_of_the_next_iteration_usec = 0;
   this->request_total_count = 0;
@@ -116,9 +105,16 @@ void supla_http_request_queue::terminateAllThreads(void) {
 supla_http_request_queue::~supla_http_request_queue() {
   safe_array_free(arr_thread);
 
-  safe_array_clean(arr_queue, supla_http_request_queue_arr_queue_clean);
-  safe_array_free(arr_queue);
+  for (std::map<int, std::list<supla_http_request *> >::iterator it =
+           user_queues.begin();
+       it != user_queues.end(); ++it) {
+    for (std::list<supla_http_request *>::iterator rit = it->second.begin();
+         rit != it->second.end(); ++rit) {
+      delete *rit;
+    }
+  }
 
+  lck_free(queue_lck);
   lck_free(lck);
   eh_free(main_eh);
 }
@@ -157,62 +153,66 @@ supla_http_request *supla_http_request_queue::queuePop(void *q_sthread,
                                                        struct timeval *now) {
   supla_http_request *result = NULL;
 
-  safe_array_lock(arr_queue);
+  lck_lock(queue_lck);
 
-  if (queue_offset >= safe_array_count(arr_queue)) {
-    queue_offset = 0;
-    last_user_id = 0;
-  }
+  for (size_t a = user_order.size(); a > 0 && result == NULL; a--) {
+    int UserID = user_order.front();
+    user_order.pop_front();
+
+    std::list<supla_http_request *> *queue = &user_queues[UserID];
+    std::list<supla_http_request *>::iterator it = queue->begin();
+
+    while (it != queue->end()) {
+      supla_http_request *request = *it;
+
+      if (request->isWaiting(now)) {
+        request->touch(now);
+        ++it;
+        continue;
+      }
 
-  while (queue_offset < safe_array_count(arr_queue)) {
-    supla_http_request *request = static_cast<supla_http_request *>(
-        safe_array_get(arr_queue, queue_offset));
+      it = queue->erase(it);
+      queue_size--;
 
-    if (request && request->getUserID() != last_user_id &&
-        !request->isWaiting(now)) {
       if (request->isCancelled(q_sthread)) {
         delete request;
-        request = NULL;
       } else if (request->timeout(NULL)) {
         supla_log(LOG_WARNING,
                   "HTTP request execution timeout! UserID: %i, IODevice: %i "
                   "Channel: %i QS: %i, TC: %i,"
                   "EventSourceType: %i (%lu/%lu/%lu/%lu/%lu/%lu/%i)",
                   request->getUserID(), request->getDeviceId(),
-                  request->getChannelId(), queueSize(), threadCount(),
+                  request->getChannelId(), queue_size, threadCount(),
                   request->getEventSourceType(), request->getTimeout(),
                   request->getStartTime(), now->tv_sec,
                   request->getTouchTimeSec(), request->getTouchCount(),
-                  last_iterate_time_sec, queue_offset);
+                  last_iterate_time_sec, (int)queue->size());
 
         delete request;
-        request = NULL;
       } else {
         result = request;
+        break;
       }
-
-      safe_array_delete(arr_queue, queue_offset);
-      break;
-    }
-
-    if (request) {
-      request->touch(now);
     }
 
-    queue_offset++;
-
-    if (result) {
-      last_user_id = result->getUserID();
-      break;
+    if (queue->empty()) {
+      user_queues.erase(UserID);
+    } else {
+      user_order.push_back(UserID);
     }
   }
-  safe_array_unlock(arr_queue);
+
+  lck_unlock(queue_lck);
 
   return result;
 }
 
 int supla_http_request_queue::queueSize(void) {
-  return safe_array_count(arr_queue);
+  int result = 0;
+  lck_lock(queue_lck);
+  result = queue_size;
+  lck_unlock(queue_lck);
+  return result;
 }
 
 int supla_http_request_queue::threadCount(void) {
@@ -257,6 +257,9 @@ void supla_http_request_queue::iterate(void *q_sthread) {
         if (request) {
           runThread(request);
           recalculateTime(&now);
+        } else {
+          // Everything left is delayed. Sleep until the first one is due.
+          recalculateTime(&now, false);
         }
       } else if (!warn_msg) {
         supla_log(LOG_WARNING,
@@ -329,30 +332,32 @@ void supla_http_request_queue::logMetrics(unsigned int min_interval_sec) {
             threadCount(), queueSize(), requestTotalCount());
 }
 
-void supla_http_request_queue::recalculateTime(struct timeval *now) {
+void supla_http_request_queue::recalculateTime(struct timeval *now,
+                                               bool raise) {
   unsigned long long now_usec = now->tv_sec * 1000000 + now->tv_usec;
   long long time = 2000000;
 
-  safe_array_lock(arr_queue);
-
-  for (int b = 0; b < safe_array_count(arr_queue) && time > 0; b++) {
-    supla_http_request *request =
-        static_cast<supla_http_request *>(safe_array_get(arr_queue, b));
+  lck_lock(queue_lck);
 
-    if (request) {
-      long long timeLeft = request->timeLeft(now);
+  for (std::map<int, std::list<supla_http_request *> >::iterator it =
+           user_queues.begin();
+       it != user_queues.end() && time > 0; ++it) {
+    for (std::list<supla_http_request *>::iterator rit = it->second.begin();
+         rit != it->second.end() && time > 0; ++rit) {
+      long long timeLeft = (*rit)->timeLeft(now);
       if (timeLeft < time) {
         time = timeLeft;
       }
     }
   }
-  safe_array_unlock(arr_queue);
+
+  lck_unlock(queue_lck);
 
   lck_lock(lck);
   time_of_the_next_iteration_usec = now_usec + (time > 0 ? time : 0);
   lck_unlock(lck);
 
-  if (queueSize() > 0) {
+  if (raise && queueSize() > 0) {
     raiseEvent();
   }
 }
@@ -364,8 +369,35 @@ void supla_http_request_queue::recalculateTime(void) {
 }
 
 void supla_http_request_queue::addRequest(supla_http_request *request) {
-  safe_array_add(arr_queue, request);
-  recalculateTime();
+  lck_lock(queue_lck);
+
+  std::list<supla_http_request *> *queue =
+      &user_queues[request->getUserID()];
+  if (queue->empty()) {
+    user_order.push_back(request->getUserID());
+  }
+
+  queue->push_back(request);
+  queue_size++;
+
+  lck_unlock(queue_lck);
+
+  // The other requests have not changed, so only the new one can bring the
+  // next iteration forward.
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  long long timeLeft = request->timeLeft(&now);
+  unsigned long long time = now.tv_sec * 1000000ULL + now.tv_usec +
+                            (timeLeft > 0 ? timeLeft : 0);
+
+  lck_lock(lck);
+  if (time < time_of_the_next_iteration_usec) {
+    time_of_the_next_iteration_usec = time;
+  }
+  lck_unlock(lck);
+
+  raiseEvent();
 }
 
 void supla_http_request_queue::createByChannelEventSourceType(
@@ -382,40 +414,50 @@ void supla_http_request_queue::createByChannelEventSourceType(
 
   for (std::list<supla_http_request *>::iterator it = requests.begin();
        it != requests.end(); it++) {
-    supla_http_request *request = *it;
-
-    safe_array_lock(arr_queue);
-
-    int ClassID = request->getClassID();
+    addOrMerge(*it, deviceId, channelId, eventSourceType, correlationToken,
+               googleRequestId);
+  }
+}
 
-    for (int a = 0; a < safe_array_count(arr_queue); a++) {
-      supla_http_request *existing =
-          static_cast<supla_http_request *>(safe_array_get(arr_queue, a));
-      if (existing && existing->getClassID() == ClassID &&
+void supla_http_request_queue::addOrMerge(supla_http_request *request,
+                                          int deviceId, int channelId,
+                                          event_source_type eventSourceType,
+                                          const char correlationToken[],
+                                          const char googleRequestId[]) {
+  int ClassID = request->getClassID();
+
+  // A request still waiting in the user's queue reads the channel state
+  // when it is executed, so it reports this change as well.
+  lck_lock(queue_lck);
+
+  std::map<int, std::list<supla_http_request *> >::iterator queue =
+      user_queues.find(request->getUserID());
+
+  if (queue != user_queues.end()) {
+    for (std::list<supla_http_request *>::iterator it = queue->second.begin();
+         it != queue->second.end(); ++it) {
+      supla_http_request *existing = *it;
+      if (existing->getClassID() == ClassID &&
           existing->isDeviceIdEqual(deviceId) &&
           existing->isChannelIdEqual(channelId) &&
           !request->verifyExisting(existing)) {
         break;
       }
     }
+  }
 
-    safe_array_unlock(arr_queue);
-
-    if (request) {
-      if (!request->isEventSourceTypeAccepted(eventSourceType, false) ||
-          !request->queueUp()) {
-        delete request;
-        request = NULL;
-      }
+  lck_unlock(queue_lck);
 
-      if (request) {
-        request->setCorrelationToken(correlationToken);
-        request->setGoogleRequestId(googleRequestId);
-        request->requestWillBeAdded();
-        addRequest(request);
-      }
-    }
+  if (!request->isEventSourceTypeAccepted(eventSourceType, false) ||
+      !request->queueUp()) {
+    delete request;
+    return;
   }
+
+  request->setCorrelationToken(correlationToken);
+  request->setGoogleRequestId(googleRequestId);
+  request->requestWillBeAdded();
+  addRequest(request);
 }
 
 void supla_http_request_queue::onChannelValueChangeEvent(
@@ -19,6 +19,8 @@
 #ifndef HTTP_HTTPREQUESTQUEUE_H_
 #define HTTP_HTTPREQUESTQUEUE_H_
 
+#include <list>
+#include <map>
 #include "commontypes.h"
 #include "eh.h"
 #include "string.h"
@@ -31,11 +33,14 @@ class supla_http_request_queue {
   static supla_http_request_queue *instance;
   TEventHandler *main_eh;
   void *lck;
-  void *arr_queue;
+  void *queue_lck;
+  // Requests waiting for execution in a FIFO per user. The users are served
+  // round-robin, so a user with many requests does not delay the others.
+  std::map<int, std::list<supla_http_request *> > user_queues;
+  std::list<int> user_order;
+  int queue_size;
   void *arr_thread;
   int thread_count_limit;
-  int queue_offset;
-  int last_user_id;
   unsigned long long last_iterate_time_sec;
   unsigned long long time_of_the_next_iteration_usec;
 
@@ -44,8 +49,6 @@ class supla_http_request_queue {
 
   void terminateAllThreads(void);
   void runThread(supla_http_request *request);
-  supla_http_request *queuePop(void *q_sthread, struct timeval *now);
-  int queueSize(void);
   int threadCount(void);
   int threadCountLimit(void);
   unsigned long long requestTotalCount(void);
@@ -54,7 +57,16 @@ class supla_http_request_queue {
                                       event_source_type eventSourceType,
                                       const char correlationToken[],
                                       const char googleRequestId[]);
-  void recalculateTime(struct timeval *now);
+  void recalculateTime(struct timeval *now, bool raise = true);
+
+ protected:
+  supla_http_request *queuePop(void *q_sthread, struct timeval *now);
+  int queueSize(void);
+  // Queues the request unless it is merged into a waiting request of the
+  // same user. Takes the ownership of the request.
+  void addOrMerge(supla_http_request *request, int deviceId, int channelId,
+                  event_source_type eventSourceType,
+                  const char correlationToken[], const char googleRequestId[]);
 
  public:
   static void init();
@@ -23,6 +23,7 @@
 #define TOKEN_MAXSIZE 2048
 
 #include <arpa/inet.h>
+#include <http/httpengine.h>
 #include <http/trivialhttp.h>
 #include <netdb.h>
 #include <stdio.h>
@@ -34,6 +35,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include "lck.h"
 #include "log.h"
 
 supla_trivial_http::supla_trivial_http(const char *host, const char *resource) {
@@ -46,6 +48,9 @@ supla_trivial_http::supla_trivial_http(const char *host, const char *resource) {
   this->resource = resource ? strndup(resource, RESOURCE_MAXSIZE) : NULL;
   this->body = NULL;
   this->token = NULL;
+  this->timeoutMs = 0;
+  this->transferId = 0;
+  this->lck = lck_init();
 }
 
 supla_trivial_http::supla_trivial_http(void) {
@@ -58,6 +63,9 @@ supla_trivial_http::supla_trivial_http(void) {
   this->resource = NULL;
   this->body = NULL;
   this->token = NULL;
+  this->timeoutMs = 0;
+  this->transferId = 0;
+  this->lck = lck_init();
 }
 
 supla_trivial_http::~supla_trivial_http(void) {
@@ -65,6 +73,7 @@ supla_trivial_http::~supla_trivial_http(void) {
   setResource(NULL);
   releaseResponse();
   setToken(NULL, false);
+  lck_free(lck);
 }
 
 void supla_trivial_http::set_string_variable(char **var, int max_len, char *src,
@@ -189,6 +198,13 @@ bool supla_trivial_http::send_recv(const char *out, char **in) {
 
   *in = NULL;
 
+  if (supla_http_engine::is_enabled()) {
+    result = supla_http_engine::perform(ai, NULL, out, in, timeoutMs,
+                                        &transferId, lck);
+    freeaddrinfo(ai);
+    return result;
+  }
+
   sfd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
   if (sfd >= 0 &&
       connect(sfd, ai->ai_addr, (unsigned int)ai->ai_addrlen) == 0) {
@@ -400,7 +416,11 @@ bool supla_trivial_http::request(const char *method, const char *header,
     OUT_APPEND("\r\n");
   }
 
-  OUT_APPEND("Connection: close\r\n");
+  if (supla_http_engine::is_keep_alive_enabled()) {
+    OUT_APPEND("Connection: keep-alive\r\n");
+  } else {
+    OUT_APPEND("Connection: close\r\n");
+  }
   if (header) {
     OUT_APPEND(header);
     OUT_APPEND("\r\n");
@@ -449,6 +469,10 @@ void supla_trivial_http::setToken(char *token, bool copy) {
   set_string_variable(&this->token, TOKEN_MAXSIZE, token, copy);
 }
 
+void supla_trivial_http::setTimeout(int timeoutMs) {
+  this->timeoutMs = timeoutMs;
+}
+
 bool supla_trivial_http::http_get(void) { return request("GET", NULL, NULL); }
 
 bool supla_trivial_http::http_post(char *header, const char *data) {
@@ -460,6 +484,12 @@ bool supla_trivial_http::http_put(char *header, const char *data) {
 }
 
 void supla_trivial_http::terminate(void) {
+  lck_lock(lck);
+  unsigned long long id = transferId;
+  lck_unlock(lck);
+
+  supla_http_engine::cancel_transfer(id);
+
   if (sfd >= 0) {
     close(sfd);
     sfd = -1;
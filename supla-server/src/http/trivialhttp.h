@@ -39,6 +39,10 @@ class supla_trivial_http {
   int resultCode;
 
   char *token;
+  int timeoutMs;
+  // Written by the request thread, read by terminate(). Guarded by lck.
+  unsigned long long transferId;
+  void *lck;
 
   void set_string_variable(char **var, int max_len, char *src, bool copy);
 
@@ -50,9 +54,9 @@ class supla_trivial_http {
   virtual bool send_recv(const char *out, char **in);
   virtual bool request(const char *method, const char *header,
                        const char *data);
+  bool get_addrinfo(void **res);
 
  private:
-  bool get_addrinfo(void **res);
 
   char *header_item_match(const char *item, unsigned int size, const char *name,
                           unsigned int name_size);
@@ -74,6 +78,7 @@ class supla_trivial_http {
   const char *getContentType(void);
   const char *getBody(void);
   void setToken(char *token, bool copy = true);
+  void setTimeout(int timeoutMs);
 
   bool http_get(void);
   bool http_post(char *header, const char *data);
@@ -17,7 +17,9 @@
  */
 
 #ifndef NOSSL
+#include <http/httpengine.h>
 #include <http/trivialhttps.h>
+#include <netdb.h>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 #include <stdio.h>
@@ -61,6 +63,11 @@ void supla_trivial_https::init(void) {
   }
 }
 
+// static
+const char *supla_trivial_https::getCAFile(void) {
+  return supla_trivial_https::caFile;
+}
+
 supla_trivial_https::supla_trivial_https(const char *host, const char *resource)
     : supla_trivial_http(host, resource) {
   this->ssl_vars = NULL;
@@ -124,6 +131,19 @@ bool supla_trivial_https::send_recv(const char *out, char **in) {
     return false;
   }
 
+  if (supla_http_engine::is_enabled()) {
+    struct addrinfo *ai = NULL;
+    if (!get_addrinfo((void **)&ai)) {
+      return false;
+    }
+
+    bool result =
+        supla_http_engine::perform(ai, host, out, in, timeoutMs, &transferId,
+                                   lck);
+    freeaddrinfo(ai);
+    return result;
+  }
+
   vars_init();
   _ssl_vars_t *vars = (_ssl_vars_t *)ssl_vars;
 
@@ -38,6 +38,7 @@ class supla_trivial_https : public supla_trivial_http {
 
  public:
   static void init(void);
+  static const char *getCAFile(void);
   supla_trivial_https(const char *host, const char *resource);
   supla_trivial_https(void);
   ~supla_trivial_https(void);
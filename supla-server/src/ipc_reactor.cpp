@@ -0,0 +1,332 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+#include "ipc_reactor.h"
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "database.h"
+#include "ipcctrl.h"
+#include "lck.h"
+#include "log.h"
+#include "sthread.h"
+
+#define IPC_REACTOR_MAX_EVENTS 256
+#define IPC_REACTOR_MAX_WAIT_MSEC 1000
+
+struct supla_ipc_reactor_conn {
+  svr_ipcctrl *ipcctrl;
+  int sfd;
+  bool output_watched;
+  std::list<supla_ipc_reactor_conn *>::iterator it;
+};
+
+void *supla_ipc_reactor::reactors_lck = NULL;
+std::vector<supla_ipc_reactor *> supla_ipc_reactor::reactors;
+
+supla_ipc_reactor::supla_ipc_reactor(void) {
+  struct epoll_event evnt = {};
+
+  lck = lck_init();
+  sthread = NULL;
+  epoll_fd = epoll_create1(0);
+  wakeup_fd = eventfd(0, EFD_NONBLOCK);
+  gettimeofday(&last_idle_check, NULL);
+
+  if (epoll_fd != -1 && wakeup_fd != -1) {
+    evnt.events = EPOLLIN;
+    evnt.data.ptr = NULL;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &evnt) == -1) {
+      supla_log(LOG_ERR, "IPC reactor: unable to add the wakeup descriptor");
+    }
+
+    Tsthread_params stp;
+    stp.execute = _execute;
+    stp.finish = _finish;
+    stp.user_data = this;
+    stp.free_on_finish = 0;
+    stp.initialize = NULL;
+
+    sthread = sthread_run(&stp);
+  } else {
+    supla_log(LOG_ERR, "IPC reactor: epoll/eventfd initialization error");
+  }
+}
+
+supla_ipc_reactor::~supla_ipc_reactor(void) {
+  if (sthread) {
+    sthread_terminate(sthread);
+    wakeup();
+    sthread_wait(sthread);
+    sthread_free(sthread);
+    sthread = NULL;
+  }
+
+  for (std::list<svr_ipcctrl *>::iterator it = incoming.begin();
+       it != incoming.end(); ++it) {
+    delete *it;
+  }
+
+  if (wakeup_fd != -1) {
+    ::close(wakeup_fd);
+  }
+
+  if (epoll_fd != -1) {
+    ::close(epoll_fd);
+  }
+
+  lck_free(lck);
+}
+
+// static
+void supla_ipc_reactor::init(int thread_count) {
+  reactors_lck = lck_init();
+
+  if (thread_count <= 0) {
+    return;
+  }
+
+  lck_lock(reactors_lck);
+  for (int a = 0; a < thread_count; a++) {
+    reactors.push_back(new supla_ipc_reactor());
+  }
+  lck_unlock(reactors_lck);
+
+  supla_log(LOG_INFO, "IPC connections are served by %i event loop threads",
+            thread_count);
+}
+
+// static
+void supla_ipc_reactor::reactor_free(void) {
+  lck_lock(reactors_lck);
+  for (std::vector<supla_ipc_reactor *>::iterator it = reactors.begin();
+       it != reactors.end(); ++it) {
+    delete *it;
+  }
+  reactors.clear();
+  lck_unlock(reactors_lck);
+
+  lck_free(reactors_lck);
+  reactors_lck = NULL;
+}
+
+// static
+bool supla_ipc_reactor::is_enabled(void) {
+  bool result = false;
+
+  lck_lock(reactors_lck);
+  result = reactors.size() > 0;
+  lck_unlock(reactors_lck);
+
+  return result;
+}
+
+// static
+void supla_ipc_reactor::dispatch(svr_ipcctrl *ipcctrl) {
+  supla_ipc_reactor *reactor = NULL;
+  unsigned int min_count = 0;
+
+  lck_lock(reactors_lck);
+  for (std::vector<supla_ipc_reactor *>::iterator it = reactors.begin();
+       it != reactors.end(); ++it) {
+    unsigned int count = (*it)->connection_count();
+    if (reactor == NULL || count < min_count) {
+      reactor = *it;
+      min_count = count;
+    }
+  }
+
+  if (reactor) {
+    reactor->add(ipcctrl);
+  }
+  lck_unlock(reactors_lck);
+
+  if (reactor == NULL) {
+    delete ipcctrl;
+  }
+}
+
+// static
+void supla_ipc_reactor::_execute(void *reactor, void *sthread) {
+  database::thread_init();
+  static_cast<supla_ipc_reactor *>(reactor)->execute(sthread);
+}
+
+// static
+void supla_ipc_reactor::_finish(void *reactor, void *sthread) {
+  database::thread_end();
+}
+
+void supla_ipc_reactor::wakeup(void) {
+  uint64_t u = 1;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+  write(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+}
+
+void supla_ipc_reactor::add(svr_ipcctrl *ipcctrl) {
+  lck_lock(lck);
+  incoming.push_back(ipcctrl);
+  lck_unlock(lck);
+
+  wakeup();
+}
+
+unsigned int supla_ipc_reactor::connection_count(void) {
+  unsigned int result = 0;
+
+  lck_lock(lck);
+  result = incoming.size() + connections.size();
+  lck_unlock(lck);
+
+  return result;
+}
+
+void supla_ipc_reactor::accept_incoming(void) {
+  std::list<svr_ipcctrl *> ipcctrls;
+
+  lck_lock(lck);
+  ipcctrls.swap(incoming);
+  lck_unlock(lck);
+
+  for (std::list<svr_ipcctrl *>::iterator it = ipcctrls.begin();
+       it != ipcctrls.end(); ++it) {
+    supla_ipc_reactor_conn *rc = new supla_ipc_reactor_conn();
+    rc->ipcctrl = *it;
+    rc->sfd = rc->ipcctrl->get_sfd();
+    rc->output_watched = false;
+
+    lck_lock(lck);
+    rc->it = connections.insert(connections.end(), rc);
+    lck_unlock(lck);
+
+    struct epoll_event evnt = {};
+    evnt.events = EPOLLIN;
+    evnt.data.ptr = rc;
+
+    if (rc->sfd == -1 ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, rc->sfd, &evnt) == -1) {
+      supla_log(LOG_ERR, "IPC reactor: unable to monitor the connection %i",
+                rc->sfd);
+      close(rc);
+    } else {
+      rc->ipcctrl->greet();
+      handle(rc, false);
+    }
+  }
+}
+
+bool supla_ipc_reactor::watch(supla_ipc_reactor_conn *rc, bool output) {
+  if (rc->output_watched == output) {
+    return true;
+  }
+
+  struct epoll_event evnt = {};
+  evnt.events = output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  evnt.data.ptr = rc;
+
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, rc->sfd, &evnt) == -1) {
+    return false;
+  }
+
+  rc->output_watched = output;
+  return true;
+}
+
+void supla_ipc_reactor::handle(supla_ipc_reactor_conn *rc, bool readable) {
+  bool success = !readable || rc->ipcctrl->read_input();
+
+  if (success) {
+    int result = rc->ipcctrl->send_output();
+    success = result != -1 && watch(rc, result == 0);
+  }
+
+  if (!success) {
+    close(rc);
+  }
+}
+
+void supla_ipc_reactor::close(supla_ipc_reactor_conn *rc) {
+  if (rc->sfd != -1) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, rc->sfd, NULL);
+  }
+
+  lck_lock(lck);
+  connections.erase(rc->it);
+  lck_unlock(lck);
+
+  delete rc->ipcctrl;
+  delete rc;
+}
+
+void supla_ipc_reactor::process_idle_connections(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  if (now.tv_sec == last_idle_check.tv_sec) {
+    return;
+  }
+
+  last_idle_check = now;
+
+  for (std::list<supla_ipc_reactor_conn *>::iterator it =
+           connections.begin();
+       it != connections.end();) {
+    supla_ipc_reactor_conn *rc = *it;
+    ++it;
+
+    if (rc->ipcctrl->idle_timeout_exceeded()) {
+      close(rc);
+    }
+  }
+}
+
+void supla_ipc_reactor::execute(void *sthread) {
+  struct epoll_event events[IPC_REACTOR_MAX_EVENTS];
+  uint64_t u = 0;
+
+  while (!sthread_isterminated(sthread)) {
+    int n = epoll_wait(epoll_fd, events, IPC_REACTOR_MAX_EVENTS,
+                       IPC_REACTOR_MAX_WAIT_MSEC);
+
+    for (int a = 0; a < n; a++) {
+      supla_ipc_reactor_conn *rc =
+          static_cast<supla_ipc_reactor_conn *>(events[a].data.ptr);
+
+      if (rc == NULL) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+        read(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+      } else {
+        handle(rc, events[a].events & (EPOLLIN | EPOLLHUP | EPOLLERR));
+      }
+    }
+
+    accept_incoming();
+    process_idle_connections();
+  }
+
+  accept_incoming();
+
+  while (!connections.empty()) {
+    close(connections.front());
+  }
+}
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef IPC_REACTOR_H_
+#define IPC_REACTOR_H_
+
+#include <sys/time.h>
+#include <list>
+#include <vector>
+
+// Serves IPC control connections from a small pool of threads instead of
+// starting a thread per connection. Each reactor owns one epoll instance
+// that monitors the sockets of its connections. The state of a partially
+// received command is kept by svr_ipcctrl between the reads.
+
+class svr_ipcctrl;
+struct supla_ipc_reactor_conn;
+class supla_ipc_reactor {
+ private:
+  static void *reactors_lck;
+  static std::vector<supla_ipc_reactor *> reactors;
+
+  void *lck;
+  void *sthread;
+  int epoll_fd;
+  int wakeup_fd;
+  std::list<svr_ipcctrl *> incoming;
+  std::list<supla_ipc_reactor_conn *> connections;
+  struct timeval last_idle_check;
+
+  static void _execute(void *reactor, void *sthread);
+  static void _finish(void *reactor, void *sthread);
+
+  void execute(void *sthread);
+  void wakeup(void);
+  void accept_incoming(void);
+  void process_idle_connections(void);
+  void handle(supla_ipc_reactor_conn *rc, bool readable);
+  bool watch(supla_ipc_reactor_conn *rc, bool output);
+  void close(supla_ipc_reactor_conn *rc);
+  void add(svr_ipcctrl *ipcctrl);
+  unsigned int connection_count(void);
+
+ public:
+  supla_ipc_reactor(void);
+  virtual ~supla_ipc_reactor(void);
+
+  // thread_count <= 0 leaves every connection to its own thread.
+  static void init(int thread_count);
+  static void reactor_free(void);
+  static bool is_enabled(void);
+  static void dispatch(svr_ipcctrl *ipcctrl);
+};
+
+#endif /* IPC_REACTOR_H_ */
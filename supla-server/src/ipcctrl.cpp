@@ -16,7 +16,10 @@
  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -32,6 +35,9 @@
 #include "tools.h"
 #include "user.h"
 
+#include <string>
+#include <unordered_map>
+
 // TODO(anyone): For setters, use the supla_action_executor class
 
 const char hello[] = "SUPLA SERVER CTRL\n";
@@ -84,40 +90,187 @@ const char cmd_user_on_device_settings_changed[] =
 const char cmd_user_before_channel_function_change[] =
     "USER-BEFORE-CHANNEL-FUNCTION-CHANGE:";
 
+const char cmd_multi_get[] = "MULTI-GET:";
+
 char ACT_VAR[] = ",ALEXA-CORRELATION-TOKEN=";
 char GRI_VAR[] = ",GOOGLE-REQUEST-ID=";
 
-svr_ipcctrl::svr_ipcctrl(int sfd) {
-  this->sfd = sfd;
+enum {
+  IPC_CMD_IS_CLIENT_CONNECTED = 1,
+  IPC_CMD_IS_IODEV_CONNECTED,
+  IPC_CMD_IS_CHANNEL_CONNECTED,
+  IPC_CMD_USER_RECONNECT,
+  IPC_CMD_CLIENT_RECONNECT,
+  IPC_CMD_GET_DOUBLE_VALUE,
+  IPC_CMD_GET_TEMPERATURE_VALUE,
+  IPC_CMD_GET_HUMIDITY_VALUE,
+  IPC_CMD_GET_RGBW_VALUE,
+  IPC_CMD_GET_CHAR_VALUE,
+  IPC_CMD_GET_EM_VALUE,
+  IPC_CMD_GET_IC_VALUE,
+  IPC_CMD_GET_VALVE_VALUE,
+  IPC_CMD_GET_DIGIGLASS_VALUE,
+  IPC_CMD_SET_CHAR_VALUE,
+  IPC_CMD_SET_RGBW_VALUE,
+  IPC_CMD_SET_RAND_RGBW_VALUE,
+  IPC_CMD_SET_CG_CHAR_VALUE,
+  IPC_CMD_SET_CG_RGBW_VALUE,
+  IPC_CMD_SET_CG_RAND_RGBW_VALUE,
+  IPC_CMD_USER_ALEXA_CREDENTIALS_CHANGED,
+  IPC_CMD_USER_GOOGLE_HOME_CREDENTIALS_CHANGED,
+  IPC_CMD_USER_STATE_WEBHOOK_CHANGED,
+  IPC_CMD_USER_MQTT_SETTINGS_CHANGED,
+  IPC_CMD_USER_ON_DEVICE_DELETED,
+  IPC_CMD_USER_BEFORE_DEVICE_DELETE,
+  IPC_CMD_USER_BEFORE_CHANNEL_FUNCTION_CHANGE,
+  IPC_CMD_USER_ON_DEVICE_SETTINGS_CHANGED,
+  IPC_CMD_SET_DIGIGLASS_VALUE,
+  IPC_CMD_ACTION_OPEN,
+  IPC_CMD_ACTION_CLOSE,
+  IPC_CMD_MULTI_GET,
+};
+
+typedef struct {
+  const char *cmd;
+  int id;
+  // Takes UserID,DeviceID,ChannelID and may be used with MULTI-GET.
+  bool channel_getter;
+} _ipc_command_t;
+
+const _ipc_command_t ipc_commands[] = {
+    {cmd_is_client_connected, IPC_CMD_IS_CLIENT_CONNECTED, false},
+    {cmd_is_iodev_connected, IPC_CMD_IS_IODEV_CONNECTED, false},
+    {cmd_is_channel_connected, IPC_CMD_IS_CHANNEL_CONNECTED, true},
+    {cmd_user_reconnect, IPC_CMD_USER_RECONNECT, false},
+    {cmd_client_reconnect, IPC_CMD_CLIENT_RECONNECT, false},
+    {cmd_get_double_value, IPC_CMD_GET_DOUBLE_VALUE, true},
+    {cmd_get_temperature_value, IPC_CMD_GET_TEMPERATURE_VALUE, true},
+    {cmd_get_humidity_value, IPC_CMD_GET_HUMIDITY_VALUE, true},
+    {cmd_get_rgbw_value, IPC_CMD_GET_RGBW_VALUE, true},
+    {cmd_get_char_value, IPC_CMD_GET_CHAR_VALUE, true},
+    {cmd_get_em_value, IPC_CMD_GET_EM_VALUE, true},
+    {cmd_get_ic_value, IPC_CMD_GET_IC_VALUE, true},
+    {cmd_get_valve_value, IPC_CMD_GET_VALVE_VALUE, true},
+    {cmd_get_digiglass_value, IPC_CMD_GET_DIGIGLASS_VALUE, true},
+    {cmd_set_char_value, IPC_CMD_SET_CHAR_VALUE, false},
+    {cmd_set_rgbw_value, IPC_CMD_SET_RGBW_VALUE, false},
+    {cmd_set_rand_rgbw_value, IPC_CMD_SET_RAND_RGBW_VALUE, false},
+    {cmd_set_cg_char_value, IPC_CMD_SET_CG_CHAR_VALUE, false},
+    {cmd_set_cg_rgbw_value, IPC_CMD_SET_CG_RGBW_VALUE, false},
+    {cmd_set_cg_rand_rgbw_value, IPC_CMD_SET_CG_RAND_RGBW_VALUE, false},
+    {cmd_user_alexa_credentials_changed,
+     IPC_CMD_USER_ALEXA_CREDENTIALS_CHANGED, false},
+    {cmd_user_google_home_credentials_changed,
+     IPC_CMD_USER_GOOGLE_HOME_CREDENTIALS_CHANGED, false},
+    {cmd_user_state_webhook_changed, IPC_CMD_USER_STATE_WEBHOOK_CHANGED,
+     false},
+    {cmd_user_mqtt_settings_changed, IPC_CMD_USER_MQTT_SETTINGS_CHANGED,
+     false},
+    {cmd_user_on_device_deleted, IPC_CMD_USER_ON_DEVICE_DELETED, false},
+    {cmd_user_before_device_delete, IPC_CMD_USER_BEFORE_DEVICE_DELETE, false},
+    {cmd_user_before_channel_function_change,
+     IPC_CMD_USER_BEFORE_CHANNEL_FUNCTION_CHANGE, false},
+    {cmd_user_on_device_settings_changed,
+     IPC_CMD_USER_ON_DEVICE_SETTINGS_CHANGED, false},
+    {cmd_set_digiglass_value, IPC_CMD_SET_DIGIGLASS_VALUE, false},
+    {cmd_action_open, IPC_CMD_ACTION_OPEN, false},
+    {cmd_action_close, IPC_CMD_ACTION_CLOSE, false},
+    {cmd_multi_get, IPC_CMD_MULTI_GET, false},
+};
+
+typedef std::unordered_map<std::string, const _ipc_command_t *>
+    _ipc_command_map_t;
+
+static _ipc_command_map_t *ipc_command_map_init(void) {
+  _ipc_command_map_t *result = new _ipc_command_map_t();
+
+  for (size_t a = 0; a < sizeof(ipc_commands) / sizeof(_ipc_command_t); a++) {
+    (*result)[ipc_commands[a].cmd] = &ipc_commands[a];
+  }
 
-  this->eh = eh_init();
-  eh_add_fd(eh, sfd);
+  return result;
 }
 
-bool svr_ipcctrl::match_command(const char *cmd, int len) {
-  if (len > (int)strnlen(cmd, IPC_BUFFER_SIZE) &&
-      memcmp(buffer, cmd, strnlen(cmd, IPC_BUFFER_SIZE)) == 0 &&
-      buffer[len - 1] == '\n') {
-    buffer[len - 1] = 0;
-    return true;
+static const _ipc_command_t *ipc_find_command(const char *line, int len) {
+  // Initialized once, thread-safe since C++11.
+  static const _ipc_command_map_t *map = ipc_command_map_init();
+
+  const char *colon = static_cast<const char *>(memchr(line, ':', len));
+  if (colon == NULL) {
+    return NULL;
   }
 
-  return false;
+  _ipc_command_map_t::const_iterator it =
+      map->find(std::string(line, colon - line + 1));
+
+  return it == map->end() ? NULL : it->second;
+}
+
+svr_ipcctrl::svr_ipcctrl(int sfd) {
+  this->sfd = sfd;
+  in_len = 0;
+  in_overflow = false;
+  in_multi_get = false;
+  eh = NULL;
+  gettimeofday(&last_action, NULL);
+}
+
+void svr_ipcctrl::send_buffer(void) {
+  out.append(buffer, strnlen(buffer, sizeof(buffer)));
 }
 
 void svr_ipcctrl::send_result(const char *result) {
   snprintf(buffer, sizeof(buffer), "%s\n", result);
-  send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+  send_buffer();
 }
 
 void svr_ipcctrl::send_result(const char *result, int i) {
   snprintf(buffer, sizeof(buffer), "%s%i\n", result, i);
-  send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+  send_buffer();
 }
 
 void svr_ipcctrl::send_result(const char *result, double i) {
   snprintf(buffer, sizeof(buffer), "%s%f\n", result, i);
-  send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+  send_buffer();
+}
+
+int svr_ipcctrl::send_output(void) {
+  size_t offset = 0;
+  int result = 1;
+
+  while (offset < out.size()) {
+    ssize_t n = send(sfd, &out[offset], out.size() - offset, MSG_NOSIGNAL);
+
+    if (n > 0) {
+      offset += n;
+    } else {
+      result = n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+      break;
+    }
+  }
+
+  out.erase(0, offset);
+  return result;
+}
+
+bool svr_ipcctrl::flush(void) {
+  int result = 0;
+
+  while ((result = send_output()) == 0) {
+    struct pollfd pfd = {};
+    pfd.fd = sfd;
+    pfd.events = POLLOUT;
+
+    if (poll(&pfd, 1, 1000) <= 0) {
+      break;
+    }
+  }
+
+  if (result != 1) {
+    out.clear();
+  }
+
+  return result == 1;
 }
 
 void svr_ipcctrl::get_double(const char *cmd, char Type) {
@@ -199,7 +352,7 @@ void svr_ipcctrl::get_rgbw(const char *cmd) {
     if (r) {
       snprintf(buffer, sizeof(buffer), "VALUE:%i,%i,%i\n", color,
                color_brightness, brightness);
-      send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+      send_buffer();
 
       return;
     }
@@ -235,7 +388,7 @@ void svr_ipcctrl::get_impulsecounter_value(const char *cmd) {
         unit_b64 = NULL;
       }
 
-      send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+      send_buffer();
 
       delete icm;
       return;
@@ -301,7 +454,7 @@ void svr_ipcctrl::get_electricitymeter_value(const char *cmd) {
                em_ev.total_reverse_reactive_energy[2], em_ev.total_cost,
                em_ev.price_per_unit, currency);
 
-      send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+      send_buffer();
 
       delete em;
       return;
@@ -326,9 +479,10 @@ void svr_ipcctrl::get_valve_value(const char *cmd) {
                                                  &Value);
 
     if (r) {
-      snprintf(buffer, sizeof(buffer), "VALUE:%i,%i", Value.closed,
-               Value.flags);
-      send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+      // Sent without the new line, unless it is a part of MULTI-GET.
+      snprintf(buffer, sizeof(buffer), "VALUE:%i,%i%s", Value.closed,
+               Value.flags, in_multi_get ? "\n" : "");
+      send_buffer();
       return;
     }
   }
@@ -355,8 +509,10 @@ void svr_ipcctrl::get_digiglass_value(const char *cmd) {
     }
 
     if (result) {
-      snprintf(buffer, sizeof(buffer), "VALUE:%i", Mask);
-      send(sfd, buffer, strnlen(buffer, IPC_BUFFER_SIZE), 0);
+      // Sent without the new line, unless it is a part of MULTI-GET.
+      snprintf(buffer, sizeof(buffer), "VALUE:%i%s", Mask,
+               in_multi_get ? "\n" : "");
+      send_buffer();
       return;
     }
   }
@@ -744,183 +900,297 @@ void svr_ipcctrl::on_device_settings_changed(const char *cmd) {
   }
 }
 
-void svr_ipcctrl::execute(void *sthread) {
-  if (sfd == -1) return;
+void svr_ipcctrl::multi_get(const char *cmd) {
+  char args[IPC_LINE_MAXSIZE];
+  snprintf(args, sizeof(args), "%s", &buffer[strnlen(cmd, IPC_BUFFER_SIZE)]);
 
-  int len;
+  int args_len = strnlen(args, sizeof(args));
+  const _ipc_command_t *getter = ipc_find_command(args, args_len);
 
-  struct timeval last_action;
-  gettimeofday(&last_action, NULL);
+  if (getter == NULL || !getter->channel_getter) {
+    send_result("COMMAND_UNKNOWN");
+    return;
+  }
 
-  send(sfd, hello, sizeof(hello), 0);
+  int ids[IPC_MULTI_GET_MAX * 2 + 1];
+  int count = 0;
 
-  while (sthread_isterminated(sthread) == 0) {
-    eh_wait(eh, 1000000);
-    memset(buffer, 0, IPC_BUFFER_SIZE);
-
-    if ((len = recv(sfd, buffer, sizeof(buffer), 0)) != 0) {
-      if (len > 0) {
-        buffer[IPC_BUFFER_SIZE - 1] = 0;
-
-        if (match_command(cmd_is_client_connected, len)) {
-          int UserID = 0;
-          int ClientID = 0;
-          sscanf(&buffer[strnlen(cmd_is_client_connected, IPC_BUFFER_SIZE)],
-                 "%i,%i", &UserID, &ClientID);
-
-          if (UserID && ClientID &&
-              supla_user::is_client_online(UserID, ClientID)) {
-            send_result("CONNECTED:", ClientID);
-          } else {
-            send_result("DISCONNECTED:", ClientID);
-          }
-
-        } else if (match_command(cmd_is_iodev_connected, len)) {
-          int UserID = 0;
-          int DeviceID = 0;
-          sscanf(&buffer[strnlen(cmd_is_iodev_connected, IPC_BUFFER_SIZE)],
-                 "%i,%i", &UserID, &DeviceID);
-
-          if (UserID && DeviceID &&
-              supla_user::is_device_online(UserID, DeviceID)) {
-            send_result("CONNECTED:", DeviceID);
-          } else {
-            send_result("DISCONNECTED:", DeviceID);
-          }
-        } else if (match_command(cmd_is_channel_connected, len)) {
-          int UserID = 0;
-          int DeviceID = 0;
-          int ChannelID = 0;
-          sscanf(&buffer[strnlen(cmd_is_channel_connected, IPC_BUFFER_SIZE)],
-                 "%i,%i,%i", &UserID, &DeviceID, &ChannelID);
-
-          if (UserID && DeviceID && ChannelID &&
-              supla_user::is_channel_online(UserID, DeviceID, ChannelID)) {
-            send_result("CONNECTED:", ChannelID);
-          } else {
-            send_result("DISCONNECTED:", ChannelID);
-          }
-        } else if (match_command(cmd_user_reconnect, len)) {
-          int UserID = 0;
-          sscanf(&buffer[strnlen(cmd_user_reconnect, IPC_BUFFER_SIZE)], "%i",
-                 &UserID);
-
-          if (UserID && supla_user::reconnect(UserID, EST_IPC)) {
-            send_result("OK:", UserID);
-          } else {
-            send_result("USER_UNKNOWN:", UserID);
-          }
-
-        } else if (match_command(cmd_client_reconnect, len)) {
-          int UserID = 0;
-          int ClientID = 0;
-
-          sscanf(&buffer[strnlen(cmd_client_reconnect, IPC_BUFFER_SIZE)],
-                 "%i,%i", &UserID, &ClientID);
-
-          if (UserID && ClientID) {
-            supla_user::client_reconnect(UserID, ClientID);
-            send_result("OK:", ClientID);
-          } else {
-            send_result("USER_OR_CLIENT_UNKNOWN");
-          }
-
-        } else if (match_command(cmd_get_double_value, len)) {
-          get_double(cmd_get_double_value, 0);
-
-        } else if (match_command(cmd_get_temperature_value, len)) {
-          get_double(cmd_get_temperature_value, 1);
-
-        } else if (match_command(cmd_get_humidity_value, len)) {
-          get_double(cmd_get_humidity_value, 2);
-
-        } else if (match_command(cmd_get_rgbw_value, len)) {
-          get_rgbw(cmd_get_rgbw_value);
-
-        } else if (match_command(cmd_get_char_value, len)) {
-          get_char(cmd_get_char_value);
-
-        } else if (match_command(cmd_get_em_value, len)) {
-          get_electricitymeter_value(cmd_get_em_value);
-
-        } else if (match_command(cmd_get_ic_value, len)) {
-          get_impulsecounter_value(cmd_get_ic_value);
-
-        } else if (match_command(cmd_get_valve_value, len)) {
-          get_valve_value(cmd_get_valve_value);
-
-        } else if (match_command(cmd_get_digiglass_value, len)) {
-          get_digiglass_value(cmd_get_digiglass_value);
-
-        } else if (match_command(cmd_set_char_value, len)) {
-          set_char(cmd_set_char_value, false);
-
-        } else if (match_command(cmd_set_rgbw_value, len)) {
-          set_rgbw(cmd_set_rgbw_value, false, false);
-
-        } else if (match_command(cmd_set_rand_rgbw_value, len)) {
-          set_rgbw(cmd_set_rand_rgbw_value, false, true);
-
-        } else if (match_command(cmd_set_cg_char_value, len)) {
-          set_char(cmd_set_cg_char_value, true);
-
-        } else if (match_command(cmd_set_cg_rgbw_value, len)) {
-          set_rgbw(cmd_set_cg_rgbw_value, true, false);
-
-        } else if (match_command(cmd_set_cg_rand_rgbw_value, len)) {
-          set_rgbw(cmd_set_cg_rand_rgbw_value, true, true);
-
-        } else if (match_command(cmd_user_alexa_credentials_changed, len)) {
-          alexa_credentials_changed(cmd_user_alexa_credentials_changed);
-
-        } else if (match_command(cmd_user_google_home_credentials_changed,
-                                 len)) {
-          google_home_credentials_changed(
-              cmd_user_google_home_credentials_changed);
-
-        } else if (match_command(cmd_user_state_webhook_changed, len)) {
-          state_webhook_changed(cmd_user_state_webhook_changed);
+  char *next = &args[strnlen(getter->cmd, IPC_BUFFER_SIZE)];
 
-        } else if (match_command(cmd_user_mqtt_settings_changed, len)) {
-          mqtt_settings_changed(cmd_user_mqtt_settings_changed);
-
-        } else if (match_command(cmd_user_on_device_deleted, len)) {
-          on_device_deleted(cmd_user_on_device_deleted);
+  while (count < IPC_MULTI_GET_MAX * 2 + 1) {
+    char *end = NULL;
+    ids[count] = strtol(next, &end, 10);
+    if (end == next) {
+      break;
+    }
 
-        } else if (match_command(cmd_user_before_device_delete, len)) {
-          before_device_delete(cmd_user_before_device_delete);
+    count++;
 
-        } else if (match_command(cmd_user_before_channel_function_change,
-                                 len)) {
-          before_channel_function_change(
-              cmd_user_before_channel_function_change);
+    if (*end != ',') {
+      break;
+    }
+    next = end + 1;
+  }
 
-        } else if (match_command(cmd_user_on_device_settings_changed, len)) {
-          on_device_settings_changed(cmd_user_on_device_settings_changed);
+  // UserID followed by DeviceID,ChannelID pairs.
+  count = count > 0 ? (count - 1) / 2 : 0;
+  send_result(cmd_multi_get, count);
 
-        } else if (match_command(cmd_set_digiglass_value, len)) {
-          set_digiglass_value(cmd_set_digiglass_value);
-        } else if (match_command(cmd_action_open, len)) {
-          action_open_close(cmd_action_open, true);
-        } else if (match_command(cmd_action_close, len)) {
-          action_open_close(cmd_action_close, false);
+  in_multi_get = true;
+  for (int a = 0; a < count; a++) {
+    snprintf(buffer, sizeof(buffer), "%s%i,%i,%i", getter->cmd, ids[0],
+             ids[a * 2 + 1], ids[a * 2 + 2]);
+    dispatch(getter->id, getter->cmd);
+  }
+  in_multi_get = false;
+}
 
-        } else {
-          supla_log(LOG_WARNING, "IPC - COMMAND UNKNOWN: %s", buffer);
-          send_result("COMMAND_UNKNOWN");
-        }
+void svr_ipcctrl::dispatch(int id, const char *cmd) {
+  switch (id) {
+    case IPC_CMD_IS_CLIENT_CONNECTED: {
+      int UserID = 0;
+      int ClientID = 0;
+      sscanf(&buffer[strnlen(cmd, IPC_BUFFER_SIZE)], "%i,%i", &UserID,
+             &ClientID);
+
+      if (UserID && ClientID &&
+          supla_user::is_client_online(UserID, ClientID)) {
+        send_result("CONNECTED:", ClientID);
+      } else {
+        send_result("DISCONNECTED:", ClientID);
+      }
+    } break;
+    case IPC_CMD_IS_IODEV_CONNECTED: {
+      int UserID = 0;
+      int DeviceID = 0;
+      sscanf(&buffer[strnlen(cmd, IPC_BUFFER_SIZE)], "%i,%i", &UserID,
+             &DeviceID);
+
+      if (UserID && DeviceID &&
+          supla_user::is_device_online(UserID, DeviceID)) {
+        send_result("CONNECTED:", DeviceID);
+      } else {
+        send_result("DISCONNECTED:", DeviceID);
+      }
+    } break;
+    case IPC_CMD_IS_CHANNEL_CONNECTED: {
+      int UserID = 0;
+      int DeviceID = 0;
+      int ChannelID = 0;
+      sscanf(&buffer[strnlen(cmd, IPC_BUFFER_SIZE)], "%i,%i,%i", &UserID,
+             &DeviceID, &ChannelID);
+
+      if (UserID && DeviceID && ChannelID &&
+          supla_user::is_channel_online(UserID, DeviceID, ChannelID)) {
+        send_result("CONNECTED:", ChannelID);
+      } else {
+        send_result("DISCONNECTED:", ChannelID);
+      }
+    } break;
+    case IPC_CMD_USER_RECONNECT: {
+      int UserID = 0;
+      sscanf(&buffer[strnlen(cmd, IPC_BUFFER_SIZE)], "%i", &UserID);
 
-        gettimeofday(&last_action, NULL);
+      if (UserID && supla_user::reconnect(UserID, EST_IPC)) {
+        send_result("OK:", UserID);
+      } else {
+        send_result("USER_UNKNOWN:", UserID);
       }
+    } break;
+    case IPC_CMD_CLIENT_RECONNECT: {
+      int UserID = 0;
+      int ClientID = 0;
 
+      sscanf(&buffer[strnlen(cmd, IPC_BUFFER_SIZE)], "%i,%i", &UserID,
+             &ClientID);
+
+      if (UserID && ClientID) {
+        supla_user::client_reconnect(UserID, ClientID);
+        send_result("OK:", ClientID);
+      } else {
+        send_result("USER_OR_CLIENT_UNKNOWN");
+      }
+    } break;
+    case IPC_CMD_GET_DOUBLE_VALUE:
+      get_double(cmd, 0);
+      break;
+    case IPC_CMD_GET_TEMPERATURE_VALUE:
+      get_double(cmd, 1);
+      break;
+    case IPC_CMD_GET_HUMIDITY_VALUE:
+      get_double(cmd, 2);
+      break;
+    case IPC_CMD_GET_RGBW_VALUE:
+      get_rgbw(cmd);
+      break;
+    case IPC_CMD_GET_CHAR_VALUE:
+      get_char(cmd);
+      break;
+    case IPC_CMD_GET_EM_VALUE:
+      get_electricitymeter_value(cmd);
+      break;
+    case IPC_CMD_GET_IC_VALUE:
+      get_impulsecounter_value(cmd);
+      break;
+    case IPC_CMD_GET_VALVE_VALUE:
+      get_valve_value(cmd);
+      break;
+    case IPC_CMD_GET_DIGIGLASS_VALUE:
+      get_digiglass_value(cmd);
+      break;
+    case IPC_CMD_SET_CHAR_VALUE:
+      set_char(cmd, false);
+      break;
+    case IPC_CMD_SET_RGBW_VALUE:
+      set_rgbw(cmd, false, false);
+      break;
+    case IPC_CMD_SET_RAND_RGBW_VALUE:
+      set_rgbw(cmd, false, true);
+      break;
+    case IPC_CMD_SET_CG_CHAR_VALUE:
+      set_char(cmd, true);
+      break;
+    case IPC_CMD_SET_CG_RGBW_VALUE:
+      set_rgbw(cmd, true, false);
+      break;
+    case IPC_CMD_SET_CG_RAND_RGBW_VALUE:
+      set_rgbw(cmd, true, true);
+      break;
+    case IPC_CMD_USER_ALEXA_CREDENTIALS_CHANGED:
+      alexa_credentials_changed(cmd);
+      break;
+    case IPC_CMD_USER_GOOGLE_HOME_CREDENTIALS_CHANGED:
+      google_home_credentials_changed(cmd);
+      break;
+    case IPC_CMD_USER_STATE_WEBHOOK_CHANGED:
+      state_webhook_changed(cmd);
+      break;
+    case IPC_CMD_USER_MQTT_SETTINGS_CHANGED:
+      mqtt_settings_changed(cmd);
+      break;
+    case IPC_CMD_USER_ON_DEVICE_DELETED:
+      on_device_deleted(cmd);
+      break;
+    case IPC_CMD_USER_BEFORE_DEVICE_DELETE:
+      before_device_delete(cmd);
+      break;
+    case IPC_CMD_USER_BEFORE_CHANNEL_FUNCTION_CHANGE:
+      before_channel_function_change(cmd);
+      break;
+    case IPC_CMD_USER_ON_DEVICE_SETTINGS_CHANGED:
+      on_device_settings_changed(cmd);
+      break;
+    case IPC_CMD_SET_DIGIGLASS_VALUE:
+      set_digiglass_value(cmd);
+      break;
+    case IPC_CMD_ACTION_OPEN:
+      action_open_close(cmd, true);
+      break;
+    case IPC_CMD_ACTION_CLOSE:
+      action_open_close(cmd, false);
+      break;
+    case IPC_CMD_MULTI_GET:
+      multi_get(cmd);
+      break;
+  }
+}
+
+void svr_ipcctrl::process_line(const char *line, int len) {
+  const _ipc_command_t *command = NULL;
+
+  if (len < IPC_LINE_MAXSIZE) {
+    memcpy(buffer, line, len);
+    buffer[len] = 0;
+    command = ipc_find_command(buffer, len);
+  } else {
+    buffer[0] = 0;
+  }
+
+  if (command) {
+    dispatch(command->id, command->cmd);
+  } else {
+    supla_log(LOG_WARNING, "IPC - COMMAND UNKNOWN: %s", buffer);
+    send_result("COMMAND_UNKNOWN");
+  }
+}
+
+void svr_ipcctrl::process_input(void) {
+  int offset = 0;
+
+  while (offset < in_len) {
+    char *nl = static_cast<char *>(memchr(&in[offset], '\n', in_len - offset));
+    if (nl == NULL) {
+      break;
+    }
+
+    int len = nl - &in[offset];
+
+    if (in_overflow) {
+      // The tail of a line that did not fit in the input buffer.
+      in_overflow = false;
+      process_line(NULL, IPC_LINE_MAXSIZE);
     } else {
-      sthread_terminate(sthread);
+      process_line(&in[offset], len);
     }
 
-    struct timeval now;
-    gettimeofday(&now, NULL);
+    offset += len + 1;
+  }
+
+  if (offset > 0) {
+    in_len -= offset;
+    memmove(in, &in[offset], in_len);
+  } else if (in_len == sizeof(in)) {
+    in_len = 0;
+    in_overflow = true;
+  }
+}
+
+int svr_ipcctrl::get_sfd(void) { return sfd; }
+
+void svr_ipcctrl::greet(void) { out.append(hello, sizeof(hello)); }
+
+bool svr_ipcctrl::read_input(void) {
+  while (true) {
+    ssize_t len = recv(sfd, &in[in_len], sizeof(in) - in_len, 0);
+
+    if (len > 0) {
+      in_len += len;
+      gettimeofday(&last_action, NULL);
+
+      // Every complete command in the input is answered in order. The
+      // results are sent together by the caller.
+      process_input();
+    } else if (len == 0) {
+      return false;
+    } else {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+  }
+}
 
-    if (now.tv_sec - last_action.tv_sec >= 5) {
+bool svr_ipcctrl::idle_timeout_exceeded(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  return now.tv_sec - last_action.tv_sec >= IPC_IDLE_TIMEOUT_SEC;
+}
+
+void svr_ipcctrl::execute(void *sthread) {
+  if (sfd == -1) return;
+
+  eh = eh_init();
+  eh_add_fd(eh, sfd);
+
+  greet();
+
+  if (!flush()) {
+    return;
+  }
+
+  while (sthread_isterminated(sthread) == 0) {
+    eh_wait(eh, 1000000);
+
+    if (!read_input() || !flush() || idle_timeout_exceeded()) {
       sthread_terminate(sthread);
       break;
     }
@@ -930,5 +1200,7 @@ void svr_ipcctrl::execute(void *sthread) {
 svr_ipcctrl::~svr_ipcctrl() {
   if (sfd != -1) close(sfd);
 
-  eh_free(eh);
+  if (eh) {
+    eh_free(eh);
+  }
 }
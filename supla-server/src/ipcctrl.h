@@ -24,9 +24,17 @@
 #define IPC_AUTH_LEVEL_OAUTH_USER 1
 #define IPC_AUTH_LEVEL_SUPERUSER 2
 
+#include <sys/time.h>
+#include <string>
+
 #include "eh.h"
 
 #define IPC_BUFFER_SIZE 4096
+#define IPC_MULTI_GET_MAX 256
+// The longest command line is a MULTI-GET with IPC_MULTI_GET_MAX pairs of
+// IDs, each up to 11 characters long plus a separator.
+#define IPC_LINE_MAXSIZE (IPC_MULTI_GET_MAX * 24 + 128)
+#define IPC_IDLE_TIMEOUT_SEC 5
 
 class svr_ipcctrl {
  private:
@@ -36,7 +44,10 @@ class svr_ipcctrl {
   char *AlexaCorrelationToken = NULL;
   char *GoogleRequestId = NULL;
 
-  bool match_command(const char *cmd, int len);
+  void process_input(void);
+  void process_line(const char *line, int len);
+  void dispatch(int id, const char *cmd);
+  void multi_get(const char *cmd);
   char *cut(const char *cmd, const char *var);
   void free_correlation_token();
   void cut_correlation_token(const char *cmd);
@@ -62,15 +73,42 @@ class svr_ipcctrl {
   void on_device_deleted(const char *cmd);
   void on_device_settings_changed(const char *cmd);
 
+  void send_buffer(void);
   void send_result(const char *result);
   void send_result(const char *result, int i);
   void send_result(const char *result, double i);
 
-  char buffer[IPC_BUFFER_SIZE];
+  char buffer[IPC_LINE_MAXSIZE];
+
+  // Commands are separated by new lines. Any number of them can arrive in a
+  // single read and their results are sent back together, in order.
+  char in[IPC_LINE_MAXSIZE];
+  int in_len;
+  bool in_overflow;
+  // Set while MULTI-GET runs the getters, whose results must be separated.
+  bool in_multi_get;
+  std::string out;
+  struct timeval last_action;
 
  public:
   explicit svr_ipcctrl(int sfd);
+  // Serves the connection in the calling thread until it is closed.
   void execute(void *sthread);
+
+  // Non-blocking steps of execute() for an event loop that serves many
+  // connections at once.
+  int get_sfd(void);
+  void greet(void);
+  // Reads and handles all the commands available without blocking. Returns
+  // false if the connection has been closed by the peer or has failed.
+  bool read_input(void);
+  // Returns 1 if all the results have been sent, 0 if the socket is full and
+  // -1 on error.
+  int send_output(void);
+  // Sends all the results, waiting for the socket for up to 1 s at a time.
+  bool flush(void);
+  bool idle_timeout_exceeded(void);
+
   virtual ~svr_ipcctrl();
 };
 
@@ -130,6 +130,7 @@ enum MQTTErrors mqtt_init(struct mqtt_client *client,
     client->number_of_timeouts = 0;
     client->number_of_keep_alives = 0;
     client->typical_response_time = -1.0;
+    client->session_present = -1;
     client->publish_response_callback = publish_response_callback;
     client->pid_lfsr = 0;
     client->send_offset = 0;
@@ -163,6 +164,7 @@ void mqtt_init_reconnect(struct mqtt_client *client,
     client->number_of_timeouts = 0;
     client->number_of_keep_alives = 0;
     client->typical_response_time = -1.0;
+    client->session_present = -1;
     client->publish_response_callback = publish_response_callback;
     client->send_offset = 0;
 
@@ -178,6 +180,7 @@ void mqtt_reinit(struct mqtt_client* client,
 {
     client->error = MQTT_ERROR_CONNECT_NOT_CALLED;
     client->socketfd = socketfd;
+    client->session_present = -1;
 
     mqtt_mq_init(&client->mq, sendbuf, sendbufsz);
 
@@ -733,6 +736,7 @@ ssize_t __mqtt_recv(struct mqtt_client *client)
                     }
                     break;
                 }
+                client->session_present = response.decoded.connack.session_present_flag;
                 break;
             case MQTT_CONTROL_PUBLISH:
                 /* stage response, none if qos==0, PUBACK if qos==1, PUBREC if qos==2 */
@@ -1153,6 +1153,13 @@ struct mqtt_client {
      */
     double typical_response_time;
 
+    /**
+     * @brief The session present flag of the last accepted CONNACK.
+     *
+     * @note The value is -1 until the broker accepts the connection.
+     */
+    int session_present;
+
     /**
      * @brief The callback that is called whenever a publish is received from the broker.
      * 
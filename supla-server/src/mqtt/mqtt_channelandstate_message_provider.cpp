@@ -76,10 +76,25 @@ void supla_mqtt_channelandstate_message_provider::init_providers_if_needed(
     void) {
   if (channel_message_provider == NULL) {
     channel_message_provider = new supla_mqtt_channel_message_provider();
+    channel_message_provider->set_message_buffer(get_message_buffer());
   }
 
   if (state_message_provider == NULL) {
     state_message_provider = new supla_mqtt_state_message_provider();
+    state_message_provider->set_message_buffer(get_message_buffer());
+  }
+}
+
+void supla_mqtt_channelandstate_message_provider::set_message_buffer(
+    supla_mqtt_message_buffer *message_buffer) {
+  supla_mqtt_message_provider::set_message_buffer(message_buffer);
+
+  if (channel_message_provider) {
+    channel_message_provider->set_message_buffer(message_buffer);
+  }
+
+  if (state_message_provider) {
+    state_message_provider->set_message_buffer(message_buffer);
   }
 }
 
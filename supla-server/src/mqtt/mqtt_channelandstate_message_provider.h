@@ -35,6 +35,7 @@ class supla_mqtt_channelandstate_message_provider
   virtual bool get_message_at_index(unsigned short index,
                                     const char *topic_prefix, char **topic_name,
                                     void **message, size_t *message_size);
+  virtual void set_message_buffer(supla_mqtt_message_buffer *message_buffer);
   void set_data_row(_mqtt_db_data_row_channel_t *row);
 };
 
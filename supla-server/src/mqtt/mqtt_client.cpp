@@ -34,6 +34,11 @@ void supla_mqtt_client::on_connected(supla_mqtt_client *client_instance) {
   client_instance->on_connected();
 }
 
+// static
+void supla_mqtt_client::on_disconnected(supla_mqtt_client *client_instance) {
+  client_instance->on_disconnected();
+}
+
 // static
 void supla_mqtt_client::on_message_received(
     supla_mqtt_client *client_instance, const _received_mqtt_message_t *msg) {
@@ -59,13 +64,18 @@ void supla_mqtt_client::job(void *sthread) {
   library_adapter->set_on_message_received_callback(
       supla_mqtt_client::on_message_received);
   library_adapter->set_on_connected_callback(supla_mqtt_client::on_connected);
+  library_adapter->set_on_disconnected_callback(
+      supla_mqtt_client::on_disconnected);
 
   library_adapter->client_connect(this);
 
   while (!sthread_isterminated(sthread)) {
     library_adapter->iterate();
 
-    if (library_adapter->is_connected()) {
+    // Until the broker takes the queued messages, the new ones wait in the
+    // datasource.
+    if (library_adapter->is_connected() &&
+        !library_adapter->is_output_blocked()) {
       if (on_iterate()) {
         library_adapter->raise_event();
       }
@@ -78,9 +88,21 @@ void supla_mqtt_client::job(void *sthread) {
 }
 
 void supla_mqtt_client::on_connected(void) {
+  // A present session only means the broker kept the subscriptions and the
+  // QoS 1/2 state. It says nothing about the retained QoS 0 messages, so the
+  // datasource still republishes whatever it could not confirm.
+  if (!library_adapter->is_session_present()) {
+    datasource->on_broker_session_lost();
+  }
   datasource->on_broker_connected();
 }
 
+void supla_mqtt_client::on_disconnected(void) {
+  datasource->on_broker_disconnected();
+}
+
+bool supla_mqtt_client::is_session_persistent(void) { return false; }
+
 bool supla_mqtt_client::subscribe(const char *topic_name,
                                   QOS_Level max_qos_level) {
   return !sthread_isterminated(sthread) && library_adapter->is_connected() &&
@@ -31,6 +31,7 @@ class supla_mqtt_client {
   void job(void *sthread);
 
   static void on_connected(supla_mqtt_client *client_instance);
+  static void on_disconnected(supla_mqtt_client *client_instance);
   static void on_message_received(supla_mqtt_client *client_instance,
                                   const _received_mqtt_message_t *msg);
 
@@ -40,6 +41,7 @@ class supla_mqtt_client {
   supla_mqtt_client_library_adapter *library_adapter;
 
   virtual void on_connected(void);
+  virtual void on_disconnected(void);
   virtual void on_message_received(const _received_mqtt_message_t *msg) = 0;
   virtual bool on_iterate(void) = 0;
 
@@ -60,6 +62,7 @@ class supla_mqtt_client {
   virtual ssize_t get_send_buffer_size(void) = 0;
   virtual ssize_t get_recv_buffer_size(void) = 0;
   virtual void get_client_id(char *clientId, size_t len) = 0;
+  virtual bool is_session_persistent(void);
 
   virtual void on_userdata_changed(int user_id);
   virtual void on_devicedata_changed(int user_id, int device_id);
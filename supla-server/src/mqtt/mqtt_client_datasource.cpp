@@ -71,19 +71,20 @@ bool supla_mqtt_client_datasource::context_should_be_opened(void) {
       context = supla_mqtt_ds_context(MQTTDS_SCOPE_FULL);
       result = true;
     } else if (user_queue.size()) {
-      context = supla_mqtt_ds_context(MQTTDS_SCOPE_USER, user_queue.front());
-      user_queue.pop_front();
+      int user_id = 0;
+      user_queue.pop_front(&user_id);
+      context = supla_mqtt_ds_context(MQTTDS_SCOPE_USER, user_id);
       result = true;
     } else if (device_queue.size()) {
-      _mqtt_ds_device_id_t id = device_queue.front();
-      device_queue.pop_front();
+      _mqtt_ds_device_id_t id = {};
+      device_queue.pop_front(&id);
 
       context =
           supla_mqtt_ds_context(MQTTDS_SCOPE_DEVICE, id.user_id, id.device_id);
       result = true;
     } else if (channel_queue.size()) {
-      _mqtt_ds_channel_id_t id = channel_queue.front();
-      channel_queue.pop_front();
+      _mqtt_ds_channel_id_t id = {};
+      channel_queue.pop_front(&id);
 
       context = supla_mqtt_ds_context(MQTTDS_SCOPE_CHANNEL_STATE, id.user_id,
                                       id.device_id, id.channel_id);
@@ -158,38 +159,31 @@ bool supla_mqtt_client_datasource::fetch(char **topic_name) {
   return fetch(topic_name, NULL, NULL);
 }
 
-bool supla_mqtt_client_datasource::is_user_queued(int user_id) {
-  for (std::list<int>::iterator it = user_queue.begin(); it != user_queue.end();
-       ++it) {
-    if (*it == user_id) {
-      return true;
-    }
-  }
+bool supla_mqtt_client_datasource::is_fetch_result_allocated(void) {
+  return true;
+}
 
-  return false;
+// static
+bool supla_mqtt_client_datasource::device_of_user(
+    const _mqtt_ds_device_id_t &id, void *user_id) {
+  return id.user_id == *static_cast<int *>(user_id);
 }
 
-bool supla_mqtt_client_datasource::is_device_queued(int device_id) {
-  for (std::list<_mqtt_ds_device_id_t>::iterator it = device_queue.begin();
-       it != device_queue.end(); ++it) {
-    if ((*it).device_id == device_id) {
-      return true;
-    }
-  }
+// static
+bool supla_mqtt_client_datasource::channel_of_user(
+    const _mqtt_ds_channel_id_t &id, void *user_id) {
+  return id.user_id == *static_cast<int *>(user_id);
+}
 
-  return false;
+// static
+bool supla_mqtt_client_datasource::channel_of_device(
+    const _mqtt_ds_channel_id_t &id, void *device_id) {
+  return id.device_id == *static_cast<int *>(device_id);
 }
 
-bool supla_mqtt_client_datasource::is_channel_queued(int channel_id) {
-  for (std::list<_mqtt_ds_channel_id_t>::iterator it = channel_queue.begin();
-       it != channel_queue.end(); ++it) {
-    if ((*it).channel_id == channel_id) {
-      return true;
-    }
-  }
+void supla_mqtt_client_datasource::on_broker_session_lost(void) {}
 
-  return false;
-}
+void supla_mqtt_client_datasource::on_broker_disconnected(void) {}
 
 void supla_mqtt_client_datasource::on_broker_connected(void) {
   supla_mqtt_ds_context context(MQTTDS_SCOPE_FULL);
@@ -216,24 +210,9 @@ void supla_mqtt_client_datasource::on_userdata_changed(int user_id) {
   }
 
   lck_lock(lck);
-  if (!all_data_expected && !is_user_queued(user_id)) {
-    user_queue.push_back(user_id);
-
-    for (std::list<_mqtt_ds_device_id_t>::iterator it = device_queue.begin();
-         it != device_queue.end(); ++it) {
-      if ((*it).user_id == user_id) {
-        it = device_queue.erase(it);
-        --it;
-      }
-    }
-
-    for (std::list<_mqtt_ds_channel_id_t>::iterator it = channel_queue.begin();
-         it != channel_queue.end(); ++it) {
-      if ((*it).user_id == user_id) {
-        it = channel_queue.erase(it);
-        --it;
-      }
-    }
+  if (!all_data_expected && user_queue.push_back(user_id, user_id)) {
+    device_queue.remove_if(device_of_user, &user_id);
+    channel_queue.remove_if(channel_of_user, &user_id);
   }
   lck_unlock(lck);
 }
@@ -247,17 +226,10 @@ void supla_mqtt_client_datasource::on_devicedata_changed(int user_id,
   }
 
   lck_lock(lck);
-  if (!all_data_expected && !is_user_queued(user_id) &&
-      !is_device_queued(device_id)) {
+  if (!all_data_expected && !user_queue.contains(user_id)) {
     _mqtt_ds_device_id_t id = {.user_id = user_id, .device_id = device_id};
-    device_queue.push_back(id);
-
-    for (std::list<_mqtt_ds_channel_id_t>::iterator it = channel_queue.begin();
-         it != channel_queue.end(); ++it) {
-      if ((*it).user_id == user_id && (*it).device_id == device_id) {
-        it = channel_queue.erase(it);
-        --it;
-      }
+    if (device_queue.push_back(device_id, id)) {
+      channel_queue.remove_if(channel_of_device, &device_id);
     }
   }
   lck_unlock(lck);
@@ -274,8 +246,9 @@ void supla_mqtt_client_datasource::on_channelstate_changed(int user_id,
   }
 
   lck_lock(lck);
-  if (!all_data_expected && !is_user_queued(user_id) &&
-      !is_device_queued(device_id) && !is_channel_queued(channel_id)) {
+  if (!all_data_expected && !user_queue.contains(user_id) &&
+      !device_queue.contains(device_id) &&
+      !channel_queue.contains(channel_id)) {
     struct timeval now;
     gettimeofday(&now, NULL);
 
@@ -283,7 +256,7 @@ void supla_mqtt_client_datasource::on_channelstate_changed(int user_id,
                                 .device_id = device_id,
                                 .channel_id = channel_id,
                                 .time = now};
-    channel_queue.push_back(id);
+    channel_queue.push_back(channel_id, id);
   }
   lck_unlock(lck);
 }
@@ -296,3 +269,20 @@ bool supla_mqtt_client_datasource::is_context_open(void) {
 
   return result;
 }
+
+size_t supla_mqtt_client_datasource::get_queue_size(size_t *max_size) {
+  lck_lock(lck);
+  size_t result =
+      user_queue.size() + device_queue.size() + channel_queue.size();
+
+  if (max_size) {
+    *max_size = user_queue.get_max_size() + device_queue.get_max_size() +
+                channel_queue.get_max_size();
+    user_queue.reset_max_size();
+    device_queue.reset_max_size();
+    channel_queue.reset_max_size();
+  }
+  lck_unlock(lck);
+
+  return result;
+}
@@ -20,11 +20,11 @@
 #define MQTT_CLIENT_DATASOURCE_H_
 
 #include <stdlib.h>
-#include <list>
 #include "database.h"
 #include "mqtt_client_library_adapter.h"
 #include "mqtt_client_settings.h"
 #include "mqtt_ds_context.h"
+#include "mqtt_ds_queue.h"
 
 typedef struct {
   int user_id;
@@ -47,13 +47,14 @@ class supla_mqtt_client_datasource {
   supla_mqtt_ds_context context;
 
   bool all_data_expected;
-  std::list<int> user_queue;
-  std::list<_mqtt_ds_device_id_t> device_queue;
-  std::list<_mqtt_ds_channel_id_t> channel_queue;
+  supla_mqtt_ds_queue<int> user_queue;
+  supla_mqtt_ds_queue<_mqtt_ds_device_id_t> device_queue;
+  supla_mqtt_ds_queue<_mqtt_ds_channel_id_t> channel_queue;
 
-  bool is_user_queued(int user_id);
-  bool is_device_queued(int device_id);
-  bool is_channel_queued(int channel_id);
+  static bool device_of_user(const _mqtt_ds_device_id_t &id, void *user_id);
+  static bool channel_of_user(const _mqtt_ds_channel_id_t &id, void *user_id);
+  static bool channel_of_device(const _mqtt_ds_channel_id_t &id,
+                                void *device_id);
 
   bool context_should_be_opened(void);
   void context_open(void);
@@ -79,7 +80,12 @@ class supla_mqtt_client_datasource {
   virtual void thread_cleanup(void);
   bool fetch(char **topic_name, void **message, size_t *message_size);
   bool fetch(char **topic_name);
+  // Whether the caller frees the topic name and the message returned by
+  // fetch(). Otherwise they stay valid until the next fetch().
+  virtual bool is_fetch_result_allocated(void);
 
+  virtual void on_broker_session_lost(void);
+  virtual void on_broker_disconnected(void);
   virtual void on_broker_connected(void);
   virtual void on_userdata_changed(int user_id);
   virtual void on_devicedata_changed(int user_id, int device_id);
@@ -87,6 +93,11 @@ class supla_mqtt_client_datasource {
                                        int channel_id);
 
   bool is_context_open(void);
+
+  // Returns the number of queued users, devices and channels. max_size
+  // receives the sum of the peak sizes of these queues since the previous
+  // call.
+  size_t get_queue_size(size_t *max_size);
 };
 
 #endif /*MQTT_CLIENT_DATASOURCE_H_*/
@@ -67,3 +67,8 @@ void supla_mqtt_client_ini_settings::getClientId(char *clientId, size_t len,
 int supla_mqtt_client_ini_settings::getKeepAlive(void) {
   return scfg_int(CFG_MQTT_KEEP_ALIVE_SEC);
 }
+
+int supla_mqtt_client_ini_settings::getPublisherCount(void) {
+  int count = scfg_int(CFG_MQTT_PUBLISHER_COUNT);
+  return count > 0 ? count : 1;
+}
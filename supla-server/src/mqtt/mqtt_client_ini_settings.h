@@ -34,6 +34,7 @@ class supla_mqtt_client_ini_settings : public supla_mqtt_client_settings {
   virtual bool isSSLEnabled(void);
   virtual void getClientId(char *clientId, size_t len, const char *suffix);
   virtual int getKeepAlive(void);
+  int getPublisherCount(void);
 };
 
 #endif /*MQTT_CLIENT_INI_SETTINGS_H_*/
@@ -23,9 +23,18 @@ supla_mqtt_client_library_adapter::supla_mqtt_client_library_adapter(
   this->settings = settings;
   on_message_received_callback = NULL;
   on_connected_callback = NULL;
+  on_disconnected_callback = NULL;
 }
 supla_mqtt_client_library_adapter::~supla_mqtt_client_library_adapter(void) {}
 
+bool supla_mqtt_client_library_adapter::is_session_present(void) {
+  return false;
+}
+
+bool supla_mqtt_client_library_adapter::is_output_blocked(void) {
+  return false;
+}
+
 void supla_mqtt_client_library_adapter::set_on_message_received_callback(
     _on_message_received_cb cb) {
   on_message_received_callback = cb;
@@ -35,3 +44,8 @@ void supla_mqtt_client_library_adapter::set_on_connected_callback(
     _on_connected_cb cb) {
   on_connected_callback = cb;
 }
+
+void supla_mqtt_client_library_adapter::set_on_disconnected_callback(
+    _on_disconnected_cb cb) {
+  on_disconnected_callback = cb;
+}
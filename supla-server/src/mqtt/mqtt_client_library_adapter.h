@@ -41,12 +41,14 @@ typedef struct {
 typedef void (*_on_message_received_cb)(supla_mqtt_client *client_instance,
                                         const _received_mqtt_message_t *msg);
 typedef void (*_on_connected_cb)(supla_mqtt_client *client_instance);
+typedef void (*_on_disconnected_cb)(supla_mqtt_client *client_instance);
 
 class supla_mqtt_client_library_adapter {
  protected:
   supla_mqtt_client_settings *settings;
   _on_message_received_cb on_message_received_callback;
   _on_connected_cb on_connected_callback;
+  _on_disconnected_cb on_disconnected_callback;
 
  public:
   explicit supla_mqtt_client_library_adapter(
@@ -63,9 +65,17 @@ class supla_mqtt_client_library_adapter {
   virtual bool publish(const char *topic_name, const void *message,
                        size_t message_size, QOS_Level qos_level,
                        bool retain) = 0;
+  // Whether the broker resumed the session of the last connection instead of
+  // starting a new one.
+  virtual bool is_session_present(void);
+  // Whether the socket stopped accepting data. New messages should wait until
+  // the queued ones are sent.
+  virtual bool is_output_blocked(void);
 
   virtual void set_on_message_received_callback(_on_message_received_cb cb);
   virtual void set_on_connected_callback(_on_connected_cb cb);
+  // Called when an established connection breaks, before the reconnect.
+  virtual void set_on_disconnected_callback(_on_disconnected_cb cb);
 };
 
 #endif /*MQTT_CLIENT_LIBRARY_ADAPTER_INTERFACE_H_*/
@@ -17,7 +17,9 @@
  */
 
 #include <mqtt_client_suite.h>
+#include <sys/time.h>
 #include <cstddef>
+#include "log.h"
 #include "tools.h"
 
 // static
@@ -41,16 +43,27 @@ void supla_mqtt_client_suite::globalInstanceRelease(void) {
 }
 
 supla_mqtt_client_suite::supla_mqtt_client_suite(void) {
+  last_metric_log_time_sec = 0;
   ini_settings = new supla_mqtt_client_ini_settings();
   if (ini_settings->isMQTTEnabled()) {
-    library_adapter_pub = new supla_mqttc_library_adapter(ini_settings);
-    library_adapter_unpub = new supla_mqttc_library_adapter(ini_settings);
-    library_adapter_sub = new supla_mqttc_library_adapter(ini_settings);
+    int publisher_count = ini_settings->getPublisherCount();
 
-    publisher_ds = new supla_mqtt_publisher_datasource(ini_settings);
+    for (int a = 0; a < publisher_count; a++) {
+      supla_mqttc_library_adapter *library_adapter =
+          new supla_mqttc_library_adapter(ini_settings);
 
-    publisher = new supla_mqtt_publisher(library_adapter_pub, ini_settings,
-                                         publisher_ds);
+      supla_mqtt_publisher_datasource *publisher_ds =
+          new supla_mqtt_publisher_datasource(ini_settings);
+      publisher_ds->set_shard(a, publisher_count);
+
+      library_adapters_pub.push_back(library_adapter);
+      publisher_datasources.push_back(publisher_ds);
+      publishers.push_back(new supla_mqtt_publisher(
+          library_adapter, ini_settings, publisher_ds, a));
+    }
+
+    library_adapter_unpub = new supla_mqttc_library_adapter(ini_settings);
+    library_adapter_sub = new supla_mqttc_library_adapter(ini_settings);
 
     unpublisher_ds = new supla_mqtt_unpublisher_datasource(ini_settings);
 
@@ -62,11 +75,8 @@ supla_mqtt_client_suite::supla_mqtt_client_suite(void) {
     subscriber = new supla_mqtt_subscriber(library_adapter_sub, ini_settings,
                                            subscriber_ds, value_setter);
   } else {
-    library_adapter_pub = NULL;
     library_adapter_unpub = NULL;
     library_adapter_sub = NULL;
-    publisher_ds = NULL;
-    publisher = NULL;
     unpublisher_ds = NULL;
     unpublisher = NULL;
     value_setter = NULL;
@@ -76,11 +86,12 @@ supla_mqtt_client_suite::supla_mqtt_client_suite(void) {
 }
 
 supla_mqtt_client_suite::~supla_mqtt_client_suite(void) {
-  if (publisher) {
-    publisher->stop();
-    delete publisher;
-    publisher = NULL;
+  for (std::vector<supla_mqtt_publisher *>::iterator it = publishers.begin();
+       it != publishers.end(); ++it) {
+    (*it)->stop();
+    delete *it;
   }
+  publishers.clear();
 
   if (unpublisher) {
     unpublisher->stop();
@@ -94,10 +105,12 @@ supla_mqtt_client_suite::~supla_mqtt_client_suite(void) {
     subscriber = NULL;
   }
 
-  if (library_adapter_pub) {
-    delete library_adapter_pub;
-    library_adapter_pub = NULL;
+  for (std::vector<supla_mqttc_library_adapter *>::iterator it =
+           library_adapters_pub.begin();
+       it != library_adapters_pub.end(); ++it) {
+    delete *it;
   }
+  library_adapters_pub.clear();
 
   if (library_adapter_unpub) {
     delete library_adapter_unpub;
@@ -109,10 +122,12 @@ supla_mqtt_client_suite::~supla_mqtt_client_suite(void) {
     library_adapter_sub = NULL;
   }
 
-  if (publisher_ds) {
-    delete publisher_ds;
-    publisher_ds = NULL;
+  for (std::vector<supla_mqtt_publisher_datasource *>::iterator it =
+           publisher_datasources.begin();
+       it != publisher_datasources.end(); ++it) {
+    delete *it;
   }
+  publisher_datasources.clear();
 
   if (unpublisher_ds) {
     delete unpublisher_ds;
@@ -135,9 +150,19 @@ supla_mqtt_client_suite::~supla_mqtt_client_suite(void) {
   }
 }
 
+supla_mqtt_publisher *supla_mqtt_client_suite::get_publisher(int UserID) {
+  if (publishers.empty()) {
+    return NULL;
+  }
+
+  return publishers[supla_mqtt_publisher_datasource::get_shard(
+      UserID, publishers.size())];
+}
+
 void supla_mqtt_client_suite::start(void) {
-  if (publisher) {
-    publisher->start();
+  for (std::vector<supla_mqtt_publisher *>::iterator it = publishers.begin();
+       it != publishers.end(); ++it) {
+    (*it)->start();
   }
 
   if (unpublisher) {
@@ -150,8 +175,9 @@ void supla_mqtt_client_suite::start(void) {
 }
 
 void supla_mqtt_client_suite::stop(void) {
-  if (publisher) {
-    publisher->stop();
+  for (std::vector<supla_mqtt_publisher *>::iterator it = publishers.begin();
+       it != publishers.end(); ++it) {
+    (*it)->stop();
   }
 
   if (unpublisher) {
@@ -165,6 +191,7 @@ void supla_mqtt_client_suite::stop(void) {
 
 void supla_mqtt_client_suite::onUserDataChanged(int UserID) {
   if (st_app_terminate == 0) {
+    supla_mqtt_publisher *publisher = get_publisher(UserID);
     if (publisher) {
       publisher->on_userdata_changed(UserID);
     }
@@ -176,6 +203,7 @@ void supla_mqtt_client_suite::onUserDataChanged(int UserID) {
 }
 
 void supla_mqtt_client_suite::onDeviceRegistered(int UserID, int DeviceID) {
+  supla_mqtt_publisher *publisher = get_publisher(UserID);
   if (publisher && st_app_terminate == 0) {
     publisher->on_devicedata_changed(UserID, DeviceID);
   }
@@ -191,6 +219,7 @@ void supla_mqtt_client_suite::onDeviceSettingsChanged(int UserID,
     unpublisher->on_devicedata_changed(UserID, DeviceID);
   }
 
+  supla_mqtt_publisher *publisher = get_publisher(UserID);
   if (publisher) {
     publisher->on_devicedata_changed(UserID, DeviceID);
   }
@@ -198,6 +227,7 @@ void supla_mqtt_client_suite::onDeviceSettingsChanged(int UserID,
 
 void supla_mqtt_client_suite::onChannelStateChanged(int UserID, int DeviceID,
                                                     int ChannelID) {
+  supla_mqtt_publisher *publisher = get_publisher(UserID);
   if (publisher && st_app_terminate == 0) {
     publisher->on_channelstate_changed(UserID, DeviceID, ChannelID);
   }
@@ -221,3 +251,38 @@ void supla_mqtt_client_suite::onDeviceDeleted(int UserID, int DeviceID) {
     unpublisher->on_device_deleted(UserID, DeviceID);
   }
 }
+
+void supla_mqtt_client_suite::logMetrics(unsigned int min_interval_sec) {
+  if (publisher_datasources.empty() || unpublisher_ds == NULL) {
+    return;
+  }
+
+  if (min_interval_sec > 0) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    if (last_metric_log_time_sec == 0) {
+      last_metric_log_time_sec = now.tv_sec;
+    }
+    if (now.tv_sec - last_metric_log_time_sec < min_interval_sec) {
+      return;
+    }
+    last_metric_log_time_sec = now.tv_sec;
+  }
+
+  size_t pub_max = 0;
+  size_t pub_size = 0;
+  for (std::vector<supla_mqtt_publisher_datasource *>::iterator it =
+           publisher_datasources.begin();
+       it != publisher_datasources.end(); ++it) {
+    size_t max_size = 0;
+    pub_size += (*it)->get_queue_size(&max_size);
+    pub_max += max_size;
+  }
+  size_t unpub_max = 0;
+  size_t unpub_size = unpublisher_ds->get_queue_size(&unpub_max);
+
+  supla_log(LOG_INFO,
+            "MQTT QUEUE METRICS: PUBLISHER[Queue Size: %zu, Peak: %zu] "
+            "UNPUBLISHER[Queue Size: %zu, Peak: %zu]",
+            pub_size, pub_max, unpub_size, unpub_max);
+}
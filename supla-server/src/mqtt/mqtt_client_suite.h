@@ -19,6 +19,7 @@
 #ifndef MQTT_CLIENT_SUITE_H_
 #define MQTT_CLIENT_SUITE_H_
 
+#include <vector>
 #include "mqtt_client_ini_settings.h"
 #include "mqtt_publisher.h"
 #include "mqtt_publisher_datasource.h"
@@ -36,18 +37,24 @@ class supla_mqtt_client_suite {
   supla_mqtt_client_ini_settings *ini_settings;
   supla_mqtt_value_setter *value_setter;
 
-  supla_mqttc_library_adapter *library_adapter_pub;
+  // One per shard of users. See supla_mqtt_publisher_datasource::get_shard.
+  std::vector<supla_mqttc_library_adapter *> library_adapters_pub;
+  std::vector<supla_mqtt_publisher_datasource *> publisher_datasources;
+  std::vector<supla_mqtt_publisher *> publishers;
+
   supla_mqttc_library_adapter *library_adapter_unpub;
   supla_mqttc_library_adapter *library_adapter_sub;
 
-  supla_mqtt_publisher_datasource *publisher_ds;
   supla_mqtt_unpublisher_datasource *unpublisher_ds;
   supla_mqtt_subscriber_datasource *subscriber_ds;
 
-  supla_mqtt_publisher *publisher;
   supla_mqtt_unpublisher *unpublisher;
   supla_mqtt_subscriber *subscriber;
 
+  unsigned long long last_metric_log_time_sec;
+
+  supla_mqtt_publisher *get_publisher(int UserID);
+
  public:
   static supla_mqtt_client_suite *globalInstance(void);
   static void globalInstanceRelease(void);
@@ -62,6 +69,7 @@ class supla_mqtt_client_suite {
   void beforeChannelFunctionChange(int UserID, int ChannelID);
   void beforeDeviceDelete(int UserID, int DeviceID);
   void onDeviceDeleted(int UserID, int DeviceID);
+  void logMetrics(unsigned int min_interval_sec);
 };
 
 #endif /*MQTT_CLIENT_SUITE_H_*/
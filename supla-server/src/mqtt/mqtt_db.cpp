@@ -86,6 +86,11 @@ typedef struct {
   my_bool channel_text_param3_is_null;
 } _mqtt_db_channelquery_t;
 
+// The same multiplicative hash as supla_mqtt_publisher_datasource::get_shard,
+// so the full load of a publisher reads only the users of its own shard.
+#define MQTT_DB_SHARD_CONDITION \
+  "(? <= 1 OR (((u.`id` * 2654435761) & 4294967295) >> 8) % ? = ?)"
+
 supla_mqtt_db::supla_mqtt_db(void) : svrdb() {
   userquery = NULL;
   devicequery = NULL;
@@ -162,7 +167,8 @@ void supla_mqtt_db::close_mqttenabledquery(void *query) {
 }
 
 void *supla_mqtt_db::open_userquery(int UserID, bool OnlyEnabled,
-                                    _mqtt_db_data_row_user_t *row) {
+                                    _mqtt_db_data_row_user_t *row, int Shard,
+                                    int ShardCount) {
   _mqtt_db_userquery_t *query =
       (_mqtt_db_userquery_t *)malloc(sizeof(_mqtt_db_userquery_t));
 
@@ -176,9 +182,9 @@ void *supla_mqtt_db::open_userquery(int UserID, bool OnlyEnabled,
   const char sql[] =
       "SELECT u.`id`, u.`email`, u.`timezone`, u.`short_unique_id` FROM "
       "`supla_user` u WHERE (? = 0 OR u.`mqtt_broker_enabled` = 1) AND (? = 0 "
-      "OR u.`id` = ?) ORDER BY u.`id`";
+      "OR u.`id` = ?) AND " MQTT_DB_SHARD_CONDITION " ORDER BY u.`id`";
 
-  MYSQL_BIND pbind[3];
+  MYSQL_BIND pbind[6];
   memset(pbind, 0, sizeof(pbind));
 
   int OE = OnlyEnabled ? 1 : 0;
@@ -192,7 +198,16 @@ void *supla_mqtt_db::open_userquery(int UserID, bool OnlyEnabled,
   pbind[2].buffer_type = MYSQL_TYPE_LONG;
   pbind[2].buffer = (char *)&UserID;
 
-  if (stmt_execute((void **)&query->stmt, sql, pbind, 3, true)) {
+  pbind[3].buffer_type = MYSQL_TYPE_LONG;
+  pbind[3].buffer = (char *)&ShardCount;
+
+  pbind[4].buffer_type = MYSQL_TYPE_LONG;
+  pbind[4].buffer = (char *)&ShardCount;
+
+  pbind[5].buffer_type = MYSQL_TYPE_LONG;
+  pbind[5].buffer = (char *)&Shard;
+
+  if (stmt_execute((void **)&query->stmt, sql, pbind, 6, true)) {
     MYSQL_BIND rbind[4];
     memset(rbind, 0, sizeof(rbind));
 
@@ -254,7 +269,8 @@ void supla_mqtt_db::close_userquery(void *query) {
 }
 
 void *supla_mqtt_db::open_devicequery(int UserID, int DeviceID,
-                                      _mqtt_db_data_row_device_t *row) {
+                                      _mqtt_db_data_row_device_t *row,
+                                      int Shard, int ShardCount) {
   _mqtt_db_devicequery_t *query =
       (_mqtt_db_devicequery_t *)malloc(sizeof(_mqtt_db_devicequery_t));
 
@@ -269,12 +285,13 @@ void *supla_mqtt_db::open_devicequery(int UserID, int DeviceID,
       "SELECT u.`short_unique_id`, d.`id`, d.`enabled`, l.`caption`, "
       "DATE_FORMAT(d.`last_connected`, '%Y-%m-%dT%TZ'), "
       "INET_NTOA(d.`last_ipv4`), d.`manufacturer_id`, d.`name`, "
-      "d.`protocol_version`, d.`software_version` FROM `supla_iodevice` d LEFT "
-      "JOIN `supla_user` u ON u.id = d.`user_id` LEFT JOIN `supla_location` l "
-      "ON l.id = d.`location_id` WHERE u.`mqtt_broker_enabled` = 1 AND (? = 0 "
-      "OR u.`id` = ?) AND (? = 0 OR d.`id` = ?) ORDER BY u.`id`, d.`id`";
+      "d.`protocol_version`, d.`software_version`, d.`user_id` FROM "
+      "`supla_iodevice` d LEFT JOIN `supla_user` u ON u.id = d.`user_id` LEFT "
+      "JOIN `supla_location` l ON l.id = d.`location_id` WHERE "
+      "u.`mqtt_broker_enabled` = 1 AND (? = 0 OR u.`id` = ?) AND (? = 0 OR "
+      "d.`id` = ?) AND " MQTT_DB_SHARD_CONDITION " ORDER BY u.`id`, d.`id`";
 
-  MYSQL_BIND pbind[4];
+  MYSQL_BIND pbind[7];
   memset(pbind, 0, sizeof(pbind));
 
   pbind[0].buffer_type = MYSQL_TYPE_LONG;
@@ -289,8 +306,17 @@ void *supla_mqtt_db::open_devicequery(int UserID, int DeviceID,
   pbind[3].buffer_type = MYSQL_TYPE_LONG;
   pbind[3].buffer = (char *)&DeviceID;
 
-  if (stmt_execute((void **)&query->stmt, sql, pbind, 4, true)) {
-    MYSQL_BIND rbind[10];
+  pbind[4].buffer_type = MYSQL_TYPE_LONG;
+  pbind[4].buffer = (char *)&ShardCount;
+
+  pbind[5].buffer_type = MYSQL_TYPE_LONG;
+  pbind[5].buffer = (char *)&ShardCount;
+
+  pbind[6].buffer_type = MYSQL_TYPE_LONG;
+  pbind[6].buffer = (char *)&Shard;
+
+  if (stmt_execute((void **)&query->stmt, sql, pbind, 7, true)) {
+    MYSQL_BIND rbind[11];
     memset(rbind, 0, sizeof(rbind));
 
     rbind[0].buffer_type = MYSQL_TYPE_STRING;
@@ -345,6 +371,10 @@ void *supla_mqtt_db::open_devicequery(int UserID, int DeviceID,
     rbind[9].length = &query->device_softver_len;
     rbind[9].is_null = &query->device_softver_is_null;
 
+    rbind[10].buffer_type = MYSQL_TYPE_LONG;
+    rbind[10].buffer = (char *)&query->row->user_id;
+    rbind[10].buffer_length = sizeof(query->row->user_id);
+
     if (mysql_stmt_bind_result(query->stmt, rbind)) {
       supla_log(LOG_ERR, "MySQL - stmt bind error - %s",
                 mysql_stmt_error(query->stmt));
@@ -395,7 +425,8 @@ void supla_mqtt_db::close_devicequery(void *query) {
 }
 
 void *supla_mqtt_db::open_channelquery(int UserID, int DeviceID, int ChannelID,
-                                       _mqtt_db_data_row_channel_t *row) {
+                                       _mqtt_db_data_row_channel_t *row,
+                                       int Shard, int ShardCount) {
   _mqtt_db_channelquery_t *query =
       (_mqtt_db_channelquery_t *)malloc(sizeof(_mqtt_db_channelquery_t));
 
@@ -417,8 +448,8 @@ void *supla_mqtt_db::open_channelquery(int UserID, int DeviceID, int ChannelID,
       "`supla_location` dl ON dl.`id` = d.`location_id` LEFT JOIN `supla_user` "
       "u ON u.id = c.`user_id` WHERE u.`mqtt_broker_enabled` = 1 AND email NOT "
       "LIKE '%#%' AND email NOT LIKE '%+%' AND (? = 0 OR u.`id` = ?) AND (? = "
-      "0 OR d.`id` = ?) AND (? = 0 OR c.`id` = ?) ORDER BY u.`id`, d.`id`, "
-      "c.`id`";
+      "0 OR d.`id` = ?) AND (? = 0 OR c.`id` = ?) AND " MQTT_DB_SHARD_CONDITION
+      " ORDER BY u.`id`, d.`id`, c.`id`";
 
   MYSQL_BIND pbind[9];
   memset(pbind, 0, sizeof(pbind));
@@ -441,7 +472,16 @@ void *supla_mqtt_db::open_channelquery(int UserID, int DeviceID, int ChannelID,
   pbind[5].buffer_type = MYSQL_TYPE_LONG;
   pbind[5].buffer = (char *)&ChannelID;
 
-  if (stmt_execute((void **)&query->stmt, sql, pbind, 6, true)) {
+  pbind[6].buffer_type = MYSQL_TYPE_LONG;
+  pbind[6].buffer = (char *)&ShardCount;
+
+  pbind[7].buffer_type = MYSQL_TYPE_LONG;
+  pbind[7].buffer = (char *)&ShardCount;
+
+  pbind[8].buffer_type = MYSQL_TYPE_LONG;
+  pbind[8].buffer = (char *)&Shard;
+
+  if (stmt_execute((void **)&query->stmt, sql, pbind, 9, true)) {
     MYSQL_BIND rbind[20];
     memset(rbind, 0, sizeof(rbind));
 
@@ -44,6 +44,7 @@ typedef struct {
   char device_name[SUPLA_DEVICE_NAME_MAXSIZE];
   int device_proto_version;
   char device_softver[SUPLA_SOFTVER_MAXSIZE];
+  int user_id;
 } _mqtt_db_data_row_device_t;
 
 typedef struct {
@@ -92,18 +93,23 @@ class supla_mqtt_db : public svrdb {
   int mqttenabledquery_fetch_row(void *query);
   void close_mqttenabledquery(void *query);
 
+  // ShardCount > 1 limits the rows to the users of the given shard. See
+  // supla_mqtt_publisher_datasource::get_shard.
   void *open_userquery(int UserID, bool OnlyEnabled,
-                       _mqtt_db_data_row_user_t *row);
+                       _mqtt_db_data_row_user_t *row, int Shard = 0,
+                       int ShardCount = 1);
   bool userquery_fetch_row(void *query);
   void close_userquery(void *query);
 
   void *open_devicequery(int UserID, int DeviceID,
-                         _mqtt_db_data_row_device_t *row);
+                         _mqtt_db_data_row_device_t *row, int Shard = 0,
+                         int ShardCount = 1);
   bool devicequery_fetch_row(void *query);
   void close_devicequery(void *query);
 
   void *open_channelquery(int UserID, int DeviceID, int ChannelID,
-                          _mqtt_db_data_row_channel_t *row);
+                          _mqtt_db_data_row_channel_t *row, int Shard = 0,
+                          int ShardCount = 1);
   bool channelquery_fetch_row(void *query);
   void close_channelquery(void *query);
 };
@@ -0,0 +1,98 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef MQTT_DS_QUEUE_H_
+#define MQTT_DS_QUEUE_H_
+
+#include <stddef.h>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// FIFO queue in which every key occurs at most once. Items leave the queue in
+// the order they were added. Checking whether a key is queued does not depend
+// on the queue length.
+template <typename T>
+class supla_mqtt_ds_queue {
+ private:
+  typedef std::list<std::pair<int, T> > items_t;
+
+  items_t items;
+  std::unordered_map<int, typename items_t::iterator> index;
+  size_t max_size;
+
+ public:
+  supla_mqtt_ds_queue(void) { max_size = 0; }
+
+  bool contains(int key) { return index.find(key) != index.end(); }
+
+  // Returns false if the key is already queued.
+  bool push_back(int key, const T &item) {
+    if (contains(key)) {
+      return false;
+    }
+
+    items.push_back(std::make_pair(key, item));
+    index[key] = --items.end();
+
+    if (items.size() > max_size) {
+      max_size = items.size();
+    }
+
+    return true;
+  }
+
+  bool pop_front(T *item) {
+    if (items.empty()) {
+      return false;
+    }
+
+    if (item) {
+      *item = items.front().second;
+    }
+
+    index.erase(items.front().first);
+    items.pop_front();
+    return true;
+  }
+
+  void remove_if(bool (*cond)(const T &item, void *arg), void *arg) {
+    for (typename items_t::iterator it = items.begin(); it != items.end();) {
+      if (cond(it->second, arg)) {
+        index.erase(it->first);
+        it = items.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void clear(void) {
+    items.clear();
+    index.clear();
+  }
+
+  size_t size(void) { return items.size(); }
+
+  // The largest size since the last reset_max_size().
+  size_t get_max_size(void) { return max_size; }
+
+  void reset_max_size(void) { max_size = items.size(); }
+};
+
+#endif /*MQTT_DS_QUEUE_H_*/
@@ -0,0 +1,142 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "mqtt_message_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mqtt_message_provider.h"
+
+supla_mqtt_message_buffer::supla_mqtt_message_buffer(void) {
+  topic_name = NULL;
+  topic_name_capacity = 0;
+  message = NULL;
+  message_capacity = 0;
+  topic_prefix = NULL;
+  suid = NULL;
+  user_prefix_len = 0;
+}
+
+supla_mqtt_message_buffer::~supla_mqtt_message_buffer(void) {
+  free(topic_name);
+  free(message);
+  free(topic_prefix);
+  free(suid);
+}
+
+// static
+bool supla_mqtt_message_buffer::reserve(void **buffer, size_t *capacity,
+                                        size_t size) {
+  if (size <= *capacity) {
+    return true;
+  }
+
+  size_t new_capacity = *capacity ? *capacity : 256;
+  while (new_capacity < size) {
+    new_capacity *= 2;
+  }
+
+  void *new_buffer = realloc(*buffer, new_capacity);
+  if (new_buffer == NULL) {
+    return false;
+  }
+
+  *buffer = new_buffer;
+  *capacity = new_capacity;
+  return true;
+}
+
+bool supla_mqtt_message_buffer::set_user_prefix(const char *topic_prefix,
+                                                const char *suid) {
+  if (topic_prefix == NULL) {
+    topic_prefix = "";
+  }
+
+  if (this->suid && this->topic_prefix && strcmp(this->suid, suid) == 0 &&
+      strcmp(this->topic_prefix, topic_prefix) == 0) {
+    return true;
+  }
+
+  free(this->topic_prefix);
+  free(this->suid);
+  this->topic_prefix = strndup(topic_prefix, MQTT_MAX_TOPIC_NAME_SIZE);
+  this->suid = strdup(suid);
+  user_prefix_len = 0;
+
+  if (this->topic_prefix == NULL || this->suid == NULL) {
+    return false;
+  }
+
+  bool with_prefix = this->topic_prefix[0] != 0;
+  int len = snprintf(NULL, 0, "%s%ssupla/%s/", this->topic_prefix,
+                     with_prefix ? "/" : "", this->suid);
+
+  if (len <= 0 || !reserve(reinterpret_cast<void **>(&topic_name),
+                           &topic_name_capacity, len + 1)) {
+    return false;
+  }
+
+  snprintf(topic_name, topic_name_capacity, "%s%ssupla/%s/",
+           this->topic_prefix, with_prefix ? "/" : "", this->suid);
+  user_prefix_len = len;
+  return true;
+}
+
+char *supla_mqtt_message_buffer::format_topic_name(const char *topic_prefix,
+                                                   const char *suid,
+                                                   const char *format,
+                                                   va_list args) {
+  if (suid == NULL || format == NULL || !set_user_prefix(topic_prefix, suid)) {
+    return NULL;
+  }
+
+  // The user prefix stays at the beginning of the buffer, the rest of the
+  // topic name is formatted right after it.
+  va_list args_copy;
+  va_copy(args_copy, args);
+  int len = vsnprintf(&topic_name[user_prefix_len],
+                      topic_name_capacity - user_prefix_len, format, args_copy);
+  va_end(args_copy);
+
+  if (len <= 0) {
+    return NULL;
+  }
+
+  if (user_prefix_len + len >= topic_name_capacity) {
+    if (!reserve(reinterpret_cast<void **>(&topic_name), &topic_name_capacity,
+                 user_prefix_len + len + 1)) {
+      return NULL;
+    }
+
+    vsnprintf(&topic_name[user_prefix_len],
+              topic_name_capacity - user_prefix_len, format, args);
+  }
+
+  return topic_name;
+}
+
+void *supla_mqtt_message_buffer::set_message(const void *message,
+                                             size_t size) {
+  if (message == NULL ||
+      !reserve(&this->message, &message_capacity, size ? size : 1)) {
+    return NULL;
+  }
+
+  memcpy(this->message, message, size);
+  return this->message;
+}
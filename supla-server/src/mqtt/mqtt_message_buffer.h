@@ -0,0 +1,53 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef MQTT_MESSAGE_BUFFER_H_
+#define MQTT_MESSAGE_BUFFER_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+
+// Reusable memory for the topic name and the message that a message provider
+// creates. The buffers grow to the longest topic and message seen so far and
+// are overwritten by the next message. The "<prefix>/supla/<suid>/" part of
+// the topic is formatted once for a user and copied until the user changes.
+class supla_mqtt_message_buffer {
+ private:
+  char *topic_name;
+  size_t topic_name_capacity;
+  void *message;
+  size_t message_capacity;
+
+  char *topic_prefix;
+  char *suid;
+  size_t user_prefix_len;
+
+  static bool reserve(void **buffer, size_t *capacity, size_t size);
+  bool set_user_prefix(const char *topic_prefix, const char *suid);
+
+ public:
+  supla_mqtt_message_buffer(void);
+  virtual ~supla_mqtt_message_buffer(void);
+
+  // Returns NULL if the formatted part of the topic name is empty.
+  char *format_topic_name(const char *topic_prefix, const char *suid,
+                          const char *format, va_list args);
+  void *set_message(const void *message, size_t size);
+};
+
+#endif /*MQTT_MESSAGE_BUFFER_H_*/
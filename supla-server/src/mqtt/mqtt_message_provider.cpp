@@ -23,6 +23,7 @@
 
 supla_mqtt_message_provider::supla_mqtt_message_provider(void) {
   this->index = 0;
+  this->message_buffer = NULL;
 }
 
 supla_mqtt_message_provider::~supla_mqtt_message_provider(void) {}
@@ -42,6 +43,30 @@ bool supla_mqtt_message_provider::create_message(
   va_list args;
   memset(&args, 0, sizeof(va_list));
 
+  if (message_buffer) {
+    va_start(args, topic_name_in);
+    *topic_name_out = message_buffer->format_topic_name(topic_prefix, suid,
+                                                        topic_name_in, args);
+    va_end(args);
+
+    if (*topic_name_out == NULL) {
+      return false;
+    }
+
+    if (message && message_string_in) {
+      size_t size = strnlen(message_string_in, MQTT_MAX_MESSAGE_SIZE);
+      if (include_null_byte) {
+        size += 1;
+      }
+      *message = message_buffer->set_message(message_string_in, size);
+      if (*message && message_size) {
+        *message_size = size;
+      }
+    }
+
+    return true;
+  }
+
   va_start(args, topic_name_in);
   size_t tn_size = vsnprintf(NULL, 0, topic_name_in, args);
   va_end(args);
@@ -142,6 +167,16 @@ void supla_mqtt_message_provider::get_mfr_name(int mfr_id, char *buf,
 
 void supla_mqtt_message_provider::reset_index(void) { index = 0; }
 
+void supla_mqtt_message_provider::set_message_buffer(
+    supla_mqtt_message_buffer *message_buffer) {
+  this->message_buffer = message_buffer;
+}
+
+supla_mqtt_message_buffer *supla_mqtt_message_provider::get_message_buffer(
+    void) {
+  return message_buffer;
+}
+
 bool supla_mqtt_message_provider::fetch(const char *topic_prefix,
                                         char **topic_name, void **message,
                                         size_t *message_size) {
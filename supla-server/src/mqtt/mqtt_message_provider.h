@@ -21,6 +21,7 @@
 
 #include "database.h"
 #include "mqtt_client_settings.h"
+#include "mqtt_message_buffer.h"
 
 #define MQTT_MAX_TOPIC_NAME_SIZE 32767
 #define MQTT_MAX_MESSAGE_SIZE 1048576
@@ -28,6 +29,7 @@
 class supla_mqtt_message_provider {
  private:
   unsigned short index;
+  supla_mqtt_message_buffer *message_buffer;
 
  protected:
   bool create_message(const char *topic_prefix, const char *email,
@@ -35,6 +37,7 @@ class supla_mqtt_message_provider {
                       size_t *message_size, const char *message_string_in,
                       bool include_null_byte, const char *topic_name_in, ...);
   void get_mfr_name(int mfr_id, char *buf, size_t buf_size);
+  supla_mqtt_message_buffer *get_message_buffer(void);
 
  public:
   supla_mqtt_message_provider(void);
@@ -43,6 +46,10 @@ class supla_mqtt_message_provider {
                                     const char *topic_prefix, char **topic_name,
                                     void **message, size_t *message_size) = 0;
   virtual void reset_index(void);
+  // With a message buffer, the topic name and the message point into the
+  // buffer and must not be freed. Otherwise they are allocated for the
+  // caller.
+  virtual void set_message_buffer(supla_mqtt_message_buffer *message_buffer);
   bool fetch(const char *topic_prefix, char **topic_name, void **message,
              size_t *message_size);
 };
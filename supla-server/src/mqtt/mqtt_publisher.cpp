@@ -24,8 +24,10 @@
 supla_mqtt_publisher::supla_mqtt_publisher(
     supla_mqtt_client_library_adapter *library_adapter,
     supla_mqtt_client_settings *settings,
-    supla_mqtt_client_datasource *datasource)
-    : supla_mqtt_client(library_adapter, settings, datasource) {}
+    supla_mqtt_client_datasource *datasource, int shard)
+    : supla_mqtt_client(library_adapter, settings, datasource) {
+  this->shard = shard;
+}
 
 supla_mqtt_publisher::~supla_mqtt_publisher(void) {}
 
@@ -35,10 +37,23 @@ ssize_t supla_mqtt_publisher::get_recv_buffer_size(void) { return 32768; }
 
 void supla_mqtt_publisher::get_client_id(char *clientId, size_t len) {
   if (settings) {
-    settings->getClientId(clientId, len, "pub");
+    // Every shard has its own broker session, so its identifier has to be
+    // unique and the same after a restart.
+    char suffix[15];
+    if (shard > 0) {
+      snprintf(suffix, sizeof(suffix), "pub%i", shard);
+    } else {
+      snprintf(suffix, sizeof(suffix), "pub");
+    }
+    settings->getClientId(clientId, len, suffix);
   }
 }
 
+// A persistent session keeps the subscriptions and the QoS 1/2 state across
+// reconnects. It says nothing about the retained QoS 0 messages lost when the
+// link broke, so the datasource republishes what it could not confirm.
+bool supla_mqtt_publisher::is_session_persistent(void) { return true; }
+
 bool supla_mqtt_publisher::on_iterate(void) {
   char *topic_name = NULL;
   void *message = NULL;
@@ -50,12 +65,14 @@ bool supla_mqtt_publisher::on_iterate(void) {
     result = true;
   }
 
-  if (topic_name) {
-    free(topic_name);
-  }
+  if (datasource->is_fetch_result_allocated()) {
+    if (topic_name) {
+      free(topic_name);
+    }
 
-  if (message) {
-    free(message);
+    if (message) {
+      free(message);
+    }
   }
 
   return result;
@@ -22,17 +22,22 @@
 #include <mqtt_client.h>
 
 class supla_mqtt_publisher : public supla_mqtt_client {
+ private:
+  int shard;
+
  protected:
   virtual ssize_t get_send_buffer_size(void);
   virtual ssize_t get_recv_buffer_size(void);
   virtual void get_client_id(char *clientId, size_t len);
+  virtual bool is_session_persistent(void);
   virtual bool on_iterate(void);
   virtual void on_message_received(const _received_mqtt_message_t *msg);
 
  public:
   supla_mqtt_publisher(supla_mqtt_client_library_adapter *library_adapter,
                        supla_mqtt_client_settings *settings,
-                       supla_mqtt_client_datasource *datasource);
+                       supla_mqtt_client_datasource *datasource,
+                       int shard = 0);
   virtual ~supla_mqtt_publisher(void);
 };
 
@@ -22,6 +22,7 @@
 #include "mqtt_channelandstate_message_provider.h"
 #include "mqtt_device_message_provider.h"
 #include "mqtt_user_message_provider.h"
+#include "safearray.h"
 
 #define MPD_DATATYPE_USER 1
 #define MPD_DATATYPE_DEVICE 2
@@ -44,10 +45,100 @@ supla_mqtt_publisher_datasource::supla_mqtt_publisher_datasource(
   this->device_message_provider = NULL;
   this->channelandstate_message_provider = NULL;
   this->state_message_provider = NULL;
+  this->row_user_id = 0;
+  this->shard = 0;
+  this->shard_count = 1;
+  memset(&this->link_lost_time, 0, sizeof(struct timeval));
 }
 
 supla_mqtt_publisher_datasource::~supla_mqtt_publisher_datasource(void) {}
 
+bool supla_mqtt_publisher_datasource::is_fetch_result_allocated(void) {
+  return false;
+}
+
+// static
+int supla_mqtt_publisher_datasource::get_shard(int user_id, int shard_count) {
+  if (shard_count <= 1) {
+    return 0;
+  }
+
+  // Multiplicative hashing spreads consecutive identifiers over all shards.
+  // Keep in sync with MQTT_DB_SHARD_CONDITION used by the full load.
+  return ((unsigned int)user_id * 2654435761U >> 8) % shard_count;
+}
+
+void supla_mqtt_publisher_datasource::set_shard(int shard, int shard_count) {
+  this->shard_count = shard_count > 0 ? shard_count : 1;
+  this->shard = shard >= 0 && shard < this->shard_count ? shard : 0;
+}
+
+bool supla_mqtt_publisher_datasource::is_user_in_shard(int user_id) {
+  return get_shard(user_id, shard_count) == shard;
+}
+
+void supla_mqtt_publisher_datasource::on_broker_session_lost(void) {
+  lock();
+  digests.clear();
+  unlock();
+}
+
+void supla_mqtt_publisher_datasource::on_broker_disconnected(void) {
+  lock();
+  gettimeofday(&link_lost_time, NULL);
+  unlock();
+}
+
+void supla_mqtt_publisher_datasource::on_broker_connected(void) {
+  lock();
+
+  // Without a detected break (first connection) every digest is suspect.
+  struct timeval confirmed_time = link_lost_time;
+  if (confirmed_time.tv_sec == 0) {
+    gettimeofday(&confirmed_time, NULL);
+  }
+  memset(&link_lost_time, 0, sizeof(struct timeval));
+
+  time_t unconfirmed_after = confirmed_time.tv_sec -
+                             get_settings()->getKeepAlive() -
+                             MPD_RESPONSE_TIMEOUT_SEC;
+
+  for (std::map<int, _mqtt_pub_digest_t>::iterator it = digests.begin();
+       it != digests.end();) {
+    if (it->second.time.tv_sec >= unconfirmed_after) {
+      digests.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+
+  if (users_enabled.size()) {
+    // Once the enabled users are known, the broker is brought up to date user
+    // by user. Each user is a separate context with its own bounded queries
+    // and the topics whose payload has not changed are skipped.
+    for (std::unordered_set<int>::iterator it = users_enabled.begin();
+         it != users_enabled.end(); ++it) {
+      supla_mqtt_client_datasource::on_userdata_changed(*it);
+    }
+
+    unlock();
+    return;
+  }
+
+  unlock();
+
+  supla_mqtt_client_datasource::on_broker_connected();
+}
+
+void supla_mqtt_publisher_datasource::on_userdata_changed(int user_id) {
+  // The topics of the user may have been removed by the unpublisher.
+  lock();
+  digests.erase(user_id);
+  unlock();
+
+  supla_mqtt_client_datasource::on_userdata_changed(user_id);
+}
+
 bool supla_mqtt_publisher_datasource::is_context_allowed(
     supla_mqtt_ds_context *context) {
   switch (context->get_scope()) {
@@ -63,15 +154,8 @@ bool supla_mqtt_publisher_datasource::is_context_allowed(
 }
 
 bool supla_mqtt_publisher_datasource::is_user_enabled(int user_id) {
-  bool result = false;
   lock();
-  for (std::list<int>::iterator it = users_enabled.begin();
-       it != users_enabled.end(); ++it) {
-    if (*it == user_id) {
-      result = true;
-      break;
-    }
-  }
+  bool result = users_enabled.find(user_id) != users_enabled.end();
   unlock();
   return result;
 }
@@ -120,20 +204,27 @@ void *supla_mqtt_publisher_datasource::datarow_malloc(int datatype) {
 
 void *supla_mqtt_publisher_datasource::open_query(
     int datatype, supla_mqtt_ds_context *context, void *data_row) {
+  // The full load reads only the users of this shard. The users of other
+  // shards are published by their own publishers.
+  int shards = context->get_scope() == MQTTDS_SCOPE_FULL ? shard_count : 1;
+
   switch (datatype) {
     case MPD_DATATYPE_USER:
       return get_db()->open_userquery(
           context->get_user_id(), true,
-          static_cast<_mqtt_db_data_row_user_t *>(data_row));
+          static_cast<_mqtt_db_data_row_user_t *>(data_row), shard,
+          shards);
     case MPD_DATATYPE_DEVICE:
       return get_db()->open_devicequery(
           context->get_user_id(), context->get_device_id(),
-          static_cast<_mqtt_db_data_row_device_t *>(data_row));
+          static_cast<_mqtt_db_data_row_device_t *>(data_row), shard,
+          shards);
     case MPD_DATATYPE_CHANNEL:
       return get_db()->open_channelquery(
           context->get_user_id(), context->get_device_id(),
           context->get_channel_id(),
-          static_cast<_mqtt_db_data_row_channel_t *>(data_row));
+          static_cast<_mqtt_db_data_row_channel_t *>(data_row), shard,
+          shards);
   }
 
   return NULL;
@@ -155,16 +246,25 @@ bool supla_mqtt_publisher_datasource::db_fetch_row(int datatype, void *query,
 
 supla_mqtt_message_provider *supla_mqtt_publisher_datasource::new_provider(
     int datatype, void *data_row) {
+  supla_mqtt_message_provider *result = NULL;
+
   switch (datatype) {
     case MPD_DATATYPE_USER:
-      return new supla_mqtt_user_message_provider();
+      result = new supla_mqtt_user_message_provider();
+      break;
     case MPD_DATATYPE_DEVICE:
-      return new supla_mqtt_device_message_provider();
+      result = new supla_mqtt_device_message_provider();
+      break;
     case MPD_DATATYPE_CHANNEL:
-      return new supla_mqtt_channelandstate_message_provider();
+      result = new supla_mqtt_channelandstate_message_provider();
+      break;
   }
 
-  return NULL;
+  if (result) {
+    result->set_message_buffer(&message_buffer);
+  }
+
+  return result;
 }
 
 void supla_mqtt_publisher_datasource::set_provider_data_row(
@@ -175,6 +275,7 @@ void supla_mqtt_publisher_datasource::set_provider_data_row(
       _mqtt_db_data_row_user_t *row_user =
           static_cast<_mqtt_db_data_row_user_t *>(data_row);
       if (row_user) {
+        row_user_id = row_user->user_id;
         if (context->get_scope() == MQTTDS_SCOPE_FULL) {
           context->set_user_id(row_user->user_id);
         }
@@ -182,14 +283,24 @@ void supla_mqtt_publisher_datasource::set_provider_data_row(
             row_user);
       }
     } break;
-    case MPD_DATATYPE_DEVICE:
+    case MPD_DATATYPE_DEVICE: {
+      _mqtt_db_data_row_device_t *row_device =
+          static_cast<_mqtt_db_data_row_device_t *>(data_row);
+      if (row_device) {
+        row_user_id = row_device->user_id;
+      }
       static_cast<supla_mqtt_device_message_provider *>(provider)->set_data_row(
-          static_cast<_mqtt_db_data_row_device_t *>(data_row));
-      break;
-    case MPD_DATATYPE_CHANNEL:
+          row_device);
+    } break;
+    case MPD_DATATYPE_CHANNEL: {
+      _mqtt_db_data_row_channel_t *row_channel =
+          static_cast<_mqtt_db_data_row_channel_t *>(data_row);
+      if (row_channel) {
+        row_user_id = row_channel->user_id;
+      }
       static_cast<supla_mqtt_channelandstate_message_provider *>(provider)
-          ->set_data_row(static_cast<_mqtt_db_data_row_channel_t *>(data_row));
-      break;
+          ->set_data_row(row_channel);
+    } break;
   }
 }
 
@@ -265,6 +376,7 @@ bool supla_mqtt_publisher_datasource::fetch_state(
     size_t *message_size) {
   if (state_message_provider == NULL) {
     state_message_provider = new supla_mqtt_state_message_provider();
+    state_message_provider->set_message_buffer(&message_buffer);
     state_message_provider->set_ids(context->get_user_id(),
                                     context->get_device_id(),
                                     context->get_channel_id());
@@ -279,9 +391,9 @@ bool supla_mqtt_publisher_datasource::fetch_state(
   return false;
 }
 
-bool supla_mqtt_publisher_datasource::_fetch(supla_mqtt_ds_context *context,
-                                             char **topic_name, void **message,
-                                             size_t *message_size) {
+bool supla_mqtt_publisher_datasource::fetch_next(
+    supla_mqtt_ds_context *context, char **topic_name, void **message,
+    size_t *message_size) {
   bool result = false;
   if (fetch_users) {
     result = fetch_user(context, topic_name, message, message_size);
@@ -312,12 +424,10 @@ bool supla_mqtt_publisher_datasource::_fetch(supla_mqtt_ds_context *context,
   }
 
   if (result) {
-    if (context->get_user_id()) {
-      if (context->get_scope() == MQTTDS_SCOPE_FULL) {
-        add_user_to_list(context->get_user_id(), &users_enabled_tmp);
-      } else if (context->get_scope() == MQTTDS_SCOPE_USER &&
-                 users_enabled_tmp.size() == 0) {
-        users_enabled_tmp.push_back(context->get_user_id());
+    if (context->get_user_id() && is_user_in_shard(context->get_user_id())) {
+      if (context->get_scope() == MQTTDS_SCOPE_FULL ||
+          context->get_scope() == MQTTDS_SCOPE_USER) {
+        users_enabled_tmp.insert(context->get_user_id());
       }
     }
   }
@@ -325,6 +435,68 @@ bool supla_mqtt_publisher_datasource::_fetch(supla_mqtt_ds_context *context,
   return result;
 }
 
+bool supla_mqtt_publisher_datasource::digest_update(int user_id,
+                                                    const char *topic_name,
+                                                    const void *message,
+                                                    size_t message_size,
+                                                    bool skip_unchanged) {
+  if (user_id == 0 || topic_name == NULL) {
+    return true;
+  }
+
+  unsigned long long topic_hash = safe_array_key_hash(
+      topic_name, strnlen(topic_name, MQTT_MAX_TOPIC_NAME_SIZE));
+  unsigned long long payload_hash =
+      safe_array_key_hash(message, message ? message_size : 0);
+
+  bool result = true;
+
+  lock();
+  _mqtt_pub_digest_t *digest = &digests[user_id];
+
+  std::map<unsigned long long, unsigned long long>::iterator it =
+      digest->payloads.find(topic_hash);
+
+  if (it == digest->payloads.end()) {
+    digest->payloads[topic_hash] = payload_hash;
+  } else if (it->second != payload_hash) {
+    it->second = payload_hash;
+  } else if (skip_unchanged) {
+    result = false;
+  }
+
+  if (result) {
+    gettimeofday(&digest->time, NULL);
+  }
+  unlock();
+
+  return result;
+}
+
+bool supla_mqtt_publisher_datasource::_fetch(supla_mqtt_ds_context *context,
+                                             char **topic_name, void **message,
+                                             size_t *message_size) {
+  while (fetch_next(context, topic_name, message, message_size)) {
+    int user_id = context->get_scope() == MQTTDS_SCOPE_FULL
+                      ? row_user_id
+                      : context->get_user_id();
+
+    if (digest_update(user_id, *topic_name, message ? *message : NULL,
+                      message_size ? *message_size : 0,
+                      context->get_scope() == MQTTDS_SCOPE_USER)) {
+      return true;
+    }
+
+    *topic_name = NULL;
+
+    if (message) {
+      *message = NULL;
+    }
+  }
+
+  return false;
+}
+
 void supla_mqtt_publisher_datasource::close_userquery(void) {
   if (user_query) {
     if (get_db()) {
@@ -385,21 +557,6 @@ void supla_mqtt_publisher_datasource::close_channelquery(void) {
   }
 }
 
-void supla_mqtt_publisher_datasource::add_user_to_list(int user_id,
-                                                       std::list<int> *ulist) {
-  bool exists = false;
-  for (std::list<int>::iterator it = ulist->begin(); it != ulist->end(); ++it) {
-    if (*it == user_id) {
-      exists = true;
-      break;
-    }
-  }
-
-  if (!exists) {
-    ulist->push_back(user_id);
-  }
-}
-
 void supla_mqtt_publisher_datasource::context_close(
     supla_mqtt_ds_context *context) {
   lock();
@@ -407,15 +564,10 @@ void supla_mqtt_publisher_datasource::context_close(
     users_enabled = users_enabled_tmp;
   } else if (context->get_scope() == MQTTDS_SCOPE_USER) {
     if (users_enabled_tmp.size()) {
-      add_user_to_list(users_enabled_tmp.front(), &users_enabled);
+      users_enabled.insert(users_enabled_tmp.begin(), users_enabled_tmp.end());
     } else if (context->get_user_id()) {
-      for (std::list<int>::iterator it = users_enabled.begin();
-           it != users_enabled.end(); ++it) {
-        if (*it == context->get_user_id()) {
-          it = users_enabled.erase(it);
-          break;
-        }
-      }
+      users_enabled.erase(context->get_user_id());
+      digests.erase(context->get_user_id());
     }
   }
 
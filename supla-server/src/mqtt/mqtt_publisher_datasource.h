@@ -19,14 +19,30 @@
 #ifndef MQTT_PUBLISHER_DATASOURCE_H_
 #define MQTT_PUBLISHER_DATASOURCE_H_
 
-#include <list>
+#include <sys/time.h>
+#include <map>
+#include <unordered_set>
 #include "mqtt_client_db_datasource.h"
 #include "mqtt_state_message_provider.h"
 
+// A broken connection is detected at the latest keep_alive plus the 30 s
+// response timeout after it broke. Whatever was published within that time
+// before the detection may not have reached the broker.
+#define MPD_RESPONSE_TIMEOUT_SEC 30
+
+// Hashes of the payloads last published to the topics of one user.
+typedef struct {
+  struct timeval time;
+  std::map<unsigned long long, unsigned long long> payloads;
+} _mqtt_pub_digest_t;
+
 class supla_mqtt_publisher_datasource : public supla_mqtt_client_db_datasource {
  private:
-  std::list<int> users_enabled;
-  std::list<int> users_enabled_tmp;
+  std::unordered_set<int> users_enabled_tmp;
+  int row_user_id;
+  int shard;
+  int shard_count;
+  supla_mqtt_message_buffer message_buffer;
 
   bool fetch_users;
   bool fetch_devices;
@@ -46,8 +62,8 @@ class supla_mqtt_publisher_datasource : public supla_mqtt_client_db_datasource {
   supla_mqtt_message_provider *channelandstate_message_provider;
   supla_mqtt_state_message_provider *state_message_provider;
 
-  void add_user_to_list(int user_id, std::list<int> *ulist);
   bool is_user_enabled(int user_id);
+  bool is_user_in_shard(int user_id);
   void *datarow_malloc(int datatype);
   void *open_query(int datatype, supla_mqtt_ds_context *context,
                    void *data_row);
@@ -57,6 +73,8 @@ class supla_mqtt_publisher_datasource : public supla_mqtt_client_db_datasource {
                              supla_mqtt_message_provider *provider,
                              void *data_row);
 
+  bool fetch_next(supla_mqtt_ds_context *context, char **topic_name,
+                  void **message, size_t *message_size);
   bool fetch(int datatype, void **query, void **data_row,
              supla_mqtt_message_provider **provider,
              supla_mqtt_ds_context *context, char **topic_name, void **message,
@@ -75,6 +93,14 @@ class supla_mqtt_publisher_datasource : public supla_mqtt_client_db_datasource {
   void close_channelquery();
 
  protected:
+  std::unordered_set<int> users_enabled;
+  std::map<int, _mqtt_pub_digest_t> digests;
+  struct timeval link_lost_time;
+
+  // Returns false when skip_unchanged is set and the payload is the same as
+  // the one last published to the topic.
+  bool digest_update(int user_id, const char *topic_name, const void *message,
+                     size_t message_size, bool skip_unchanged);
   virtual bool is_context_allowed(supla_mqtt_ds_context *context);
   virtual bool context_open(supla_mqtt_ds_context *context);
   virtual bool _fetch(supla_mqtt_ds_context *context, char **topic_name,
@@ -85,6 +111,19 @@ class supla_mqtt_publisher_datasource : public supla_mqtt_client_db_datasource {
   explicit supla_mqtt_publisher_datasource(
       supla_mqtt_client_settings *settings);
   virtual ~supla_mqtt_publisher_datasource(void);
+  virtual bool is_fetch_result_allocated(void);
+
+  // Returns the shard the user belongs to when the users are spread over
+  // shard_count publishers.
+  static int get_shard(int user_id, int shard_count);
+  // Limits the full load to the users of the given shard. Other events are
+  // expected to be routed to the publisher of the user by the caller.
+  void set_shard(int shard, int shard_count);
+
+  virtual void on_broker_session_lost(void);
+  virtual void on_broker_disconnected(void);
+  virtual void on_broker_connected(void);
+  virtual void on_userdata_changed(int user_id);
 };
 
 #endif /*MQTT_PUBLISHER_DATASOURCE_H_*/
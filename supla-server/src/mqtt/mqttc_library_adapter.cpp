@@ -22,15 +22,23 @@
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <openssl/ssl.h>
+#include <poll.h>
 #include <sthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include "log.h"
 #include "mqtt_client.h"
 #include "supla-socket.h"
 
+#define MQTTC_RECONNECT_DELAY_USEC 5000000
+#define MQTTC_WAIT_TIMEOUT_MS 1000
+#define MQTTC_SSL_CONNECT_POLL_MS 100
+
 // static
 ssize_t supla_mqttc_library_adapter::__mqtt_pal_sendall(
     supla_mqttc_library_adapter *adapter_instance, const char *buf, size_t len,
@@ -124,17 +132,51 @@ supla_mqttc_library_adapter::supla_mqttc_library_adapter(
   this->sockfd = -1;
   this->bio = NULL;
   this->ssl_ctx = NULL;
-  this->eh = NULL;
   this->recvbuf = NULL;
   this->sendbuf = NULL;
   this->unable_to_connect_notified = false;
+  this->connack_expected = false;
+  this->output_blocked = false;
+  this->output_watched = false;
+  this->reconnect_after_usec = 0;
   this->supla_client_instance = NULL;
 
   m.instance = this;
   m.__recvall = supla_mqttc_library_adapter::__mqtt_pal_recvall;
   m.__sendall = supla_mqttc_library_adapter::__mqtt_pal_sendall;
+
+  epoll_fd = epoll_create1(0);
+  wakeup_fd = eventfd(0, EFD_NONBLOCK);
+
+  if (epoll_fd != -1 && wakeup_fd != -1) {
+    struct epoll_event evnt = {};
+    evnt.events = EPOLLIN;
+    evnt.data.fd = wakeup_fd;
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &evnt) == -1) {
+      supla_log(LOG_ERR, "MQTT: unable to add the wakeup descriptor");
+    }
+  } else {
+    supla_log(LOG_ERR, "MQTT: epoll/eventfd initialization error");
+  }
+}
+
+supla_mqttc_library_adapter::~supla_mqttc_library_adapter(void) {
+  if (wakeup_fd != -1) {
+    close(wakeup_fd);
+  }
+
+  if (epoll_fd != -1) {
+    close(epoll_fd);
+  }
+}
+
+// static
+unsigned long long supla_mqttc_library_adapter::now_usec(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec * 1000000ULL + now.tv_usec;
 }
-supla_mqttc_library_adapter::~supla_mqttc_library_adapter(void) {}
 
 void supla_mqttc_library_adapter::client_connect(
     supla_mqtt_client *supla_client_instance) {
@@ -159,26 +201,72 @@ void supla_mqttc_library_adapter::client_connect(
 
 bool supla_mqttc_library_adapter::is_connected(void) { return sockfd != -1; }
 
+void supla_mqttc_library_adapter::watch(bool output) {
+  if (sockfd == -1 || output == output_watched) {
+    return;
+  }
+
+  struct epoll_event evnt = {};
+  evnt.events = output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  evnt.data.fd = sockfd;
+
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sockfd, &evnt) == 0) {
+    output_watched = output;
+  }
+}
+
+void supla_mqttc_library_adapter::wait(int timeout_ms) {
+  struct epoll_event events[2];
+  int n = epoll_wait(epoll_fd, events, 2, timeout_ms);
+
+  for (int a = 0; a < n; a++) {
+    if (events[a].data.fd == wakeup_fd) {
+      uint64_t u = 0;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+      read(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+    }
+  }
+}
+
 void supla_mqttc_library_adapter::iterate(void) {
+  if (sockfd == -1 && reconnect_after_usec) {
+    unsigned long long now = now_usec();
+    if (reconnect_after_usec > now) {
+      wait((reconnect_after_usec - now) / 1000 + 1);
+      return;
+    }
+  }
+
+  output_blocked = false;
   mqtt_sync(&client);
 
-  if (mqtt_mq_length(&client.mq) > 0) {
-    mqtt_mq_clean(&client.mq);
+  // The session flag is known only after the broker accepted the connection.
+  if (connack_expected && client.session_present != -1) {
+    connack_expected = false;
+    if (on_connected_callback) {
+      on_connected_callback(supla_client_instance);
+    }
   }
 
-  if (eh == NULL) {
-    usleep(500000);
-  } else {
-    eh_wait(eh, 1000000);
+  // The queue lives in the send buffer, which is gone after a disconnection.
+  if (sockfd != -1 && mqtt_mq_length(&client.mq) > 0) {
+    mqtt_mq_clean(&client.mq);
   }
+
+  watch(output_blocked);
+  wait(MQTTC_WAIT_TIMEOUT_MS);
 }
 
 void supla_mqttc_library_adapter::disconnect(void) {
-  if (eh != NULL) {
-    eh_free(eh);
-    eh = NULL;
+  if (sockfd != -1) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sockfd, NULL);
   }
 
+  output_blocked = false;
+  output_watched = false;
+
   if (bio) {
     ssl_free();
   } else if (sockfd != -1) {
@@ -209,7 +297,21 @@ void supla_mqttc_library_adapter::cleanup(void) {
   }
 }
 
-void supla_mqttc_library_adapter::raise_event(void) { eh_raise_event(eh); }
+void supla_mqttc_library_adapter::raise_event(void) {
+  uint64_t u = 1;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+  write(wakeup_fd, &u, sizeof(uint64_t));
+#pragma GCC diagnostic pop
+}
+
+bool supla_mqttc_library_adapter::is_session_present(void) {
+  return client.session_present == 1;
+}
+
+bool supla_mqttc_library_adapter::is_output_blocked(void) {
+  return output_blocked;
+}
 
 bool supla_mqttc_library_adapter::posix_connect(const char *port) {
   // The source of this code fragment
@@ -285,7 +387,8 @@ bool supla_mqttc_library_adapter::ssl_connect(const char *port) {
   /* open BIO socket */
   BIO *bio = BIO_new_ssl_connect(ssl_ctx);
   BIO_get_ssl(bio, &ssl);
-  SSL_set_mode(ssl, SSL_MODE_AUTO_RETRY);
+  // The write is retried from the queue, which mqtt_mq_clean() may move.
+  SSL_set_mode(ssl, SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
   BIO_set_conn_hostname(bio, settings->getHost());
   BIO_set_nbio(bio, 1);
   BIO_set_conn_port(bio, port);
@@ -297,6 +400,13 @@ bool supla_mqttc_library_adapter::ssl_connect(const char *port) {
   int rv = BIO_do_connect(bio);
   while (rv <= 0 && !supla_client_instance->is_terminated() &&
          BIO_should_retry(bio) && (int)time(NULL) - start_time < 10) {
+    struct pollfd pfd = {};
+    pfd.fd = -1;
+    BIO_get_fd(bio, &pfd.fd);
+    if (pfd.fd >= 0) {
+      pfd.events = BIO_should_read(bio) ? POLLIN : POLLOUT;
+      poll(&pfd, 1, MQTTC_SSL_CONNECT_POLL_MS);
+    }
     rv = BIO_do_connect(bio);
   }
 
@@ -314,13 +424,26 @@ void supla_mqttc_library_adapter::reconnect(struct mqtt_client *client) {
     return;
   }
 
-  if (client->error != MQTT_ERROR_INITIAL_RECONNECT) {
-    if (sockfd != -1) {
+  // Instead of sleeping, the next attempt is made by the first iteration after
+  // the delay. Until then iterate() only waits for events.
+  if (client->error != MQTT_ERROR_INITIAL_RECONNECT &&
+      reconnect_after_usec == 0) {
+    bool was_connected = sockfd != -1;
+    if (was_connected) {
       supla_log(LOG_ERR, "%s", mqtt_error_str(client->error));
     }
-    usleep(5000000);
+    disconnect();
+    if (was_connected && on_disconnected_callback) {
+      on_disconnected_callback(supla_client_instance);
+    }
+    reconnect_after_usec = now_usec() + MQTTC_RECONNECT_DELAY_USEC;
+  }
+
+  if (reconnect_after_usec > now_usec()) {
+    return;
   }
 
+  reconnect_after_usec = 0;
   disconnect();
 
   size_t sendbuf_size = supla_client_instance->get_send_buffer_size();
@@ -343,13 +466,14 @@ void supla_mqttc_library_adapter::reconnect(struct mqtt_client *client) {
       supla_log(LOG_ERR, "MQTT: Can't connect to %s", settings->getHost());
       unable_to_connect_notified = true;
     }
+    reconnect_after_usec = now_usec() + MQTTC_RECONNECT_DELAY_USEC;
   } else {
     unable_to_connect_notified = false;
 
-    if (eh == NULL) {
-      eh = eh_init();
-      eh_add_fd(eh, sockfd);
-    }
+    struct epoll_event evnt = {};
+    evnt.events = EPOLLIN;
+    evnt.data.fd = sockfd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockfd, &evnt);
 
     mqtt_reinit(client, client->socketfd, (uint8_t *)sendbuf, sendbuf_size,
                 (uint8_t *)recvbuf, recvbuf_size);
@@ -358,15 +482,16 @@ void supla_mqttc_library_adapter::reconnect(struct mqtt_client *client) {
     supla_client_instance->get_client_id(clientId, sizeof(clientId));
 
     mqtt_connect(client, clientId, NULL, NULL, 0, settings->getUsername(),
-                 settings->getPassword(), MQTT_CONNECT_CLEAN_SESSION,
+                 settings->getPassword(),
+                 supla_client_instance->is_session_persistent()
+                     ? 0
+                     : MQTT_CONNECT_CLEAN_SESSION,
                  settings->getKeepAlive());
 
-    if (on_connected_callback) {
-      on_connected_callback(supla_client_instance);
-    }
+    connack_expected = true;
   }
 
-  eh_raise_event(eh);
+  raise_event();
 }
 
 ssize_t supla_mqttc_library_adapter::mqtt_pal_sendall(const char *buf,
@@ -377,12 +502,16 @@ ssize_t supla_mqttc_library_adapter::mqtt_pal_sendall(const char *buf,
     // The source of this code fragment
     // https://github.com/LiamBindle/MQTT-C/blob/9a7cc93eb09680140ab963e1faecfe3d2f80829c/src/mqtt_pal.c#L224
 
-    size_t sent = 0;
+    // A write that would block returns what has been sent so far. MQTT-C
+    // sends the rest in the next iteration.
     while (sent < len) {
       int tmp = BIO_write((BIO *)bio, (const char *)buf + sent, len - sent);
       if (tmp > 0) {
         sent += (size_t)tmp;
-      } else if (tmp <= 0 && !BIO_should_retry((BIO *)bio)) {
+      } else if (BIO_should_retry((BIO *)bio)) {
+        output_blocked = BIO_should_write((BIO *)bio);
+        break;
+      } else {
         return MQTT_ERROR_SOCKET_ERROR;
       }
     }
@@ -394,8 +523,9 @@ ssize_t supla_mqttc_library_adapter::mqtt_pal_sendall(const char *buf,
     while (sent < len) {
       ssize_t tmp = send(sockfd, buf + sent, len - sent, flags);
       if (tmp < 1) {
-        if (errno == EAGAIN) {
-          usleep(1000);
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          output_blocked = true;
+          break;
         } else {
           return MQTT_ERROR_SOCKET_ERROR;
         }
@@ -473,7 +603,7 @@ bool supla_mqttc_library_adapter::subscribe(const char *topic_name,
 
   if (is_connected() &&
       MQTT_OK == mqtt_subscribe(&client, topic_name, _max_qos_level)) {
-    eh_raise_event(eh);
+    raise_event();
     return true;
   }
   return false;
@@ -481,7 +611,7 @@ bool supla_mqttc_library_adapter::subscribe(const char *topic_name,
 
 bool supla_mqttc_library_adapter::unsubscribe(const char *topic_name) {
   if (is_connected() && MQTT_OK == mqtt_unsubscribe(&client, topic_name)) {
-    eh_raise_event(eh);
+    raise_event();
     return true;
   }
   return false;
@@ -514,7 +644,7 @@ bool supla_mqttc_library_adapter::publish(const char *topic_name,
         mqtt_publish(&client, topic_name, message, message_size, publish_flags);
 
     if (r == MQTT_OK) {
-      eh_raise_event(eh);
+      raise_event();
       return true;
     } else if (r == MQTT_ERROR_SEND_BUFFER_IS_FULL) {
       client.error = MQTT_OK;
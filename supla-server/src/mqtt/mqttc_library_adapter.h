@@ -20,7 +20,6 @@
 #define MQTTC_LIBRARY_ADAPTER_H_
 
 #include <mqtt_client_library_adapter.h>
-#include "eh.h"
 #include "mqtt.h"
 
 class supla_mqttc_library_adapter;
@@ -40,8 +39,13 @@ class supla_mqttc_library_adapter : public supla_mqtt_client_library_adapter {
   void *bio;
   void *ssl_ctx;
   struct mqtt_client client;
-  TEventHandler *eh;
+  int epoll_fd;
+  int wakeup_fd;
   bool unable_to_connect_notified;
+  bool connack_expected;
+  bool output_blocked;
+  bool output_watched;
+  unsigned long long reconnect_after_usec;
 
   void *recvbuf;
   void *sendbuf;
@@ -62,6 +66,10 @@ class supla_mqttc_library_adapter : public supla_mqtt_client_library_adapter {
   ssize_t mqtt_pal_sendall(const char *buf, size_t len, int flags);
   ssize_t mqtt_pal_recvall(char *buf, size_t bufsz, int flags);
 
+  static unsigned long long now_usec(void);
+
+  void watch(bool output);
+  void wait(int timeout_ms);
   bool posix_connect(const char *port);
   void ssl_free(void);
   bool ssl_connect(const char *portd);
@@ -76,6 +84,8 @@ class supla_mqttc_library_adapter : public supla_mqtt_client_library_adapter {
   virtual void disconnect(void);
   virtual void cleanup(void);
   virtual void raise_event(void);
+  virtual bool is_session_present(void);
+  virtual bool is_output_blocked(void);
 
   virtual bool subscribe(const char *topic_name, QOS_Level max_qos_level);
   virtual bool unsubscribe(const char *topic_name);
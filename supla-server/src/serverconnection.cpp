@@ -24,8 +24,11 @@
 #include <ifaddrs.h>
 #include <linux/if_link.h>
 #include "client/client.h"
+#include "client/clientmetadatacache.h"
 #include "database.h"
 #include "device/device.h"
+#include "device/device_registration_cache.h"
+#include "lck.h"
 #include "log.h"
 #include "safearray.h"
 #include "serverconnection.h"
@@ -104,12 +107,19 @@ void serverconnection::init(void) {
   serverconnection::read_local_ipv4_addresses();
   serverconnection::reg_pending_arr = safe_array_init();
   cdbase::init();
+  supla_device_registration_cache::global_instance();
+  supla_client_metadata_cache::global_instance();
 }
 
 // static
 void serverconnection::serverconnection_free(void) {
   cdbase::cdbase_free();
+  supla_device_registration_cache::global_instance_release();
+  supla_client_metadata_cache::global_instance_release();
   safe_array_free(serverconnection::reg_pending_arr);
+  // Connections handed over to devices and clients which are still in use
+  // may be deleted later.
+  serverconnection::reg_pending_arr = NULL;
 }
 
 // static
@@ -118,8 +128,10 @@ int serverconnection::registration_pending_count() {
 }
 
 serverconnection::serverconnection(void *ssd, void *supla_socket,
-                                   unsigned int client_ipv4) {
+                                   unsigned int client_ipv4, bool event_loop) {
   gettimeofday(&this->init_time, NULL);
+  this->lck = lck_init();
+  this->terminated = false;
   this->client_ipv4 = client_ipv4;
   this->sthread = NULL;
   this->cdptr = NULL;
@@ -129,8 +141,14 @@ serverconnection::serverconnection(void *ssd, void *supla_socket,
   this->activity_timeout = ACTIVITY_TIMEOUT;
   this->incorrect_call_counter = 0;
 
-  eh = eh_init();
-  eh_add_fd(eh, ssocket_supla_socket_getsfd(supla_socket));
+  if (event_loop) {
+    // The socket and the event descriptor are monitored by
+    // supla_connection_reactor
+    eh = eh_init_without_epoll();
+  } else {
+    eh = eh_init();
+    eh_add_fd(eh, ssocket_supla_socket_getsfd(supla_socket));
+  }
 
   TsrpcParams srpc_params;
   srpc_params_init(&srpc_params);
@@ -149,7 +167,10 @@ serverconnection::~serverconnection() {
   eh_free(eh);
   ssocket_supla_socket_free(supla_socket);
 
-  safe_array_remove(serverconnection::reg_pending_arr, this);
+  if (serverconnection::reg_pending_arr) {
+    safe_array_remove(serverconnection::reg_pending_arr, this);
+  }
+  lck_free(lck);
   supla_log(LOG_DEBUG, "Connection Finished");
 }
 
@@ -168,7 +189,7 @@ void serverconnection::catch_incorrect_call(unsigned int call_type) {
 
   if (incorrect_call_counter >= INCORRECT_CALL_MAXCOUNT) {
     supla_log(LOG_DEBUG, "The number of incorrect calls has been exceeded.");
-    sthread_terminate(sthread);
+    terminate();
   }
 }
 
@@ -876,7 +897,7 @@ void serverconnection::on_remote_call_received(void *_srpc, unsigned int rr_id,
       }
 
     } else {
-      sthread_terminate(sthread);
+      terminate();
     }
   }
 
@@ -884,9 +905,7 @@ end:
   srpc_rd_free(&rd);
 }
 
-void serverconnection::execute(void *sthread) {
-  this->sthread = sthread;
-
+bool serverconnection::prologue(void) {
   int concurrent_registrations_limit =
       scfg_int(CFG_LIMIT_CONCURRENT_REGISTRATIONS);
 
@@ -915,49 +934,56 @@ void serverconnection::execute(void *sthread) {
 
   if (concurrent_registrations_limit > 0) {
     supla_log(LOG_DEBUG, "Connection Dropped");
-    sthread_terminate(sthread);
-    return;
+    terminate();
+    return false;
   }
 
-  if (ssocket_accept_ssl(ssd, supla_socket) != 1) {
-    sthread_terminate(sthread);
-    return;
+  return true;
+}
+
+bool serverconnection::iterate(void) {
+  if (srpc_iterate(_srpc) == SUPLA_RESULT_FALSE) {
+    // supla_log(LOG_DEBUG, "srpc_iterate(_srpc) == SUPLA_RESULT_FALSE");
+    return false;
   }
 
-  supla_log(LOG_DEBUG, "Connection Started %i, secure=%i", sthread,
-            ssocket_is_secure(ssd));
+  if (registered == REG_NONE) {
+    // TERMINATE IF REGISTRATION TIMEOUT
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    if (now.tv_sec - init_time.tv_sec >= REGISTER_WAIT_TIMEOUT) {
+      terminate();
+      supla_log(LOG_DEBUG, "Reg timeout", this);
+      return false;
+    }
 
-  while (sthread_isterminated(sthread) == 0) {
-    eh_wait(eh, registered == REG_NONE ? 1000000 : cdptr->waitTimeUSec());
+  } else {
+    cdptr->iterate();
 
-    if (srpc_iterate(_srpc) == SUPLA_RESULT_FALSE) {
-      // supla_log(LOG_DEBUG, "srpc_iterate(_srpc) == SUPLA_RESULT_FALSE");
-      break;
+    if (cdptr->getActivityDelay() >= GetActivityTimeout()) {
+      terminate();
+      supla_log(LOG_DEBUG, "Activity timeout %i, %i, %i", this,
+                cdptr->getActivityDelay(), registered);
+      return false;
     }
+  }
 
-    if (registered == REG_NONE) {
-      // TERMINATE IF REGISTRATION TIMEOUT
-      struct timeval now;
-      gettimeofday(&now, NULL);
+  return true;
+}
 
-      if (now.tv_sec - init_time.tv_sec >= REGISTER_WAIT_TIMEOUT) {
-        sthread_terminate(sthread);
-        supla_log(LOG_DEBUG, "Reg timeout", sthread);
-        break;
-      }
+unsigned _supla_int64_t serverconnection::wait_time_usec(void) {
+  return registered == REG_NONE ? 1000000 : cdptr->waitTimeUSec();
+}
 
-    } else {
-      cdptr->iterate();
+bool serverconnection::register_wait_timeout_exceeded(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
 
-      if (cdptr->getActivityDelay() >= GetActivityTimeout()) {
-        sthread_terminate(sthread);
-        supla_log(LOG_DEBUG, "Activity timeout %i, %i, %i", sthread,
-                  cdptr->getActivityDelay(), registered);
-        break;
-      }
-    }
-  }
+  return now.tv_sec - init_time.tv_sec >= REGISTER_WAIT_TIMEOUT;
+}
 
+void serverconnection::epilogue_begin(void) {
   if (cdptr != NULL) {
     supla_user *user = cdptr->getUser();
 
@@ -968,38 +994,90 @@ void serverconnection::execute(void *sthread) {
         user->moveClientToTrash(client);
       }
     }
+  }
+}
 
-    {
-      unsigned long deadlock_counter = 0;
-
-      while (cdptr->ptrCounter() > 1) {
-        usleep(100);
-        deadlock_counter++;
-        if (deadlock_counter > 100000) {
-          supla_log(
-              LOG_WARNING,
-              "Too long waiting time to release the object pointer! %i/%i",
-              sthread, cdptr);
-          break;
-        }
-      }
-    }
+void serverconnection::epilogue_end(void) {
+  if (cdptr == NULL) {
+    delete this;
+    return;
+  }
 
-    cdptr->releasePtr();
+  supla_user *user = cdptr->getUser();
 
-    if (user) {
-      user->emptyTrash();
+  if (user) {
+    cdbase *cd = cdptr;
+    // The trash is emptied by other threads too, so after releasePtr() both
+    // objects may already be deleted.
+    cd->takeOverSvrConn();
+    cd->releasePtr();
+    user->emptyTrash();
+  } else {
+    if (registered == REG_DEVICE) {
+      delete device;
     } else {
-      if (registered == REG_DEVICE) {
-        delete device;
-      } else {
-        delete client;
-      }
+      delete client;
+    }
+
+    delete this;
+  }
+}
+
+void serverconnection::execute(void *sthread) {
+  this->sthread = sthread;
+
+  if (!prologue()) {
+    return;
+  }
+
+  if (ssocket_accept_ssl(ssd, supla_socket) != 1) {
+    terminate();
+    return;
+  }
+
+  supla_log(LOG_DEBUG, "Connection Started %i, secure=%i", sthread,
+            ssocket_is_secure(ssd));
+
+  while (sthread_isterminated(sthread) == 0) {
+    eh_wait(eh, wait_time_usec());
+
+    if (!iterate()) {
+      break;
     }
   }
+
+  epilogue_begin();
+
+  // The thread is released when this method returns, while the device or
+  // the client may still be terminated by other threads.
+  lck_lock(lck);
+  this->sthread = NULL;
+  lck_unlock(lck);
+}
+
+void serverconnection::terminate(void) {
+  lck_lock(lck);
+  terminated = true;
+
+  if (sthread) {
+    sthread_terminate(sthread);
+  } else {
+    eh_raise_event(eh);
+  }
+  lck_unlock(lck);
+}
+
+bool serverconnection::is_terminated(void) {
+  bool result = false;
+
+  lck_lock(lck);
+  result = terminated;
+  lck_unlock(lck);
+
+  return result;
 }
 
-void serverconnection::terminate(void) { sthread_terminate(sthread); }
+TEventHandler *serverconnection::get_eh(void) { return eh; }
 
 unsigned int serverconnection::getClientIpv4(void) { return client_ipv4; }
 
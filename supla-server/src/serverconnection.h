@@ -29,6 +29,7 @@
 class supla_client;
 class supla_device;
 class cdbase;
+class supla_connection_reactor;
 
 class serverconnection {
  private:
@@ -47,11 +48,15 @@ class serverconnection {
                                unsigned _supla_int_t *CaptionSize);
 
  protected:
+  friend class supla_connection_reactor;
+
   unsigned int client_ipv4;
   void *ssd;
   void *supla_socket;
   void *_srpc;
   void *sthread;
+  void *lck;
+  bool terminated;
   TEventHandler *eh;
 
   struct timeval init_time;
@@ -68,14 +73,28 @@ class serverconnection {
   int incorrect_call_counter;
   void catch_incorrect_call(unsigned int call_type);
 
+  bool prologue(void);
+  bool iterate(void);
+  unsigned _supla_int64_t wait_time_usec(void);
+  bool register_wait_timeout_exceeded(void);
+  void epilogue_begin(void);
+
  public:
   static unsigned int local_ipv4[LOCAL_IPV4_ARRAY_SIZE];
-  serverconnection(void *ssd, void *supla_socket, unsigned int client_ipv4);
+  serverconnection(void *ssd, void *supla_socket, unsigned int client_ipv4,
+                   bool event_loop = false);
   static void init(void);
   static void serverconnection_free(void);
   static int registration_pending_count();
   void execute(void *sthread);
+  // Deletes the connection. If its device or client is still used by other
+  // threads, the connection is handed over to it and deleted together with
+  // it once the last pointer is released. The object must not be used after
+  // this call.
+  void epilogue_end(void);
   void terminate(void);
+  bool is_terminated(void);
+  TEventHandler *get_eh(void);
   virtual ~serverconnection();
 
   int socket_read(void *buf, size_t count);
@@ -23,10 +23,13 @@
 #include "accept_loop.h"
 #include "asynctask/asynctask_default_thread_pool.h"
 #include "asynctask/asynctask_queue.h"
+#include "connection_reactor.h"
 #include "database.h"
 #include "datalogger.h"
+#include "http/httpengine.h"
 #include "http/httprequestqueue.h"
 #include "http/trivialhttps.h"
+#include "ipc_reactor.h"
 #include "ipcsocket.h"
 #include "lck.h"
 #include "log.h"
@@ -91,9 +94,12 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  database::pool_init();
+
 #ifndef NOSSL
   sslcrypto_init();
   supla_trivial_https::init();
+  supla_http_engine::init();
   supla_http_request_queue::init();
 
   if (scfg_bool(CFG_SSL_ENABLED) == 1) {
@@ -119,7 +125,10 @@ int main(int argc, char *argv[]) {
   }
 
   supla_user::init();
+  supla_channel_value_writer::global_instance();
   serverconnection::init();
+  supla_connection_reactor::init();
+  supla_ipc_reactor::init(scfg_int(CFG_IPC_EVENT_LOOP_THREADS));
 
   st_setpidfile(pidfile_path);
   st_mainloop_init();
@@ -154,8 +163,10 @@ int main(int argc, char *argv[]) {
   // MAIN LOOP
   while (st_app_terminate == 0) {
     st_mainloop_wait(1000000);
+    supla_user::empty_all_trash();
     supla_user::log_metrics(3600);
     supla_http_request_queue::getInstance()->logMetrics(3600);
+    supla_mqtt_client_suite::globalInstance()->logMetrics(3600);
     supla_http_request_queue::getInstance()->logStuckWarning();
     supla_asynctask_queue::global_instance()->log_stuck_warning();
   }
@@ -175,6 +186,8 @@ int main(int argc, char *argv[]) {
     ipcsocket_free(ipc);
   }
 
+  supla_ipc_reactor::reactor_free();  // after the IPC accept loop
+
   if (ssd_ssl != NULL) {
     ssocket_close(ssd_ssl);
     sthread_twf(ssl_accept_loop_thread);  // ! after ssocket_close and before
@@ -189,6 +202,8 @@ int main(int argc, char *argv[]) {
     ssocket_free(ssd_tcp);
   }
 
+  supla_connection_reactor::reactor_free();  // after the accept loops
+
   sthread_twf(datalogger_loop_thread);
   sthread_twf(http_request_queue_loop_thread);
 
@@ -199,10 +214,14 @@ int main(int argc, char *argv[]) {
 
   // ! after serverconnection_free() and before user_free()
   supla_http_request_queue::queueFree();
+  supla_http_engine::engine_free();  // after the http request threads
   supla_mqtt_client_suite::globalInstanceRelease();
   // -----------------------------------------------
 
+  // The last values of the channels are stored here
+  supla_channel_value_writer::global_instance_release();
   supla_user::user_free();
+  database::pool_free();
   database::mainthread_end();
   sslcrypto_free();
 
@@ -94,6 +94,51 @@ unsigned char svrcfg_init(int argc, char *argv[]) {
   scfg_add_str_param(s_mqtt, "client_id", NULL);
   scfg_add_int_param(s_mqtt, "keep_alive_sec", 30);
 
+  // 0 - one thread per connection
+  scfg_add_int_param(s_net, "event_loop_threads", 0);
+  // [ms] 0 - channel value changes are sent to clients immediately
+  scfg_add_int_param(s_net, "client_value_update_window", 0);
+
+  char *s_datalogger = "DATALOGGER";
+  // 1 - all channels are logged at the same moment of the interval
+  scfg_add_int_param(s_datalogger, "shard_count", 1);
+
+  // Idle connections kept open for reuse. 0 - connection per database object
+  scfg_add_int_param(s_mysql, "pool_size", 10);
+
+  // Devices whose registration data is kept. 0 - cache disabled
+  scfg_add_int_param(s_limit, "registration_cache_size", 100000);
+  // [sec] Applies also to the authkey cache. 0 - no expiration
+  scfg_add_int_param(s_limit, "registration_cache_ttl", 3600);
+
+  // [ms] 0 - channel values are written on every change
+  scfg_add_int_param(s_mysql, "channel_value_flush_interval", 1000);
+
+  // 0 - every request blocks its own thread on the sockets
+  scfg_add_int_param(s_http, "engine_threads", 2);
+  // [ms] Connect, send and receive of a single request
+  scfg_add_int_param(s_http, "transfer_timeout", 10000);
+  // Idle connections kept open per host. 0 - connection per request
+  scfg_add_int_param(s_http, "connection_pool_size", 10);
+  // [sec]
+  scfg_add_int_param(s_http, "connection_idle_timeout", 30);
+  // [ms] The longest time events are gathered into one queued report
+  scfg_add_int_param(s_http, "batch_window", 5000);
+
+  // Broker connections the publications are spread over by UserID
+  scfg_add_int_param(s_mqtt, "publisher_count", 1);
+
+  // 0 - one thread per IPC connection
+  scfg_add_int_param(s_ipc, "event_loop_threads", 0);
+
+  // [sec] Metadata shared by the clients of one access identifier.
+  // 0 - every client reads its own
+  scfg_add_int_param(s_limit, "client_metadata_cache_ttl", 60);
+
+  // Threads that iterate the connections of the event loop threads, so that
+  // registrations and database queries do not stall the loop
+  scfg_add_int_param(s_net, "event_loop_workers", 20);
+
 #ifdef __TEST
   result = scfg_load(argc, argv, "/etc/supla-server/supla-test.cfg");
 #else
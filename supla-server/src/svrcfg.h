@@ -78,6 +78,23 @@ extern "C" {
 #define CFG_MQTT_CLIENTID 31
 #define CFG_MQTT_KEEP_ALIVE_SEC 32
 
+#define CFG_NET_EVENT_LOOP_THREADS 33
+#define CFG_NET_CLIENT_VALUE_UPDATE_WINDOW 34
+#define CFG_DATALOGGER_SHARD_COUNT 35
+#define CFG_MYSQL_POOL_SIZE 36
+#define CFG_LIMIT_REGISTRATION_CACHE_SIZE 37
+#define CFG_LIMIT_REGISTRATION_CACHE_TTL 38
+#define CFG_MYSQL_CHANNEL_VALUE_FLUSH_INTERVAL 39
+#define CFG_HTTP_ENGINE_THREADS 40
+#define CFG_HTTP_TRANSFER_TIMEOUT 41
+#define CFG_HTTP_CONNECTION_POOL_SIZE 42
+#define CFG_HTTP_CONNECTION_IDLE_TIMEOUT 43
+#define CFG_HTTP_BATCH_WINDOW 44
+#define CFG_MQTT_PUBLISHER_COUNT 45
+#define CFG_IPC_EVENT_LOOP_THREADS 46
+#define CFG_LIMIT_CLIENT_METADATA_CACHE_TTL 47
+#define CFG_NET_EVENT_LOOP_WORKERS 48
+
 extern char* svrcfg_oauth_url_base64;
 extern int svrcfg_oauth_url_base64_len;
 
@@ -17,11 +17,170 @@
  */
 
 #include "svrdb.h"
+#include <mysql.h>
+#include <stddef.h>
+#include "lck.h"
+#include "log.h"
 #include "svrcfg.h"
 
+void *svrdb::pool_lck = NULL;
+int svrdb::pool_size = 0;
+std::list<svrdb_pool_item_t> svrdb::pool;
+
 svrdb::svrdb(void) : dbcommon() {}
 
-svrdb::~svrdb(void) {}
+svrdb::~svrdb(void) {
+  // dbcommon's destructor would close the connection instead of returning it
+  // to the pool.
+  disconnect();
+}
+
+// static
+void svrdb::pool_init(void) {
+  pool_size = scfg_int(CFG_MYSQL_POOL_SIZE);
+  if (pool_size <= 0) {
+    pool_size = 0;
+    return;
+  }
+
+  pool_lck = lck_init();
+
+  for (int a = 0; a < pool_size; a++) {
+    svrdb *db = new svrdb();
+    bool connected = db->dbcommon::connect(0);
+    delete db;
+
+    if (!connected) {
+      break;
+    }
+  }
+
+  lck_lock(pool_lck);
+  supla_log(LOG_DEBUG, "Database connection pool: %i/%i", (int)pool.size(),
+            pool_size);
+  lck_unlock(pool_lck);
+}
+
+// static
+void svrdb::pool_free(void) {
+  if (pool_lck == NULL) {
+    return;
+  }
+
+  lck_lock(pool_lck);
+  while (!pool.empty()) {
+    mysql_close((MYSQL *)pool.front().mysql);
+    pool.pop_front();
+  }
+  lck_unlock(pool_lck);
+
+  lck_free(pool_lck);
+  pool_lck = NULL;
+}
+
+// static
+void *svrdb::pool_get(void) {
+  if (pool_lck == NULL) {
+    return NULL;
+  }
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  while (true) {
+    svrdb_pool_item_t item;
+    item.mysql = NULL;
+
+    lck_lock(pool_lck);
+    if (!pool.empty()) {
+      item = pool.front();
+      pool.pop_front();
+    }
+    lck_unlock(pool_lck);
+
+    if (item.mysql == NULL) {
+      return NULL;
+    }
+
+    if (now.tv_sec - item.released_at.tv_sec < SVRDB_POOL_PING_INTERVAL_SEC ||
+        mysql_ping((MYSQL *)item.mysql) == 0) {
+      return item.mysql;
+    }
+
+    mysql_close((MYSQL *)item.mysql);
+  }
+}
+
+// static
+bool svrdb::pool_put(void *mysql) {
+  if (pool_lck == NULL) {
+    return false;
+  }
+
+  svrdb_pool_item_t item;
+  item.mysql = mysql;
+  gettimeofday(&item.released_at, NULL);
+
+  bool result = false;
+
+  lck_lock(pool_lck);
+  if (pool.size() < (unsigned int)pool_size) {
+    // The most recently used connections are handed out first so that the
+    // ones needed only at peak times stay at the back.
+    pool.push_front(item);
+    result = true;
+  }
+  lck_unlock(pool_lck);
+
+  return result;
+}
+
+bool svrdb::connect(int connection_timeout_sec) {
+  if (_mysql == NULL && (_mysql = pool_get()) != NULL) {
+    return true;
+  }
+
+  return dbcommon::connect(connection_timeout_sec);
+}
+
+void svrdb::disconnect(void) {
+  if (_mysql != NULL) {
+    if (in_transaction) {
+      rollback();
+    }
+
+    if (is_reusable() && pool_put(_mysql)) {
+      _mysql = NULL;
+    }
+  }
+
+  dbcommon::disconnect();
+}
+
+bool svrdb::is_reusable(void) {
+  MYSQL *mysql = static_cast<MYSQL *>(_mysql);
+
+  if (mysql_errno(mysql) != 0 || last_stmt_errno != 0 ||
+      mysql_more_results(mysql)) {
+    return false;
+  }
+
+  // Clears user variables, session settings, temporary tables and prepared
+  // statements left by the previous borrower. It fails when a result set
+  // has not been read.
+  if (mysql_reset_connection(mysql) != 0) {
+    return false;
+  }
+
+  // The reset restores the character set agreed during the handshake,
+  // not the one set by connect().
+  if (mysql_set_character_set(mysql, "utf8mb4") != 0) {
+    return false;
+  }
+
+  last_stmt_errno = 0;
+  return true;
+}
 
 char *svrdb::cfg_get_host(void) { return scfg_string(CFG_MYSQL_HOST); }
 
@@ -20,8 +20,30 @@
 #define SVRDB_H_
 
 #include <dbcommon.h>
+#include <sys/time.h>
+#include <list>
+
+// A pooled connection that has been idle for longer than this is pinged
+// before it is handed out again.
+#define SVRDB_POOL_PING_INTERVAL_SEC 30
+
+typedef struct {
+  void *mysql;
+  struct timeval released_at;
+} svrdb_pool_item_t;
 
 class svrdb : public dbcommon {
+ private:
+  static void *pool_lck;
+  static int pool_size;
+  static std::list<svrdb_pool_item_t> pool;
+
+  static void *pool_get(void);
+  static bool pool_put(void *mysql);
+  // Resets the session so that nothing of it leaks to the next borrower.
+  // Returns false if the connection has to be closed instead.
+  bool is_reusable(void);
+
  protected:
   virtual char *cfg_get_host(void);
   virtual char *cfg_get_user(void);
@@ -32,6 +54,13 @@ class svrdb : public dbcommon {
  public:
   svrdb(void);
   virtual ~svrdb(void);
+
+  using dbcommon::connect;
+  virtual bool connect(int connection_timeout_sec);
+  virtual void disconnect(void);
+
+  static void pool_init(void);
+  static void pool_free(void);
 };
 
 #endif /* SVRDB_H_ */
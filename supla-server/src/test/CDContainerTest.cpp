@@ -91,6 +91,35 @@ TEST_F(CDContainerTest, moveToTrashWithPtrUse) {
   delete container;
 }
 
+TEST_F(CDContainerTest, handedOverConnectionIsDeletedWithItem) {
+  STCDContainer *container = new STCDContainer();
+  ASSERT_FALSE(container == NULL);
+
+  serverconnection *conn = new serverconnection(NULL, NULL, 0, true);
+  CDBaseMock *cd = new CDBaseMock(conn);
+  ASSERT_FALSE(cd == NULL);
+
+  container->addToList(cd);
+  cd->retainPtr();  // The connection
+  cd->retainPtr();  // Another thread
+
+  container->moveToTrash(cd);
+  cd->takeOverSvrConn();
+  cd->releasePtr();
+
+  ASSERT_FALSE(container->emptyTrash());
+  ASSERT_EQ(1, container->trashCount());
+  ASSERT_EQ(0, container->delCount());
+
+  cd->releasePtr();
+
+  ASSERT_TRUE(container->emptyTrash());
+  ASSERT_EQ(0, container->trashCount());
+  ASSERT_EQ(1, container->delCount());
+
+  delete container;
+}
+
 TEST_F(CDContainerTest, findItem) {
   STCDContainer *container = new STCDContainer();
   ASSERT_FALSE(container == NULL);
@@ -0,0 +1,55 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ChannelValueWriterMock.h"
+
+ChannelValueWriterMock::ChannelValueWriterMock(int flush_interval_ms)
+    : supla_channel_value_writer(flush_interval_ms) {
+  write_count = 0;
+  write_result = true;
+}
+
+ChannelValueWriterMock::~ChannelValueWriterMock(void) {
+  // The thread must not call write() of a partially destroyed object, and
+  // nothing may be left for the database writer of the base class.
+  stop();
+  write_result = true;
+  flush();
+}
+
+bool ChannelValueWriterMock::write(
+    std::vector<supla_channel_value_write_t *> *items) {
+  write_count++;
+  for (std::vector<supla_channel_value_write_t *>::iterator it =
+           items->begin();
+       it != items->end(); ++it) {
+    written.push_back(**it);
+  }
+  return write_result;
+}
+
+void ChannelValueWriterMock::setWriteResult(bool write_result) {
+  this->write_result = write_result;
+}
+
+int ChannelValueWriterMock::getWriteCount(void) { return write_count; }
+
+std::vector<supla_channel_value_write_t> ChannelValueWriterMock::getWritten(
+    void) {
+  return written;
+}
@@ -0,0 +1,43 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CHANNEL_VALUE_WRITER_MOCK_H_
+#define CHANNEL_VALUE_WRITER_MOCK_H_
+
+#include <vector>
+#include "channel_value_writer.h"
+
+class ChannelValueWriterMock : public supla_channel_value_writer {
+ protected:
+  std::vector<supla_channel_value_write_t> written;
+  int write_count;
+
+  bool write_result;
+
+  bool write(std::vector<supla_channel_value_write_t *> *items);
+
+ public:
+  explicit ChannelValueWriterMock(int flush_interval_ms);
+  virtual ~ChannelValueWriterMock(void);
+
+  void setWriteResult(bool write_result);
+  int getWriteCount(void);
+  std::vector<supla_channel_value_write_t> getWritten(void);
+};
+
+#endif /* CHANNEL_VALUE_WRITER_MOCK_H_ */
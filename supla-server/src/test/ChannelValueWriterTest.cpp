@@ -0,0 +1,129 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ChannelValueWriterTest.h"
+#include <string.h>
+#include <unistd.h>
+#include "ChannelValueWriterMock.h"
+
+namespace testing {
+
+ChannelValueWriterTest::ChannelValueWriterTest(void) {}
+ChannelValueWriterTest::~ChannelValueWriterTest(void) {}
+
+TEST_F(ChannelValueWriterTest, latestValuePerChannel) {
+  ChannelValueWriterMock writer(100000);
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  memset(value, 0, SUPLA_CHANNELVALUE_SIZE);
+
+  for (int a = 0; a < 10; a++) {
+    value[0] = a;
+    writer.update(1, 5, value, 60);
+    writer.update(2, 5, value, 0);
+  }
+
+  EXPECT_EQ(2, writer.pending_count());
+  EXPECT_EQ(0, writer.getWriteCount());
+
+  writer.flush();
+
+  EXPECT_EQ(0, writer.pending_count());
+  ASSERT_EQ(1, writer.getWriteCount());
+
+  std::vector<supla_channel_value_write_t> written = writer.getWritten();
+  ASSERT_EQ((size_t)2, written.size());
+
+  for (size_t a = 0; a < written.size(); a++) {
+    EXPECT_EQ(9, written[a].value[0]);
+    EXPECT_EQ(5, written[a].UserID);
+    EXPECT_EQ(written[a].ChannelID == 1 ? 60U : 0U,
+              written[a].validity_time_sec);
+  }
+
+  writer.flush();
+  EXPECT_EQ(1, writer.getWriteCount());
+}
+
+TEST_F(ChannelValueWriterTest, flushOnTimer) {
+  ChannelValueWriterMock *writer = new ChannelValueWriterMock(50);
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  memset(value, 1, SUPLA_CHANNELVALUE_SIZE);
+
+  writer->update(1, 5, value, 60);
+
+  for (int a = 0; a < 50 && writer->pending_count() > 0; a++) {
+    usleep(20000);
+  }
+
+  EXPECT_EQ(0, writer->pending_count());
+  delete writer;
+}
+
+TEST_F(ChannelValueWriterTest, expiredValuesAreSkipped) {
+  ChannelValueWriterMock writer(100000);
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  memset(value, 0, SUPLA_CHANNELVALUE_SIZE);
+
+  writer.update(1, 5, value, 1);
+  writer.update(2, 5, value, 60);
+  sleep(1);
+  writer.flush();
+
+  std::vector<supla_channel_value_write_t> written = writer.getWritten();
+  ASSERT_EQ((size_t)1, written.size());
+  EXPECT_EQ(2, written[0].ChannelID);
+  EXPECT_GE(60U, written[0].validity_time_sec);
+  EXPECT_LE(59U, written[0].validity_time_sec);
+}
+
+TEST_F(ChannelValueWriterTest, failedWriteIsRetried) {
+  ChannelValueWriterMock writer(100000);
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  memset(value, 0, SUPLA_CHANNELVALUE_SIZE);
+
+  value[0] = 1;
+  writer.update(1, 5, value, 60);
+  writer.update(2, 5, value, 0);
+
+  writer.setWriteResult(false);
+  writer.flush();
+  EXPECT_EQ(1, writer.getWriteCount());
+  EXPECT_EQ(2, writer.pending_count());
+
+  // The newer value of channel 2 replaces the one that was not written.
+  value[0] = 2;
+  writer.update(2, 5, value, 0);
+  writer.setWriteResult(false);
+  writer.flush();
+  EXPECT_EQ(2, writer.pending_count());
+
+  value[0] = 3;
+  writer.update(2, 5, value, 0);
+  writer.setWriteResult(true);
+  writer.flush();
+  EXPECT_EQ(0, writer.pending_count());
+
+  std::vector<supla_channel_value_write_t> written = writer.getWritten();
+  ASSERT_EQ((size_t)6, written.size());
+
+  for (size_t a = 4; a < written.size(); a++) {
+    EXPECT_EQ(written[a].ChannelID == 1 ? 1 : 3, written[a].value[0]);
+  }
+}
+
+}  // namespace testing
@@ -0,0 +1,117 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ClientMetadataTest.h"
+#include <string.h>
+#include <string>
+#include "clientmetadatacache.h"
+
+namespace testing {
+
+ClientMetadataTest::ClientMetadataTest(void) {}
+ClientMetadataTest::~ClientMetadataTest(void) {}
+
+TEST_F(ClientMetadataTest, addRows) {
+  supla_client_metadata *md = new supla_client_metadata(1, 2, 0);
+  char value[SUPLA_CHANNELVALUE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+  md->add_location(10, "Home");
+  md->add_channel(20, 30, 10, SUPLA_CHANNELTYPE_RELAY,
+                  SUPLA_CHANNELFNC_POWERSWITCH, 1, 2, 3, "PLN", NULL, NULL,
+                  "Lamp", 4, 5, 6, 7, 8, 9, value, 0);
+  md->add_channel_group(40, 10, SUPLA_CHANNELFNC_POWERSWITCH, NULL, 1, 2);
+  md->add_relation(20, 40, true, 30);
+
+  ASSERT_EQ((size_t)1, md->get_locations().size());
+  EXPECT_EQ(10, md->get_locations()[0].Id);
+  EXPECT_STREQ("Home", md->get_locations()[0].Caption);
+
+  ASSERT_EQ((size_t)1, md->get_channels().size());
+  const supla_client_metadata_channel_t *channel = &md->get_channels()[0];
+  EXPECT_EQ(20, channel->Id);
+  EXPECT_EQ(30, channel->DeviceId);
+  EXPECT_EQ(SUPLA_CHANNELFNC_POWERSWITCH, channel->Func);
+  EXPECT_STREQ("PLN", channel->TextParam1);
+  EXPECT_TRUE(channel->TextParam2 == NULL);
+  EXPECT_STREQ("Lamp", channel->Caption);
+  EXPECT_EQ(0, memcmp(value, channel->Value, SUPLA_CHANNELVALUE_SIZE));
+
+  ASSERT_EQ((size_t)1, md->get_channel_groups().size());
+  EXPECT_EQ(40, md->get_channel_groups()[0].Id);
+  EXPECT_TRUE(md->get_channel_groups()[0].Caption == NULL);
+
+  ASSERT_EQ((size_t)1, md->get_relations().size());
+  EXPECT_TRUE(md->get_relations()[0].Hidden);
+
+  md->release();
+}
+
+TEST_F(ClientMetadataTest, captionIsTruncated) {
+  supla_client_metadata *md = new supla_client_metadata(1, 2, 0);
+
+  std::string caption(SUPLA_LOCATION_CAPTION_MAXSIZE * 2, 'x');
+  md->add_location(10, caption.c_str());
+
+  EXPECT_EQ((size_t)SUPLA_LOCATION_CAPTION_MAXSIZE,
+            strlen(md->get_locations()[0].Caption));
+
+  md->release();
+}
+
+TEST_F(ClientMetadataTest, validityTimeCountsFromLoad) {
+  supla_client_metadata *md = new supla_client_metadata(1, 2, 0);
+  char value[SUPLA_CHANNELVALUE_SIZE] = {};
+
+  md->add_channel(20, 30, 10, 0, 0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, 0,
+                  0, 0, 0, value, 0);
+  md->add_channel(21, 30, 10, 0, 0, 0, 0, 0, NULL, NULL, NULL, NULL, 0, 0, 0,
+                  0, 0, 0, value, 100);
+
+  EXPECT_EQ((unsigned _supla_int_t)0,
+            md->get_validity_time_sec(&md->get_channels()[0]));
+
+  unsigned _supla_int_t sec =
+      md->get_validity_time_sec(&md->get_channels()[1]);
+  EXPECT_LE(sec, (unsigned _supla_int_t)100);
+  EXPECT_GE(sec, (unsigned _supla_int_t)99);
+
+  md->release();
+}
+
+TEST_F(ClientMetadataTest, retainAndRelease) {
+  supla_client_metadata *md = new supla_client_metadata(1, 2, 3);
+
+  EXPECT_EQ(md, md->retain());
+  md->release();
+
+  EXPECT_EQ(1, md->get_user_id());
+  EXPECT_EQ(2, md->get_access_id());
+  EXPECT_EQ(3, md->get_device_id());
+
+  md->release();
+}
+
+TEST_F(ClientMetadataTest, disabledCacheKeepsNothing) {
+  supla_client_metadata_cache cache(0);
+  EXPECT_EQ(0, cache.count());
+
+  cache.user_invalidate(1);
+  EXPECT_EQ(0, cache.count());
+}
+
+}  // namespace testing
@@ -0,0 +1,31 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CLIENTMOCK_H_
+#define CLIENTMOCK_H_
+
+#include "client/client.h"
+
+class ClientMock : public supla_client {
+ public:
+  explicit ClientMock(serverconnection *svrconn);
+  void scheduleValueUpdate(int window_ms);
+  bool valueUpdateDue(void);
+};
+
+#endif /* CLIENTMOCK_H_ */
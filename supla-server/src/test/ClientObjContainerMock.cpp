@@ -0,0 +1,79 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ClientObjContainerMock.h"
+#include <stddef.h>
+
+ClientObjContainerItemMock::ClientObjContainerItemMock(
+    supla_client_objcontainer *Container, int Id, int ExtraId)
+    : supla_client_objcontainer_item(Container, Id, NULL) {
+  this->ExtraId = ExtraId;
+}
+
+int ClientObjContainerItemMock::getExtraId(void) { return ExtraId; }
+
+bool ClientObjContainerItemMock::remote_update_is_possible(void) {
+  return true;
+}
+
+ClientObjContainerMock::ClientObjContainerMock(unsigned int pack_size)
+    : supla_client_objcontainer(NULL) {
+  this->pack_size = pack_size;
+  this->visited = 0;
+}
+
+void ClientObjContainerMock::_load(supla_client_metadata *md,
+                                   e_objc_scope scope) {}
+
+bool ClientObjContainerMock::get_data_for_remote(
+    supla_client_objcontainer_item *obj, void **data, int data_type,
+    bool *check_more, e_objc_scope scope) {
+  *check_more = true;
+  visited++;
+
+  std::vector<int> *pack = static_cast<std::vector<int> *>(*data);
+  if (pack == NULL) {
+    pack = new std::vector<int>();
+    *data = pack;
+  }
+
+  if (pack->size() >= pack_size) {
+    return false;
+  }
+
+  pack->push_back(obj->getId());
+  return true;
+}
+
+void ClientObjContainerMock::send_data_to_remote_and_free(void *srpc,
+                                                          void *data,
+                                                          int data_type,
+                                                          e_objc_scope scope) {
+  std::vector<int> *pack = static_cast<std::vector<int> *>(data);
+  sent.push_back(*pack);
+  delete pack;
+}
+
+int ClientObjContainerMock::available_data_types_for_remote(
+    e_objc_scope scope) {
+  return OI_REMOTEUPDATE_DATA1;
+}
+
+void ClientObjContainerMock::value_changed(void *srpc, int Id, int ExtraId) {
+  on_value_changed(srpc, Id, ExtraId, master, OI_REMOTEUPDATE_DATA1);
+}
@@ -0,0 +1,60 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef CLIENT_OBJCONTAINER_MOCK_H_
+#define CLIENT_OBJCONTAINER_MOCK_H_
+
+#include <vector>
+#include "clientobjcontainer.h"
+#include "clientobjcontaineritem.h"
+
+class ClientObjContainerItemMock : public supla_client_objcontainer_item {
+ private:
+  int ExtraId;
+
+ public:
+  ClientObjContainerItemMock(supla_client_objcontainer *Container, int Id,
+                             int ExtraId);
+  int getExtraId(void);
+  bool remote_update_is_possible(void);
+};
+
+// Sends the IDs of the marked items in packs of pack_size.
+class ClientObjContainerMock : public supla_client_objcontainer {
+ private:
+  unsigned int pack_size;
+
+ protected:
+  void _load(supla_client_metadata *md, e_objc_scope scope);
+  bool get_data_for_remote(supla_client_objcontainer_item *obj, void **data,
+                           int data_type, bool *check_more, e_objc_scope scope);
+  void send_data_to_remote_and_free(void *srpc, void *data, int data_type,
+                                    e_objc_scope scope);
+  int available_data_types_for_remote(e_objc_scope scope);
+
+ public:
+  // IDs of the sent items, one vector per pack
+  std::vector<std::vector<int> > sent;
+  // Items passed to get_data_for_remote()
+  int visited;
+
+  explicit ClientObjContainerMock(unsigned int pack_size);
+  void value_changed(void *srpc, int Id, int ExtraId);
+};
+
+#endif /* CLIENT_OBJCONTAINER_MOCK_H_ */
@@ -0,0 +1,122 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ClientObjContainerTest.h"
+
+namespace testing {
+
+ClientObjContainerTest::ClientObjContainerTest(void) {}
+ClientObjContainerTest::~ClientObjContainerTest(void) {}
+
+void ClientObjContainerTest::add_items(ClientObjContainerMock *container,
+                                       int count, int ExtraId) {
+  int first = container->count() + 1;
+  for (int a = first; a < first + count; a++) {
+    ASSERT_TRUE(
+        container->add(new ClientObjContainerItemMock(container, a, ExtraId)));
+  }
+}
+
+TEST_F(ClientObjContainerTest, addedItemsAreSentOnce) {
+  ClientObjContainerMock container(10);
+  add_items(&container, 3, 100);
+
+  EXPECT_TRUE(container.remote_update(NULL));
+  ASSERT_EQ((size_t)1, container.sent.size());
+  ASSERT_EQ((size_t)3, container.sent[0].size());
+  EXPECT_EQ(1, container.sent[0][0]);
+  EXPECT_EQ(2, container.sent[0][1]);
+  EXPECT_EQ(3, container.sent[0][2]);
+
+  container.visited = 0;
+  EXPECT_FALSE(container.remote_update(NULL));
+  EXPECT_EQ((size_t)1, container.sent.size());
+  EXPECT_EQ(0, container.visited);
+}
+
+TEST_F(ClientObjContainerTest, fullPacksAreSentOneByOne) {
+  ClientObjContainerMock container(2);
+  add_items(&container, 5, 100);
+
+  EXPECT_TRUE(container.remote_update(NULL));
+  EXPECT_TRUE(container.remote_update(NULL));
+  EXPECT_TRUE(container.remote_update(NULL));
+  EXPECT_FALSE(container.remote_update(NULL));
+
+  ASSERT_EQ((size_t)3, container.sent.size());
+  EXPECT_EQ((size_t)2, container.sent[0].size());
+  EXPECT_EQ((size_t)2, container.sent[1].size());
+  ASSERT_EQ((size_t)1, container.sent[2].size());
+  EXPECT_EQ(5, container.sent[2][0]);
+}
+
+TEST_F(ClientObjContainerTest, onlyChangedItemsAreVisited) {
+  ClientObjContainerMock container(10);
+  add_items(&container, 500, 100);
+  add_items(&container, 3, 200);
+
+  while (container.remote_update(NULL)) {
+  }
+  EXPECT_EQ((size_t)51, container.sent.size());
+  container.sent.clear();
+  container.visited = 0;
+
+  container.value_changed(NULL, 502, 200);
+  EXPECT_TRUE(container.remote_update(NULL));
+  ASSERT_EQ((size_t)1, container.sent.size());
+  ASSERT_EQ((size_t)1, container.sent[0].size());
+  EXPECT_EQ(502, container.sent[0][0]);
+  EXPECT_EQ(1, container.visited);
+
+  container.sent.clear();
+  container.visited = 0;
+
+  // Id == 0 - all items with the given ExtraId
+  container.value_changed(NULL, 0, 200);
+  EXPECT_TRUE(container.remote_update(NULL));
+  ASSERT_EQ((size_t)1, container.sent.size());
+  EXPECT_EQ((size_t)3, container.sent[0].size());
+  EXPECT_EQ(3, container.visited);
+}
+
+TEST_F(ClientObjContainerTest, itemIsQueuedOnce) {
+  ClientObjContainerMock container(10);
+  add_items(&container, 2, 100);
+  EXPECT_TRUE(container.remote_update(NULL));
+  container.sent.clear();
+
+  container.value_changed(NULL, 1, 100);
+  container.value_changed(NULL, 1, 100);
+  container.value_changed(NULL, 1, 100);
+
+  EXPECT_TRUE(container.remote_update(NULL));
+  ASSERT_EQ((size_t)1, container.sent.size());
+  EXPECT_EQ((size_t)1, container.sent[0].size());
+  EXPECT_FALSE(container.remote_update(NULL));
+}
+
+TEST_F(ClientObjContainerTest, unknownExtraId) {
+  ClientObjContainerMock container(10);
+  add_items(&container, 2, 100);
+  EXPECT_TRUE(container.remote_update(NULL));
+
+  container.value_changed(NULL, 1, 101);
+  EXPECT_FALSE(container.remote_update(NULL));
+}
+
+}  // namespace testing
@@ -0,0 +1,82 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "ClientValueUpdateTest.h"
+#include <unistd.h>
+#include "ClientMock.h"
+#include "gtest/gtest.h"  // NOLINT
+
+namespace {
+
+class ClientValueUpdateTest : public ::testing::Test {
+ protected:
+};
+
+TEST_F(ClientValueUpdateTest, notDueWithoutSchedule) {
+  ClientMock *client = new ClientMock(NULL);
+  ASSERT_FALSE(client->valueUpdateDue());
+  ASSERT_EQ((unsigned _supla_int64_t)120000000, client->waitTimeUSec());
+  delete client;
+}
+
+TEST_F(ClientValueUpdateTest, dueOnceWindowExpires) {
+  ClientMock *client = new ClientMock(NULL);
+
+  client->scheduleValueUpdate(100);
+  ASSERT_FALSE(client->valueUpdateDue());
+
+  unsigned _supla_int64_t wait = client->waitTimeUSec();
+  ASSERT_GT(wait, (unsigned _supla_int64_t)0);
+  ASSERT_LE(wait, (unsigned _supla_int64_t)100000);
+
+  usleep(110000);
+  ASSERT_EQ((unsigned _supla_int64_t)0, client->waitTimeUSec());
+  ASSERT_TRUE(client->valueUpdateDue());
+
+  // The window is reset once it has been consumed.
+  ASSERT_FALSE(client->valueUpdateDue());
+  ASSERT_EQ((unsigned _supla_int64_t)120000000, client->waitTimeUSec());
+  delete client;
+}
+
+TEST_F(ClientValueUpdateTest, laterChangesDoNotExtendTheWindow) {
+  ClientMock *client = new ClientMock(NULL);
+
+  client->scheduleValueUpdate(100);
+  usleep(60000);
+  client->scheduleValueUpdate(100);
+
+  ASSERT_LE(client->waitTimeUSec(), (unsigned _supla_int64_t)40000);
+
+  usleep(50000);
+  ASSERT_TRUE(client->valueUpdateDue());
+  delete client;
+}
+
+TEST_F(ClientValueUpdateTest, windowOverOneSecond) {
+  ClientMock *client = new ClientMock(NULL);
+
+  client->scheduleValueUpdate(1500);
+  unsigned _supla_int64_t wait = client->waitTimeUSec();
+  ASSERT_GT(wait, (unsigned _supla_int64_t)1400000);
+  ASSERT_LE(wait, (unsigned _supla_int64_t)1500000);
+  ASSERT_FALSE(client->valueUpdateDue());
+  delete client;
+}
+
+}  // namespace
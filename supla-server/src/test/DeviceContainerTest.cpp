@@ -0,0 +1,144 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "DeviceContainerTest.h"
+#include <string.h>
+#include "device/device.h"
+#include "gtest/gtest.h"  // NOLINT
+#include "user/devicecontainer.h"
+
+namespace {
+
+class DeviceContainerTest : public ::testing::Test {
+ protected:
+  supla_device *newDevice(int ChannelID1, int ChannelID2);
+};
+
+supla_device *DeviceContainerTest::newDevice(int ChannelID1,
+                                             int ChannelID2) {
+  char value[SUPLA_CHANNELVALUE_SIZE];
+  memset(value, 0, SUPLA_CHANNELVALUE_SIZE);
+
+  supla_device *device = new supla_device(NULL);
+  device->get_channels()->add_channel(ChannelID1, 0, 1, 0, 0, 0, 0, 0, NULL,
+                                      NULL, NULL, false, 0, value, 0);
+  device->get_channels()->add_channel(ChannelID2, 1, 1, 0, 0, 0, 0, 0, NULL,
+                                      NULL, NULL, false, 0, value, 0);
+  return device;
+}
+
+TEST_F(DeviceContainerTest, findByChannelID) {
+  supla_user_device_container *container = new supla_user_device_container();
+  supla_device *device1 = newDevice(10, 11);
+  supla_device *device2 = newDevice(20, 21);
+
+  ASSERT_TRUE(container->findByChannelID(10) == NULL);
+
+  container->addToList(device1);
+  container->addToList(device2);
+
+  supla_device *device = container->findByChannelID(11);
+  ASSERT_TRUE(device == device1);
+  device->releasePtr();
+
+  device = container->findByChannelID(20);
+  ASSERT_TRUE(device == device2);
+  device->releasePtr();
+
+  ASSERT_TRUE(container->findByChannelID(0) == NULL);
+  ASSERT_TRUE(container->findByChannelID(30) == NULL);
+
+  container->deleteAll(0);
+  ASSERT_TRUE(container->findByChannelID(10) == NULL);
+  ASSERT_TRUE(container->findByChannelID(21) == NULL);
+  delete container;
+}
+
+TEST_F(DeviceContainerTest, channelIDOwnedByTwoDevices) {
+  supla_user_device_container *container = new supla_user_device_container();
+  // The same device connected twice, e.g. before the old connection closed.
+  supla_device *device1 = newDevice(10, 11);
+  supla_device *device2 = newDevice(10, 11);
+
+  container->addToList(device1);
+  container->addToList(device2);
+
+  supla_device *device = container->findByChannelID(10);
+  ASSERT_TRUE(device == device1 || device == device2);
+  device->releasePtr();
+
+  container->moveToTrash(device1);
+
+  device = container->findByChannelID(10);
+  ASSERT_TRUE(device == device2);
+  device->releasePtr();
+
+  device = container->findByChannelID(11);
+  ASSERT_TRUE(device == device2);
+  device->releasePtr();
+
+  container->moveToTrash(device2);
+  ASSERT_TRUE(container->findByChannelID(10) == NULL);
+
+  container->deleteAll(0);
+  delete container;
+}
+
+TEST_F(DeviceContainerTest, removedFromIndexBeforeTrash) {
+  supla_user_device_container *container = new supla_user_device_container();
+  supla_device *device1 = newDevice(10, 11);
+
+  container->addToList(device1);
+
+  supla_device *device = container->findByChannelID(10);
+  ASSERT_TRUE(device == device1);
+
+  // The device is still in use, so it stays in the trash.
+  container->moveToTrash(device1);
+  ASSERT_EQ(1, container->trashCount());
+  ASSERT_TRUE(container->findByChannelID(10) == NULL);
+  ASSERT_TRUE(container->findByChannelID(11) == NULL);
+
+  device->releasePtr();
+  container->deleteAll(0);
+  ASSERT_EQ(0, container->trashCount());
+  delete container;
+}
+
+TEST_F(DeviceContainerTest, backOnTheListAfterTrash) {
+  supla_user_device_container *container = new supla_user_device_container();
+  supla_device *device1 = newDevice(10, 11);
+
+  container->addToList(device1);
+
+  supla_device *device = container->findByChannelID(10);
+  container->moveToTrash(device1);
+  container->addToList(device1);
+  device->releasePtr();
+
+  ASSERT_EQ(0, container->trashCount());
+
+  device = container->findByChannelID(11);
+  ASSERT_TRUE(device == device1);
+  device->releasePtr();
+
+  container->deleteAll(0);
+  delete container;
+}
+
+}  // namespace
@@ -0,0 +1,200 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "DeviceRegistrationCacheTest.h"
+#include <string.h>
+#include <unistd.h>
+
+namespace testing {
+
+DeviceRegistrationCacheTest::DeviceRegistrationCacheTest(void) {}
+DeviceRegistrationCacheTest::~DeviceRegistrationCacheTest(void) {}
+
+void DeviceRegistrationCacheTest::init_data(
+    supla_device_registration_data_t *data, int UserID, char GUIDByte,
+    int DeviceID) {
+  data->UserID = UserID;
+  memset(data->GUID, GUIDByte, SUPLA_GUID_SIZE);
+  data->DeviceID = DeviceID;
+  data->DeviceEnabled = true;
+  data->OriginalLocationID = 0;
+  data->LocationID = 10;
+  data->LocationEnabled = true;
+  data->channels.clear();
+
+  supla_device_registration_channel_t channel;
+  channel.Number = 0;
+  channel.Type = SUPLA_CHANNELTYPE_RELAY;
+  data->channels.push_back(channel);
+  channel.Number = 1;
+  channel.Type = SUPLA_CHANNELTYPE_THERMOMETERDS18B20;
+  data->channels.push_back(channel);
+}
+
+TEST_F(DeviceRegistrationCacheTest, setAndGet) {
+  supla_device_registration_cache cache(10, 0);
+  supla_device_registration_data_t data;
+
+  init_data(&data, 1, 5, 100);
+  ASSERT_FALSE(cache.get(1, data.GUID, &data));
+
+  cache.set(&data);
+  EXPECT_EQ(1, cache.count());
+
+  supla_device_registration_data_t cached;
+  ASSERT_TRUE(cache.get(1, data.GUID, &cached));
+  EXPECT_EQ(100, cached.DeviceID);
+  EXPECT_EQ(10, cached.LocationID);
+  EXPECT_EQ(2, (int)cached.channels.size());
+  EXPECT_EQ(SUPLA_CHANNELTYPE_THERMOMETERDS18B20,
+            supla_device_registration_cache::get_channel_type(&cached, 1));
+  EXPECT_EQ(0, supla_device_registration_cache::get_channel_type(&cached, 2));
+
+  EXPECT_FALSE(cache.get(2, data.GUID, &cached));
+
+  data.GUID[0] = 6;
+  EXPECT_FALSE(cache.get(1, data.GUID, &cached));
+}
+
+TEST_F(DeviceRegistrationCacheTest, update) {
+  supla_device_registration_cache cache(10, 0);
+  supla_device_registration_data_t data;
+
+  init_data(&data, 1, 5, 100);
+  cache.set(&data);
+
+  data.OriginalLocationID = 20;
+  data.channels.pop_back();
+  cache.set(&data);
+  EXPECT_EQ(1, cache.count());
+
+  supla_device_registration_data_t cached;
+  ASSERT_TRUE(cache.get(1, data.GUID, &cached));
+  EXPECT_EQ(20, cached.OriginalLocationID);
+  EXPECT_EQ(1, (int)cached.channels.size());
+}
+
+TEST_F(DeviceRegistrationCacheTest, sizeLimit) {
+  supla_device_registration_cache cache(3, 0);
+  supla_device_registration_data_t data;
+
+  for (int a = 1; a <= 5; a++) {
+    init_data(&data, 1, a, 100 + a);
+    cache.set(&data);
+  }
+
+  EXPECT_EQ(3, cache.count());
+
+  init_data(&data, 1, 1, 0);
+  EXPECT_FALSE(cache.get(1, data.GUID, &data));
+
+  init_data(&data, 1, 5, 0);
+  ASSERT_TRUE(cache.get(1, data.GUID, &data));
+  EXPECT_EQ(105, data.DeviceID);
+}
+
+TEST_F(DeviceRegistrationCacheTest, oldestIsEvictedAfterInvalidation) {
+  supla_device_registration_cache cache(3, 0);
+  supla_device_registration_data_t data;
+
+  for (int a = 1; a <= 3; a++) {
+    init_data(&data, a, a, 100 + a);
+    cache.set(&data);
+  }
+
+  cache.user_invalidate(2);
+
+  // Refreshing an entry makes it the most recent one.
+  init_data(&data, 1, 1, 101);
+  cache.set(&data);
+
+  init_data(&data, 4, 4, 104);
+  cache.set(&data);
+  init_data(&data, 5, 5, 105);
+  cache.set(&data);
+
+  EXPECT_EQ(3, cache.count());
+
+  init_data(&data, 3, 3, 0);
+  EXPECT_FALSE(cache.get(3, data.GUID, &data));
+
+  init_data(&data, 1, 1, 0);
+  EXPECT_TRUE(cache.get(1, data.GUID, &data));
+
+  init_data(&data, 4, 4, 0);
+  EXPECT_TRUE(cache.get(4, data.GUID, &data));
+
+  init_data(&data, 5, 5, 0);
+  EXPECT_TRUE(cache.get(5, data.GUID, &data));
+}
+
+TEST_F(DeviceRegistrationCacheTest, disabled) {
+  supla_device_registration_cache cache(0, 0);
+  supla_device_registration_data_t data;
+
+  init_data(&data, 1, 5, 100);
+  cache.set(&data);
+
+  EXPECT_EQ(0, cache.count());
+  EXPECT_FALSE(cache.get(1, data.GUID, &data));
+}
+
+TEST_F(DeviceRegistrationCacheTest, invalidate) {
+  supla_device_registration_cache cache(10, 0);
+  supla_device_registration_data_t data;
+
+  init_data(&data, 1, 1, 101);
+  cache.set(&data);
+  init_data(&data, 1, 2, 102);
+  cache.set(&data);
+  init_data(&data, 2, 3, 103);
+  cache.set(&data);
+
+  EXPECT_EQ(3, cache.count());
+
+  cache.device_invalidate(1, 102);
+  EXPECT_EQ(2, cache.count());
+  init_data(&data, 1, 2, 0);
+  EXPECT_FALSE(cache.get(1, data.GUID, &data));
+
+  init_data(&data, 1, 1, 0);
+  EXPECT_TRUE(cache.get(1, data.GUID, &data));
+
+  cache.user_invalidate(1);
+  EXPECT_EQ(1, cache.count());
+  EXPECT_FALSE(cache.get(1, data.GUID, &data));
+
+  init_data(&data, 2, 3, 0);
+  EXPECT_TRUE(cache.get(2, data.GUID, &data));
+}
+
+TEST_F(DeviceRegistrationCacheTest, expiration) {
+  supla_device_registration_cache cache(10, 1);
+  supla_device_registration_data_t data;
+
+  init_data(&data, 1, 5, 100);
+  cache.set(&data);
+  ASSERT_TRUE(cache.get(1, data.GUID, &data));
+
+  sleep(2);
+
+  EXPECT_FALSE(cache.get(1, data.GUID, &data));
+  EXPECT_EQ(0, cache.count());
+}
+
+}  // namespace testing
@@ -0,0 +1,39 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef DEVICE_REGISTRATION_CACHE_TEST_H_
+#define DEVICE_REGISTRATION_CACHE_TEST_H_
+
+#include "device_registration_cache.h"
+#include "gtest/gtest.h"  // NOLINT
+
+namespace testing {
+
+class DeviceRegistrationCacheTest : public Test {
+ protected:
+  void init_data(supla_device_registration_data_t *data, int UserID,
+                 char GUIDByte, int DeviceID);
+
+ public:
+  DeviceRegistrationCacheTest();
+  virtual ~DeviceRegistrationCacheTest();
+};
+
+} /* namespace testing */
+
+#endif /* DEVICE_REGISTRATION_CACHE_TEST_H_ */
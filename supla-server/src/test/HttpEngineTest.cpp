@@ -0,0 +1,266 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "HttpEngineTest.h"
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "lck.h"
+#include "sthread.h"
+
+namespace testing {
+
+const char http_engine_test_request[] =
+    "GET /test HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+
+typedef struct {
+  void *lck;
+  bool done;
+  bool success;
+} _http_engine_test_result_t;
+
+static void http_engine_test_done(void *_result, bool success, char *in) {
+  _http_engine_test_result_t *result =
+      static_cast<_http_engine_test_result_t *>(_result);
+
+  lck_lock(result->lck);
+  result->done = true;
+  result->success = success;
+  lck_unlock(result->lck);
+
+  free(in);
+}
+
+HttpEngineTest::HttpEngineTest(void) {}
+HttpEngineTest::~HttpEngineTest(void) {}
+
+void HttpEngineTest::SetUp() {
+  listen_fd = -1;
+  port = 0;
+  response_delay_ms = 0;
+  keep_alive = false;
+  connection_count = 0;
+  server_sthread = NULL;
+  ai = NULL;
+
+  supla_http_engine::init();
+  ASSERT_TRUE(supla_http_engine::is_enabled());
+
+  listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_NE(listen_fd, -1);
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+
+  ASSERT_EQ(0, bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)));
+  ASSERT_EQ(0, listen(listen_fd, 10));
+
+  socklen_t len = sizeof(addr);
+  ASSERT_EQ(0, getsockname(listen_fd, (struct sockaddr *)&addr, &len));
+  port = ntohs(addr.sin_port);
+
+  char service[15];
+  snprintf(service, sizeof(service), "%i", port);
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+
+  ASSERT_EQ(0, getaddrinfo("127.0.0.1", service, &hints, &ai));
+}
+
+void HttpEngineTest::TearDown() {
+  // Closes the idle connections the server is waiting on.
+  supla_http_engine::engine_free();
+
+  if (listen_fd != -1) {
+    shutdown(listen_fd, SHUT_RDWR);
+  }
+
+  if (server_sthread) {
+    sthread_twf(server_sthread);
+  }
+
+  if (listen_fd != -1) {
+    close(listen_fd);
+  }
+
+  if (ai) {
+    freeaddrinfo(ai);
+  }
+}
+
+// static
+void HttpEngineTest::server_loop(void *_test, void *sthread) {
+  HttpEngineTest *test = static_cast<HttpEngineTest *>(_test);
+  int fd = -1;
+
+  while ((fd = accept(test->listen_fd, NULL, NULL)) != -1) {
+    test->connection_count++;
+
+    while (true) {
+      char buffer[1024] = {};
+      size_t size = 0;
+
+      while (size < sizeof(buffer) - 1 &&
+             strstr(buffer, "\r\n\r\n") == NULL) {
+        ssize_t n = recv(fd, &buffer[size], sizeof(buffer) - 1 - size, 0);
+        if (n <= 0) {
+          break;
+        }
+        size += n;
+      }
+
+      if (strstr(buffer, "\r\n\r\n") == NULL) {
+        break;
+      }
+
+      usleep(test->response_delay_ms * 1000);
+
+      const char *response =
+          test->keep_alive
+              ? "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+                "Content-Length: 5\r\n\r\nHello"
+              : "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n"
+                "Content-Length: 5\r\nConnection: close\r\n\r\nHello";
+
+      send(fd, response, strlen(response), MSG_NOSIGNAL);
+
+      if (!test->keep_alive) {
+        break;
+      }
+    }
+
+    close(fd);
+  }
+}
+
+void HttpEngineTest::start_server(void) {
+  server_sthread = sthread_simple_run(server_loop, this, 0);
+}
+
+TEST_F(HttpEngineTest, perform) {
+  start_server();
+
+  char *in = NULL;
+  unsigned long long id = 1;
+
+  ASSERT_TRUE(supla_http_engine::perform(ai, NULL, http_engine_test_request,
+                                         &in, 1000, &id));
+  ASSERT_TRUE(in != NULL);
+  EXPECT_EQ(0, strncmp(in, "HTTP/1.1 200 OK", 15));
+  EXPECT_TRUE(strstr(in, "\r\n\r\nHello") != NULL);
+  EXPECT_EQ((unsigned long long)0, id);
+
+  free(in);
+}
+
+TEST_F(HttpEngineTest, deadlineExceeded) {
+  response_delay_ms = 1000;
+  start_server();
+
+  struct timeval start, now;
+  gettimeofday(&start, NULL);
+
+  char *in = NULL;
+  EXPECT_FALSE(supla_http_engine::perform(ai, NULL, http_engine_test_request,
+                                          &in, 100, NULL));
+  EXPECT_TRUE(in == NULL);
+
+  gettimeofday(&now, NULL);
+  EXPECT_LT((now.tv_sec - start.tv_sec) * 1000 +
+                (now.tv_usec - start.tv_usec) / 1000,
+            800);
+}
+
+TEST_F(HttpEngineTest, connectionRefused) {
+  // Nobody accepts connections on a closed listener's port.
+  close(listen_fd);
+  listen_fd = -1;
+
+  char *in = NULL;
+  EXPECT_FALSE(supla_http_engine::perform(ai, NULL, http_engine_test_request,
+                                          &in, 1000, NULL));
+  EXPECT_TRUE(in == NULL);
+}
+
+TEST_F(HttpEngineTest, cancel) {
+  response_delay_ms = 1000;
+  start_server();
+
+  _http_engine_test_result_t result = {};
+  result.lck = lck_init();
+  result.success = true;
+
+  unsigned long long id =
+      supla_http_engine::submit(ai, NULL, http_engine_test_request, 5000,
+                                http_engine_test_done, &result);
+  ASSERT_GT(id, (unsigned long long)0);
+
+  supla_http_engine::cancel_transfer(id);
+
+  bool done = false;
+  for (int a = 0; a < 100 && !done; a++) {
+    usleep(10000);
+    lck_lock(result.lck);
+    done = result.done;
+    lck_unlock(result.lck);
+  }
+
+  EXPECT_TRUE(done);
+  EXPECT_FALSE(result.success);
+
+  lck_free(result.lck);
+}
+
+TEST_F(HttpEngineTest, keepAlive) {
+  keep_alive = true;
+  start_server();
+
+  for (int a = 0; a < 3; a++) {
+    char *in = NULL;
+    ASSERT_TRUE(supla_http_engine::perform(
+        ai, NULL, http_engine_test_request, &in, 1000, NULL));
+    ASSERT_TRUE(in != NULL);
+    EXPECT_TRUE(strstr(in, "\r\n\r\nHello") != NULL);
+    free(in);
+  }
+
+  EXPECT_EQ(1, connection_count);
+}
+
+TEST_F(HttpEngineTest, connectionClose) {
+  start_server();
+
+  for (int a = 0; a < 2; a++) {
+    char *in = NULL;
+    ASSERT_TRUE(supla_http_engine::perform(
+        ai, NULL, http_engine_test_request, &in, 1000, NULL));
+    free(in);
+  }
+
+  EXPECT_EQ(2, connection_count);
+}
+
+}  // namespace testing
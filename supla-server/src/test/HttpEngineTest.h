@@ -0,0 +1,50 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef HTTP_ENGINE_TEST_H_
+#define HTTP_ENGINE_TEST_H_
+
+#include <netdb.h>
+#include "gtest/gtest.h"  // NOLINT
+#include "http/httpengine.h"
+
+namespace testing {
+
+class HttpEngineTest : public Test {
+ protected:
+  int listen_fd;
+  int port;
+  int response_delay_ms;
+  bool keep_alive;
+  int connection_count;
+  void *server_sthread;
+  struct addrinfo *ai;
+
+  static void server_loop(void *test, void *sthread);
+  void start_server(void);
+
+ public:
+  HttpEngineTest();
+  virtual ~HttpEngineTest();
+  virtual void SetUp();
+  virtual void TearDown();
+};
+
+} /* namespace testing */
+
+#endif /* HTTP_ENGINE_TEST_H_ */
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "HttpRequestMock.h"
+#include <stdio.h>
+#include "TrivialHttpMock.h"
+
+#define HTTP_REQUEST_MOCK_CLASS_ID 1000
+
+HttpRequestMock::HttpRequestMock(supla_user *user, int DeviceId,
+                                 int ChannelId)
+    : supla_http_request(user, HTTP_REQUEST_MOCK_CLASS_ID, DeviceId,
+                         ChannelId, ET_CHANNEL_VALUE_CHANGED, EST_DEVICE) {
+  postponeUs = 0;
+  mergedInto = NULL;
+}
+
+HttpRequestMock::~HttpRequestMock() {}
+
+void HttpRequestMock::setPostponeUs(unsigned long long postponeUs) {
+  this->postponeUs = postponeUs;
+}
+
+supla_http_request *HttpRequestMock::getMergedInto(void) {
+  return mergedInto;
+}
+
+bool HttpRequestMock::isCancelled(void *sthread) { return false; }
+
+bool HttpRequestMock::verifyExisting(supla_http_request *existing) {
+  mergedInto = existing;
+  if (postponeUs) {
+    existing->postpone(postponeUs);
+  }
+  return true;
+}
+
+bool HttpRequestMock::queueUp(void) { return mergedInto == NULL; }
+
+bool HttpRequestMock::isEventSourceTypeAccepted(
+    event_source_type eventSourceType, bool verification) {
+  return true;
+}
+
+bool HttpRequestMock::isEventTypeAccepted(event_type eventType,
+                                          bool verification) {
+  return true;
+}
+
+void HttpRequestMock::execute(void *sthread) {
+  char resource[50];
+  snprintf(resource, sizeof(resource), "/%i/%i", getUserID(), getChannelId());
+
+  TrivialHttpMock http;
+  http.setHost((char *)"localhost");
+  http.setResource(resource);
+  http.http_get();
+}
@@ -0,0 +1,47 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef HTTPREQUESTMOCK_H_
+#define HTTPREQUESTMOCK_H_
+
+#include "http/httprequest.h"
+
+class HttpRequestMock : public supla_http_request {
+ private:
+  unsigned long long postponeUs;
+  supla_http_request *mergedInto;
+
+ public:
+  HttpRequestMock(supla_user *user, int DeviceId, int ChannelId);
+  virtual ~HttpRequestMock();
+
+  // Delay added to the existing request this one is merged into.
+  void setPostponeUs(unsigned long long postponeUs);
+  supla_http_request *getMergedInto(void);
+
+  virtual bool isCancelled(void *sthread);
+  virtual bool verifyExisting(supla_http_request *existing);
+  virtual bool queueUp(void);
+  virtual bool isEventSourceTypeAccepted(event_source_type eventSourceType,
+                                         bool verification);
+  virtual bool isEventTypeAccepted(event_type eventType, bool verification);
+  // Sends GET /<UserID>/<ChannelId> through TrivialHttpMock.
+  virtual void execute(void *sthread);
+};
+
+#endif /* HTTPREQUESTMOCK_H_ */
@@ -0,0 +1,39 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "HttpRequestQueueMock.h"
+#include <sys/time.h>
+#include "http/httprequest.h"
+
+HttpRequestQueueMock::HttpRequestQueueMock() : supla_http_request_queue() {}
+
+HttpRequestQueueMock::~HttpRequestQueueMock() {}
+
+supla_http_request *HttpRequestQueueMock::pop(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return queuePop(NULL, &now);
+}
+
+int HttpRequestQueueMock::size(void) { return queueSize(); }
+
+void HttpRequestQueueMock::addOrMerge(supla_http_request *request) {
+  supla_http_request_queue::addOrMerge(
+      request, request->getDeviceId(), request->getChannelId(),
+      request->getEventSourceType(), NULL, NULL);
+}
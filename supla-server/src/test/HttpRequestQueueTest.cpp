@@ -0,0 +1,139 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "HttpRequestQueueTest.h"
+#include <stdio.h>
+#include "HttpRequestMock.h"
+#include "TrivialHttpMock.h"
+#include "svrcfg.h"
+
+namespace testing {
+
+void HttpRequestQueueTest::SetUp() {
+  // Requests reschedule the queue instance whenever their delay changes.
+  supla_http_request_queue::init();
+  queue = new HttpRequestQueueMock();
+  user1 = new supla_user(1);
+  user2 = new supla_user(2);
+  user3 = new supla_user(3);
+}
+
+void HttpRequestQueueTest::TearDown() {
+  delete queue;
+  supla_http_request_queue::queueFree();
+  delete user1;
+  delete user2;
+  delete user3;
+}
+
+bool HttpRequestQueueTest::popAndExecute(int UserID, int ChannelId) {
+  supla_http_request *request = queue->pop();
+  if (request == NULL) {
+    return false;
+  }
+
+  request->execute(NULL);
+  delete request;
+
+  char expected[100];
+  snprintf(expected, sizeof(expected),
+           "GET /%i/%i HTTP/1.1\r\nHost: localhost\r\n"
+           "User-Agent: supla-server\r\nConnection: close\r\n\r\n",
+           UserID, ChannelId);
+
+  return TrivialHttpMock::outputEqualTo(expected);
+}
+
+TEST_F(HttpRequestQueueTest, roundRobinBetweenUsers) {
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 10));
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 11));
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 12));
+  queue->addOrMerge(new HttpRequestMock(user2, 2, 20));
+  queue->addOrMerge(new HttpRequestMock(user3, 3, 30));
+
+  ASSERT_EQ(queue->size(), 5);
+
+  EXPECT_TRUE(popAndExecute(1, 10));
+  EXPECT_TRUE(popAndExecute(2, 20));
+  EXPECT_TRUE(popAndExecute(3, 30));
+  EXPECT_TRUE(popAndExecute(1, 11));
+  EXPECT_TRUE(popAndExecute(1, 12));
+
+  EXPECT_TRUE(queue->pop() == NULL);
+  EXPECT_EQ(queue->size(), 0);
+}
+
+TEST_F(HttpRequestQueueTest, waitingRequestDoesNotBlockLaterOnes) {
+  HttpRequestMock *waiting = new HttpRequestMock(user1, 1, 10);
+  waiting->setDelay(10000000);
+  queue->addOrMerge(waiting);
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 11));
+
+  EXPECT_TRUE(popAndExecute(1, 11));
+  EXPECT_TRUE(queue->pop() == NULL);
+  EXPECT_EQ(queue->size(), 1);
+}
+
+TEST_F(HttpRequestQueueTest, coalescingOnlyWithinUserFifo) {
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 10));
+
+  HttpRequestMock *request = new HttpRequestMock(user2, 1, 10);
+  queue->addOrMerge(request);
+  EXPECT_TRUE(request->getMergedInto() == NULL);
+  EXPECT_EQ(queue->size(), 2);
+
+  request = new HttpRequestMock(user1, 1, 11);
+  queue->addOrMerge(request);
+  EXPECT_TRUE(request->getMergedInto() == NULL);
+  EXPECT_EQ(queue->size(), 3);
+
+  queue->addOrMerge(new HttpRequestMock(user1, 1, 10));
+  EXPECT_EQ(queue->size(), 3);
+
+  EXPECT_TRUE(popAndExecute(1, 10));
+  EXPECT_TRUE(popAndExecute(2, 10));
+  EXPECT_TRUE(popAndExecute(1, 11));
+  EXPECT_TRUE(queue->pop() == NULL);
+}
+
+TEST_F(HttpRequestQueueTest, postponeCappedByBatchWindow) {
+  long long windowUs = scfg_int(CFG_HTTP_BATCH_WINDOW) * 1000LL;
+  ASSERT_GT(windowUs, 1000000);
+
+  HttpRequestMock *first = new HttpRequestMock(user1, 1, 10);
+  queue->addOrMerge(first);
+
+  HttpRequestMock *request = new HttpRequestMock(user1, 1, 10);
+  request->setPostponeUs(1000000);
+  queue->addOrMerge(request);
+
+  EXPECT_GT(first->timeLeft(NULL), 900000);
+  EXPECT_LE(first->timeLeft(NULL), 1000000);
+
+  request = new HttpRequestMock(user1, 1, 10);
+  request->setPostponeUs(windowUs * 10);
+  queue->addOrMerge(request);
+
+  EXPECT_GT(first->timeLeft(NULL), windowUs - 100000);
+  EXPECT_LE(first->timeLeft(NULL), windowUs);
+
+  EXPECT_EQ(queue->size(), 1);
+  EXPECT_TRUE(queue->pop() == NULL);
+}
+
+} /* namespace testing */
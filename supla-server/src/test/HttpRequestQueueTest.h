@@ -0,0 +1,45 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef HTTPREQUESTQUEUETEST_H_
+#define HTTPREQUESTQUEUETEST_H_
+
+#include "HttpRequestQueueMock.h"
+#include "gtest/gtest.h"  // NOLINT
+#include "user/user.h"
+
+namespace testing {
+
+class HttpRequestQueueTest : public Test {
+ protected:
+  supla_user *user1;
+  supla_user *user2;
+  supla_user *user3;
+  HttpRequestQueueMock *queue;
+
+  // Pops the next request, executes it and checks which one it was.
+  bool popAndExecute(int UserID, int ChannelId);
+
+ public:
+  virtual void SetUp();
+  virtual void TearDown();
+};
+
+} /* namespace testing */
+
+#endif /* HTTPREQUESTQUEUETEST_H_ */
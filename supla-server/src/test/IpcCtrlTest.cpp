@@ -0,0 +1,196 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "IpcCtrlTest.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "sthread.h"
+
+namespace testing {
+
+IpcCtrlTest::IpcCtrlTest(void) {}
+IpcCtrlTest::~IpcCtrlTest(void) {}
+
+// static
+void IpcCtrlTest::ipcctrl_execute(void *ipcctrl, void *sthread) {
+  static_cast<svr_ipcctrl *>(ipcctrl)->execute(sthread);
+}
+
+// static
+void IpcCtrlTest::ipcctrl_finish(void *ipcctrl, void *sthread) {
+  delete static_cast<svr_ipcctrl *>(ipcctrl);
+}
+
+void IpcCtrlTest::start(int sfd) {
+  Tsthread_params stp;
+  stp.execute = ipcctrl_execute;
+  stp.finish = ipcctrl_finish;
+  stp.user_data = new svr_ipcctrl(sfd);
+  stp.free_on_finish = 0;
+  stp.initialize = NULL;
+
+  ipcctrl_sthread = sthread_run(&stp);
+}
+
+int IpcCtrlTest::connect(void) {
+  int sv[2];
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+    return -1;
+  }
+
+  fcntl(sv[1], F_SETFL, O_NONBLOCK);
+  start(sv[1]);
+
+  // The greeting is followed by the terminating zero.
+  std::string hello = read_lines(sv[0], 1);
+  char zero = 1;
+
+  if (hello != "SUPLA SERVER CTRL\n" || recv(sv[0], &zero, 1, 0) != 1 ||
+      zero != 0) {
+    close(sv[0]);
+    return -1;
+  }
+
+  return sv[0];
+}
+
+void IpcCtrlTest::SetUp() {
+  ipcctrl_sthread = NULL;
+  fd = connect();
+  ASSERT_NE(-1, fd);
+}
+
+void IpcCtrlTest::TearDown() {
+  if (fd != -1) {
+    shutdown(fd, SHUT_RDWR);
+  }
+
+  if (ipcctrl_sthread) {
+    sthread_twf(ipcctrl_sthread);
+  }
+
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+void IpcCtrlTest::write_commands(const char *commands) {
+  write_commands(fd, commands);
+}
+
+void IpcCtrlTest::write_commands(int fd, const char *commands) {
+  ASSERT_EQ((ssize_t)strlen(commands),
+            send(fd, commands, strlen(commands), MSG_NOSIGNAL));
+}
+
+std::string IpcCtrlTest::read_lines(int count) {
+  return read_lines(fd, count);
+}
+
+std::string IpcCtrlTest::read_lines(int fd, int count) {
+  std::string result;
+
+  while (count > 0) {
+    struct pollfd pfd = {};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    if (poll(&pfd, 1, 1000) <= 0) {
+      break;
+    }
+
+    char c = 0;
+    if (recv(fd, &c, 1, 0) != 1) {
+      break;
+    }
+
+    result.push_back(c);
+    if (c == '\n') {
+      count--;
+    }
+  }
+
+  return result;
+}
+
+TEST_F(IpcCtrlTest, pipelinedCommands) {
+  write_commands(
+      "IS-CLIENT-CONNECTED:0,5\nGET-CHAR-VALUE:0,1,7\nFOO:1\n"
+      "IS-IODEV-CONNECTED:0,3\n");
+  EXPECT_EQ("DISCONNECTED:5\nUNKNOWN:7\nCOMMAND_UNKNOWN\nDISCONNECTED:3\n",
+            read_lines(4));
+}
+
+TEST_F(IpcCtrlTest, commandSplitAcrossWrites) {
+  write_commands("IS-IODEV-");
+  usleep(50000);
+  write_commands("CONNECTED:0,3\nIS-CLIENT");
+  EXPECT_EQ("DISCONNECTED:3\n", read_lines(1));
+
+  write_commands("-CONNECTED:0,4\n");
+  EXPECT_EQ("DISCONNECTED:4\n", read_lines(1));
+}
+
+TEST_F(IpcCtrlTest, prefixIsNotACommand) {
+  write_commands("IS-CLIENT-CONNECTED-X:0,5\nIS-CLIENT:0,5\n");
+  EXPECT_EQ("COMMAND_UNKNOWN\nCOMMAND_UNKNOWN\n", read_lines(2));
+}
+
+TEST_F(IpcCtrlTest, multiGet) {
+  write_commands("MULTI-GET:GET-CHAR-VALUE:0,1,2,3,4\n");
+  EXPECT_EQ("MULTI-GET:2\nUNKNOWN:2\nUNKNOWN:4\n", read_lines(3));
+
+  write_commands("MULTI-GET:IS-CHANNEL-CONNECTED:0,1,2\n");
+  EXPECT_EQ("MULTI-GET:1\nDISCONNECTED:2\n", read_lines(2));
+}
+
+TEST_F(IpcCtrlTest, multiGetWithUnsupportedCommand) {
+  write_commands("MULTI-GET:USER-RECONNECT:0,1,2\nMULTI-GET:\n");
+  EXPECT_EQ("COMMAND_UNKNOWN\nCOMMAND_UNKNOWN\n", read_lines(2));
+}
+
+TEST_F(IpcCtrlTest, multiGetAtLimit) {
+  // The longest getter and IDs of the maximum length.
+  std::string command = "MULTI-GET:GET-TEMPERATURE-VALUE:-2147483648";
+  std::string expected = "MULTI-GET:256\n";
+
+  for (int a = 0; a < IPC_MULTI_GET_MAX; a++) {
+    command.append(",-2147483648,-2147483648");
+    expected.append("UNKNOWN:-2147483648\n");
+  }
+
+  command.append("\n");
+  ASSERT_LT(command.size(), (size_t)IPC_LINE_MAXSIZE);
+
+  write_commands(command.c_str());
+  EXPECT_EQ(expected, read_lines(IPC_MULTI_GET_MAX + 1));
+}
+
+TEST_F(IpcCtrlTest, lineTooLong) {
+  std::string commands(IPC_LINE_MAXSIZE + 100, 'A');
+  commands.append("\nIS-CLIENT-CONNECTED:0,1\n");
+
+  write_commands(commands.c_str());
+  EXPECT_EQ("COMMAND_UNKNOWN\nDISCONNECTED:1\n", read_lines(2));
+}
+
+}  // namespace testing
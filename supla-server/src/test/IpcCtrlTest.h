@@ -0,0 +1,51 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef IPC_CTRL_TEST_H_
+#define IPC_CTRL_TEST_H_
+
+#include <string>
+#include "gtest/gtest.h"  // NOLINT
+#include "ipcctrl.h"
+
+namespace testing {
+
+class IpcCtrlTest : public Test {
+ protected:
+  int fd;
+  void *ipcctrl_sthread;
+
+  static void ipcctrl_execute(void *ipcctrl, void *sthread);
+  static void ipcctrl_finish(void *ipcctrl, void *sthread);
+  virtual void start(int sfd);
+  int connect(void);
+  void write_commands(const char *commands);
+  void write_commands(int fd, const char *commands);
+  std::string read_lines(int count);
+  std::string read_lines(int fd, int count);
+
+ public:
+  IpcCtrlTest();
+  virtual ~IpcCtrlTest();
+  virtual void SetUp();
+  virtual void TearDown();
+};
+
+} /* namespace testing */
+
+#endif /* IPC_CTRL_TEST_H_ */
@@ -0,0 +1,88 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "IpcReactorTest.h"
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace testing {
+
+IpcReactorTest::IpcReactorTest(void) {}
+IpcReactorTest::~IpcReactorTest(void) {}
+
+void IpcReactorTest::SetUp() {
+  supla_ipc_reactor::init(2);
+  ASSERT_TRUE(supla_ipc_reactor::is_enabled());
+
+  IpcCtrlTest::SetUp();
+}
+
+void IpcReactorTest::TearDown() {
+  IpcCtrlTest::TearDown();
+  supla_ipc_reactor::reactor_free();
+}
+
+void IpcReactorTest::start(int sfd) {
+  supla_ipc_reactor::dispatch(new svr_ipcctrl(sfd));
+}
+
+TEST_F(IpcReactorTest, pipelinedCommands) {
+  write_commands("IS-CLIENT-CONNECTED:0,5\nGET-CHAR-");
+  EXPECT_EQ("DISCONNECTED:5\n", read_lines(1));
+
+  write_commands("VALUE:0,1,7\nMULTI-GET:GET-RGBW-VALUE:0,1,2,3,4\n");
+  EXPECT_EQ("UNKNOWN:7\nMULTI-GET:2\nUNKNOWN:2\nUNKNOWN:4\n", read_lines(4));
+}
+
+TEST_F(IpcReactorTest, manyConnections) {
+  const int count = 50;
+  int fds[count];
+
+  for (int a = 0; a < count; a++) {
+    fds[a] = connect();
+    ASSERT_NE(-1, fds[a]);
+  }
+
+  for (int a = 0; a < count; a++) {
+    char command[50];
+    snprintf(command, sizeof(command), "IS-IODEV-CONNECTED:0,%i\n", a + 1);
+    write_commands(fds[a], command);
+  }
+
+  for (int a = 0; a < count; a++) {
+    char result[50];
+    snprintf(result, sizeof(result), "DISCONNECTED:%i\n", a + 1);
+    EXPECT_EQ(result, read_lines(fds[a], 1));
+  }
+
+  for (int a = 0; a < count; a++) {
+    close(fds[a]);
+  }
+}
+
+TEST_F(IpcReactorTest, closedByPeer) {
+  int other = connect();
+  ASSERT_NE(-1, other);
+  close(other);
+
+  write_commands("IS-CLIENT-CONNECTED:0,1\n");
+  EXPECT_EQ("DISCONNECTED:1\n", read_lines(1));
+}
+
+}  // namespace testing
@@ -0,0 +1,110 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "MqttDsQueueTest.h"
+#include "mqtt_ds_queue.h"
+
+namespace testing {
+
+MqttDsQueueTest::MqttDsQueueTest(void) {}
+
+MqttDsQueueTest::~MqttDsQueueTest(void) {}
+
+static bool mqtt_ds_queue_test_even(const int &item, void *arg) {
+  return item % 2 == 0;
+}
+
+TEST_F(MqttDsQueueTest, empty) {
+  supla_mqtt_ds_queue<int> queue;
+  int item = 0;
+  ASSERT_EQ(queue.size(), (size_t)0);
+  ASSERT_FALSE(queue.contains(1));
+  ASSERT_FALSE(queue.pop_front(&item));
+}
+
+TEST_F(MqttDsQueueTest, insertionOrder) {
+  supla_mqtt_ds_queue<int> queue;
+  ASSERT_TRUE(queue.push_back(3, 30));
+  ASSERT_TRUE(queue.push_back(1, 10));
+  ASSERT_TRUE(queue.push_back(2, 20));
+  ASSERT_EQ(queue.size(), (size_t)3);
+
+  int item = 0;
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 30);
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 10);
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 20);
+  ASSERT_FALSE(queue.pop_front(&item));
+}
+
+TEST_F(MqttDsQueueTest, deduplication) {
+  supla_mqtt_ds_queue<int> queue;
+  ASSERT_TRUE(queue.push_back(1, 10));
+  ASSERT_FALSE(queue.push_back(1, 11));
+  ASSERT_TRUE(queue.contains(1));
+  ASSERT_EQ(queue.size(), (size_t)1);
+
+  int item = 0;
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 10);
+  ASSERT_FALSE(queue.contains(1));
+  ASSERT_TRUE(queue.push_back(1, 12));
+}
+
+TEST_F(MqttDsQueueTest, removeIf) {
+  supla_mqtt_ds_queue<int> queue;
+  for (int a = 1; a <= 6; a++) {
+    ASSERT_TRUE(queue.push_back(a, a));
+  }
+
+  queue.remove_if(mqtt_ds_queue_test_even, NULL);
+  ASSERT_EQ(queue.size(), (size_t)3);
+  ASSERT_FALSE(queue.contains(2));
+  ASSERT_TRUE(queue.contains(3));
+
+  int item = 0;
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 1);
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 3);
+  ASSERT_TRUE(queue.pop_front(&item));
+  ASSERT_EQ(item, 5);
+}
+
+TEST_F(MqttDsQueueTest, maxSize) {
+  supla_mqtt_ds_queue<int> queue;
+  queue.push_back(1, 1);
+  queue.push_back(2, 2);
+  queue.push_back(3, 3);
+  queue.pop_front(NULL);
+  queue.pop_front(NULL);
+
+  ASSERT_EQ(queue.size(), (size_t)1);
+  ASSERT_EQ(queue.get_max_size(), (size_t)3);
+
+  queue.reset_max_size();
+  ASSERT_EQ(queue.get_max_size(), (size_t)1);
+
+  queue.clear();
+  ASSERT_EQ(queue.size(), (size_t)0);
+  ASSERT_FALSE(queue.contains(3));
+}
+
+}  // namespace testing
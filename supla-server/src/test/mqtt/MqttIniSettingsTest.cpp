@@ -48,6 +48,7 @@ TEST_F(MqttIniSettingsTest, serverConfigurationTest) {
 
   ASSERT_EQ(strcmp(clientId, "NunYnx-test"), 0);
   ASSERT_EQ(iniSettings->getKeepAlive(), 30);
+  ASSERT_EQ(iniSettings->getPublisherCount(), 1);
 }
 
 } /* namespace testing */
@@ -0,0 +1,52 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "MqttPublisherDataSourceMock.h"
+#include <string.h>
+
+MqttPublisherDataSourceMock::MqttPublisherDataSourceMock(
+    supla_mqtt_client_settings *settings)
+    : supla_mqtt_publisher_datasource(settings) {}
+
+MqttPublisherDataSourceMock::~MqttPublisherDataSourceMock(void) {}
+
+bool MqttPublisherDataSourceMock::digestUpdate(int user_id,
+                                               const char *topic_name,
+                                               const char *message,
+                                               bool skip_unchanged) {
+  return digest_update(user_id, topic_name, message,
+                       message ? strlen(message) : 0, skip_unchanged);
+}
+
+bool MqttPublisherDataSourceMock::digestExists(int user_id) {
+  return digests.find(user_id) != digests.end();
+}
+
+void MqttPublisherDataSourceMock::setDigestTime(int user_id, time_t time) {
+  digests[user_id].time.tv_sec = time;
+  digests[user_id].time.tv_usec = 0;
+}
+
+void MqttPublisherDataSourceMock::setLinkLostTime(time_t time) {
+  link_lost_time.tv_sec = time;
+  link_lost_time.tv_usec = 0;
+}
+
+void MqttPublisherDataSourceMock::enableUser(int user_id) {
+  users_enabled.insert(user_id);
+}
@@ -0,0 +1,37 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef MQTT_PUBLISHER_DATASOURCE_MOCK_H_
+#define MQTT_PUBLISHER_DATASOURCE_MOCK_H_
+
+#include "mqtt_publisher_datasource.h"
+
+class MqttPublisherDataSourceMock : public supla_mqtt_publisher_datasource {
+ public:
+  explicit MqttPublisherDataSourceMock(supla_mqtt_client_settings *settings);
+  virtual ~MqttPublisherDataSourceMock(void);
+
+  bool digestUpdate(int user_id, const char *topic_name, const char *message,
+                    bool skip_unchanged);
+  bool digestExists(int user_id);
+  void setDigestTime(int user_id, time_t time);
+  void setLinkLostTime(time_t time);
+  void enableUser(int user_id);
+};
+
+#endif /* MQTT_PUBLISHER_DATASOURCE_MOCK_H_ */
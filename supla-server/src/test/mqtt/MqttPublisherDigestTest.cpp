@@ -0,0 +1,145 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "MqttPublisherDigestTest.h"
+#include <sys/time.h>
+
+namespace testing {
+
+MqttPublisherDigestTest::MqttPublisherDigestTest(void) {}
+MqttPublisherDigestTest::~MqttPublisherDigestTest(void) {}
+
+void MqttPublisherDigestTest::SetUp() {
+  iniSettings = new supla_mqtt_client_ini_settings();
+  ds = new MqttPublisherDataSourceMock(iniSettings);
+}
+
+void MqttPublisherDigestTest::TearDown() {
+  delete ds;
+  delete iniSettings;
+}
+
+TEST_F(MqttPublisherDigestTest, unchangedPayloadIsSkipped) {
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "1", true));
+  ASSERT_FALSE(ds->digestUpdate(1, "supla/a", "1", true));
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "1", false));
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "2", true));
+  ASSERT_FALSE(ds->digestUpdate(1, "supla/a", "2", true));
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/b", "2", true));
+  ASSERT_TRUE(ds->digestUpdate(2, "supla/a", "2", true));
+  ASSERT_TRUE(ds->digestUpdate(0, "supla/a", "2", true));
+  ASSERT_TRUE(ds->digestUpdate(0, "supla/a", "2", true));
+}
+
+TEST_F(MqttPublisherDigestTest, userdataChangeForgetsTheUser) {
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "1", true));
+  ASSERT_TRUE(ds->digestUpdate(2, "supla/a", "1", true));
+
+  ds->on_userdata_changed(1);
+
+  ASSERT_FALSE(ds->digestExists(1));
+  ASSERT_TRUE(ds->digestExists(2));
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "1", true));
+  ASSERT_FALSE(ds->digestUpdate(2, "supla/a", "1", true));
+}
+
+TEST_F(MqttPublisherDigestTest, sessionLostForgetsEveryone) {
+  ASSERT_TRUE(ds->digestUpdate(1, "supla/a", "1", true));
+  ASSERT_TRUE(ds->digestUpdate(2, "supla/a", "1", true));
+
+  ds->on_broker_session_lost();
+
+  ASSERT_FALSE(ds->digestExists(1));
+  ASSERT_FALSE(ds->digestExists(2));
+}
+
+TEST_F(MqttPublisherDigestTest, reconnectKeepsConfirmedDigests) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  // Anything published within keep alive + response timeout before the link
+  // broke may not have reached the broker.
+  int unconfirmed_sec = iniSettings->getKeepAlive() + MPD_RESPONSE_TIMEOUT_SEC;
+  time_t link_lost = now.tv_sec - 100;
+
+  ds->setDigestTime(1, link_lost - unconfirmed_sec - 1);
+  ds->setDigestTime(2, link_lost - unconfirmed_sec + 1);
+  ds->setDigestTime(3, now.tv_sec);
+  ds->setLinkLostTime(link_lost);
+
+  ds->on_broker_connected();
+
+  ASSERT_TRUE(ds->digestExists(1));
+  ASSERT_FALSE(ds->digestExists(2));
+  ASSERT_FALSE(ds->digestExists(3));
+}
+
+TEST_F(MqttPublisherDigestTest, reconnectWithoutDetectedBreak) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  int unconfirmed_sec = iniSettings->getKeepAlive() + MPD_RESPONSE_TIMEOUT_SEC;
+
+  // Without the time of the break, it is assumed to be now.
+  ds->setDigestTime(1, now.tv_sec - unconfirmed_sec - 10);
+  ds->setDigestTime(2, now.tv_sec - unconfirmed_sec + 10);
+
+  ds->on_broker_connected();
+
+  ASSERT_TRUE(ds->digestExists(1));
+  ASSERT_FALSE(ds->digestExists(2));
+}
+
+TEST_F(MqttPublisherDigestTest, breakIsMeasuredFromDisconnection) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+
+  int unconfirmed_sec = iniSettings->getKeepAlive() + MPD_RESPONSE_TIMEOUT_SEC;
+
+  ds->setDigestTime(1, now.tv_sec - unconfirmed_sec - 10);
+  ds->on_broker_disconnected();
+  ds->on_broker_connected();
+  ASSERT_TRUE(ds->digestExists(1));
+
+  // The time of the break is used once.
+  ds->setDigestTime(2, now.tv_sec - unconfirmed_sec + 10);
+  ds->on_broker_connected();
+  ASSERT_TRUE(ds->digestExists(1));
+  ASSERT_FALSE(ds->digestExists(2));
+}
+
+TEST_F(MqttPublisherDigestTest, reconnectRequeuesEnabledUsers) {
+  ds->enableUser(1);
+  ds->enableUser(2);
+  ds->enableUser(3);
+
+  ASSERT_EQ(ds->get_queue_size(NULL), (size_t)0);
+  ds->on_broker_connected();
+  ASSERT_EQ(ds->get_queue_size(NULL), (size_t)3);
+}
+
+TEST_F(MqttPublisherDigestTest, firstConnectionLoadsEverything) {
+  ds->on_userdata_changed(1);
+  ASSERT_EQ(ds->get_queue_size(NULL), (size_t)1);
+
+  // Without enabled users the full load replaces the queued ones.
+  ds->on_broker_connected();
+  ASSERT_EQ(ds->get_queue_size(NULL), (size_t)0);
+}
+
+} /* namespace testing */
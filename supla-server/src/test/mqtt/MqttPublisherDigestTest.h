@@ -0,0 +1,42 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef MQTTPUBLISHERDIGESTTEST_H_
+#define MQTTPUBLISHERDIGESTTEST_H_
+
+#include "MqttPublisherDataSourceMock.h"
+#include "gtest/gtest.h"  // NOLINT
+#include "mqtt_client_ini_settings.h"
+
+namespace testing {
+
+class MqttPublisherDigestTest : public Test {
+ protected:
+  supla_mqtt_client_ini_settings *iniSettings;
+  MqttPublisherDataSourceMock *ds;
+
+ public:
+  virtual void SetUp();
+  virtual void TearDown();
+  MqttPublisherDigestTest();
+  virtual ~MqttPublisherDigestTest();
+};
+
+} /* namespace testing */
+
+#endif /* MQTTPUBLISHERDIGESTTEST_H_ */
@@ -0,0 +1,57 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "MqttPublisherShardTest.h"
+#include "mqtt_publisher_datasource.h"
+
+namespace testing {
+
+MqttPublisherShardTest::MqttPublisherShardTest(void) {}
+
+MqttPublisherShardTest::~MqttPublisherShardTest(void) {}
+
+TEST_F(MqttPublisherShardTest, singleShard) {
+  for (int user_id = 1; user_id < 1000; user_id++) {
+    ASSERT_EQ(supla_mqtt_publisher_datasource::get_shard(user_id, 1), 0);
+    ASSERT_EQ(supla_mqtt_publisher_datasource::get_shard(user_id, 0), 0);
+  }
+}
+
+TEST_F(MqttPublisherShardTest, stableAndInRange) {
+  for (int user_id = 1; user_id < 1000; user_id++) {
+    int shard = supla_mqtt_publisher_datasource::get_shard(user_id, 3);
+    ASSERT_GE(shard, 0);
+    ASSERT_LT(shard, 3);
+    ASSERT_EQ(supla_mqtt_publisher_datasource::get_shard(user_id, 3), shard);
+  }
+}
+
+TEST_F(MqttPublisherShardTest, consecutiveUsersAreSpread) {
+  int count[4] = {};
+
+  for (int user_id = 1; user_id <= 4000; user_id++) {
+    count[supla_mqtt_publisher_datasource::get_shard(user_id, 4)]++;
+  }
+
+  for (int a = 0; a < 4; a++) {
+    EXPECT_GT(count[a], 800);
+    EXPECT_LT(count[a], 1200);
+  }
+}
+
+} /* namespace testing */
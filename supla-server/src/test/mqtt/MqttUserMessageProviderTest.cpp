@@ -17,6 +17,7 @@
  */
 
 #include "MqttUserMessageProviderTest.h"
+#include <string.h>
 
 namespace testing {
 
@@ -128,4 +129,43 @@ TEST_F(MqttUserMessageProviderTest, fetchAllWithCorrectPrefix) {
   ASSERT_FALSE(dataExists(provider));
 }
 
+TEST_F(MqttUserMessageProviderTest, fetchToMessageBuffer) {
+  _mqtt_db_data_row_user_t row_user;
+  fillUserData(&row_user);
+
+  supla_mqtt_message_buffer buffer;
+  provider->set_message_buffer(&buffer);
+  provider->set_data_row(&row_user);
+
+  char *topic_name = NULL;
+  void *message = NULL;
+  size_t message_size = 0;
+
+  ASSERT_TRUE(
+      provider->fetch("prefix", &topic_name, &message, &message_size));
+  ASSERT_TRUE(topic_name != NULL);
+  ASSERT_TRUE(message != NULL);
+  EXPECT_STREQ(topic_name,
+               "prefix/supla/7720767494dd87196e1896c7cbab707c/account/"
+               "timezone");
+  ASSERT_EQ(message_size, strlen("Europe/Warsaw"));
+  EXPECT_EQ(memcmp(message, "Europe/Warsaw", message_size), 0);
+
+  char *first_topic_name = topic_name;
+  void *first_message = message;
+
+  ASSERT_TRUE(
+      provider->fetch("prefix", &topic_name, &message, &message_size));
+  EXPECT_STREQ(topic_name,
+               "prefix/supla/7720767494dd87196e1896c7cbab707c/account/email");
+  ASSERT_EQ(message_size, strlen("user@supla.org"));
+  EXPECT_EQ(memcmp(message, "user@supla.org", message_size), 0);
+
+  // The buffer is reused, so nothing is freed here.
+  EXPECT_EQ(topic_name, first_topic_name);
+  EXPECT_EQ(message, first_message);
+
+  ASSERT_FALSE(dataExists(provider));
+}
+
 } /* namespace testing */
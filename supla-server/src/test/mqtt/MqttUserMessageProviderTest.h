@@ -22,6 +22,7 @@
 #include "MqttMessageProviderTest.h"
 #include "gtest/gtest.h"  // NOLINT
 #include "mqtt_db.h"
+#include "mqtt_message_buffer.h"
 #include "mqtt_user_message_provider.h"
 
 namespace testing {
@@ -19,16 +19,6 @@
 #include <clientcontainer.h>
 #include "client/client.h"
 
-// static
-char supla_user_client_container::find_client_byid(void *ptr, void *ID) {
-  return ((supla_client *)ptr)->getID() == *(int *)ID ? 1 : 0;
-}
-
-// static
-char supla_user_client_container::find_client_byguid(void *ptr, void *GUID) {
-  return ((supla_client *)ptr)->cmpGUID((char *)GUID) ? 1 : 0;
-}
-
 supla_user_client_container::supla_user_client_container() : cdcontainer() {}
 
 supla_user_client_container::~supla_user_client_container() {}
@@ -52,11 +42,11 @@ supla_client *supla_user_client_container::findByID(int ClientID) {
   if (ClientID == 0) {
     return NULL;
   }
-  return baseToClient(find(find_client_byid, &ClientID));
+  return baseToClient(findBaseByID(ClientID));
 }
 
 supla_client *supla_user_client_container::findByGUID(const char *GUID) {
-  return baseToClient(find(find_client_byguid, (void *)GUID));
+  return baseToClient(findBaseByGUID(GUID));
 }
 
 supla_client *supla_user_client_container::get(int idx) {
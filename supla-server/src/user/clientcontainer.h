@@ -23,9 +23,6 @@
 
 class supla_user_client_container : public cdcontainer {
  private:
-  static char find_client_byid(void *ptr, void *ID);
-  static char find_client_byguid(void *ptr, void *GUID);
-
   supla_client *baseToClient(cdbase *base);
 
  protected:
@@ -16,28 +16,35 @@
  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 #include "devicecontainer.h"
+#include <stdlib.h>
+#include <list>
 #include "device/device.h"
 
 // static
-char supla_user_device_container::find_device_byid(void *ptr, void *ID) {
-  return ((supla_device *)ptr)->getID() == *(int *)ID ? 1 : 0;
+unsigned long long supla_user_device_container::channel_ref_key(void *ptr) {
+  return ((supla_user_channel_ref_t *)ptr)->ChannelID;
 }
 
 // static
-char supla_user_device_container::find_device_by_channelid(void *ptr,
-                                                           void *ID) {
-  return ((supla_device *)ptr)->get_channels()->channel_exists(*(int *)ID) ? 1
-                                                                           : 0;
+char supla_user_device_container::find_channel_ref(void *ptr, void *device) {
+  return ((supla_user_channel_ref_t *)ptr)->device == device ? 1 : 0;
 }
 
 // static
-char supla_user_device_container::find_device_byguid(void *ptr, void *GUID) {
-  return ((supla_device *)ptr)->cmpGUID((char *)GUID) ? 1 : 0;
+char supla_user_device_container::channel_ref_clean(void *ptr) {
+  free(ptr);
+  return 1;
 }
 
-supla_user_device_container::supla_user_device_container() : cdcontainer() {}
+supla_user_device_container::supla_user_device_container() : cdcontainer() {
+  channel_arr = safe_array_init();
+  safe_array_add_index(channel_arr, channel_ref_key);
+}
 
-supla_user_device_container::~supla_user_device_container() {}
+supla_user_device_container::~supla_user_device_container() {
+  safe_array_clean(channel_arr, channel_ref_clean);
+  safe_array_free(channel_arr);
+}
 
 void supla_user_device_container::cd_delete(cdbase *base) {
   supla_device *device = dynamic_cast<supla_device *>(base);
@@ -46,6 +53,54 @@ void supla_user_device_container::cd_delete(cdbase *base) {
   }
 }
 
+void supla_user_device_container::onItemAdded(cdbase *base) {
+  supla_device *device = dynamic_cast<supla_device *>(base);
+  if (device == NULL) {
+    return;
+  }
+
+  // The set of channels does not change while the device is on the list.
+  // Channels are loaded during registration, before the device is added.
+  std::list<int> ids = device->get_channels()->get_channel_ids();
+
+  safe_array_lock(channel_arr);
+  for (std::list<int>::iterator it = ids.begin(); it != ids.end(); ++it) {
+    supla_user_channel_ref_t *ref =
+        (supla_user_channel_ref_t *)malloc(sizeof(supla_user_channel_ref_t));
+    if (ref) {
+      ref->ChannelID = *it;
+      ref->device = device;
+      if (safe_array_add(channel_arr, ref) == -1) {
+        free(ref);
+      }
+    }
+  }
+  safe_array_unlock(channel_arr);
+}
+
+void supla_user_device_container::onItemRemoved(cdbase *base) {
+  supla_device *device = dynamic_cast<supla_device *>(base);
+  if (device == NULL) {
+    return;
+  }
+
+  std::list<int> ids = device->get_channels()->get_channel_ids();
+
+  safe_array_lock(channel_arr);
+  for (std::list<int>::iterator it = ids.begin(); it != ids.end(); ++it) {
+    // A channel ID can be referenced by more than one device for a while,
+    // e.g. when a device reconnects before the old connection is closed.
+    supla_user_channel_ref_t *ref =
+        (supla_user_channel_ref_t *)safe_array_findkey(
+            channel_arr, 0, *it, find_channel_ref, device);
+    if (ref) {
+      safe_array_remove(channel_arr, ref);
+      free(ref);
+    }
+  }
+  safe_array_unlock(channel_arr);
+}
+
 supla_device *supla_user_device_container::baseToDevice(cdbase *base) {
   supla_device *device = NULL;
   if (base && (device = dynamic_cast<supla_device *>(base)) == NULL) {
@@ -58,18 +113,33 @@ supla_device *supla_user_device_container::findByID(int DeviceID) {
   if (DeviceID == 0) {
     return NULL;
   }
-  return baseToDevice(find(find_device_byid, &DeviceID));
+  return baseToDevice(findBaseByID(DeviceID));
 }
 
 supla_device *supla_user_device_container::findByChannelID(int ChannelID) {
   if (ChannelID == 0) {
     return NULL;
   }
-  return baseToDevice(find(find_device_by_channelid, &ChannelID));
+
+  supla_device *result = NULL;
+
+  safe_array_lock(channel_arr);
+  supla_user_channel_ref_t *ref =
+      (supla_user_channel_ref_t *)safe_array_findkey(channel_arr, 0, ChannelID,
+                                                     NULL, NULL);
+  if (ref) {
+    // Devices are removed from this index before they are moved to the trash,
+    // so the pointer is valid as long as the index is locked.
+    result = ref->device;
+    result->retainPtr();
+  }
+  safe_array_unlock(channel_arr);
+
+  return result;
 }
 
 supla_device *supla_user_device_container::findByGUID(const char *GUID) {
-  return baseToDevice(find(find_device_byguid, (void *)GUID));
+  return baseToDevice(findBaseByGUID(GUID));
 }
 
 supla_device *supla_user_device_container::get(int idx) {
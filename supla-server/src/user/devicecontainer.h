@@ -21,16 +21,26 @@
 
 #include "cdcontainer.h"
 
+typedef struct {
+  int ChannelID;
+  supla_device *device;
+} supla_user_channel_ref_t;
+
 class supla_user_device_container : public cdcontainer {
  private:
-  static char find_device_byid(void *ptr, void *ID);
-  static char find_device_by_channelid(void *ptr, void *ID);
-  static char find_device_byguid(void *ptr, void *GUID);
+  // ChannelID -> device index of the devices on the list
+  void *channel_arr;
+
+  static unsigned long long channel_ref_key(void *ptr);
+  static char find_channel_ref(void *ptr, void *device);
+  static char channel_ref_clean(void *ptr);
 
   supla_device *baseToDevice(cdbase *base);
 
  protected:
   virtual void cd_delete(cdbase *base);
+  virtual void onItemAdded(cdbase *base);
+  virtual void onItemRemoved(cdbase *base);
 
  public:
   supla_user_device_container();
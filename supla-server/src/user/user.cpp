@@ -25,8 +25,11 @@
 #include <list>
 #include "client.h"
 #include "clientcontainer.h"
+#include "clientmetadatacache.h"
 #include "database.h"
+#include "datalogger.h"
 #include "device.h"
+#include "device_registration_cache.h"
 #include "devicecontainer.h"
 #include "http/httprequestqueue.h"
 #include "lck.h"
@@ -43,8 +46,8 @@ unsigned int supla_user::device_max_metric = 0;
 struct timeval supla_user::metric_tv = (struct timeval){0};
 
 // static
-char supla_user::find_user_by_id(void *ptr, void *UserID) {
-  return ((supla_user *)ptr)->getUserID() == *(int *)UserID ? 1 : 0;
+unsigned long long supla_user::user_id_key(void *ptr) {
+  return ((supla_user *)ptr)->getUserID();
 }
 
 // static
@@ -74,6 +77,7 @@ void supla_user::user_init(int UserID, const char *short_unique_id,
   this->long_unique_id =
       long_unique_id ? strndup(long_unique_id, LONG_UNIQUEID_MAXSIZE) : NULL;
   this->lck = lck_init();
+  this->offline_temphum_arr = NULL;
   this->amazon_alexa_credentials->load();
   this->google_home_credentials->load();
   this->state_webhook_credentials->load();
@@ -110,6 +114,10 @@ supla_user::~supla_user() {
   compex_value_cache_clean(0);
   safe_array_free(complex_value_functions_arr);
 
+  if (offline_temphum_arr) {
+    supla_channel_temphum::free(offline_temphum_arr);
+  }
+
   if (!device_container->deleteAll(10)) {
     supla_log(LOG_ERR,
               "Can't release user device container items! (TIMEOUT) UserID:%i",
@@ -125,7 +133,10 @@ supla_user::~supla_user() {
   delete client_container;
 }
 
-void supla_user::init(void) { supla_user::user_arr = safe_array_init(); }
+void supla_user::init(void) {
+  supla_user::user_arr = safe_array_init();
+  safe_array_add_index(supla_user::user_arr, user_id_key);
+}
 
 void supla_user::user_free(void) {
   supla_user *ptr = NULL;
@@ -185,6 +196,8 @@ supla_user *supla_user::get_user(int idx) {
 }
 
 void supla_user::moveDeviceToTrash(supla_device *device) {
+  // The offline values of the device's channels may have changed.
+  supla_client_metadata_cache::global_instance()->user_invalidate(getUserID());
   device_container->moveToTrash(device);
 }
 
@@ -197,6 +210,18 @@ void supla_user::emptyTrash(void) {
   client_container->emptyTrash();
 }
 
+// static
+void supla_user::empty_all_trash(void) {
+  // Users are deleted only by user_free(), so the pointers remain valid
+  // after the array is unlocked.
+  for (int a = 0; a < user_count(); a++) {
+    supla_user *user = get_user(a);
+    if (user) {
+      user->emptyTrash();
+    }
+  }
+}
+
 bool supla_user::getClientName(int ClientID, char *buffer, int size) {
   if (size < 1) return false;
 
@@ -230,7 +255,7 @@ supla_user *supla_user::find(int UserID, bool create) {
   safe_array_lock(supla_user::user_arr);
 
   supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
+      (supla_user *)safe_array_findkey(user_arr, 0, UserID, NULL, NULL);
 
   if (user == NULL && create) user = new supla_user(UserID);
 
@@ -372,10 +397,7 @@ bool supla_user::is_channel_online(int DeviceID, int ChannelID) {
 bool supla_user::is_client_online(int UserID, int ClientID) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user && user->is_client_online(ClientID) == true) result = true;
 
@@ -386,10 +408,7 @@ bool supla_user::is_client_online(int UserID, int ClientID) {
 bool supla_user::is_device_online(int UserID, int DeviceID) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user && user->is_device_online(DeviceID) == true) result = true;
 
@@ -400,10 +419,7 @@ bool supla_user::is_device_online(int UserID, int DeviceID) {
 bool supla_user::is_channel_online(int UserID, int DeviceID, int ChannelID) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user && user->is_channel_online(DeviceID, ChannelID) == true)
     result = true;
@@ -515,10 +531,7 @@ bool supla_user::get_channel_double_value(int UserID, int DeviceID,
                                           char Type) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     switch (Type) {
@@ -563,10 +576,7 @@ bool supla_user::get_channel_char_value(int UserID, int DeviceID, int ChannelID,
                                         char *Value) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     result = user->get_channel_char_value(DeviceID, ChannelID, Value) == true;
@@ -581,10 +591,7 @@ bool supla_user::get_channel_rgbw_value(int UserID, int DeviceID, int ChannelID,
                                         char *brightness, char *on_off) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     result = user->get_channel_rgbw_value(DeviceID, ChannelID, color,
@@ -600,10 +607,7 @@ supla_channel_electricity_measurement *supla_user::get_electricity_measurement(
     int UserID, int DeviceID, int ChannelID) {
   supla_channel_electricity_measurement *result = NULL;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     result = user->get_electricity_measurement(DeviceID, ChannelID);
@@ -617,10 +621,7 @@ supla_channel_ic_measurement *supla_user::supla_user::get_ic_measurement(
     int UserID, int DeviceID, int ChannelID) {
   supla_channel_ic_measurement *result = NULL;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     result = user->get_ic_measurement(DeviceID, ChannelID);
@@ -634,10 +635,7 @@ bool supla_user::get_channel_valve_value(int UserID, int DeviceID,
                                          int ChannelID, TValve_Value *Value) {
   bool result = false;
 
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     result = user->get_channel_valve_value(DeviceID, ChannelID, Value) == true;
@@ -726,10 +724,7 @@ bool supla_user::get_channel_extendedvalue(int DeviceID, int ChannelID,
 
 // static
 void supla_user::on_amazon_alexa_credentials_changed(int UserID) {
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     user->amazonAlexaCredentials()->on_credentials_changed();
@@ -738,10 +733,7 @@ void supla_user::on_amazon_alexa_credentials_changed(int UserID) {
 
 // static
 void supla_user::on_google_home_credentials_changed(int UserID) {
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     user->googleHomeCredentials()->on_credentials_changed();
@@ -750,10 +742,7 @@ void supla_user::on_google_home_credentials_changed(int UserID) {
 
 // static
 void supla_user::on_state_webhook_changed(int UserID) {
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_user *user = find(UserID, false);
 
   if (user) {
     user->stateWebhookCredentials()->on_credentials_changed();
@@ -768,6 +757,7 @@ void supla_user::on_mqtt_settings_changed(int UserID) {
 // static
 void supla_user::before_channel_function_change(
     int UserID, int ChannelID, event_source_type eventSourceType) {
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
   supla_mqtt_client_suite::globalInstance()->beforeChannelFunctionChange(
       UserID, ChannelID);
 }
@@ -775,6 +765,9 @@ void supla_user::before_channel_function_change(
 // static
 void supla_user::before_device_delete(int UserID, int DeviceID,
                                       event_source_type eventSourceType) {
+  supla_device_registration_cache::global_instance()->device_invalidate(
+      UserID, DeviceID);
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
   supla_mqtt_client_suite::globalInstance()->beforeDeviceDelete(UserID,
                                                                 DeviceID);
 }
@@ -782,10 +775,11 @@ void supla_user::before_device_delete(int UserID, int DeviceID,
 // static
 void supla_user::on_device_deleted(int UserID, int DeviceID,
                                    event_source_type eventSourceType) {
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_device_registration_cache::global_instance()->device_invalidate(
+      UserID, DeviceID);
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
+
+  supla_user *user = find(UserID, false);
 
   if (user) {
     supla_http_request_queue::getInstance()->onDeviceDeletedEvent(
@@ -799,10 +793,11 @@ void supla_user::on_device_deleted(int UserID, int DeviceID,
 // static
 void supla_user::on_device_settings_changed(int UserID, int DeviceID,
                                             event_source_type eventSourceType) {
-  safe_array_lock(supla_user::user_arr);
-  supla_user *user =
-      (supla_user *)safe_array_findcnd(user_arr, find_user_by_id, &UserID);
-  safe_array_unlock(supla_user::user_arr);
+  supla_device_registration_cache::global_instance()->device_invalidate(
+      UserID, DeviceID);
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
+
+  supla_user *user = find(UserID, false);
 
   if (user) {
     supla_mqtt_client_suite::globalInstance()->onDeviceSettingsChanged(
@@ -953,6 +948,8 @@ bool supla_user::set_channelgroup_rgbw_value(int GroupID, int color,
 }
 
 void supla_user::update_client_device_channels(int LocationID, int DeviceID) {
+  supla_client_metadata_cache::global_instance()->user_invalidate(getUserID());
+
   {
     supla_client *client;
 
@@ -1056,33 +1053,103 @@ void supla_user::call_event(TSC_SuplaEvent *event) {
     }
 }
 
-void supla_user::get_temp_and_humidity(void *tarr) {
+void supla_user::get_temp_and_humidity(void *tarr, int shard,
+                                       int shard_count) {
   int a;
   supla_device *device;
 
+  // Values of channels that are not connected are loaded from the database.
+  // This is done in the shard of the user so that the query is executed once
+  // per interval. The connected channels are then collected from all shards
+  // to let the query skip them. The loaded values are logged in the shards of
+  // their channels, like the values of the connected ones.
+
+  bool load = supla_datalogger::in_shard(getUserID(), shard, shard_count);
+  void *uarr = load ? safe_array_init() : tarr;
+
   for (a = 0; a < device_container->count(); a++) {
     if (NULL != (device = device_container->get(a))) {
-      device->get_channels()->get_temp_and_humidity(tarr);
+      if (load) {
+        device->get_channels()->get_temp_and_humidity(uarr);
+      } else {
+        device->get_channels()->get_temp_and_humidity(tarr, shard,
+                                                      shard_count);
+      }
       device->releasePtr();
     }
   }
 
-  database *db = new database();
+  if (load) {
+    int connected_count = safe_array_count(uarr);
+
+    database *db = new database();
+
+    if (db->connect() == true) {
+      db->load_temperatures_and_humidity(getUserID(), uarr);
+    }
+
+    delete db;
+
+    // Anything left from the previous load is an interval old.
+    if (offline_temphum_arr) {
+      supla_channel_temphum::free(offline_temphum_arr);
+    }
+    offline_temphum_arr = safe_array_init();
 
-  if (db->connect() == true) {
-    db->load_temperatures_and_humidity(getUserID(), tarr);
+    for (a = 0; a < safe_array_count(uarr); a++) {
+      supla_channel_temphum *sct =
+          static_cast<supla_channel_temphum *>(safe_array_get(uarr, a));
+
+      if (a >= connected_count) {
+        safe_array_add(offline_temphum_arr, sct);
+      } else if (supla_datalogger::in_shard(sct->getChannelId(), shard,
+                                            shard_count)) {
+        safe_array_add(tarr, sct);
+      } else {
+        delete sct;
+      }
+    }
+
+    safe_array_free(uarr);
+  }
+
+  if (offline_temphum_arr == NULL) {
+    return;
   }
 
-  delete db;
+  a = 0;
+  while (a < safe_array_count(offline_temphum_arr)) {
+    supla_channel_temphum *sct = static_cast<supla_channel_temphum *>(
+        safe_array_get(offline_temphum_arr, a));
+
+    if (!supla_datalogger::in_shard(sct->getChannelId(), shard,
+                                    shard_count)) {
+      a++;
+      continue;
+    }
+
+    safe_array_delete(offline_temphum_arr, a);
+
+    // A channel connected in the meantime has been collected from its device.
+    if (NULL != (device = device_container->findByChannelID(
+                     sct->getChannelId()))) {
+      device->releasePtr();
+      delete sct;
+    } else {
+      safe_array_add(tarr, sct);
+    }
+  }
 }
 
-void supla_user::get_electricity_measurements(void *emarr) {
+void supla_user::get_electricity_measurements(void *emarr, int shard,
+                                              int shard_count) {
   int a;
   supla_device *device;
 
   for (a = 0; a < device_container->count(); a++) {
     if (NULL != (device = device_container->get(a))) {
-      device->get_channels()->get_electricity_measurements(emarr);
+      device->get_channels()->get_electricity_measurements(emarr, shard,
+                                                           shard_count);
       device->releasePtr();
     }
   }
@@ -1101,13 +1168,13 @@ supla_channel_electricity_measurement *supla_user::get_electricity_measurement(
   return result;
 }
 
-void supla_user::get_ic_measurements(void *icarr) {
+void supla_user::get_ic_measurements(void *icarr, int shard, int shard_count) {
   int a;
   supla_device *device;
 
   for (a = 0; a < device_container->count(); a++) {
     if (NULL != (device = device_container->get(a))) {
-      device->get_channels()->get_ic_measurements(icarr);
+      device->get_channels()->get_ic_measurements(icarr, shard, shard_count);
       device->releasePtr();
     }
   }
@@ -1126,13 +1193,15 @@ supla_channel_ic_measurement *supla_user::get_ic_measurement(int DeviceID,
   return result;
 }
 
-void supla_user::get_thermostat_measurements(void *tharr) {
+void supla_user::get_thermostat_measurements(void *tharr, int shard,
+                                             int shard_count) {
   int a;
   supla_device *device;
 
   for (a = 0; a < device_container->count(); a++) {
     if (NULL != (device = device_container->get(a))) {
-      device->get_channels()->get_thermostat_measurements(tharr);
+      device->get_channels()->get_thermostat_measurements(tharr, shard,
+                                                          shard_count);
       device->releasePtr();
     }
   }
@@ -1266,6 +1335,11 @@ bool supla_user::device_reconnect(int DeviceID) {
 
 // static
 bool supla_user::reconnect(int UserID, event_source_type eventSourceType) {
+  // Credentials, locations or devices may have been changed.
+  supla_device_registration_cache::global_instance()->user_invalidate(UserID);
+  cdbase::authkey_auth_cache_user_invalidate(UserID);
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
+
   supla_user *user = find(UserID, true);
 
   if (user) {
@@ -1279,6 +1353,9 @@ bool supla_user::reconnect(int UserID, event_source_type eventSourceType) {
 
 // static
 bool supla_user::client_reconnect(int UserID, int ClientID) {
+  // The client may have been assigned to another access identifier.
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
+
   supla_user *user = find(UserID, true);
 
   if (user) {
@@ -1290,6 +1367,10 @@ bool supla_user::client_reconnect(int UserID, int ClientID) {
 
 // static
 bool supla_user::device_reconnect(int UserID, int DeviceID) {
+  supla_device_registration_cache::global_instance()->device_invalidate(
+      UserID, DeviceID);
+  supla_client_metadata_cache::global_instance()->user_invalidate(UserID);
+
   supla_user *user = find(UserID, true);
 
   if (user) {
@@ -1444,6 +1525,9 @@ void supla_user::set_channel_function(supla_client *sender,
   }
 
   if (result.ResultCode == SUPLA_RESULTCODE_TRUE) {
+    supla_client_metadata_cache::global_instance()->user_invalidate(
+        getUserID());
+
     supla_device *device = device_container->findByChannelID(func->ChannelID);
     if (device != NULL) {
       device->get_channels()->set_channel_function(func->ChannelID, func->Func);
@@ -1497,6 +1581,9 @@ void supla_user::set_caption(supla_client *sender, TCS_SetCaption *caption,
   }
 
   if (result.ResultCode == SUPLA_RESULTCODE_TRUE) {
+    supla_client_metadata_cache::global_instance()->user_invalidate(
+        getUserID());
+
     supla_client *client = NULL;
 
     for (int a = 0; a < client_container->count(); a++)
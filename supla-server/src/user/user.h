@@ -42,6 +42,9 @@ class supla_user {
   char *short_unique_id;
   char *long_unique_id;
   void *lck;
+  // Logged values of the channels that are not connected, loaded in the
+  // datalogger shard of the user and waiting for the shards of the channels.
+  void *offline_temphum_arr;
 
   static struct timeval metric_tv;
   static unsigned int client_add_metric;
@@ -74,7 +77,7 @@ class supla_user {
   void compex_value_cache_update_function(int DeviceId, int ChannelID, int Type,
                                           int Function, bool channel_is_hidden);
 
-  static char find_user_by_id(void *ptr, void *UserID);
+  static unsigned long long user_id_key(void *ptr);
   static char find_user_by_suid(void *ptr, void *suid);
   static bool get_channel_double_value(int UserID, int DeviceID, int ChannelID,
                                        double *Value, char Type);
@@ -135,6 +138,9 @@ class supla_user {
                                          event_source_type eventSourceType);
   static unsigned int total_cd_count(bool client);
   static void log_metrics(int min_interval_sec);
+  // Deletes the devices and the clients left in the trash by connections
+  // which ended while other threads were still using them.
+  static void empty_all_trash(void);
 
   void reconnect(event_source_type eventSourceType);
   void reconnect(event_source_type eventSourceType, bool allDevices,
@@ -205,13 +211,15 @@ class supla_user {
   void on_channel_become_online(int DeviceId, int ChannelId);
 
   void call_event(TSC_SuplaEvent *event);
-  void get_temp_and_humidity(void *tarr);
-  void get_electricity_measurements(void *emarr);
+  void get_temp_and_humidity(void *tarr, int shard = 0, int shard_count = 1);
+  void get_electricity_measurements(void *emarr, int shard = 0,
+                                    int shard_count = 1);
   supla_channel_electricity_measurement *get_electricity_measurement(
       int DeviceID, int ChannelID);
-  void get_ic_measurements(void *icarr);
+  void get_ic_measurements(void *icarr, int shard = 0, int shard_count = 1);
   supla_channel_ic_measurement *get_ic_measurement(int DeviceID, int ChannelID);
-  void get_thermostat_measurements(void *tharr);
+  void get_thermostat_measurements(void *tharr, int shard = 0,
+                                   int shard_count = 1);
 
   bool device_calcfg_request(int SenderID, int DeviceId, int ChannelId,
                              TCS_DeviceCalCfgRequest_B *request);